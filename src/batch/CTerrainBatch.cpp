@@ -0,0 +1,240 @@
+#include "CTerrainBatch.h"
+#include "../terrain/TerrainBrushStamps.h"
+#include "../terrain/TerrainFilters.h"
+#include "../terrain/TerrainGenerators.h"
+#include <fstream>
+#include <stdlib.h>
+
+/*
+ *	\brief Class constructor
+*/
+CTerrainBatch::CTerrainBatch()
+{
+
+}
+
+/*
+ *	\brief Class destructor
+*/
+CTerrainBatch::~CTerrainBatch()
+{
+
+}
+
+/*
+ *	\brief Set the run as failed with a given reason
+*/
+bool CTerrainBatch::Fail(
+		const std::string &error					//!< Why the run failed
+	)
+{
+	m_error = error;
+	return false;
+}
+
+/*
+ *	\brief Read the script to run from a file
+*/
+bool CTerrainBatch::LoadScript(
+		const char *fileName						//!< The location of the script
+	)
+{
+	std::ifstream file(fileName);
+	if (!file.is_open())
+	{
+		return Fail(std::string("Failed to open the script ") + fileName);
+	}
+
+	m_script.clear();
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		m_script.push_back(line);
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Run the script, loading and saving a heightmap either side if given
+*/
+bool CTerrainBatch::Run(
+		const char *input,							//!< The heightmap to load before the script, or null
+		const char *output							//!< The heightmap to save after the script, or null
+	)
+{
+	m_error.clear();
+
+	if (input != nullptr && !m_heightField.Load(input))
+	{
+		return Fail(m_heightField.GetError());
+	}
+
+	for (unsigned int lineIndex = 0; lineIndex < m_script.size(); ++lineIndex)
+	{
+		std::string line = m_script[lineIndex];
+
+		const std::string::size_type comment = line.find('#');
+		if (comment != std::string::npos)
+		{
+			line.erase(comment);
+		}
+
+		std::istringstream arguments(line);
+		std::string command;
+		if (!(arguments >> command))
+			continue;
+
+		if (!RunCommand(command, arguments))
+		{
+			std::stringstream error;
+			error << "Line " << (lineIndex + 1) << ": " << m_error;
+			return Fail(error.str());
+		}
+	}
+
+	if (output != nullptr && !m_heightField.Save(output))
+	{
+		return Fail(std::string(output) + ": " + m_heightField.GetError());
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Run a single command from the script
+*/
+bool CTerrainBatch::RunCommand(
+		const std::string &command,					//!< The name of the command
+		std::istringstream &arguments				//!< The rest of the line
+	)
+{
+	if (command == "new")
+	{
+		unsigned int size = 0;
+		float height = 0.0f;
+		if (!(arguments >> size) || size < 2)
+			return Fail("new expects a size of at least 2");
+		arguments >> height;
+
+		m_heightField.Create(size, height);
+		return true;
+	}
+
+	if (command == "load" || command == "save")
+	{
+		std::string fileName;
+		if (!(arguments >> fileName))
+			return Fail(command + " expects a file name");
+
+		const bool result = command == "load" ? m_heightField.Load(fileName.c_str()) : m_heightField.Save(fileName.c_str());
+		return result ? true : Fail(fileName + ": " + m_heightField.GetError());
+	}
+
+	if (command == "seed")
+	{
+		unsigned int seed = 0;
+		if (!(arguments >> seed))
+			return Fail("seed expects a number");
+
+		srand(seed);
+		return true;
+	}
+
+	static const char *const EditCommands[] = { "raise", "lower", "level", "smooth", "noise", "flat", "fractal", "blur", "clamp", "rescale" };
+
+	bool known = false;
+	for (unsigned int commandIndex = 0; commandIndex < sizeof(EditCommands) / sizeof(EditCommands[0]); ++commandIndex)
+	{
+		known = known || command == EditCommands[commandIndex];
+	}
+
+	if (!known)
+		return Fail("Unknown command '" + command + "'");
+
+	// everything below edits the heightmap, so one must exist
+	const HeightPlane plane = m_heightField.GetPlane();
+	if (plane.IsEmpty())
+		return Fail(command + " needs a heightmap, use new or load first");
+
+	if (command == "raise" || command == "lower" || command == "level" || command == "smooth" || command == "noise")
+	{
+		float x = 0.0f, z = 0.0f;
+		int size = 0;
+		if (!(arguments >> x >> z >> size))
+			return Fail(command + " expects <x> <z> <size>");
+
+		if (command == "level")
+		{
+			StampLevel(plane, x, z, size);
+			return true;
+		}
+
+		if (command == "smooth")
+		{
+			float amount = 0.1f;
+			arguments >> amount;
+			StampSmooth(plane, x, z, size, amount);
+			return true;
+		}
+
+		if (command == "noise")
+		{
+			float amplitude = 0.125f;
+			arguments >> amplitude;
+			StampNoise(plane, x, z, size, amplitude);
+			return true;
+		}
+
+		float strength = 0.0f;
+		if (!(arguments >> strength))
+			return Fail(command + " expects <x> <z> <size> <strength>");
+
+		// the same falloff as the mouse driven raise and lower brushes
+		StampOffset(plane, x, z, size, command == "raise" ? strength : -strength, 0.75f);
+		return true;
+	}
+
+	if (command == "flat")
+	{
+		float height = 0.0f;
+		if (!(arguments >> height))
+			return Fail("flat expects a height");
+
+		GenerateFlat(plane, height);
+		return true;
+	}
+
+	if (command == "fractal")
+	{
+		unsigned int seed = 0, octaves = 0;
+		float featureSize = 0.0f, amplitude = 0.0f, persistence = 0.0f;
+		if (!(arguments >> seed >> octaves >> featureSize >> amplitude >> persistence))
+			return Fail("fractal expects <seed> <octaves> <feature size> <amplitude> <persistence>");
+
+		GenerateFractal(plane, seed, octaves, featureSize, amplitude, persistence);
+		return true;
+	}
+
+	if (command == "blur")
+	{
+		unsigned int passes = 0;
+		if (!(arguments >> passes))
+			return Fail("blur expects a number of passes");
+
+		FilterBlur(plane, passes);
+		return true;
+	}
+
+	// only clamp and rescale are left
+	float minimum = 0.0f, maximum = 0.0f;
+	if (!(arguments >> minimum >> maximum) || minimum > maximum)
+		return Fail(command + " expects <min> <max>");
+
+	if (command == "clamp")
+		FilterClamp(plane, minimum, maximum);
+	else
+		FilterRescale(plane, minimum, maximum);
+	return true;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "../terrain/CHeightField.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ *	\brief Runs a script of brush stamps, generators and filters over a heightmap.
+ *	Scripts hold one command per line, '#' starts a comment:
+ *
+ *		new <size> [height]						create a flat heightmap
+ *		load <file>								load a 24 bit heightmap bitmap
+ *		save <file>								save the heightmap as a 24 bit bitmap
+ *		seed <seed>								seed the noise stamp
+ *		raise <x> <z> <size> <strength>			raise the terrain like the raise brush
+ *		lower <x> <z> <size> <strength>			lower the terrain like the lower brush
+ *		level <x> <z> <size>					level the terrain to the height at x, z
+ *		smooth <x> <z> <size> [amount]			pull the terrain towards its average
+ *		noise <x> <z> <size> [amplitude]		add random noise to the terrain
+ *		flat <height>							set the whole heightmap to a height
+ *		fractal <seed> <octaves> <feature size> <amplitude> <persistence>
+ *		blur <passes>							3x3 box blur the whole heightmap
+ *		clamp <min> <max>						clamp every height into a range
+ *		rescale <min> <max>						stretch the heights to span a range
+*/
+class CTerrainBatch {
+private:
+	std::vector<std::string>	m_script;						//!< The lines of the script
+	CHeightField				m_heightField;					//!< The heightmap the script edits
+	std::string					m_error;						//!< A description of why the last run failed
+
+private:
+								//! Run a single command from the script
+	bool						RunCommand(
+									const std::string &command,		//!< The name of the command
+									std::istringstream &arguments	//!< The rest of the line
+								);
+
+								//! Set the run as failed with a given reason
+	bool						Fail(
+									const std::string &error		//!< Why the run failed
+								);
+
+public:
+								//! Class constructor
+								CTerrainBatch();
+
+								//! Class destructor
+								~CTerrainBatch();
+
+								//! Read the script to run from a file
+	bool						LoadScript(
+									const char *fileName			//!< The location of the script
+								);
+
+								//! Run the script, loading and saving a heightmap either side if given
+	bool						Run(
+									const char *input,				//!< The heightmap to load before the script, or null
+									const char *output				//!< The heightmap to save after the script, or null
+								);
+
+								//! Get a description of why the last run failed
+	const char					*GetError() const
+								{
+									return m_error.c_str();
+								}
+};
@@ -0,0 +1,61 @@
+/*
+ *	VisCraftBatch - runs a terrain script over heightmaps without a window or GPU.
+ *
+ *	Usage: VisCraftBatch <script> [<input heightmap> <output heightmap>]...
+ *
+ *	With no heightmaps the script runs once and is expected to new/load and save itself.
+ *	Otherwise each input is loaded, the script is run and the result written to its output.
+ *	The time taken per heightmap is printed so runs can be compared between builds.
+ *
+ *	The tool only uses the portable terrain core, on Linux it builds with the top level CMakeLists.txt.
+*/
+
+#include "CTerrainBatch.h"
+#include <chrono>
+#include <iostream>
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2 || (argc % 2) != 0)
+	{
+		std::cerr << "Usage: " << argv[0] << " <script> [<input heightmap> <output heightmap>]..." << std::endl;
+		return 2;
+	}
+
+	CTerrainBatch batch;
+	if (!batch.LoadScript(argv[1]))
+	{
+		std::cerr << batch.GetError() << std::endl;
+		return 1;
+	}
+
+	if (argc == 2)
+	{
+		if (!batch.Run(nullptr, nullptr))
+		{
+			std::cerr << argv[1] << ": " << batch.GetError() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+
+	int failed = 0;
+	for (int argument = 2; argument < argc; argument += 2)
+	{
+		const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		const bool result = batch.Run(argv[argument], argv[argument + 1]);
+		const std::chrono::high_resolution_clock::duration taken = std::chrono::high_resolution_clock::now() - start;
+
+		if (!result)
+		{
+			std::cerr << argv[argument] << ": " << batch.GetError() << std::endl;
+			failed++;
+			continue;
+		}
+
+		std::cout << argv[argument] << " -> " << argv[argument + 1] << " ("
+			<< std::chrono::duration_cast<std::chrono::milliseconds>(taken).count() << " ms)" << std::endl;
+	}
+
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,428 @@
+#include "Benchmarks.h"
+#include "../kinect/CAudioRing.h"
+#include "../kinect/CLatencyHistogram.h"
+#include <chrono>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+// a 10 millisecond chunk of the kinect's 16kHz 16 bit mono audio, about what the capture thread gets a pass
+static const unsigned int ChunkBytes = 320;
+
+// the samples the synthetic capture thread writes, each a 32 bit count so a torn or reordered one shows
+static const unsigned int CaptureSamples = 200000;
+static const unsigned int SampleBytes = sizeof(unsigned int);
+
+// the chunks timestamped to measure how long the reader takes to get them
+static const unsigned int LatencyChunks = 200;
+
+/*
+ *	\brief Write a run of counted samples
+*/
+static void WriteSamples(
+		CAudioRing &ring,							//!< The ring
+		unsigned int first,							//!< The count of the first sample
+		unsigned int count							//!< The number of samples
+	)
+{
+	std::vector<unsigned int> samples(count);
+	for (unsigned int sample = 0; sample < count; ++sample)
+	{
+		samples[sample] = first + sample;
+	}
+
+	ring.Write(reinterpret_cast<const unsigned char *>(&samples[0]), count * SampleBytes);
+}
+
+/*
+ *	\brief Read everything left in the ring
+*/
+static std::vector<unsigned char> ReadAll(
+		CAudioRing &ring							//!< The ring
+	)
+{
+	std::vector<unsigned char> bytes(ring.GetCapacity());
+	const unsigned int read = ring.Read(&bytes[0], static_cast<unsigned int>(bytes.size()));
+	bytes.resize(read);
+	return bytes;
+}
+
+/*
+ *	\brief Check bytes written in odd sized pieces come back in order across many wraps of the ring
+*/
+static bool CheckRingOrder()
+{
+	CAudioRing ring;
+	ring.Create(256, 1);
+
+	std::vector<unsigned char> written;
+	std::vector<unsigned char> read;
+	unsigned char next = 0;
+	unsigned char buffer[256];
+
+	for (unsigned int pass = 0; pass < 1000; ++pass)
+	{
+		const unsigned int size = 1 + ((pass * 37) % 200);
+		for (unsigned int byte = 0; byte < size; ++byte)
+		{
+			buffer[byte] = next++;
+		}
+
+		// only write what fits, this check is of the order not of overwriting
+		const unsigned int room = ring.GetCapacity() - ring.GetSize();
+		const unsigned int writing = size < room ? size : room;
+		ring.Write(buffer, writing);
+		written.insert(written.end(), buffer, buffer + writing);
+		next = static_cast<unsigned char>(next - (size - writing));
+
+		const unsigned int copied = ring.Read(buffer, 1 + ((pass * 53) % 150));
+		read.insert(read.end(), buffer, buffer + copied);
+	}
+
+	const std::vector<unsigned char> rest = ReadAll(ring);
+	read.insert(read.end(), rest.begin(), rest.end());
+
+	if (read != written || ring.GetSize() != 0)
+	{
+		std::cerr << "audio: " << written.size() << " bytes written came back as " << read.size() << " bytes, "
+			<< (read.size() == written.size() ? "out of order" : "some missing") << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Check a full ring keeps the newest samples, and a reader part way through a sample stays on the sample boundary
+*/
+static bool CheckOverwrite()
+{
+	CAudioRing ring;
+	ring.Create(1024, SampleBytes);
+	const unsigned int held = ring.GetCapacity() / SampleBytes;
+
+	bool passed = true;
+
+	// three rings worth without reading keeps only the last ring of it
+	for (unsigned int written = 0; written < 3; ++written)
+	{
+		WriteSamples(ring, held * written, held);
+	}
+
+	const std::vector<unsigned char> newest = ReadAll(ring);
+	const unsigned int *samples = reinterpret_cast<const unsigned int *>(newest.data());
+	if (newest.size() != ring.GetCapacity() || samples[0] != held * 2 || samples[held - 1] != (held * 3) - 1)
+	{
+		std::cerr << "audio: after overwriting, the ring gave " << newest.size() << " bytes from sample " << (newest.empty() ? 0 : samples[0]) << std::endl;
+		passed = false;
+	}
+
+	// more than the ring holds in one write keeps its end
+	WriteSamples(ring, 0, held + 10);
+	const std::vector<unsigned char> end = ReadAll(ring);
+	samples = reinterpret_cast<const unsigned int *>(end.data());
+	if (end.size() != ring.GetCapacity() || samples[0] != 10)
+	{
+		std::cerr << "audio: a write bigger than the ring kept " << end.size() << " bytes from sample " << (end.empty() ? 0 : samples[0]) << std::endl;
+		passed = false;
+	}
+
+	// read a sample and a half, then overwrite, what is left starts with the rest of a sample
+	WriteSamples(ring, 0, 8);
+	unsigned char start[6];
+	ring.Read(start, sizeof(start));
+	WriteSamples(ring, 8, held * 2);
+
+	const std::vector<unsigned char> rest = ReadAll(ring);
+	const unsigned int partial = SampleBytes - (sizeof(start) % SampleBytes);
+	if (rest.size() % SampleBytes != partial || rest.size() < SampleBytes + partial)
+	{
+		std::cerr << "audio: a reader part way through a sample was left " << rest.size() << " bytes after overwriting" << std::endl;
+		return false;
+	}
+
+	unsigned int first;
+	memcpy(&first, &rest[partial], SampleBytes);
+	for (unsigned int sample = 0; partial + (sample * SampleBytes) < rest.size(); ++sample)
+	{
+		unsigned int value;
+		memcpy(&value, &rest[partial + (sample * SampleBytes)], SampleBytes);
+		if (value != first + sample)
+		{
+			std::cerr << "audio: after overwriting a part read sample, sample " << sample << " was " << value << " instead of " << (first + sample) << std::endl;
+			return false;
+		}
+	}
+
+	const unsigned int before = first - 1;
+	if (memcmp(&rest[0], reinterpret_cast<const unsigned char *>(&before) + (SampleBytes - partial), partial) != 0 || first + ((rest.size() - partial) / SampleBytes) != 8 + (held * 2))
+	{
+		std::cerr << "audio: after overwriting a part read sample, the reader didn't stay on the sample boundary" << std::endl;
+		passed = false;
+	}
+
+	return passed;
+}
+
+/*
+ *	\brief Check the ring counts the bytes written, read and dropped, how full writes left it and how long bytes waited
+*/
+static bool CheckCounts()
+{
+	CAudioRing ring;
+	ring.Create(1024, SampleBytes);
+	const unsigned int held = ring.GetCapacity() / SampleBytes;
+
+	bool passed = true;
+
+	// a quarter, then a whole ring, which drops the quarter, then wait a while before reading
+	WriteSamples(ring, 0, held / 4);
+	WriteSamples(ring, held / 4, held);
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	ReadAll(ring);
+
+	if (ring.GetBytesWritten() != ring.GetCapacity() + (ring.GetCapacity() / 4) || ring.GetBytesRead() != ring.GetCapacity()
+		|| ring.GetBytesDropped() != ring.GetCapacity() / 4 || ring.GetOverruns() != 1 || ring.GetFullest() != ring.GetCapacity())
+	{
+		std::cerr << "audio: the ring counted " << ring.GetBytesWritten() << " bytes written, " << ring.GetBytesRead() << " read, " << ring.GetBytesDropped()
+			<< " dropped in " << ring.GetOverruns() << " overruns, at fullest " << ring.GetFullest() << std::endl;
+		passed = false;
+	}
+
+	const unsigned int quarter = CAudioRing::OccupancyBuckets / 4;
+	for (unsigned int bucket = 0; bucket < CAudioRing::OccupancyBuckets; ++bucket)
+	{
+		const unsigned int expected = bucket == quarter || bucket == CAudioRing::OccupancyBuckets - 1 ? 1 : 0;
+		if (ring.GetOccupancyCount(bucket) != expected)
+		{
+			std::cerr << "audio: " << ring.GetOccupancyCount(bucket) << " writes left the ring filled to part " << bucket << ", not " << expected << std::endl;
+			passed = false;
+		}
+	}
+
+	const CLatencyHistogram &latency = ring.GetReadLatency();
+	if (latency.GetCount() != 1 || latency.GetMaximum() < 5000)
+	{
+		std::cerr << "audio: bytes read 5ms after writing were counted " << latency.GetCount() << " times as waiting " << latency.GetMaximum() << "us" << std::endl;
+		passed = false;
+	}
+
+	return passed;
+}
+
+/*
+ *	\brief Check a capture thread writing faster than the reader reads only ever loses whole runs of the oldest samples
+*/
+static bool CheckCapture()
+{
+	CAudioRing ring;
+	ring.Create(4096, SampleBytes);
+
+	std::thread capture([&]() {
+		for (unsigned int first = 0; first < CaptureSamples; first += 80)
+		{
+			WriteSamples(ring, first, 80);
+			if ((first / 80) % 16 == 0)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		ring.Close();
+	});
+
+	// read whole samples in sizes which don't line up with the writes, a sample split by dropping bytes
+	// under a part read is torn, CheckOverwrite covers that reader
+	std::vector<unsigned char> buffer(1000);
+	unsigned char partial[SampleBytes];
+	unsigned int partialBytes = 0;
+	unsigned int received = 0;
+	unsigned int gaps = 0;
+	unsigned int last = 0;
+	bool passed = true;
+	unsigned int pass = 0;
+
+	while (ring.Wait(CAudioRing::Forever))
+	{
+		const unsigned int copied = ring.Read(&buffer[0], SampleBytes * (1 + ((pass++ * 97) % 249)));
+		for (unsigned int byte = 0; byte < copied; ++byte)
+		{
+			partial[partialBytes++] = buffer[byte];
+			if (partialBytes < SampleBytes)
+				continue;
+
+			partialBytes = 0;
+			unsigned int sample;
+			memcpy(&sample, partial, SampleBytes);
+
+			if (received > 0 && sample != last + 1)
+			{
+				if (sample <= last || sample >= CaptureSamples)
+				{
+					if (passed)
+					{
+						std::cerr << "audio: the reader got sample " << sample << " after " << last << std::endl;
+					}
+
+					passed = false;
+				}
+
+				gaps++;
+			}
+
+			last = sample;
+			received++;
+		}
+	}
+
+	capture.join();
+
+	if (passed && (partialBytes != 0 || last != CaptureSamples - 1))
+	{
+		std::cerr << "audio: the reader finished on sample " << last << " with " << partialBytes << " bytes of a sample left, "
+			<< CaptureSamples << " were captured" << std::endl;
+		passed = false;
+	}
+
+	// every byte written was read or counted as dropped
+	if (ring.GetBytesWritten() != CaptureSamples * SampleBytes || ring.GetBytesRead() != received * SampleBytes
+		|| ring.GetBytesRead() + ring.GetBytesDropped() != ring.GetBytesWritten() || (gaps != 0) != (ring.GetOverruns() != 0))
+	{
+		std::cerr << "audio: the ring counted " << ring.GetBytesWritten() << " bytes written, " << ring.GetBytesRead() << " read and " << ring.GetBytesDropped()
+			<< " dropped in " << ring.GetOverruns() << " overruns, the reader got " << (received * SampleBytes) << " bytes with " << gaps << " gaps" << std::endl;
+		passed = false;
+	}
+
+	std::cout << "# audio: the reader got " << received << " of " << CaptureSamples << " samples, losing the oldest " << gaps << " times, "
+		<< ring.GetBytesDropped() << " bytes dropped in " << ring.GetOverruns() << " overruns" << std::endl;
+	return passed;
+}
+
+/*
+ *	\brief Check a waiting reader is woken by a write, by closing the ring and by its time running out
+*/
+static bool CheckWake()
+{
+	CAudioRing ring;
+	ring.Create(256, 1);
+
+	bool passed = true;
+	const auto started = std::chrono::steady_clock::now();
+	if (ring.Wait(20) || std::chrono::steady_clock::now() - started < std::chrono::milliseconds(15))
+	{
+		std::cerr << "audio: waiting on an empty ring didn't wait out its time" << std::endl;
+		passed = false;
+	}
+
+	bool woken = false;
+	std::thread reader([&]() {
+		woken = ring.Wait(CAudioRing::Forever);
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	const unsigned char byte = 1;
+	ring.Write(&byte, 1);
+	reader.join();
+
+	unsigned char read;
+	if (!woken || ring.Read(&read, 1) != 1)
+	{
+		std::cerr << "audio: a write didn't wake the waiting reader" << std::endl;
+		passed = false;
+	}
+
+	reader = std::thread([&]() {
+		woken = ring.Wait(CAudioRing::Forever);
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	ring.Close();
+	reader.join();
+
+	if (woken || !ring.IsClosed())
+	{
+		std::cerr << "audio: closing the ring didn't wake the waiting reader empty handed" << std::endl;
+		passed = false;
+	}
+
+	return passed;
+}
+
+/*
+ *	\brief Measure how long after a chunk is written the waiting reader has it
+*/
+static void MeasureLatency()
+{
+	CAudioRing ring;
+	ring.Create(1 << 16, ChunkBytes);
+
+	std::thread capture([&]() {
+		unsigned char chunk[ChunkBytes] = { 0 };
+		for (unsigned int written = 0; written < LatencyChunks; ++written)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			const long long stamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+			memcpy(chunk, &stamp, sizeof(stamp));
+			ring.Write(chunk, ChunkBytes);
+		}
+
+		ring.Close();
+	});
+
+	CLatencyHistogram latency;
+	unsigned char chunk[ChunkBytes];
+	unsigned int chunkBytes = 0;
+	while (ring.Wait(CAudioRing::Forever))
+	{
+		chunkBytes += ring.Read(chunk + chunkBytes, ChunkBytes - chunkBytes);
+		if (chunkBytes < ChunkBytes)
+			continue;
+
+		long long stamp;
+		memcpy(&stamp, chunk, sizeof(stamp));
+		const long long now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		latency.Add(static_cast<unsigned long long>(now - stamp));
+		chunkBytes = 0;
+	}
+
+	capture.join();
+
+	std::cout << "# audio: a waiting reader had " << latency.GetCount() << " chunks after a mean of " << latency.GetMean() << "us, 99% within "
+		<< latency.GetPercentile(99.0f) << "us, the longest " << latency.GetMaximum() << "us" << std::endl;
+
+	const CLatencyHistogram &counted = ring.GetReadLatency();
+	std::cout << "# audio: the ring counted " << counted.GetCount() << " reads waiting a mean of " << counted.GetMean() << "us, 99% within "
+		<< counted.GetPercentile(99.0f) << "us, fullest " << ring.GetFullest() << " bytes" << std::endl;
+}
+
+/*
+ *	\brief Check the audio ring keeps captured bytes in order, overwrites the oldest in whole samples, wakes its reader and counts it all, and time it
+*/
+bool RunAudioBenchmarks(
+		CBenchmark &benchmark						//!< The benchmark runner
+	)
+{
+	bool passed = CheckRingOrder();
+	passed = CheckOverwrite() && passed;
+	passed = CheckCounts() && passed;
+	passed = CheckCapture() && passed;
+	passed = CheckWake() && passed;
+	MeasureLatency();
+
+	CAudioRing ring;
+	ring.Create(1 << 16, 2);
+	std::vector<unsigned char> chunk(ChunkBytes, 1);
+	std::vector<unsigned char> read(ChunkBytes);
+
+	benchmark.Run("audio/ring/chunk", ChunkBytes, [&]() {
+		ring.Write(&chunk[0], ChunkBytes);
+		ring.Read(&read[0], ChunkBytes);
+	}, ChunkBytes);
+
+	// nobody reading, every write overwrites the oldest chunk
+	benchmark.Run("audio/ring/overwrite", ChunkBytes, [&]() {
+		ring.Write(&chunk[0], ChunkBytes);
+	}, ChunkBytes);
+
+	return passed;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "CBenchmark.h"
+#include "DepthFrames.h"
+
+							//! Check the background heightmap loader cancels and restarts cleanly and the height pyramid and statistics match a scan, and time them, false if any fails
+bool						RunTerrainBenchmarks(
+								CBenchmark &benchmark,			//!< The benchmark runner
+								unsigned int mapSize			//!< The width and height of the heightmap
+							);
+
+							//! Check the depth color conversions against the conversion they replaced and time them, false if they disagree
+bool						RunDepthBenchmarks(
+								CBenchmark &benchmark			//!< The benchmark runner
+							);
+
+							//! Check the hand finding passes against the way CHand used to find the hand and time them, false if they disagree
+bool						RunHandBenchmarks(
+								CBenchmark &benchmark,			//!< The benchmark runner
+								const DepthFrames &frames		//!< The frames to find the hand in
+							);
+
+							//! Check depth frames survive delta encoding and the recorder and time encoding them, false if they don't
+bool						RunRecordBenchmarks(
+								CBenchmark &benchmark,			//!< The benchmark runner
+								const DepthFrames &frames		//!< The frames to record
+							);
+
+							//! Check depth recordings replay the frames written to them, and reject an oversized frame chunk, and time reading them back, false if they don't
+bool						RunReplayBenchmarks(
+								CBenchmark &benchmark,			//!< The benchmark runner
+								const DepthFrames &frames		//!< The frames to record
+							);
+
+							//! Check screenshots are saved off the capture thread and time encoding them, false if they aren't
+bool						RunScreenshotBenchmarks(
+								CBenchmark &benchmark,			//!< The benchmark runner
+								const DepthFrames &frames		//!< The frames to color into screenshots
+							);
+
+							//! Check the hand shape classifier on drawn hands and time it, false if it misreads them
+bool						RunShapeBenchmarks(
+								CBenchmark &benchmark,			//!< The benchmark runner
+								const DepthFrames &frames,		//!< The frames to classify the hand in
+								const std::string &labelsFile	//!< The hand state labels of the frames, empty if there are none
+							);
+
+							//! Check the distance transform and the hand templates on drawn hands and time them, false if a template fits the wrong hand
+bool						RunTemplateBenchmarks(
+								CBenchmark &benchmark			//!< The benchmark runner
+							);
+
+							//! Check the frame pipeline keeps frames in order and never blocks the thread pushing them, and time it, false if it doesn't
+bool						RunPipelineBenchmarks(
+								CBenchmark &benchmark,			//!< The benchmark runner
+								const DepthFrames &frames		//!< The frames of the synthetic source
+							);
+
+							//! Check the palm filters follow and smooth a moving hand, and measure how well they predict the palm of the frames, false if they don't
+bool						RunFilterBenchmarks(
+								CBenchmark &benchmark,			//!< The benchmark runner
+								const DepthFrames &frames		//!< The frames to track the palm through
+							);
+
+							//! Check searching around the last hand finds the same hand as searching the whole frame, and measure the pixels it saves, false if it doesn't
+bool						RunTrackBenchmarks(
+								CBenchmark &benchmark,			//!< The benchmark runner
+								const DepthFrames &frames		//!< The frames to track the hand through
+							);
+
+							//! Check the depth pyramid levels against building them a pixel at a time and time building and searching each level, false if they disagree
+bool						RunPyramidBenchmarks(
+								CBenchmark &benchmark,			//!< The benchmark runner
+								const DepthFrames &frames		//!< The frames to build pyramids of
+							);
+
+							//! Check the depth band is calibrated around the hand and follows it, and time histogramming a frame, false if the band is wrong
+bool						RunCalibrationBenchmarks(
+								CBenchmark &benchmark,			//!< The benchmark runner
+								const DepthFrames &frames		//!< The frames to calibrate from
+							);
+
+							//! Check the audio ring keeps captured bytes in order, overwrites the oldest in whole samples and wakes its reader, and time it, false if it doesn't
+bool						RunAudioBenchmarks(
+								CBenchmark &benchmark			//!< The benchmark runner
+							);
@@ -0,0 +1,75 @@
+#include "CBenchmark.h"
+#include <chrono>
+
+/*
+ *	\brief Class constructor
+*/
+CBenchmark::CBenchmark(
+		std::ostream &output,						//!< Where the results are written
+		const std::string &filter,					//!< Only benchmarks whose name contains this are run
+		double minimumSeconds						//!< The least time each benchmark is run for
+	) :
+	m_output(output),
+	m_filter(filter),
+	m_minimumSeconds(minimumSeconds)
+{
+
+}
+
+/*
+ *	\brief Class destructor
+*/
+CBenchmark::~CBenchmark()
+{
+
+}
+
+/*
+ *	\brief Write the CSV header row
+*/
+void CBenchmark::WriteHeader()
+{
+	m_output << "benchmark,size,iterations,total_ms,ns_per_op,mitems_per_s" << std::endl;
+}
+
+/*
+ *	\brief Time a piece of work and write its row
+*/
+void CBenchmark::Run(
+		const std::string &name,					//!< The name of the benchmark
+		unsigned int size,							//!< The size of the data used, the heightmap width for terrain benchmarks
+		const std::function<void ()> &work,			//!< One operation to time
+		unsigned int itemsPerOperation				//!< The number of items, such as pixels, each operation processes
+	)
+{
+	if (!IsEnabled(name))
+		return;
+
+	typedef std::chrono::high_resolution_clock Clock;
+
+	// warm the caches and any lazily allocated buffers
+	work();
+
+	unsigned long long iterations = 0;
+	unsigned long long batch = 1;
+	double seconds = 0.0;
+
+	while (seconds < m_minimumSeconds)
+	{
+		const Clock::time_point start = Clock::now();
+		for (unsigned long long iteration = 0; iteration < batch; ++iteration)
+		{
+			work();
+		}
+		seconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+		iterations += batch;
+		batch *= 2;
+	}
+
+	const double items = static_cast<double>(iterations) * itemsPerOperation;
+
+	m_output << name << "," << size << "," << iterations << "," << (seconds * 1000.0) << ","
+		<< ((seconds * 1000000000.0) / static_cast<double>(iterations)) << ","
+		<< ((items / seconds) / 1000000.0) << std::endl;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include <functional>
+#include <iostream>
+#include <string>
+
+/*
+ *	\brief Times small pieces of work and prints one CSV row per benchmark.
+ *	Each benchmark is repeated in doubling batches until it has run for at
+ *	least the minimum time, the rows can be diffed between builds to catch regressions.
+*/
+class CBenchmark {
+private:
+	std::ostream				&m_output;						//!< Where the results are written
+	std::string					m_filter;						//!< Only benchmarks whose name contains this are run
+	double						m_minimumSeconds;				//!< The least time each benchmark is run for
+
+public:
+								//! Class constructor
+								CBenchmark(
+									std::ostream &output,			//!< Where the results are written
+									const std::string &filter,		//!< Only benchmarks whose name contains this are run
+									double minimumSeconds			//!< The least time each benchmark is run for
+								);
+
+								//! Class destructor
+								~CBenchmark();
+
+								//! Write the CSV header row
+	void						WriteHeader();
+
+								//! Should a benchmark with a given name be run
+	bool						IsEnabled(
+									const std::string &name			//!< The name of the benchmark
+								) const
+								{
+									return m_filter.empty() || name.find(m_filter) != std::string::npos;
+								}
+
+								//! Time a piece of work and write its row
+	void						Run(
+									const std::string &name,		//!< The name of the benchmark
+									unsigned int size,				//!< The size of the data used, the heightmap width for terrain benchmarks
+									const std::function<void ()> &work,	//!< One operation to time
+									unsigned int itemsPerOperation = 1	//!< The number of items, such as pixels, each operation processes
+								);
+};
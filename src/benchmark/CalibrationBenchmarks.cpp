@@ -0,0 +1,242 @@
+#include "Benchmarks.h"
+#include "../kinect/CDepthBandCalibrator.h"
+#include "../kinect/CDepthPyramid.h"
+#include <math.h>
+#include <sstream>
+#include <vector>
+
+// the hand band CHand uses until it is calibrated, in millimetres
+static const int NearPoint = 832;
+static const int FarPoint = 1344;
+
+// the levels of the depth pyramid CKinect builds, the band is calibrated from the coarsest
+static const unsigned int PyramidLevels = 3;
+
+// the depths of the generated hand and the body behind it, in millimetres
+static const int HandNearest = 1000;
+static const int HandFurthest = 1060;
+static const int BodyDepth = 1800;
+
+// the furthest CDepthBandCalibrator takes a hand to be, and the depths of a floor sloping away past it
+static const int HandReach = 2500;
+static const int FloorNearest = 1000;
+static const int FloorFurthest = 3500;
+
+// how far the user steps back, and how far they sway without the band having to follow
+static const int StepBack = 400;
+static const int Sway = 48;
+
+// the frames given to the calibrator in each check, two passes of the generated frames
+static const unsigned int CalibrationFrames = 60;
+
+/*
+ *	\brief Move every reading of the frames further away, as if the user stepped back
+*/
+static void ShiftDepthFrames(
+		const DepthFrames &frames,					//!< The frames to move
+		int millimetres,							//!< How far to move them
+		DepthFrames &shifted						//!< Receives the moved frames
+	)
+{
+	shifted = frames;
+	for (unsigned int pixel = 0; pixel < shifted.pixels.size(); ++pixel)
+	{
+		if (shifted.pixels[pixel] >= 8)
+		{
+			shifted.pixels[pixel] = static_cast<unsigned short>(shifted.pixels[pixel] + (millimetres << 3));
+		}
+	}
+}
+
+/*
+ *	\brief Build the coarsest pyramid level of every frame, the level CHand calibrates from
+*/
+static void BuildCoarseFrames(
+		const DepthFrames &frames,					//!< The frames
+		DepthFrames &coarse							//!< Receives the coarsest level of each frame
+	)
+{
+	CDepthPyramid pyramid;
+	pyramid.Create(frames.width, frames.height, PyramidLevels);
+
+	coarse.width = pyramid.GetLevelWidth(PyramidLevels - 1);
+	coarse.height = pyramid.GetLevelHeight(PyramidLevels - 1);
+	coarse.count = frames.count;
+	coarse.pixels.clear();
+
+	for (unsigned int frame = 0; frame < frames.count; ++frame)
+	{
+		pyramid.Build(frames.GetFrame(frame));
+		const unsigned short *level = pyramid.GetLevel(PyramidLevels - 1);
+		coarse.pixels.insert(coarse.pixels.end(), level, level + (coarse.width * coarse.height));
+	}
+}
+
+/*
+ *	\brief Give the calibrator frames, cycling through them, and count the frames until the band last moved
+*/
+static unsigned int Calibrate(
+		CDepthBandCalibrator &calibrator,			//!< The calibrator
+		const DepthFrames &coarse,					//!< The coarse frames
+		unsigned int &moves							//!< Receives the number of times the band moved
+	)
+{
+	unsigned int lastMove = 0;
+	moves = 0;
+	for (unsigned int frame = 0; frame < CalibrationFrames; ++frame)
+	{
+		if (calibrator.AddFrame(coarse.GetFrame(frame % coarse.count), coarse.width * coarse.height))
+		{
+			lastMove = frame + 1;
+			moves++;
+		}
+	}
+
+	return lastMove;
+}
+
+/*
+ *	\brief Check the band is set around the hand, in front of the body
+*/
+static bool CheckBand(
+		const char *name,							//!< What the frames show
+		const CDepthBandCalibrator &calibrator,		//!< The calibrator
+		int handNearest,							//!< The nearest depth of the hand, in millimetres
+		int handFurthest,							//!< The furthest depth of the hand
+		int bodyDepth								//!< The depth of the body behind it
+	)
+{
+	if (!calibrator.IsCalibrated() || calibrator.GetNearPoint() > handNearest || calibrator.GetFarPoint() <= handFurthest || calibrator.GetFarPoint() > bodyDepth)
+	{
+		std::cerr << "calibration: " << name << " the band is " << calibrator.GetNearPoint() << " to " << calibrator.GetFarPoint() << "mm, "
+			<< (calibrator.IsCalibrated() ? "calibrated" : "not calibrated") << ", the hand is " << handNearest << " to " << handFurthest
+			<< "mm and the body " << bodyDepth << "mm" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Check the band finds the hand, follows the user stepping back, ignores a sway and isn't set from a wall alone
+*/
+static bool CheckCalibration(
+		const DepthFrames &frames					//!< The generated frames
+	)
+{
+	DepthFrames coarse;
+	BuildCoarseFrames(frames, coarse);
+
+	CDepthBandCalibrator calibrator;
+	calibrator.Create(NearPoint, FarPoint);
+
+	bool passed = true;
+	unsigned int moves;
+	const unsigned int found = Calibrate(calibrator, coarse, moves);
+	passed = CheckBand("held out", calibrator, HandNearest, HandFurthest, BodyDepth) && passed;
+	std::cout << "# calibration: the band was set to " << calibrator.GetNearPoint() << " to " << calibrator.GetFarPoint() << "mm around a hand at "
+		<< calibrator.GetHandDepth() << "mm after " << found << " frames" << std::endl;
+
+	// stepping back takes the hand out of the old band, the band follows it once it has stayed there
+	DepthFrames shifted;
+	DepthFrames shiftedCoarse;
+	ShiftDepthFrames(frames, StepBack, shifted);
+	BuildCoarseFrames(shifted, shiftedCoarse);
+
+	const unsigned int followed = Calibrate(calibrator, shiftedCoarse, moves);
+	passed = CheckBand("stepped back", calibrator, HandNearest + StepBack, HandFurthest + StepBack, BodyDepth + StepBack) && passed;
+	if (moves != 1)
+	{
+		std::cerr << "calibration: the band moved " << moves << " times following one step back" << std::endl;
+		passed = false;
+	}
+
+	std::cout << "# calibration: stepping back " << StepBack << "mm moved the band to " << calibrator.GetNearPoint() << " to " << calibrator.GetFarPoint()
+		<< "mm after " << followed << " frames" << std::endl;
+
+	// a sway smaller than the hysteresis leaves the band where it is
+	ShiftDepthFrames(shifted, Sway, shifted);
+	BuildCoarseFrames(shifted, shiftedCoarse);
+
+	Calibrate(calibrator, shiftedCoarse, moves);
+	if (moves != 0)
+	{
+		std::cerr << "calibration: a " << Sway << "mm sway moved the band " << moves << " times" << std::endl;
+		passed = false;
+	}
+
+	// a wall alone is out of reach, so the band stays as it was created
+	DepthFrames wall = coarse;
+	for (unsigned int pixel = 0; pixel < wall.pixels.size(); ++pixel)
+	{
+		wall.pixels[pixel] = static_cast<unsigned short>((3000 + (pixel % 7)) << 3);
+	}
+
+	calibrator.Reset();
+	Calibrate(calibrator, wall, moves);
+	if (calibrator.IsCalibrated() || calibrator.GetNearPoint() != NearPoint || calibrator.GetFarPoint() != FarPoint)
+	{
+		std::cerr << "calibration: a wall set the band to " << calibrator.GetNearPoint() << " to " << calibrator.GetFarPoint() << "mm" << std::endl;
+		passed = false;
+	}
+
+	// a floor sloping away shows more of itself the further it goes, the peak mustn't be climbed past the hand's reach
+	DepthFrames floor = coarse;
+	const unsigned int framePixels = floor.width * floor.height;
+	for (unsigned int pixel = 0; pixel < floor.pixels.size(); ++pixel)
+	{
+		const double along = sqrt(((pixel % framePixels) + 0.5) / framePixels);
+		floor.pixels[pixel] = static_cast<unsigned short>((FloorNearest + static_cast<int>(along * (FloorFurthest - FloorNearest))) << 3);
+	}
+
+	calibrator.Reset();
+	Calibrate(calibrator, floor, moves);
+	if (calibrator.IsCalibrated() && calibrator.GetHandDepth() > HandReach + static_cast<int>(CDepthBandCalibrator::BinWidth))
+	{
+		std::cerr << "calibration: a floor sloping away put the hand at " << calibrator.GetHandDepth() << "mm, beyond " << HandReach << "mm" << std::endl;
+		passed = false;
+	}
+
+	return passed;
+}
+
+/*
+ *	\brief Check the depth band calibration on the generated frames and time histogramming a frame at each pyramid level
+*/
+bool RunCalibrationBenchmarks(
+		CBenchmark &benchmark,						//!< The benchmark runner
+		const DepthFrames &frames					//!< The frames to calibrate from
+	)
+{
+	// the generated frames have a known hand and body, a recording only gets timed
+	DepthFrames generated;
+	GenerateDepthFrames(frames.width, frames.height, 30, generated);
+	bool passed = CheckCalibration(generated);
+
+	std::vector<CDepthPyramid> pyramids(frames.count);
+	for (unsigned int built = 0; built < frames.count; ++built)
+	{
+		pyramids[built].Create(frames.width, frames.height, PyramidLevels);
+		pyramids[built].Build(frames.GetFrame(built));
+	}
+
+	for (unsigned int level = 0; level < PyramidLevels; ++level)
+	{
+		CDepthBandCalibrator calibrator;
+		calibrator.Create(NearPoint, FarPoint);
+
+		const unsigned int width = pyramids[0].GetLevelWidth(level);
+		const unsigned int height = pyramids[0].GetLevelHeight(level);
+
+		std::stringstream name;
+		name << "calibrate/level/" << level;
+
+		unsigned int frame = 0;
+		benchmark.Run(name.str(), width, [&]() {
+			calibrator.AddFrame(pyramids[frame].GetLevel(level), width * height);
+			frame = (frame + 1) % frames.count;
+		}, width * height);
+	}
+
+	return passed;
+}
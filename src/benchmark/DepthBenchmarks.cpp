@@ -0,0 +1,122 @@
+#include "Benchmarks.h"
+#include "../kinect/CDepthColorTable.h"
+#include <stdlib.h>
+#include <vector>
+
+static const unsigned int FrameWidth = 640;
+static const unsigned int FrameHeight = 480;
+
+// the player tints CKinect::Nui_ShortToQuad_Depth used before the table, kept here so the checks don't share the table's own
+static const int g_IntensityShiftByPlayerR[] = { 1, 2, 0, 2, 0, 0, 2, 0 };
+static const int g_IntensityShiftByPlayerG[] = { 1, 2, 2, 0, 2, 0, 0, 1 };
+static const int g_IntensityShiftByPlayerB[] = { 1, 0, 2, 2, 0, 2, 0, 2 };
+
+/*
+ *	\brief The color CKinect::Nui_ShortToQuad_Depth gave a depth pixel before the table, as the RGBQUAD read as one unsigned int
+*/
+static unsigned int ShortToQuadDepth(
+		unsigned short s							//!< The depth pixel, the depth in millimeters above the 3 bit player index
+	)
+{
+	// NuiDepthPixelToDepth and NuiDepthPixelToPlayerIndex
+	const unsigned short realDepth = static_cast<unsigned short>(s >> 3);
+	const unsigned short player = static_cast<unsigned short>(s & 7);
+
+	// transform 13-bit depth information into an 8-bit intensity appropriate
+	// for display (we disregard information in most significant bit)
+	const unsigned char intensity = static_cast<unsigned char>(~(realDepth >> 4));
+
+	// tint the intensity by dividing by per-player values
+	const unsigned char red = static_cast<unsigned char>(intensity >> g_IntensityShiftByPlayerR[player]);
+	const unsigned char green = static_cast<unsigned char>(intensity >> g_IntensityShiftByPlayerG[player]);
+	const unsigned char blue = static_cast<unsigned char>(intensity >> g_IntensityShiftByPlayerB[player]);
+
+	// an RGBQUAD is blue, green, red then a zero reserved byte
+	return (static_cast<unsigned int>(red) << 16) | (static_cast<unsigned int>(green) << 8) | blue;
+}
+
+/*
+ *	\brief Check a conversion path gives the same color Nui_ShortToQuad_Depth did for every depth pixel
+*/
+static bool CheckConversion(
+		const char *name,							//!< The name of the conversion path
+		const std::vector<unsigned short> &pixels,	//!< Every depth pixel
+		const std::vector<unsigned int> &colors		//!< The colors the path converted them to
+	)
+{
+	for (unsigned int pixel = 0; pixel < CDepthColorTable::Entries; ++pixel)
+	{
+		const unsigned int expected = ShortToQuadDepth(pixels[pixel]);
+		if (colors[pixel] != expected)
+		{
+			std::cerr << name << ": depth pixel " << pixels[pixel] << " gave " << std::hex << colors[pixel]
+				<< " instead of " << expected << std::dec << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Check the depth color conversions against the conversion they replaced and time them
+*/
+bool RunDepthBenchmarks(
+		CBenchmark &benchmark						//!< The benchmark runner
+	)
+{
+	const CDepthColorTable table;
+
+	// every possible input, the function filling the table and each conversion must match the old conversion exactly
+	std::vector<unsigned short> allPixels(CDepthColorTable::Entries);
+	std::vector<unsigned int> allColors(CDepthColorTable::Entries);
+	for (unsigned int pixel = 0; pixel < CDepthColorTable::Entries; ++pixel)
+	{
+		allPixels[pixel] = static_cast<unsigned short>(pixel);
+		allColors[pixel] = CDepthColorTable::CalculateColor(allPixels[pixel]);
+	}
+
+	bool passed = CheckConversion("depth/function", allPixels, allColors);
+
+	table.ConvertScalar(&allPixels[0], CDepthColorTable::Entries, &allColors[0]);
+	passed = CheckConversion("depth/table", allPixels, allColors) && passed;
+
+#ifdef DEPTH_COLOR_TABLE_AVX2
+	if (CDepthColorTable::IsAVX2Supported())
+	{
+		table.ConvertAVX2(&allPixels[0], CDepthColorTable::Entries, &allColors[0]);
+		passed = CheckConversion("depth/avx2", allPixels, allColors) && passed;
+	}
+#endif
+
+	// a frame of plausible depths, 0.4m to 4m with the odd tracked player
+	srand(1);
+	std::vector<unsigned short> frame(FrameWidth * FrameHeight);
+	for (unsigned int pixel = 0; pixel < frame.size(); ++pixel)
+	{
+		const unsigned int depth = 400 + (rand() % 3600);
+		const unsigned int player = (rand() % 8) == 0 ? 1 + (rand() % 6) : 0;
+		frame[pixel] = static_cast<unsigned short>((depth << 3) | player);
+	}
+
+	std::vector<unsigned int> colors(frame.size());
+	const unsigned int pixelCount = static_cast<unsigned int>(frame.size());
+
+	benchmark.Run("depth/function", FrameWidth, [&]() {
+		for (unsigned int pixel = 0; pixel < pixelCount; ++pixel)
+		{
+			colors[pixel] = CDepthColorTable::CalculateColor(frame[pixel]);
+		}
+	}, pixelCount);
+
+	benchmark.Run("depth/table", FrameWidth, [&]() { table.ConvertScalar(&frame[0], pixelCount, &colors[0]); }, pixelCount);
+
+#ifdef DEPTH_COLOR_TABLE_AVX2
+	if (CDepthColorTable::IsAVX2Supported())
+	{
+		benchmark.Run("depth/avx2", FrameWidth, [&]() { table.ConvertAVX2(&frame[0], pixelCount, &colors[0]); }, pixelCount);
+	}
+#endif
+
+	return passed;
+}
@@ -0,0 +1,110 @@
+#include "DepthFrames.h"
+#include "../kinect/CDepthReplaySource.h"
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+
+/*
+ *	\brief Generate frames of a user holding a hand out in front of a wall, the hand circles over the frames
+*/
+void GenerateDepthFrames(
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows in a frame
+		unsigned int count,							//!< The number of frames
+		DepthFrames &frames							//!< Receives the frames
+	)
+{
+	frames.width = width;
+	frames.height = height;
+	frames.count = count;
+	frames.pixels.resize(width * height * count);
+
+	srand(1);
+
+	const float centerX = width * 0.5f;
+
+	for (unsigned int frame = 0; frame < count; ++frame)
+	{
+		const float angle = (6.2831853f * frame) / count;
+		const float handX = centerX + (cos(angle) * width * 0.2f);
+		const float handY = (height * 0.35f) + (sin(angle) * height * 0.15f);
+		const float handRadiusX = width * 0.05f;
+		const float handRadiusY = height * 0.09f;
+
+		unsigned short *pixels = &frames.pixels[frame * width * height];
+		for (unsigned int y = 0; y < height; ++y)
+		{
+			for (unsigned int x = 0; x < width; ++x)
+			{
+				// a wall, sloping away towards the top of the frame
+				int depth = 3000 + static_cast<int>((height - y) * 2);
+
+				// the body of the user
+				if (fabs(x - centerX) < width * 0.15f && y > height * 0.3f)
+				{
+					depth = 1800;
+				}
+
+				// the forearm, reaching from the body up to the hand
+				const float armX = x - handX;
+				const float armY = y - handY;
+				if (armY > 0.0f && armY < height * 0.4f && fabs(armX) < width * 0.025f)
+				{
+					depth = 1100 + static_cast<int>(armY * 2);
+				}
+
+				// the hand
+				const float handDistance = ((armX * armX) / (handRadiusX * handRadiusX)) + ((armY * armY) / (handRadiusY * handRadiusY));
+				if (handDistance < 1.0f)
+				{
+					depth = 1000 + static_cast<int>(handDistance * 60.0f);
+				}
+
+				// sensor noise, and the odd pixel the sensor couldn't see
+				depth += (rand() % 9) - 4;
+				if ((rand() % 50) == 0)
+				{
+					depth = 0;
+				}
+
+				pixels[(y * width) + x] = static_cast<unsigned short>(depth << 3);
+			}
+		}
+	}
+}
+
+/*
+ *	\brief Load every frame of a depth recording
+*/
+bool LoadDepthFrames(
+		const std::string &fileName,				//!< The recording to load
+		DepthFrames &frames							//!< Receives the frames
+	)
+{
+	CDepthReplaySource replay;
+	if (!replay.Open(fileName, ReplaySpeed::AsFastAsPossible))
+	{
+		std::cerr << fileName << ": " << replay.GetError() << std::endl;
+		return false;
+	}
+
+	frames.width = replay.GetWidth();
+	frames.height = replay.GetHeight();
+	frames.count = 0;
+	frames.pixels.clear();
+
+	DepthFrame frame;
+	while (replay.GetNextFrame(frame))
+	{
+		frames.pixels.insert(frames.pixels.end(), frame.pixels, frame.pixels + (frame.width * frame.height));
+		frames.count++;
+	}
+
+	if (*replay.GetError() != '\0')
+	{
+		std::cerr << fileName << ": " << replay.GetError() << std::endl;
+		return false;
+	}
+
+	return frames.count > 0;
+}
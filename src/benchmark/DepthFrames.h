@@ -0,0 +1,40 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include <string>
+#include <vector>
+
+/*
+ *	\brief A sequence of packed Kinect depth frames, depth in millimetres in the top 13 bits
+*/
+struct DepthFrames
+{
+	unsigned int				width;							//!< The number of pixels in a row
+	unsigned int				height;							//!< The number of rows in a frame
+	unsigned int				count;							//!< The number of frames
+	std::vector<unsigned short>	pixels;							//!< Every frame, one after another
+
+								//! Get the first pixel of a frame
+	const unsigned short		*GetFrame(
+									unsigned int frame			//!< The index of the frame
+								) const
+								{
+									return &pixels[frame * width * height];
+								}
+};
+
+							//! Generate frames of a user holding a hand out in front of a wall, the hand circles over the frames
+void						GenerateDepthFrames(
+								unsigned int width,				//!< The number of pixels in a row
+								unsigned int height,			//!< The number of rows in a frame
+								unsigned int count,				//!< The number of frames
+								DepthFrames &frames				//!< Receives the frames
+							);
+
+							//! Load every frame of a depth recording
+bool						LoadDepthFrames(
+								const std::string &fileName,	//!< The recording to load
+								DepthFrames &frames				//!< Receives the frames
+							);
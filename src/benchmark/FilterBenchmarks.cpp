@@ -0,0 +1,334 @@
+#include "Benchmarks.h"
+#include "HandShapes.h"
+#include "../kinect/CKalmanFilter.h"
+#include "../kinect/COneEuroFilter.h"
+#include <math.h>
+#include <stdlib.h>
+
+// the depth band CHand finds the hand in, in millimetres
+static const int NearPoint = 832;
+static const int FarPoint = 1344;
+
+// the settings CKinect filters the palm with
+static const OneEuroSettings OneEuroDefaults = { 1.0f, 0.05f, 4.0f, 50000 };
+static const KalmanSettings KalmanDefaults = { 2000.0f, 2.0f, 50000 };
+
+static const unsigned long long FrameInterval = 33333;	// microseconds between frames at 30 frames a second
+static const unsigned int WarmUpFrames = 5;				// frames a filter gets to settle before its error counts
+static const unsigned int TrackLoops = 4;				// the times the frames are played through for a track
+
+/*
+ *	\brief A palm position measured in a frame
+*/
+struct PalmSample
+{
+	unsigned long long			time;							//!< When the frame was captured, in microseconds
+	float						x;								//!< The column of the palm
+	float						y;								//!< The row of the palm
+	bool						found;							//!< Was there a hand in the frame
+};
+
+/*
+ *	\brief Find the palm in each frame the way CHand does, over a few loops of the frames
+*/
+static void FindPalms(
+		const DepthFrames &frames,					//!< The frames to find the palm in
+		std::vector<PalmSample> &palms				//!< Receives the palm of each frame played
+	)
+{
+	CBlobLabeller labeller;
+	labeller.Create(frames.width, frames.height);
+
+	std::vector<unsigned char> mask(frames.width * frames.height);
+	std::vector<PalmSample> loop(frames.count);
+
+	for (unsigned int frame = 0; frame < frames.count; ++frame)
+	{
+		ThresholdDepthBand(frames.GetFrame(frame), frames.width, 0, frames.height, NearPoint, FarPoint, &mask[0]);
+
+		MaskArea area;
+		unsigned int startX, startY;
+		loop[frame].found = FindHandArea(&mask[0], frames.width, frames.height, labeller, area, startX, startY);
+
+		// the middle of the hand area, as CHand samples it
+		loop[frame].x = area.left + ((area.right - 1 - area.left) * 0.5f);
+		loop[frame].y = area.top + ((area.bottom - area.top) * 0.5f);
+	}
+
+	palms.clear();
+	for (unsigned int played = 0; played < frames.count * TrackLoops; ++played)
+	{
+		PalmSample palm = loop[played % frames.count];
+		palm.time = played * FrameInterval;
+		palms.push_back(palm);
+	}
+}
+
+/*
+ *	\brief Make a track along a circle, as the generated frames move the hand, with noise on each position
+*/
+static void MakeCircleTrack(
+		unsigned int count,							//!< The number of positions
+		float noise,								//!< The most each position is off the circle, in pixels
+		std::vector<PalmSample> &palms				//!< Receives the track
+	)
+{
+	palms.resize(count);
+	for (unsigned int index = 0; index < count; ++index)
+	{
+		const float angle = (6.2831853f * index) / 30.0f;
+		const float offsetX = noise * (((rand() % 2001) - 1000) / 1000.0f);
+		const float offsetY = noise * (((rand() % 2001) - 1000) / 1000.0f);
+
+		palms[index].time = index * FrameInterval;
+		palms[index].x = 320.0f + (cos(angle) * 128.0f) + offsetX;
+		palms[index].y = 168.0f + (sin(angle) * 72.0f) + offsetY;
+		palms[index].found = true;
+	}
+}
+
+/*
+ *	\brief Get the mean distance between where a filter predicts the palm one frame ahead and where the next frame finds it,
+ *	a null filter holds the last palm as CKinect did before filtering
+*/
+static float GetPredictionError(
+		IPositionFilter *filter,					//!< The filter to test, null to hold the last position
+		const std::vector<PalmSample> &palms		//!< The track
+	)
+{
+	if (filter != nullptr) filter->Reset();
+
+	float totalError = 0.0f;
+	unsigned int predictions = 0;
+	unsigned int tracked = 0;
+
+	for (unsigned int index = 0; index + 1 < palms.size(); ++index)
+	{
+		if (!palms[index].found)
+		{
+			// a lost hand starts a new track
+			if (filter != nullptr) filter->Reset();
+			tracked = 0;
+			continue;
+		}
+
+		tracked++;
+
+		float x = palms[index].x;
+		float y = palms[index].y;
+		if (filter != nullptr)
+		{
+			filter->Add(palms[index].time, palms[index].x, palms[index].y);
+			filter->Predict(palms[index + 1].time, x, y);
+		}
+
+		if (tracked <= WarmUpFrames || !palms[index + 1].found)
+			continue;
+
+		const float errorX = x - palms[index + 1].x;
+		const float errorY = y - palms[index + 1].y;
+		totalError += sqrt((errorX * errorX) + (errorY * errorY));
+		predictions++;
+	}
+
+	return predictions == 0 ? 0.0f : totalError / predictions;
+}
+
+/*
+ *	\brief Get the spread of a filter's positions at the time of each measurement about their mean on a still, noisy track
+*/
+static float GetStillSpread(
+		IPositionFilter *filter,					//!< The filter to test, null for the raw positions
+		const std::vector<PalmSample> &palms		//!< The still track
+	)
+{
+	if (filter != nullptr) filter->Reset();
+
+	std::vector<float> xs;
+	for (unsigned int index = 0; index < palms.size(); ++index)
+	{
+		float x = palms[index].x;
+		float y = palms[index].y;
+		if (filter != nullptr)
+		{
+			filter->Add(palms[index].time, palms[index].x, palms[index].y);
+			filter->Predict(palms[index].time, x, y);
+		}
+
+		if (index >= WarmUpFrames * 4) xs.push_back(x);
+	}
+
+	float mean = 0.0f;
+	for (unsigned int index = 0; index < xs.size(); ++index) mean += xs[index];
+	mean /= static_cast<float>(xs.size());
+
+	float variance = 0.0f;
+	for (unsigned int index = 0; index < xs.size(); ++index) variance += (xs[index] - mean) * (xs[index] - mean);
+	return sqrt(variance / static_cast<float>(xs.size()));
+}
+
+/*
+ *	\brief Check the filters follow a moving palm, smooth a still one and stop extrapolating at their limit
+*/
+static bool CheckFilters()
+{
+	COneEuroFilter oneEuro(OneEuroDefaults);
+	CKalmanFilter kalman(KalmanDefaults);
+	IPositionFilter *const filters[] = { &oneEuro, &kalman };
+	const char *const names[] = { "one euro", "kalman" };
+
+	bool passed = true;
+	srand(4);
+
+	// a straight line at 300 pixels a second, which the kalman filter's model fits exactly
+	std::vector<PalmSample> line(60);
+	for (unsigned int index = 0; index < line.size(); ++index)
+	{
+		line[index].time = index * FrameInterval;
+		line[index].x = 100.0f + (index * 10.0f);
+		line[index].y = 200.0f;
+		line[index].found = true;
+	}
+
+	std::vector<PalmSample> circle;
+	MakeCircleTrack(120, 1.5f, circle);
+
+	std::vector<PalmSample> still;
+	MakeCircleTrack(120, 2.0f, still);
+	for (unsigned int index = 0; index < still.size(); ++index)
+	{
+		still[index].x -= cos((6.2831853f * index) / 30.0f) * 128.0f;
+		still[index].y -= sin((6.2831853f * index) / 30.0f) * 72.0f;
+	}
+
+	const float lineHold = GetPredictionError(nullptr, line);
+	const float circleHold = GetPredictionError(nullptr, circle);
+	const float stillRaw = GetStillSpread(nullptr, still);
+
+	for (unsigned int filter = 0; filter < 2; ++filter)
+	{
+		float x, y;
+		filters[filter]->Reset();
+		if (filters[filter]->Predict(0, x, y))
+		{
+			std::cerr << "filter: the " << names[filter] << " filter predicted a position before it was given one" << std::endl;
+			passed = false;
+		}
+
+		const float lineError = GetPredictionError(filters[filter], line);
+		const float circleError = GetPredictionError(filters[filter], circle);
+		const float stillSpread = GetStillSpread(filters[filter], still);
+
+		std::cout << "# filter: " << names[filter] << " predicts a frame ahead " << lineError << "px off a line (holding is " << lineHold << "px), "
+			<< circleError << "px off a circle (" << circleHold << "px), and spreads " << stillSpread << "px holding still (" << stillRaw << "px)" << std::endl;
+
+		// the kalman filter's model is a line it predicts exactly, the one euro filter trades some of its lead for smoothing a still hand
+		const float lineLimit = filter == 1 ? 0.5f : lineHold * 0.5f;
+		const float circleLimit = circleHold * (filter == 1 ? 0.5f : 0.75f);
+		const float stillLimit = stillRaw * (filter == 1 ? 1.0f : 0.5f);
+		if (lineError > lineLimit || circleError > circleLimit || stillSpread > stillLimit)
+		{
+			std::cerr << "filter: the " << names[filter] << " filter predicted " << lineError << "px off a line, " << circleError << "px off a circle and spread "
+				<< stillSpread << "px holding still" << std::endl;
+			passed = false;
+		}
+
+		// extrapolation stops at the maximum lead
+		float leadX, leadY, farX, farY;
+		filters[filter]->Reset();
+		filters[filter]->Add(0, 0.0f, 0.0f);
+		filters[filter]->Add(FrameInterval, 10.0f, 0.0f);
+		filters[filter]->Predict(FrameInterval + KalmanDefaults.maximumLead, leadX, leadY);
+		filters[filter]->Predict(FrameInterval + (KalmanDefaults.maximumLead * 10), farX, farY);
+		if (leadX != farX || leadY != farY || leadX <= 0.0f)
+		{
+			std::cerr << "filter: the " << names[filter] << " filter extrapolated to " << farX << " past its lead limit at " << leadX << std::endl;
+			passed = false;
+		}
+	}
+
+	return passed;
+}
+
+/*
+ *	\brief Check the palm filters, measure how far ahead they predict the palm of the frames and search for the settings which predict them best
+*/
+bool RunFilterBenchmarks(
+		CBenchmark &benchmark,						//!< The benchmark runner
+		const DepthFrames &frames					//!< The frames to track the palm through
+	)
+{
+	bool passed = CheckFilters();
+
+	std::vector<PalmSample> palms;
+	FindPalms(frames, palms);
+
+	COneEuroFilter oneEuro(OneEuroDefaults);
+	CKalmanFilter kalman(KalmanDefaults);
+
+	std::cout << "# filter: predicting the palm a frame ahead in the frames is off by " << GetPredictionError(nullptr, palms) << "px holding, "
+		<< GetPredictionError(&oneEuro, palms) << "px with the one euro filter and " << GetPredictionError(&kalman, palms) << "px with the kalman filter" << std::endl;
+
+	// a coarse search of the settings, to tune the defaults against a recording
+	OneEuroSettings bestOneEuro = OneEuroDefaults;
+	float bestOneEuroError = GetPredictionError(&oneEuro, palms);
+	for (float cutoff = 0.5f; cutoff <= 4.0f; cutoff *= 2.0f)
+	{
+		for (float beta = 0.0025f; beta <= 0.1f; beta *= 2.0f)
+		{
+			const OneEuroSettings settings = { cutoff, beta, OneEuroDefaults.derivativeCutoff, OneEuroDefaults.maximumLead };
+			oneEuro.SetSettings(settings);
+
+			const float error = GetPredictionError(&oneEuro, palms);
+			if (error < bestOneEuroError)
+			{
+				bestOneEuroError = error;
+				bestOneEuro = settings;
+			}
+		}
+	}
+
+	KalmanSettings bestKalman = KalmanDefaults;
+	float bestKalmanError = GetPredictionError(&kalman, palms);
+	for (float acceleration = 250.0f; acceleration <= 16000.0f; acceleration *= 2.0f)
+	{
+		for (float measurementError = 0.5f; measurementError <= 8.0f; measurementError *= 2.0f)
+		{
+			const KalmanSettings settings = { acceleration, measurementError, KalmanDefaults.maximumLead };
+			kalman.SetSettings(settings);
+
+			const float error = GetPredictionError(&kalman, palms);
+			if (error < bestKalmanError)
+			{
+				bestKalmanError = error;
+				bestKalman = settings;
+			}
+		}
+	}
+
+	std::cout << "# filter: the best one euro settings found were cutoff " << bestOneEuro.minimumCutoff << "Hz beta " << bestOneEuro.beta << ", " << bestOneEuroError
+		<< "px, the best kalman settings acceleration " << bestKalman.acceleration << " measurement error " << bestKalman.measurementError << ", " << bestKalmanError << "px" << std::endl;
+
+	oneEuro.SetSettings(OneEuroDefaults);
+	kalman.SetSettings(KalmanDefaults);
+
+	unsigned int index = 0;
+	benchmark.Run("filter/oneeuro", 1, [&]() {
+		float x, y;
+		const PalmSample &palm = palms[index % palms.size()];
+		const unsigned long long time = index++ * FrameInterval;
+		oneEuro.Add(time, palm.x, palm.y);
+		oneEuro.Predict(time + FrameInterval, x, y);
+	});
+
+	index = 0;
+	benchmark.Run("filter/kalman", 1, [&]() {
+		float x, y;
+		const PalmSample &palm = palms[index % palms.size()];
+		const unsigned long long time = index++ * FrameInterval;
+		kalman.Add(time, palm.x, palm.y);
+		kalman.Predict(time + FrameInterval, x, y);
+	});
+
+	return passed;
+}
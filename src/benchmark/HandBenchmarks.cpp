@@ -0,0 +1,493 @@
+#include "Benchmarks.h"
+#include "../kinect/CBlobLabeller.h"
+#include "../kinect/DepthBand.h"
+#include "../kinect/SobelEdges.h"
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+// the hand band CHand thresholds, in millimetres
+static const int NearPoint = 832;
+static const int FarPoint = 1344;
+
+// the rows either side of the last hand CHand searches first
+static const unsigned int WindowMargin = 48;
+
+// the smallest blob CHand keeps
+static const unsigned int MinimumBlobArea = 64;
+
+// the smallest gradient of the hand mask CHand counts as an edge
+static const unsigned int EdgeThreshold = 3;
+
+// written around the area edges are detected in, to catch writes outside it
+static const unsigned short UntouchedMagnitude = 0xabab;
+static const unsigned char UntouchedEdge = 0xab;
+
+/*
+ *	\brief The extremities of the band pixels as CHand found them before the fused pass
+*/
+struct TwoPassBounds
+{
+	bool						found;							//!< Was any pixel in the band
+	unsigned int				left;							//!< The first column with a pixel in the band
+	unsigned int				right;							//!< The last column with a pixel in the band
+	unsigned int				top;							//!< The first row with a pixel in the band
+};
+
+/*
+ *	\brief Threshold a frame then scan the mask for the bounds, the way CHand did before the fused pass
+*/
+static TwoPassBounds ThresholdTwoPass(
+		const unsigned short *depthPixels,			//!< The packed depth pixels of the frame
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows in the frame
+		unsigned char *mask							//!< Receives the mask
+	)
+{
+	const unsigned int frameSize = width * height;
+	for (unsigned int depthIndex = 0; depthIndex < frameSize; ++depthIndex)
+	{
+		const int depth = depthPixels[depthIndex] >> 3;
+		mask[depthIndex] = (depth >= NearPoint && depth < FarPoint) ? 1 : 0;
+	}
+
+	TwoPassBounds bounds = { false, width, 0, height };
+	for (unsigned int yPos = 0; yPos < height; ++yPos)
+	{
+		for (unsigned int xPos = 0; xPos < width; ++xPos)
+		{
+			if (mask[(yPos * width) + xPos] == 0)
+				continue;
+
+			bounds.found = true;
+			if (xPos > bounds.right) bounds.right = xPos;
+			if (xPos < bounds.left) bounds.left = xPos;
+			if (yPos < bounds.top) bounds.top = yPos;
+		}
+	}
+
+	return bounds;
+}
+
+/*
+ *	\brief Check the fused pass gives the same mask and bounds as the two pass threshold on every frame
+*/
+static bool CheckFusedThreshold(
+		const DepthFrames &frames					//!< The frames to check
+	)
+{
+	const unsigned int frameSize = frames.width * frames.height;
+	std::vector<unsigned char> twoPassMask(frameSize);
+	std::vector<unsigned char> fusedMask(frameSize);
+
+	for (unsigned int frame = 0; frame < frames.count; ++frame)
+	{
+		const TwoPassBounds expected = ThresholdTwoPass(frames.GetFrame(frame), frames.width, frames.height, &twoPassMask[0]);
+		const MaskArea area = ThresholdDepthBand(frames.GetFrame(frame), frames.width, 0, frames.height, NearPoint, FarPoint, &fusedMask[0]);
+
+		bool matches = expected.found == !area.IsEmpty() && twoPassMask == fusedMask;
+		if (matches && expected.found)
+		{
+			matches = area.left == expected.left && area.right - 1 == expected.right && area.top == expected.top;
+		}
+
+		if (!matches)
+		{
+			std::cerr << "hand/band: frame " << frame << " of " << frames.width << "x" << frames.height
+				<< " gave " << area.left << "," << area.top << " to " << area.right << "," << area.bottom
+				<< " instead of " << expected.left << "," << expected.top << " to " << expected.right << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Label the 8-connected blobs of a mask by flood filling from each unlabelled pixel in turn
+*/
+static std::vector<MaskBlob> FloodFillBlobs(
+		const unsigned char *mask,					//!< The mask to label
+		unsigned int width,							//!< The number of pixels in a row
+		const MaskArea &area,						//!< The area of the mask to label
+		unsigned int minimumArea,					//!< Blobs with fewer pixels than this are dropped
+		std::vector<unsigned int> &blobNumbers		//!< Receives the blob number of every pixel of the mask
+	)
+{
+	std::vector<MaskBlob> blobs;
+	std::vector<unsigned int> visited(blobNumbers.size(), 0);
+	std::fill(blobNumbers.begin(), blobNumbers.end(), 0);
+
+	std::vector<unsigned int> stack;
+	std::vector<unsigned int> pixels;
+
+	for (unsigned int y = area.top; y < area.bottom; ++y)
+	{
+		for (unsigned int x = area.left; x < area.right; ++x)
+		{
+			if (mask[(y * width) + x] == 0 || visited[(y * width) + x] != 0)
+				continue;
+
+			pixels.clear();
+			stack.push_back((y * width) + x);
+			visited[(y * width) + x] = 1;
+
+			while (!stack.empty())
+			{
+				const unsigned int pixel = stack.back();
+				stack.pop_back();
+				pixels.push_back(pixel);
+
+				const int pixelX = pixel % width;
+				const int pixelY = pixel / width;
+				for (int neighbourY = pixelY - 1; neighbourY <= pixelY + 1; ++neighbourY)
+				{
+					for (int neighbourX = pixelX - 1; neighbourX <= pixelX + 1; ++neighbourX)
+					{
+						if (neighbourX < static_cast<int>(area.left) || neighbourX >= static_cast<int>(area.right)) continue;
+						if (neighbourY < static_cast<int>(area.top) || neighbourY >= static_cast<int>(area.bottom)) continue;
+
+						const unsigned int neighbour = (neighbourY * width) + neighbourX;
+						if (mask[neighbour] == 0 || visited[neighbour] != 0)
+							continue;
+
+						visited[neighbour] = 1;
+						stack.push_back(neighbour);
+					}
+				}
+			}
+
+			if (pixels.size() < minimumArea)
+				continue;
+
+			MaskBlob blob = { static_cast<unsigned int>(pixels.size()), { width, area.bottom, 0, 0 }, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+			double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumYY = 0.0, sumXY = 0.0;
+			for (unsigned int index = 0; index < pixels.size(); ++index)
+			{
+				const unsigned int pixelX = pixels[index] % width;
+				const unsigned int pixelY = pixels[index] / width;
+				if (pixelX < blob.bounds.left) blob.bounds.left = pixelX;
+				if (pixelX + 1 > blob.bounds.right) blob.bounds.right = pixelX + 1;
+				if (pixelY < blob.bounds.top) blob.bounds.top = pixelY;
+				if (pixelY + 1 > blob.bounds.bottom) blob.bounds.bottom = pixelY + 1;
+				sumX += pixelX;
+				sumY += pixelY;
+				sumXX += static_cast<double>(pixelX) * pixelX;
+				sumYY += static_cast<double>(pixelY) * pixelY;
+				sumXY += static_cast<double>(pixelX) * pixelY;
+				blobNumbers[pixels[index]] = static_cast<unsigned int>(blobs.size() + 1);
+			}
+
+			const double count = static_cast<double>(pixels.size());
+			blob.centroidX = static_cast<float>(sumX / count);
+			blob.centroidY = static_cast<float>(sumY / count);
+			blob.varianceX = static_cast<float>((sumXX / count) - ((sumX / count) * (sumX / count)));
+			blob.varianceY = static_cast<float>((sumYY / count) - ((sumY / count) * (sumY / count)));
+			blob.covariance = static_cast<float>((sumXY / count) - ((sumX / count) * (sumY / count)));
+			blobs.push_back(blob);
+		}
+	}
+
+	return blobs;
+}
+
+/*
+ *	\brief Are two blob moments the same, allowing for rounding
+*/
+static bool IsSameMoment(
+		float first,								//!< The first moment
+		float second								//!< The second moment
+	)
+{
+	return fabs(first - second) <= 1e-3f * (1.0f + fabs(first));
+}
+
+/*
+ *	\brief Check the labeller finds the same blobs and pixel labels as a flood fill
+*/
+static bool CheckBlobLabeller(
+		const char *name,							//!< The name of the mask, for the error
+		const unsigned char *mask,					//!< The mask to label
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows in the mask
+		const MaskArea &area						//!< The area of the mask to label
+	)
+{
+	CBlobLabeller labeller;
+	labeller.Create(width, height);
+	labeller.Label(mask, area, MinimumBlobArea);
+	const std::vector<MaskBlob> &blobs = labeller.GetBlobs();
+
+	std::vector<unsigned int> expectedNumbers(width * height);
+	const std::vector<MaskBlob> expected = FloodFillBlobs(mask, width, area, MinimumBlobArea, expectedNumbers);
+
+	bool matches = blobs.size() == expected.size();
+	for (unsigned int blob = 0; matches && blob < blobs.size(); ++blob)
+	{
+		const MaskBlob &found = blobs[blob];
+		const MaskBlob &wanted = expected[blob];
+		matches = found.area == wanted.area
+			&& found.bounds.left == wanted.bounds.left && found.bounds.top == wanted.bounds.top
+			&& found.bounds.right == wanted.bounds.right && found.bounds.bottom == wanted.bounds.bottom
+			&& IsSameMoment(found.centroidX, wanted.centroidX) && IsSameMoment(found.centroidY, wanted.centroidY)
+			&& IsSameMoment(found.varianceX, wanted.varianceX) && IsSameMoment(found.varianceY, wanted.varianceY)
+			&& IsSameMoment(found.covariance, wanted.covariance);
+	}
+
+	for (unsigned int y = 0; matches && y < height; ++y)
+	{
+		for (unsigned int x = 0; matches && x < width; ++x)
+		{
+			matches = labeller.GetBlobNumber(x, y) == expectedNumbers[(y * width) + x];
+		}
+	}
+
+	if (!matches)
+	{
+		std::cerr << "hand/blobs: " << name << " found " << blobs.size() << " blobs, the flood fill found " << expected.size() << std::endl;
+	}
+
+	return matches;
+}
+
+/*
+ *	\brief Check the labeller against a flood fill on thresholded frames and random masks
+*/
+static bool CheckBlobLabeller(
+		const DepthFrames &frames					//!< The frames to threshold into masks
+	)
+{
+	bool passed = true;
+
+	const unsigned int frameSize = frames.width * frames.height;
+	std::vector<unsigned char> mask(frameSize);
+
+	for (unsigned int frame = 0; frame < frames.count; ++frame)
+	{
+		const MaskArea area = ThresholdDepthBand(frames.GetFrame(frame), frames.width, 0, frames.height, NearPoint, FarPoint, &mask[0]);
+		passed = CheckBlobLabeller("depth frame", &mask[0], frames.width, frames.height, area) && passed;
+	}
+
+	// random masks join and split many more labels than a real frame
+	srand(1);
+	static const unsigned int Densities[] = { 10, 30, 45, 60, 80 };
+	for (unsigned int density = 0; density < sizeof(Densities) / sizeof(Densities[0]); ++density)
+	{
+		for (unsigned int pixel = 0; pixel < frameSize; ++pixel)
+		{
+			mask[pixel] = static_cast<unsigned int>(rand() % 100) < Densities[density] ? 1 : 0;
+		}
+
+		const MaskArea wholeMask = { 0, 0, frames.width, frames.height };
+		const MaskArea partMask = { 17, 9, frames.width - 33, frames.height - 5 };
+		passed = CheckBlobLabeller("random mask", &mask[0], frames.width, frames.height, wholeMask) && passed;
+		passed = CheckBlobLabeller("part of a random mask", &mask[0], frames.width, frames.height, partMask) && passed;
+	}
+
+	return passed;
+}
+
+/*
+ *	\brief Check the Sobel edges of an area against the 3x3 kernels applied one pixel at a time
+*/
+static bool CheckSobelEdges(
+		const char *name,							//!< The name of the case, for errors
+		const unsigned char *image,					//!< The pixels of the whole image
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows in the image
+		const MaskArea &area,						//!< The area to detect edges in
+		unsigned int threshold						//!< The smallest magnitude which is an edge
+	)
+{
+	static const int SobelX[3][3] = { { -1, 0, 1 }, { -2, 0, 2 }, { -1, 0, 1 } };
+	static const int SobelY[3][3] = { { -1, -2, -1 }, { 0, 0, 0 }, { 1, 2, 1 } };
+
+	std::vector<unsigned short> magnitude(width * height, UntouchedMagnitude);
+	std::vector<unsigned char> edges(width * height, UntouchedEdge);
+	DetectSobelEdges(image, width, height, area, threshold, &magnitude[0], &edges[0]);
+
+	for (unsigned int y = 0; y < height; ++y)
+	{
+		for (unsigned int x = 0; x < width; ++x)
+		{
+			const unsigned int pixel = (y * width) + x;
+			const bool inArea = x >= area.left && x < area.right && y >= area.top && y < area.bottom;
+
+			// the border of the image has no gradient, and is never an edge
+			const bool inside = x > 0 && y > 0 && x + 1 < width && y + 1 < height;
+
+			unsigned int expected = 0;
+			if (inArea && inside)
+			{
+				int gx = 0;
+				int gy = 0;
+				for (int offsetY = -1; offsetY <= 1; ++offsetY)
+				{
+					for (int offsetX = -1; offsetX <= 1; ++offsetX)
+					{
+						const int value = image[pixel + (offsetY * static_cast<int>(width)) + offsetX];
+						gx += SobelX[offsetY + 1][offsetX + 1] * value;
+						gy += SobelY[offsetY + 1][offsetX + 1] * value;
+					}
+				}
+				expected = abs(gx) + abs(gy);
+			}
+
+			const unsigned short expectedMagnitude = inArea ? static_cast<unsigned short>(expected) : UntouchedMagnitude;
+			const unsigned char expectedEdge = inArea ? (inside && expected >= threshold ? 1 : 0) : UntouchedEdge;
+			if (magnitude[pixel] != expectedMagnitude || edges[pixel] != expectedEdge)
+			{
+				std::cerr << "hand: sobel edges of " << name << " at " << x << ", " << y << " gave " << magnitude[pixel] << "/" << static_cast<int>(edges[pixel])
+					<< " rather than " << expectedMagnitude << "/" << static_cast<int>(expectedEdge) << std::endl;
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Check the Sobel edges on hand masks, the image borders and the largest gradients
+*/
+static bool CheckSobelEdges(
+		const DepthFrames &frames					//!< The frames to threshold into masks
+	)
+{
+	bool passed = true;
+
+	const unsigned int frameSize = frames.width * frames.height;
+	std::vector<unsigned char> mask(frameSize);
+
+	for (unsigned int frame = 0; frame < frames.count && passed; ++frame)
+	{
+		const MaskArea area = ThresholdDepthBand(frames.GetFrame(frame), frames.width, 0, frames.height, NearPoint, FarPoint, &mask[0]);
+		passed = CheckSobelEdges("a hand mask", &mask[0], frames.width, frames.height, area, EdgeThreshold);
+	}
+
+	// full range noise reaches the largest magnitudes, whole images and odd areas cover the borders and leftover columns
+	srand(1);
+	for (unsigned int pixel = 0; pixel < frameSize; ++pixel)
+	{
+		mask[pixel] = (rand() % 3) == 0 ? static_cast<unsigned char>(rand() % 256) : (pixel / 7) % 2 ? 255 : 0;
+	}
+
+	const MaskArea wholeImage = { 0, 0, frames.width, frames.height };
+	const MaskArea oddArea = { 3, 1, frames.width - 7, frames.height - 1 };
+	const MaskArea tinyArea = { frames.width - 2, 0, frames.width + 5, 3 };
+	static const unsigned int Thresholds[] = { 0, 1, EdgeThreshold, 700, 2040, 2041, 5000 };
+	for (unsigned int threshold = 0; threshold < sizeof(Thresholds) / sizeof(Thresholds[0]); ++threshold)
+	{
+		passed = CheckSobelEdges("noise", &mask[0], frames.width, frames.height, wholeImage, Thresholds[threshold]) && passed;
+	}
+
+	passed = CheckSobelEdges("part of the noise", &mask[0], frames.width, frames.height, oddArea, EdgeThreshold) && passed;
+	passed = CheckSobelEdges("a corner of the noise", &mask[0], frames.width, frames.height, tinyArea, EdgeThreshold) && passed;
+	passed = CheckSobelEdges("noise with an odd width", &mask[0], frames.width - 5, frames.height, wholeImage, 700) && passed;
+
+	return passed;
+}
+
+/*
+ *	\brief Check the hand finding passes against the way CHand used to find the hand and time them
+*/
+bool RunHandBenchmarks(
+		CBenchmark &benchmark,						//!< The benchmark runner
+		const DepthFrames &frames					//!< The frames to find the hand in
+	)
+{
+	// an odd width checks the pixels left over after the vectorised columns
+	DepthFrames oddFrames;
+	GenerateDepthFrames(frames.width - 3, frames.height, 4, oddFrames);
+
+	bool passed = CheckFusedThreshold(frames);
+	passed = CheckFusedThreshold(oddFrames) && passed;
+	passed = CheckBlobLabeller(frames) && passed;
+	passed = CheckSobelEdges(frames) && passed;
+
+	const unsigned int frameSize = frames.width * frames.height;
+	std::vector<unsigned char> mask(frameSize);
+
+	// the row window CHand would search around the hand it found in each frame
+	std::vector<unsigned int> windowRows(frames.count * 2);
+	for (unsigned int frame = 0; frame < frames.count; ++frame)
+	{
+		const MaskArea area = ThresholdDepthBand(frames.GetFrame(frame), frames.width, 0, frames.height, NearPoint, FarPoint, &mask[0]);
+		const unsigned int top = area.IsEmpty() ? 0 : area.top;
+		const unsigned int bottom = area.IsEmpty() ? frames.height : top + static_cast<unsigned int>((area.right - area.left) * 1.3f);
+
+		windowRows[frame * 2] = top > WindowMargin ? top - WindowMargin : 0;
+		windowRows[(frame * 2) + 1] = bottom + WindowMargin < frames.height ? bottom + WindowMargin : frames.height;
+	}
+
+	unsigned int frame = 0;
+	benchmark.Run("hand/band/twopass", frames.width, [&]() {
+		ThresholdTwoPass(frames.GetFrame(frame), frames.width, frames.height, &mask[0]);
+		frame = (frame + 1) % frames.count;
+	}, frameSize);
+
+	frame = 0;
+	benchmark.Run("hand/band/fused", frames.width, [&]() {
+		ThresholdDepthBand(frames.GetFrame(frame), frames.width, 0, frames.height, NearPoint, FarPoint, &mask[0]);
+		frame = (frame + 1) % frames.count;
+	}, frameSize);
+
+	frame = 0;
+	benchmark.Run("hand/band/window", frames.width, [&]() {
+		ThresholdDepthBand(frames.GetFrame(frame), frames.width, windowRows[frame * 2], windowRows[(frame * 2) + 1], NearPoint, FarPoint, &mask[0]);
+		frame = (frame + 1) % frames.count;
+	}, frameSize);
+
+	// labelling the whole band of each frame, as CHand does when it can't find the hand near the last one
+	std::vector<MaskArea> bandAreas(frames.count);
+	std::vector<unsigned char> masks(frameSize * frames.count);
+	for (unsigned int bandFrame = 0; bandFrame < frames.count; ++bandFrame)
+	{
+		bandAreas[bandFrame] = ThresholdDepthBand(frames.GetFrame(bandFrame), frames.width, 0, frames.height, NearPoint, FarPoint, &masks[bandFrame * frameSize]);
+	}
+
+	CBlobLabeller labeller;
+	labeller.Create(frames.width, frames.height);
+
+	frame = 0;
+	benchmark.Run("hand/blobs/band", frames.width, [&]() {
+		labeller.Label(&masks[frame * frameSize], bandAreas[frame], MinimumBlobArea);
+		frame = (frame + 1) % frames.count;
+	}, frameSize);
+
+	// a half full random mask, close to the worst case for the number of labels joined
+	for (unsigned int pixel = 0; pixel < frameSize; ++pixel)
+	{
+		mask[pixel] = (rand() % 2) == 0 ? 1 : 0;
+	}
+
+	const MaskArea wholeMask = { 0, 0, frames.width, frames.height };
+	benchmark.Run("hand/blobs/noise", frames.width, [&]() { labeller.Label(&mask[0], wholeMask, MinimumBlobArea); }, frameSize);
+
+	// the edges of the hand area CHand would sample from each band, and of the whole mask
+	std::vector<MaskArea> handAreas(frames.count);
+	for (unsigned int bandFrame = 0; bandFrame < frames.count; ++bandFrame)
+	{
+		const MaskArea &band = bandAreas[bandFrame];
+		const unsigned int bottom = band.top + static_cast<unsigned int>((band.right - band.left) * 1.3f);
+		const MaskArea handArea = { band.left, band.top, band.right, bottom < frames.height ? bottom : frames.height };
+		handAreas[bandFrame] = band.IsEmpty() ? band : handArea;
+	}
+
+	std::vector<unsigned short> magnitude(frameSize);
+	std::vector<unsigned char> edges(frameSize);
+
+	frame = 0;
+	benchmark.Run("hand/edges/area", frames.width, [&]() {
+		DetectSobelEdges(&masks[frame * frameSize], frames.width, frames.height, handAreas[frame], EdgeThreshold, &magnitude[0], &edges[0]);
+		frame = (frame + 1) % frames.count;
+	}, frameSize);
+
+	frame = 0;
+	benchmark.Run("hand/edges/frame", frames.width, [&]() {
+		DetectSobelEdges(&masks[frame * frameSize], frames.width, frames.height, wholeMask, EdgeThreshold, &magnitude[0], &edges[0]);
+		frame = (frame + 1) % frames.count;
+	}, frameSize);
+
+	return passed;
+}
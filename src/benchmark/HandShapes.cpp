@@ -0,0 +1,154 @@
+#include "HandShapes.h"
+#include <math.h>
+#include <stdlib.h>
+
+// the smallest blob and hand widths CHand uses
+static const unsigned int MinimumBlobArea = 64;
+static const unsigned int SmallestHand = 30;
+static const unsigned int LargestHand = 90;
+
+/*
+ *	\brief Set the mask pixels within a distance of a line segment
+*/
+static void DrawCapsule(
+		std::vector<unsigned char> &mask,			//!< The square mask to draw on
+		float startX,								//!< The column of the start of the segment
+		float startY,								//!< The row of the start of the segment
+		float endX,									//!< The column of the end of the segment
+		float endY,									//!< The row of the end of the segment
+		float radius								//!< The distance from the segment which is set
+	)
+{
+	const float segmentX = endX - startX;
+	const float segmentY = endY - startY;
+	const float lengthSquared = (segmentX * segmentX) + (segmentY * segmentY);
+
+	for (unsigned int y = 0; y < HandMaskSize; ++y)
+	{
+		for (unsigned int x = 0; x < HandMaskSize; ++x)
+		{
+			float along = lengthSquared > 0.0f ? (((x - startX) * segmentX) + ((y - startY) * segmentY)) / lengthSquared : 0.0f;
+			along = along < 0.0f ? 0.0f : along > 1.0f ? 1.0f : along;
+
+			const float offsetX = x - (startX + (segmentX * along));
+			const float offsetY = y - (startY + (segmentY * along));
+			if ((offsetX * offsetX) + (offsetY * offsetY) <= radius * radius)
+			{
+				mask[(y * HandMaskSize) + x] = 1;
+			}
+		}
+	}
+}
+
+/*
+ *	\brief Draw a hand holding up a number of fingers, on the end of an arm reaching up from below
+*/
+void DrawHand(
+		unsigned int fingers,						//!< The number of fingers held up, 0 for a fist, 2 to 5 otherwise
+		float scale,								//!< The size of the hand, 1 for a palm 40 pixels across
+		float rotation,								//!< The lean of the hand, in radians
+		bool noisy,									//!< Flip pixels along the outline and drop some, as the sensor does
+		std::vector<unsigned char> &mask			//!< Receives the mask of the hand
+	)
+{
+	// the angle of each finger from straight up, the thumb last, and their lengths
+	static const float FingerAngles[5] = { -0.47f, -0.16f, 0.16f, 0.47f, -1.22f };
+	static const float FingerLengths[5] = { 32.0f, 35.0f, 33.0f, 27.0f, 24.0f };
+
+	mask.assign(HandMaskSize * HandMaskSize, 0);
+
+	const float palmX = HandMaskSize * 0.5f;
+	const float palmY = HandMaskSize * 0.55f;
+	const float palmRadius = 20.0f * scale;
+
+	// the wrist and forearm until it leaves the hand band, then the palm or fist
+	DrawCapsule(mask, palmX, palmY, palmX - (sin(rotation) * 80.0f), palmY + (cos(rotation) * 80.0f), 11.0f * scale);
+	DrawCapsule(mask, palmX, palmY - (2.0f * scale), palmX, palmY + (4.0f * scale), palmRadius);
+
+	// two fingers are the first two, three adds the ring finger, five adds the thumb
+	for (unsigned int index = 0; index < fingers; ++index)
+	{
+		const float angle = FingerAngles[index] + rotation;
+		const float baseDistance = palmRadius * 0.6f;
+		const float tipDistance = baseDistance + (FingerLengths[index] * scale);
+
+		DrawCapsule(mask,
+			palmX + (sin(angle) * baseDistance), palmY - (cos(angle) * baseDistance),
+			palmX + (sin(angle) * tipDistance), palmY - (cos(angle) * tipDistance),
+			(index == 4 ? 5.0f : 4.0f) * scale);
+	}
+
+	if (!noisy)
+		return;
+
+	// the sensor's edges are ragged and the odd pixel goes missing
+	std::vector<unsigned char> original = mask;
+	for (unsigned int y = 1; y + 1 < HandMaskSize; ++y)
+	{
+		for (unsigned int x = 1; x + 1 < HandMaskSize; ++x)
+		{
+			const unsigned int pixel = (y * HandMaskSize) + x;
+			const bool onEdge = original[pixel - 1] != original[pixel] || original[pixel + 1] != original[pixel]
+				|| original[pixel - HandMaskSize] != original[pixel] || original[pixel + HandMaskSize] != original[pixel];
+
+			if ((onEdge && (rand() % 100) < 15) || (original[pixel] != 0 && (rand() % 50) == 0))
+			{
+				mask[pixel] = original[pixel] != 0 ? 0 : 1;
+			}
+		}
+	}
+}
+
+/*
+ *	\brief Find the hand area and the blob's first pixel the way CHand does when it isn't following a hand, false if there is no hand
+*/
+bool FindHandArea(
+		const unsigned char *mask,					//!< The mask of the hand band
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows
+		CBlobLabeller &labeller,					//!< Labels the blobs of the mask
+		MaskArea &handArea,							//!< Receives the hand area
+		unsigned int &startX,						//!< Receives the column of the blob's first pixel
+		unsigned int &startY						//!< Receives the row of the blob's first pixel
+	)
+{
+	const MaskArea wholeMask = { 0, 0, width, height };
+	labeller.Label(mask, wholeMask, MinimumBlobArea);
+
+	// the largest blob as wide as a hand
+	const std::vector<MaskBlob> &blobs = labeller.GetBlobs();
+	unsigned int handBlob = 0;
+	unsigned int largestArea = 0;
+	for (unsigned int blob = 0; blob < blobs.size(); ++blob)
+	{
+		const unsigned int blobWidth = blobs[blob].bounds.right - 1 - blobs[blob].bounds.left;
+		if (blobWidth >= SmallestHand && blobWidth <= LargestHand && blobs[blob].area > largestArea)
+		{
+			largestArea = blobs[blob].area;
+			handBlob = blob + 1;
+		}
+	}
+
+	if (handBlob == 0)
+		return false;
+
+	// a box as tall as 1.3 times its width, hanging from the top of the blob
+	const MaskArea &bounds = blobs[handBlob - 1].bounds;
+	const unsigned int bottom = bounds.top + static_cast<unsigned int>((bounds.right - 1 - bounds.left) * 1.3f);
+	if (bottom > height)
+		return false;
+
+	handArea.left = bounds.left;
+	handArea.top = bounds.top;
+	handArea.right = bounds.right;
+	handArea.bottom = bottom;
+
+	startY = bounds.top;
+	for (startX = bounds.left; startX < bounds.right; ++startX)
+	{
+		if (labeller.GetBlobNumber(startX, startY) == handBlob)
+			return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "../kinect/CBlobLabeller.h"
+#include "../kinect/DepthBand.h"
+#include <vector>
+
+/*
+ *	Synthetic hand masks for checking the hand shape passes.
+ *	The hands are drawn on a square mask with the middle of the palm at
+ *	HandMaskSize * 0.5 across and HandMaskSize * 0.55 down, the arm reaching up from below.
+*/
+
+							//! The width and height of the drawn hand masks
+static const unsigned int	HandMaskSize = 240;
+
+							//! Draw a hand holding up a number of fingers, on the end of an arm reaching up from below
+void						DrawHand(
+								unsigned int fingers,			//!< The number of fingers held up, 0 for a fist, 2 to 5 otherwise
+								float scale,					//!< The size of the hand, 1 for a palm 40 pixels across
+								float rotation,					//!< The lean of the hand, in radians
+								bool noisy,						//!< Flip pixels along the outline and drop some, as the sensor does
+								std::vector<unsigned char> &mask	//!< Receives the mask of the hand
+							);
+
+							//! Find the hand area and the blob's first pixel the way CHand does when it isn't following a hand, false if there is no hand
+bool						FindHandArea(
+								const unsigned char *mask,		//!< The mask of the hand band
+								unsigned int width,				//!< The number of pixels in a row
+								unsigned int height,			//!< The number of rows
+								CBlobLabeller &labeller,		//!< Labels the blobs of the mask
+								MaskArea &handArea,				//!< Receives the hand area
+								unsigned int &startX,			//!< Receives the column of the blob's first pixel
+								unsigned int &startY			//!< Receives the row of the blob's first pixel
+							);
@@ -0,0 +1,705 @@
+#include "Benchmarks.h"
+#include "../kinect/CFramePipeline.h"
+#include "../kinect/HandSample.h"
+#include "../kinect/TripleBuffer.h"
+#include <chrono>
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+
+static const unsigned int RingItems = 100000;			// items passed through the ring between two threads
+static const unsigned int PacedFrames = 60;				// frames pushed with time for every stage to finish between them
+static const unsigned int BurstFrames = 40;				// frames pushed at a pipeline with a slow stage
+static const unsigned int SlowStageMilliseconds = 30;	// how long the slow stage sleeps over each frame
+static const unsigned int BurstIntervalMilliseconds = 2;	// the time between frames pushed at the slow stage
+static const unsigned int IdleTimeoutMilliseconds = 5000;	// how long a pipeline may take to empty
+static const unsigned int PublishedSamples = 200000;	// hand samples published while the render thread reads them
+static const unsigned int PoolBuffers = 3;				// buffers in the pool whose exhaustion and reuse are checked
+static const unsigned int ReleasingThreads = 4;			// threads releasing shared buffer references at once
+static const unsigned int SharedReleases = 20000;		// buffers shared out and released by those threads
+
+/*
+ *	\brief Wait for every frame pushed to be dropped or leave the last stage, false if it takes too long
+*/
+static bool WaitForIdle(
+		const CFramePipeline &pipeline				//!< The pipeline to wait for
+	)
+{
+	for (unsigned int waited = 0; waited < IdleTimeoutMilliseconds; ++waited)
+	{
+		if (pipeline.IsIdle())
+			return true;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	return pipeline.IsIdle();
+}
+
+/*
+ *	\brief Get a depth frame of the synthetic source
+*/
+static DepthFrame GetSourceFrame(
+		const DepthFrames &frames,					//!< The frames the source cycles through
+		unsigned int index							//!< The number of frames taken before this one
+	)
+{
+	const DepthFrame frame = { frames.width, frames.height, index * 33333ULL, frames.GetFrame(index % frames.count), nullptr };
+	return frame;
+}
+
+/*
+ *	\brief A source filling the pipeline's pooled buffers, as the sensor's source does, holding the last until the next frame
+*/
+struct PooledSource
+{
+	CDepthBufferPool				*buffers;							//!< The pool the frames are copied into
+	CDepthBuffer					*buffer;							//!< The buffer of the last frame
+};
+
+/*
+ *	\brief Copy a depth frame of the synthetic source into a pooled buffer, false if every buffer is held
+*/
+static bool GetPooledFrame(
+		PooledSource &source,						//!< The pooled source
+		const DepthFrames &frames,					//!< The frames the source cycles through
+		unsigned int index,							//!< The number of frames taken before this one
+		DepthFrame &frame							//!< Receives the frame
+	)
+{
+	if (source.buffer != nullptr)
+	{
+		source.buffer->Release();
+	}
+
+	source.buffer = source.buffers->Acquire();
+	if (source.buffer == nullptr)
+		return false;
+
+	frame = GetSourceFrame(frames, index);
+	memcpy(source.buffer->GetPixels(), frame.pixels, frame.width * frame.height * sizeof(unsigned short));
+	frame.pixels = source.buffer->GetPixels();
+	frame.buffer = source.buffer;
+	return true;
+}
+
+/*
+ *	\brief Release the buffer a pooled source holds
+*/
+static void ReleasePooledSource(
+		PooledSource &source						//!< The pooled source
+	)
+{
+	if (source.buffer != nullptr)
+	{
+		source.buffer->Release();
+		source.buffer = nullptr;
+	}
+}
+
+/*
+ *	\brief Check the histogram buckets, percentiles and maximum of known times
+*/
+static bool CheckHistogram()
+{
+	CLatencyHistogram histogram;
+
+	// 90 fast times and 10 slow ones
+	for (unsigned int time = 0; time < 90; ++time)
+	{
+		histogram.Add(100);
+	}
+
+	for (unsigned int time = 0; time < 10; ++time)
+	{
+		histogram.Add(5000);
+	}
+
+	const unsigned long long fast = CLatencyHistogram::GetBucketLimit(CLatencyHistogram::GetBucket(100));
+	const unsigned long long slow = CLatencyHistogram::GetBucketLimit(CLatencyHistogram::GetBucket(5000));
+
+	if (CLatencyHistogram::GetBucket(0) != 0 || CLatencyHistogram::GetBucket(1) != 1 || CLatencyHistogram::GetBucket(127) != 7 || CLatencyHistogram::GetBucket(128) != 8
+		|| CLatencyHistogram::GetBucket(~0ULL) != CLatencyHistogram::BucketCount - 1 || fast < 100 || fast >= 200 || slow < 5000 || slow >= 10000)
+	{
+		std::cerr << "pipeline: the histogram buckets are wrong" << std::endl;
+		return false;
+	}
+
+	if (histogram.GetCount() != 100 || histogram.GetMaximum() != 5000 || histogram.GetMean() != 590.0
+		|| histogram.GetPercentile(50.0f) != fast || histogram.GetPercentile(90.0f) != fast || histogram.GetPercentile(91.0f) != slow || histogram.GetPercentile(100.0f) != slow)
+	{
+		std::cerr << "pipeline: the histogram of 90 100us and 10 5000us times gave " << histogram.GetCount() << " times, max " << histogram.GetMaximum()
+			<< ", mean " << histogram.GetMean() << ", 50% " << histogram.GetPercentile(50.0f) << ", 91% " << histogram.GetPercentile(91.0f) << std::endl;
+		return false;
+	}
+
+	histogram.Reset();
+	if (histogram.GetCount() != 0 || histogram.GetMaximum() != 0 || histogram.GetPercentile(50.0f) != 0)
+	{
+		std::cerr << "pipeline: a reset histogram still holds times" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Check items pushed through a small ring on one thread all come out on another, in order
+*/
+static bool CheckRing()
+{
+	CSpscRing<unsigned int, 4> ring;
+
+	std::thread producer([&]() {
+		for (unsigned int item = 0; item < RingItems; ++item)
+		{
+			while (!ring.TryPush(item))
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	bool passed = true;
+	for (unsigned int expected = 0; expected < RingItems; ++expected)
+	{
+		unsigned int item;
+		while (!ring.TryPop(item))
+		{
+			std::this_thread::yield();
+		}
+
+		if (item != expected && passed)
+		{
+			std::cerr << "pipeline: the ring gave item " << item << " instead of " << expected << std::endl;
+			passed = false;
+		}
+	}
+
+	producer.join();
+
+	unsigned int item;
+	if (ring.TryPop(item) || !ring.IsEmpty())
+	{
+		std::cerr << "pipeline: the ring held more items than were pushed" << std::endl;
+		passed = false;
+	}
+
+	return passed;
+}
+
+/*
+ *	\brief Make a hand sample whose fields all follow from its sequence number, so a torn one shows
+*/
+static HandSample MakeSample(
+		unsigned int sequence						//!< The sequence number of the sample
+	)
+{
+	HandFrame hand;
+	hand.state = sequence % 2 == 0 ? HandState::OpenHand : HandState::ClosedFist;
+	hand.confidence = static_cast<float>(sequence % 100) / 100.0f;
+	hand.palmX = static_cast<float>(sequence % 640);
+	hand.palmY = static_cast<float>(sequence % 480);
+	hand.centerX = hand.palmX + 1.0f;
+	hand.centerY = hand.palmY + 2.0f;
+	return HandSample(hand, sequence * 33333ULL, sequence * 33333ULL, sequence);
+}
+
+/*
+ *	\brief Check a hand sample is whole, every field from the same publish
+*/
+static bool IsWholeSample(
+		const HandSample &sample					//!< The sample read
+	)
+{
+	const unsigned int sequence = static_cast<unsigned int>(sample.sequence);
+	const HandSample expected = MakeSample(sequence);
+	return sample.timestamp == expected.timestamp && sample.state == expected.state && sample.confidence == expected.confidence && sample.palmX == expected.palmX
+		&& sample.palmY == expected.palmY && sample.centerX == expected.centerX && sample.centerY == expected.centerY;
+}
+
+/*
+ *	\brief Check the render thread only ever reads whole hand samples, never older than the last it read, while the tracker publishes as fast as it can
+*/
+static bool CheckHandSamples()
+{
+	CTripleBuffer<HandSample> samples;
+
+	// the first sample published is 1, so reading the default sample means nothing was published yet
+	std::atomic<bool> publishing(true);
+	std::thread tracker([&]() {
+		for (unsigned int sequence = 1; sequence <= PublishedSamples; ++sequence)
+		{
+			samples.Publish(MakeSample(sequence));
+
+			// give the reader a turn now and then, even on one core
+			if (sequence % 16 == 0)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		publishing = false;
+	});
+
+	bool passed = true;
+	unsigned int reads = 0;
+	unsigned int freshReads = 0;
+	unsigned long long lastSequence = 0;
+
+	HandSample sample;
+	for (bool finished = false; !finished; )
+	{
+		// one more read after the tracker stops, which must see its last sample
+		finished = !publishing;
+
+		const bool fresh = samples.Read(sample);
+		reads++;
+		freshReads += fresh ? 1 : 0;
+
+		if ((sample.sequence != 0 && !IsWholeSample(sample)) || sample.sequence < lastSequence || (fresh && sample.sequence == lastSequence))
+		{
+			std::cerr << "hand sample: read sample " << sample.sequence << " after " << lastSequence << ", or it was torn" << std::endl;
+			passed = false;
+			break;
+		}
+
+		lastSequence = sample.sequence;
+		std::this_thread::yield();
+	}
+
+	tracker.join();
+
+	if (passed && lastSequence != PublishedSamples)
+	{
+		std::cerr << "hand sample: the last sample read was " << lastSequence << " not " << PublishedSamples << std::endl;
+		passed = false;
+	}
+
+	std::cout << "# hand sample: " << reads << " reads of " << PublishedSamples << " published samples, " << freshReads << " of them new, none torn" << std::endl;
+	return passed;
+}
+
+/*
+ *	\brief Check the buffer pool runs out rather than allocating, hands back released buffers, keeps a shared buffer until its last reference goes and counts what is still held
+*/
+static bool CheckBufferPool(
+		const DepthFrames &frames					//!< The frames the buffers are sized for
+	)
+{
+	CDepthBufferPool pool;
+	pool.Create(frames.width, frames.height, PoolBuffers);
+
+	bool passed = true;
+	CDepthBuffer *held[PoolBuffers];
+	for (unsigned int buffer = 0; buffer < PoolBuffers; ++buffer)
+	{
+		held[buffer] = pool.Acquire();
+		if (held[buffer] == nullptr || held[buffer]->GetReferences() != 1 || (reinterpret_cast<uintptr_t>(held[buffer]->GetPixels()) % CDepthBufferPool::Alignment) != 0)
+		{
+			std::cerr << "buffer pool: buffer " << buffer << " of " << PoolBuffers << " was missing, already referenced or not aligned" << std::endl;
+			return false;
+		}
+	}
+
+	// every buffer is held, so the pool is exhausted rather than growing
+	if (pool.Acquire() != nullptr || pool.GetExhausted() != 1 || pool.GetFreeCount() != 0 || pool.GetOutstanding() != PoolBuffers)
+	{
+		std::cerr << "buffer pool: with every buffer held the pool handed out another, or counted " << pool.GetExhausted() << " exhaustions and "
+			<< pool.GetOutstanding() << " held buffers" << std::endl;
+		passed = false;
+	}
+
+	// a shared buffer only goes back once both holders release it, then it is the next one handed out
+	held[0]->AddReference();
+	held[0]->Release();
+	if (pool.GetFreeCount() != 0)
+	{
+		std::cerr << "buffer pool: a buffer went back to the pool while it was still referenced" << std::endl;
+		passed = false;
+	}
+
+	held[0]->Release();
+	CDepthBuffer *reused = pool.Acquire();
+	if (reused != held[0] || pool.GetReused() != 1 || pool.GetAcquired() != PoolBuffers + 1)
+	{
+		std::cerr << "buffer pool: the released buffer wasn't handed out again, " << pool.GetReused() << " reuses counted" << std::endl;
+		passed = false;
+	}
+
+	held[0] = reused;
+	for (unsigned int buffer = 0; buffer < PoolBuffers; ++buffer)
+	{
+		if (held[buffer] != nullptr) held[buffer]->Release();
+	}
+
+	// a pool can't be created again under a buffer someone still holds
+	CDepthBuffer *leaked = pool.Acquire();
+	if (pool.GetOutstanding() != 1 || pool.Create(frames.width, frames.height, PoolBuffers))
+	{
+		std::cerr << "buffer pool: a buffer still held counted as " << pool.GetOutstanding() << " outstanding, or the pool was created again under it" << std::endl;
+		passed = false;
+	}
+
+	leaked->Release();
+	if (pool.GetOutstanding() != 0 || pool.GetFreeCount() != PoolBuffers)
+	{
+		std::cerr << "buffer pool: with every buffer released " << pool.GetOutstanding() << " are outstanding and " << pool.GetFreeCount() << " free" << std::endl;
+		passed = false;
+	}
+
+	// references released on several threads at once, only the last of each returns the buffer
+	std::atomic<unsigned int> shared(0);
+	std::vector<CDepthBuffer *> handedOut(SharedReleases, nullptr);
+	std::vector<std::thread> releasers;
+	for (unsigned int thread = 0; thread < ReleasingThreads; ++thread)
+	{
+		releasers.push_back(std::thread([&]() {
+			for (unsigned int release = 0; release < SharedReleases; ++release)
+			{
+				while (release >= shared)
+				{
+					std::this_thread::yield();
+				}
+
+				handedOut[release]->Release();
+			}
+		}));
+	}
+
+	for (unsigned int release = 0; release < SharedReleases; ++release)
+	{
+		CDepthBuffer *buffer;
+		while ((buffer = pool.Acquire()) == nullptr)
+		{
+			std::this_thread::yield();
+		}
+
+		for (unsigned int thread = 1; thread < ReleasingThreads; ++thread)
+		{
+			buffer->AddReference();
+		}
+
+		handedOut[release] = buffer;
+		shared++;
+	}
+
+	for (unsigned int thread = 0; thread < ReleasingThreads; ++thread)
+	{
+		releasers[thread].join();
+	}
+
+	if (pool.GetOutstanding() != 0 || pool.GetFreeCount() != PoolBuffers)
+	{
+		std::cerr << "buffer pool: after releasing on " << ReleasingThreads << " threads " << pool.GetOutstanding() << " buffers are outstanding and "
+			<< pool.GetFreeCount() << " free" << std::endl;
+		passed = false;
+	}
+
+	std::cout << "# buffer pool: " << pool.GetAcquired() << " buffers shared between " << ReleasingThreads << " threads came back, "
+		<< pool.GetExhausted() << " times the pool ran out" << std::endl;
+	return passed;
+}
+
+/*
+ *	\brief Check a pooled frame goes through every stage without a copy, a held up stage drops frames in the pipeline without starving the source of buffers, and stopping releases every buffer in flight
+*/
+static bool CheckZeroCopy(
+		const DepthFrames &frames					//!< The frames of the synthetic source
+	)
+{
+	std::atomic<unsigned int> shared(0);
+	std::atomic<bool> blocked(false);
+
+	CFramePipeline pipeline;
+	pipeline.AddStage("convert", [&](PipelineFrame &frame) {
+		if (frame.depth == frame.buffer->GetPixels() && frame.buffer->GetReferences() >= 1) shared++;
+	});
+	pipeline.AddStage("block", [&](PipelineFrame &) {
+		while (blocked)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	});
+	pipeline.Start(frames.width, frames.height);
+
+	CDepthBufferPool &buffers = pipeline.GetBufferPool();
+	PooledSource source = { &buffers, nullptr };
+
+	bool passed = true;
+	unsigned int pushed = 0;
+	for (unsigned int index = 0; index < PacedFrames; ++index)
+	{
+		DepthFrame frame;
+		if (GetPooledFrame(source, frames, index, frame))
+		{
+			pushed += pipeline.Push(frame) ? 1 : 0;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	passed = WaitForIdle(pipeline) && passed;
+
+	if (shared != pushed || pipeline.GetFramesCopied() != 0 || buffers.GetOutstanding() != 1)
+	{
+		std::cerr << "pipeline: " << shared << " of " << pushed << " pooled frames were shared rather than copied, " << pipeline.GetFramesCopied()
+			<< " copied, and " << buffers.GetOutstanding() << " buffers are held besides the source's" << std::endl;
+		passed = false;
+	}
+
+	// with a stage held up every pooled frame fills, but the source's spare buffer comes back with each dropped frame
+	blocked = true;
+	const unsigned long long droppedBefore = pipeline.GetFramesDropped();
+	unsigned int sourceDropped = 0;
+	for (unsigned int index = 0; index < CFramePipeline::PoolSize * 3; ++index)
+	{
+		DepthFrame frame;
+		if (!GetPooledFrame(source, frames, index, frame))
+		{
+			sourceDropped++;
+			continue;
+		}
+
+		pipeline.Push(frame);
+	}
+
+	const unsigned long long pipelineDropped = pipeline.GetFramesDropped() - droppedBefore;
+	if (sourceDropped != 0 || buffers.GetExhausted() != 0 || pipelineDropped < CFramePipeline::PoolSize * 2 || buffers.GetFreeCount() != 0)
+	{
+		std::cerr << "pipeline: behind a blocked stage the source dropped " << sourceDropped << " frames and the pipeline " << pipelineDropped
+			<< ", the pool ran out " << buffers.GetExhausted() << " times and has " << buffers.GetFreeCount() << " buffers free" << std::endl;
+		passed = false;
+	}
+
+	// frames still in a stage when the pipeline stops give their buffers back too
+	ReleasePooledSource(source);
+	blocked = false;
+	pipeline.Stop();
+
+	if (buffers.GetOutstanding() != 0 || buffers.GetFreeCount() != buffers.GetBufferCount())
+	{
+		std::cerr << "pipeline: after stopping " << buffers.GetOutstanding() << " depth buffers leaked" << std::endl;
+		passed = false;
+	}
+
+	std::cout << "# pipeline: " << shared << " pooled frames went through without a copy, " << pipelineDropped
+		<< " were dropped behind a blocked stage without the source running out, and no buffer leaked after " << buffers.GetAcquired() << " acquired, " << buffers.GetReused() << " of them reused" << std::endl;
+	return passed;
+}
+
+/*
+ *	\brief Check every stage sees the frames which weren't dropped, in the order they were pushed and with their own pixels
+*/
+static bool CheckOrdering(
+		const DepthFrames &frames					//!< The frames of the synthetic source
+	)
+{
+	static const unsigned int StageCount = 3;
+
+	// each stage only writes its own list, and they are read once the pipeline is idle
+	std::vector<unsigned long long> seen[StageCount];
+	unsigned int corrupted = 0;
+
+	CFramePipeline pipeline;
+	for (unsigned int stage = 0; stage < StageCount; ++stage)
+	{
+		std::vector<unsigned long long> &stageSeen = seen[stage];
+		pipeline.AddStage("stage", [&stageSeen](PipelineFrame &frame) { stageSeen.push_back(frame.sequence); });
+	}
+
+	// the last stage checks the copy, the frame's pixels are the source frame it was pushed from
+	pipeline.AddStage("check", [&](PipelineFrame &frame) {
+		const DepthFrame source = GetSourceFrame(frames, static_cast<unsigned int>(frame.sequence));
+		if (frame.timestamp != source.timestamp || memcmp(frame.depth, source.pixels, frame.width * frame.height * sizeof(unsigned short)) != 0)
+		{
+			corrupted++;
+		}
+	});
+
+	pipeline.Start(frames.width, frames.height);
+
+	unsigned int pushed = 0;
+	for (unsigned int index = 0; index < PacedFrames; ++index)
+	{
+		pushed += pipeline.Push(GetSourceFrame(frames, index)) ? 1 : 0;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	if (!WaitForIdle(pipeline))
+	{
+		std::cerr << "pipeline: " << pipeline.GetFramesCompleted() << " of " << pushed << " frames came out of the pipeline" << std::endl;
+		return false;
+	}
+
+	pipeline.Stop();
+
+	bool passed = true;
+	for (unsigned int stage = 0; stage < StageCount; ++stage)
+	{
+		bool ordered = seen[stage].size() == pushed;
+		for (unsigned int index = 1; ordered && index < seen[stage].size(); ++index)
+		{
+			ordered = seen[stage][index] > seen[stage][index - 1];
+		}
+
+		if (!ordered)
+		{
+			std::cerr << "pipeline: stage " << stage << " saw " << seen[stage].size() << " of " << pushed << " frames, or saw them out of order" << std::endl;
+			passed = false;
+		}
+	}
+
+	if (corrupted != 0 || pipeline.GetFramesPushed() != PacedFrames || pipeline.GetFramesCompleted() != pushed || pipeline.GetFramesDropped() != PacedFrames - pushed)
+	{
+		std::cerr << "pipeline: " << corrupted << " frames were corrupted, " << pipeline.GetFramesPushed() << " pushed, " << pipeline.GetFramesCompleted()
+			<< " completed and " << pipeline.GetFramesDropped() << " dropped of " << PacedFrames << std::endl;
+		passed = false;
+	}
+
+	std::cout << "# pipeline: " << pushed << " of " << PacedFrames << " paced frames went through every stage in order" << std::endl;
+	return passed;
+}
+
+/*
+ *	\brief Check a slow stage drops frames rather than holding up push, and the pool gets every frame back
+*/
+static bool CheckSlowStage(
+		const DepthFrames &frames					//!< The frames of the synthetic source
+	)
+{
+	CFramePipeline pipeline;
+	pipeline.AddStage("convert", [](PipelineFrame &) {});
+	pipeline.AddStage("slow", [](PipelineFrame &) { std::this_thread::sleep_for(std::chrono::milliseconds(SlowStageMilliseconds)); });
+	pipeline.AddStage("publish", [](PipelineFrame &) {});
+	pipeline.Start(frames.width, frames.height);
+
+	unsigned int pushed = 0;
+	for (unsigned int index = 0; index < BurstFrames; ++index)
+	{
+		pushed += pipeline.Push(GetSourceFrame(frames, index)) ? 1 : 0;
+		std::this_thread::sleep_for(std::chrono::milliseconds(BurstIntervalMilliseconds));
+	}
+
+	bool passed = WaitForIdle(pipeline);
+
+	// a push only ever copies, it never waits for the slow stage
+	const CLatencyHistogram &push = pipeline.GetPushLatency();
+	if (push.GetMaximum() >= SlowStageMilliseconds * 1000ULL)
+	{
+		std::cerr << "pipeline: a push took " << push.GetMaximum() << "us behind a " << SlowStageMilliseconds << "ms stage" << std::endl;
+		passed = false;
+	}
+
+	if (pipeline.GetFramesDropped() == 0 || pushed + pipeline.GetFramesDropped() != BurstFrames || pipeline.GetFramesCompleted() != pushed)
+	{
+		std::cerr << "pipeline: with a slow stage " << pipeline.GetFramesCompleted() << " of " << BurstFrames << " frames completed and "
+			<< pipeline.GetFramesDropped() << " were dropped" << std::endl;
+		passed = false;
+	}
+
+	// every stage timed every frame which wasn't dropped, and so did the end to end histogram
+	for (unsigned int stage = 0; stage < pipeline.GetStageCount(); ++stage)
+	{
+		const CLatencyHistogram &latency = pipeline.GetStageLatency(stage);
+		std::cout << "# pipeline: " << pipeline.GetStageName(stage) << " took " << latency.GetMean() << "us on average, 99% under " << latency.GetPercentile(99.0f)
+			<< "us, and frames queued 99% under " << pipeline.GetStageWait(stage).GetPercentile(99.0f) << "us for it" << std::endl;
+
+		if (latency.GetCount() != pushed || pipeline.GetStageWait(stage).GetCount() != pushed)
+		{
+			std::cerr << "pipeline: the " << pipeline.GetStageName(stage) << " stage timed " << latency.GetCount() << " of " << pushed << " frames" << std::endl;
+			passed = false;
+		}
+	}
+
+	if (pipeline.GetEndToEndLatency().GetCount() != pushed || pipeline.GetStageLatency(1).GetPercentile(50.0f) < SlowStageMilliseconds * 1000ULL)
+	{
+		std::cerr << "pipeline: the end to end histogram counted " << pipeline.GetEndToEndLatency().GetCount() << " of " << pushed << " frames" << std::endl;
+		passed = false;
+	}
+
+	// once idle the whole pool is free again, so a burst as big as the pool all gets in
+	for (unsigned int index = 0; passed && index < CFramePipeline::PoolSize; ++index)
+	{
+		if (!pipeline.Push(GetSourceFrame(frames, index)))
+		{
+			std::cerr << "pipeline: only " << index << " frames of the pool came back" << std::endl;
+			passed = false;
+		}
+	}
+
+	passed = WaitForIdle(pipeline) && passed;
+
+	std::cout << "# pipeline: " << pipeline.GetFramesDropped() << " of " << BurstFrames << " frames were dropped behind a " << SlowStageMilliseconds
+		<< "ms stage, the longest push took " << push.GetMaximum() << "us" << std::endl;
+	return passed;
+}
+
+/*
+ *	\brief Check the frame pipeline keeps frames in order and never blocks the thread pushing them, and time a frame's trip through it
+*/
+bool RunPipelineBenchmarks(
+		CBenchmark &benchmark,						//!< The benchmark runner
+		const DepthFrames &frames					//!< The frames of the synthetic source
+	)
+{
+	bool passed = CheckHistogram();
+	passed = CheckRing() && passed;
+	passed = CheckOrdering(frames) && passed;
+	passed = CheckSlowStage(frames) && passed;
+	passed = CheckBufferPool(frames) && passed;
+	passed = CheckZeroCopy(frames) && passed;
+	passed = CheckHandSamples() && passed;
+
+	if (benchmark.IsEnabled("pipeline/"))
+	{
+		CFramePipeline pipeline;
+		for (unsigned int stage = 0; stage < 4; ++stage)
+		{
+			pipeline.AddStage("empty", [](PipelineFrame &) {});
+		}
+
+		pipeline.Start(frames.width, frames.height);
+
+		// a frame at a time, so this is the copy in and the hand offs between the four stage threads
+		unsigned int index = 0;
+		benchmark.Run("pipeline/frame", frames.width, [&]() {
+			pipeline.Push(GetSourceFrame(frames, index++));
+			while (!pipeline.IsIdle())
+			{
+				std::this_thread::yield();
+			}
+		}, frames.width * frames.height);
+
+		// a frame already in a pooled buffer, as the sensor's source fills them, is only a reference and the hand offs
+		PooledSource source = { &pipeline.GetBufferPool(), nullptr };
+		DepthFrame pooled;
+		GetPooledFrame(source, frames, 0, pooled);
+		benchmark.Run("pipeline/frame/pooled", frames.width, [&]() {
+			pipeline.Push(pooled);
+			while (!pipeline.IsIdle())
+			{
+				std::this_thread::yield();
+			}
+		}, frames.width * frames.height);
+
+		ReleasePooledSource(source);
+
+		CSpscRing<unsigned int, 4> ring;
+		benchmark.Run("pipeline/ring", 4, [&]() {
+			unsigned int item;
+			ring.TryPush(index);
+			ring.TryPop(item);
+		});
+
+		// the publish stage and the render thread's read of the latest hand
+		CTripleBuffer<HandSample> samples;
+		HandSample sample;
+		benchmark.Run("pipeline/sample", 1, [&]() {
+			samples.Publish(MakeSample(index++));
+			samples.Read(sample);
+		});
+	}
+
+	return passed;
+}
@@ -0,0 +1,162 @@
+#include "Benchmarks.h"
+#include "../kinect/CBlobLabeller.h"
+#include "../kinect/CDepthPyramid.h"
+#include "../kinect/DepthBand.h"
+#include <stdlib.h>
+#include <sstream>
+#include <vector>
+
+// the hand band CHand thresholds, in millimetres
+static const int NearPoint = 832;
+static const int FarPoint = 1344;
+
+// the smallest blob CHand keeps, at full resolution
+static const unsigned int MinimumBlobArea = 64;
+
+// the levels of the depth pyramid CKinect builds
+static const unsigned int PyramidLevels = 3;
+
+/*
+ *	\brief Build a pyramid level a pixel at a time, the nearest reading of the 2x2 pixels below, 0 if none has one
+*/
+static void BuildLevelPerPixel(
+		const unsigned short *below,				//!< The packed pixels of the level below
+		unsigned int belowWidth,					//!< The number of pixels in a row of the level below
+		unsigned int width,							//!< The number of pixels in a row of the level
+		unsigned int height,						//!< The number of rows of the level
+		std::vector<unsigned short> &level			//!< Receives the level
+	)
+{
+	level.resize(width * height);
+	for (unsigned int y = 0; y < height; ++y)
+	{
+		for (unsigned int x = 0; x < width; ++x)
+		{
+			int nearest = 0;
+			for (unsigned int pixel = 0; pixel < 4; ++pixel)
+			{
+				const int depth = below[(((y * 2) + (pixel / 2)) * belowWidth) + (x * 2) + (pixel % 2)] >> 3;
+				if (depth != 0 && (nearest == 0 || depth < nearest)) nearest = depth;
+			}
+
+			level[(y * width) + x] = static_cast<unsigned short>(nearest << 3);
+		}
+	}
+}
+
+/*
+ *	\brief Check every level of the pyramid against building it a pixel at a time
+*/
+static bool CheckPyramid(
+		const char *name,							//!< The name of the frames
+		const DepthFrames &frames					//!< The frames to build pyramids of
+	)
+{
+	CDepthPyramid pyramid;
+	pyramid.Create(frames.width, frames.height, PyramidLevels);
+
+	bool passed = true;
+	std::vector<unsigned short> expected;
+	for (unsigned int frame = 0; frame < frames.count; ++frame)
+	{
+		pyramid.Build(frames.GetFrame(frame));
+
+		for (unsigned int level = 1; level < PyramidLevels; ++level)
+		{
+			const unsigned int width = pyramid.GetLevelWidth(level);
+			const unsigned int height = pyramid.GetLevelHeight(level);
+			BuildLevelPerPixel(pyramid.GetLevel(level - 1), pyramid.GetLevelWidth(level - 1), width, height, expected);
+
+			unsigned int wrong = 0;
+			for (unsigned int pixel = 0; pixel < width * height; ++pixel)
+			{
+				if (pyramid.GetLevel(level)[pixel] != expected[pixel]) wrong++;
+			}
+
+			if (wrong != 0)
+			{
+				std::cerr << "pyramid: level " << level << " of frame " << frame << " of the " << name << " frames has " << wrong << " pixels wrong" << std::endl;
+				passed = false;
+			}
+		}
+	}
+
+	return passed;
+}
+
+/*
+ *	\brief Check the pyramid levels against building them a pixel at a time and time building and searching each level
+*/
+bool RunPyramidBenchmarks(
+		CBenchmark &benchmark,						//!< The benchmark runner
+		const DepthFrames &frames					//!< The frames to build pyramids of
+	)
+{
+	// an odd width and height check the pixels left over after the vectorised columns and the dropped edges
+	DepthFrames oddFrames;
+	GenerateDepthFrames(frames.width - 5, frames.height - 3, 4, oddFrames);
+
+	// random pixels, with and without readings and with player bits, check the ordering of the vectorised minimum
+	DepthFrames noise;
+	GenerateDepthFrames(frames.width, frames.height, 2, noise);
+	for (unsigned int pixel = 0; pixel < noise.pixels.size(); ++pixel)
+	{
+		noise.pixels[pixel] = (rand() % 4) == 0 ? static_cast<unsigned short>(rand() % 8) : static_cast<unsigned short>(rand() & 0xffff);
+	}
+
+	bool passed = CheckPyramid("given", frames);
+	passed = CheckPyramid("odd sized", oddFrames) && passed;
+	passed = CheckPyramid("noise", noise) && passed;
+
+	// a pyramid of each frame, so searching a level doesn't time building it
+	std::vector<CDepthPyramid> pyramids(frames.count);
+	for (unsigned int built = 0; built < frames.count; ++built)
+	{
+		pyramids[built].Create(frames.width, frames.height, PyramidLevels);
+		pyramids[built].Build(frames.GetFrame(built));
+	}
+
+	CDepthPyramid pyramid;
+	pyramid.Create(frames.width, frames.height, PyramidLevels);
+
+	unsigned int frame = 0;
+	benchmark.Run("pyramid/build", frames.width, [&]() {
+		pyramid.Build(frames.GetFrame(frame));
+		frame = (frame + 1) % frames.count;
+	}, frames.width * frames.height);
+
+	for (unsigned int level = 1; level < PyramidLevels; ++level)
+	{
+		std::stringstream name;
+		name << "pyramid/level/" << level;
+
+		benchmark.Run(name.str(), pyramid.GetLevelWidth(level), [&]() {
+			pyramid.BuildLevel(level);
+		}, pyramid.GetLevelWidth(level) * pyramid.GetLevelHeight(level));
+	}
+
+	// searching a level for the hand, thresholding the band then labelling its blobs, as CHand does to acquire it
+	std::vector<unsigned char> mask(frames.width * frames.height);
+	for (unsigned int level = 0; level < PyramidLevels; ++level)
+	{
+		const unsigned int width = pyramid.GetLevelWidth(level);
+		const unsigned int height = pyramid.GetLevelHeight(level);
+		const MaskArea levelArea = { 0, 0, width, height };
+		const unsigned int minimumArea = MinimumBlobArea >> (level * 2);
+
+		CBlobLabeller labeller;
+		labeller.Create(width, height);
+
+		std::stringstream name;
+		name << "pyramid/search/" << level;
+
+		frame = 0;
+		benchmark.Run(name.str(), width, [&]() {
+			const MaskArea bandArea = ThresholdDepthWindow(pyramids[frame].GetLevel(level), width, levelArea, NearPoint, FarPoint, &mask[0]);
+			labeller.Label(&mask[0], bandArea, minimumArea);
+			frame = (frame + 1) % frames.count;
+		}, width * height);
+	}
+
+	return passed;
+}
@@ -0,0 +1,256 @@
+#include "Benchmarks.h"
+#include "../kinect/CDepthRecorder.h"
+#include "../kinect/CDepthReplaySource.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+static const char *const RecordingName = "VisCraftBenchmark.record.vcdr";
+static const unsigned long long FrameInterval = 33333;		// microseconds between frames at 30 frames a second
+static const unsigned int BurstFrames = 256;				// frames pushed at the recorder without waiting
+
+/*
+ *	\brief Check a frame survives being delta encoded and decoded
+*/
+static bool CheckRoundTrip(
+		const char *name,							//!< The name of the case, for errors
+		const unsigned short *pixels,				//!< The frame to encode
+		const unsigned short *previous,				//!< The previous frame, null for a key frame
+		unsigned int count							//!< The number of pixels in a frame
+	)
+{
+	std::vector<unsigned char> encoded;
+	EncodeDepthDeltas(pixels, previous, count, encoded);
+
+	// decoding in place over the previous frame, as the replay does
+	std::vector<unsigned short> decoded(count);
+	if (previous != nullptr)
+	{
+		memcpy(&decoded[0], previous, count * sizeof(unsigned short));
+	}
+
+	if (!DecodeDepthDeltas(encoded.empty() ? nullptr : &encoded[0], static_cast<unsigned int>(encoded.size()), previous != nullptr ? &decoded[0] : nullptr, count, &decoded[0])
+		|| memcmp(&decoded[0], pixels, count * sizeof(unsigned short)) != 0)
+	{
+		std::cerr << "record: " << name << " did not survive delta encoding" << std::endl;
+		return false;
+	}
+
+	// a truncated frame must be rejected rather than read past
+	if (encoded.size() > 1 && DecodeDepthDeltas(&encoded[0], static_cast<unsigned int>(encoded.size() - 1), previous != nullptr ? &decoded[0] : nullptr, count, &decoded[0]))
+	{
+		std::cerr << "record: truncated " << name << " decoded without an error" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Check the delta encodings on the recorded frames, noise and the largest differences
+*/
+static bool CheckEncodings(
+		const DepthFrames &frames					//!< The frames to encode
+	)
+{
+	const unsigned int count = frames.width * frames.height;
+
+	for (unsigned int index = 0; index < frames.count; ++index)
+	{
+		const unsigned short *const previous = index > 0 ? frames.GetFrame(index - 1) : nullptr;
+		if (!CheckRoundTrip("key frame", frames.GetFrame(index), nullptr, count)
+			|| !CheckRoundTrip("frame delta", frames.GetFrame(index), previous, count))
+			return false;
+	}
+
+	std::vector<unsigned short> noise(count);
+	std::vector<unsigned short> extremes(count);
+	std::vector<unsigned short> inverted(count);
+
+	srand(1);
+	for (unsigned int index = 0; index < count; ++index)
+	{
+		noise[index] = static_cast<unsigned short>((static_cast<unsigned int>(rand()) << 8) ^ static_cast<unsigned int>(rand()));
+		extremes[index] = (index / 3) % 2 ? 65535 : 0;
+		inverted[index] = static_cast<unsigned short>(65535 - extremes[index]);
+	}
+
+	// short runs of each token, and lengths either side of the longest runs
+	static const unsigned int RunLengths[] = { 1, 2, 63, 64, 65, 127, 128, 129, 300 };
+	std::vector<unsigned short> runs(count, 0);
+	unsigned int position = 0;
+	for (unsigned int run = 0; position < count; run = (run + 1) % (sizeof(RunLengths) / sizeof(RunLengths[0])))
+	{
+		for (unsigned int pixel = 0; pixel < RunLengths[run] && position < count; ++pixel, ++position)
+		{
+			runs[position] = static_cast<unsigned short>(run % 3 == 0 ? 0 : run % 3 == 1 ? 800 + (pixel % 7) : (pixel * 997));
+		}
+	}
+
+	return CheckRoundTrip("noise", &noise[0], nullptr, count)
+		&& CheckRoundTrip("noise delta", &noise[0], frames.GetFrame(0), count)
+		&& CheckRoundTrip("extremes", &extremes[0], nullptr, count)
+		&& CheckRoundTrip("extremes delta", &extremes[0], &inverted[0], count)
+		&& CheckRoundTrip("runs", &runs[0], nullptr, count)
+		&& CheckRoundTrip("runs delta", &runs[0], &noise[0], count)
+		&& CheckRoundTrip("single pixel", &noise[0], nullptr, 1);
+}
+
+/*
+ *	\brief Check a recording made by the recorder replays the frames it says it wrote
+*/
+static bool CheckRecording(
+		const DepthFrames &frames,					//!< The frames pushed, cycled through in order
+		unsigned int written						//!< The number of frames the recorder wrote
+	)
+{
+	CDepthReplaySource replay;
+	if (!replay.Open(RecordingName, ReplaySpeed::AsFastAsPossible))
+	{
+		std::cerr << "record: " << replay.GetError() << std::endl;
+		return false;
+	}
+
+	const unsigned int frameSize = frames.width * frames.height;
+
+	DepthFrame frame;
+	for (unsigned int index = 0; index < written; ++index)
+	{
+		if (!replay.GetNextFrame(frame))
+		{
+			std::cerr << "record: frame " << index << " of " << written << " missing, " << replay.GetError() << std::endl;
+			return false;
+		}
+
+		// frames may have been dropped, the timestamp says which one was recorded
+		const unsigned int pushed = static_cast<unsigned int>(frame.timestamp / FrameInterval);
+		if (memcmp(frame.pixels, frames.GetFrame(pushed % frames.count), frameSize * sizeof(unsigned short)) != 0)
+		{
+			std::cerr << "record: frame " << index << " differs from the one pushed" << std::endl;
+			return false;
+		}
+	}
+
+	if (replay.GetNextFrame(frame))
+	{
+		std::cerr << "record: more frames were replayed than written" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Push frames at the recorder, paced like the sensor or as fast as possible
+*/
+static bool Record(
+		const DepthFrames &frames,					//!< The frames to push, cycled through in order
+		unsigned int count,							//!< The number of frames to push
+		bool paced,									//!< Wait a frame interval between frames, like the sensor
+		CDepthRecorder &recorder					//!< The recorder
+	)
+{
+	if (!recorder.Start(RecordingName, frames.width, frames.height))
+	{
+		std::cerr << "record: " << recorder.GetError() << std::endl;
+		return false;
+	}
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	unsigned int accepted = 0;
+	for (unsigned int index = 0; index < count; ++index)
+	{
+		if (paced)
+		{
+			std::this_thread::sleep_until(start + std::chrono::microseconds(index * FrameInterval));
+		}
+
+		DepthFrame frame;
+		frame.width = frames.width;
+		frame.height = frames.height;
+		frame.timestamp = index * FrameInterval;
+		frame.pixels = frames.GetFrame(index % frames.count);
+
+		if (recorder.Push(frame)) accepted++;
+	}
+
+	recorder.Stop();
+
+	if (!recorder.GetError().empty() || recorder.GetFramesWritten() != accepted || accepted + recorder.GetFramesDropped() != count)
+	{
+		std::cerr << "record: pushed " << count << ", accepted " << accepted << ", wrote " << recorder.GetFramesWritten()
+			<< ", dropped " << recorder.GetFramesDropped() << " " << recorder.GetError() << std::endl;
+		return false;
+	}
+
+	return CheckRecording(frames, accepted);
+}
+
+/*
+ *	\brief Check depth frames survive delta encoding and the recorder, and time encoding them
+*/
+bool RunRecordBenchmarks(
+		CBenchmark &benchmark,						//!< The benchmark runner
+		const DepthFrames &frames					//!< The frames to record
+	)
+{
+	bool passed = CheckEncodings(frames);
+
+	CDepthRecorder recorder;
+
+	// at the sensor's rate the writer should keep up without dropping anything
+	if (passed && benchmark.IsEnabled("record"))
+	{
+		const unsigned int count = frames.count < 30 ? frames.count : 30;
+		passed = Record(frames, count, true, recorder);
+		if (passed && recorder.GetFramesDropped() != 0)
+		{
+			std::cerr << "record: dropped " << recorder.GetFramesDropped() << " of " << count << " frames at 30 frames a second" << std::endl;
+			passed = false;
+		}
+
+		if (passed)
+		{
+			const unsigned long long rawBytes = static_cast<unsigned long long>(count) * frames.width * frames.height * sizeof(unsigned short);
+			std::cout << "# record: " << count << " frames encoded to " << recorder.GetBytesWritten() << " of " << rawBytes << " bytes" << std::endl;
+		}
+	}
+
+	// a burst faster than the writer can keep up with drops frames, but never loses count of them
+	if (passed && benchmark.IsEnabled("record"))
+	{
+		passed = Record(frames, BurstFrames, false, recorder);
+		std::cout << "# record: burst of " << BurstFrames << " frames, " << recorder.GetFramesDropped() << " dropped, queue reached "
+			<< recorder.GetMaximumQueueDepth() << std::endl;
+	}
+
+	remove(RecordingName);
+
+	const unsigned int count = frames.width * frames.height;
+	std::vector<unsigned char> encoded;
+	std::vector<unsigned short> decoded(count);
+
+	unsigned int frame = 0;
+	benchmark.Run("record/encode/key", frames.width, [&]() {
+		EncodeDepthDeltas(frames.GetFrame(frame), nullptr, count, encoded);
+		frame = (frame + 1) % frames.count;
+	}, count);
+
+	frame = 0;
+	benchmark.Run("record/encode/delta", frames.width, [&]() {
+		const unsigned int next = (frame + 1) % frames.count;
+		EncodeDepthDeltas(frames.GetFrame(next), frames.GetFrame(frame), count, encoded);
+		frame = next;
+	}, count);
+
+	EncodeDepthDeltas(frames.GetFrame(frames.count > 1 ? 1 : 0), frames.GetFrame(0), count, encoded);
+	benchmark.Run("record/decode", frames.width, [&]() {
+		memcpy(&decoded[0], frames.GetFrame(0), count * sizeof(unsigned short));
+		DecodeDepthDeltas(encoded.empty() ? nullptr : &encoded[0], static_cast<unsigned int>(encoded.size()), &decoded[0], count, &decoded[0]);
+	}, count);
+
+	return passed;
+}
@@ -0,0 +1,164 @@
+#include "Benchmarks.h"
+#include "../kinect/CDepthReplaySource.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static const char *const RecordingName = "VisCraftBenchmark.vcdr";
+static const unsigned long long FrameInterval = 33333;		// microseconds between frames at 30 frames a second
+
+/*
+ *	\brief Check a replay hands out the recorded frames, in order and with their timestamps
+*/
+static bool CheckReplay(
+		CDepthReplaySource &replay,					//!< The replay of the recording
+		const DepthFrames &frames					//!< The frames which were recorded
+	)
+{
+	const unsigned int frameSize = frames.width * frames.height;
+
+	DepthFrame frame;
+	for (unsigned int index = 0; index < frames.count; ++index)
+	{
+		if (!replay.GetNextFrame(frame))
+		{
+			std::cerr << "replay: frame " << index << " missing, " << replay.GetError() << std::endl;
+			return false;
+		}
+
+		if (frame.width != frames.width || frame.height != frames.height || frame.timestamp != index * FrameInterval
+			|| memcmp(frame.pixels, frames.GetFrame(index), frameSize * sizeof(unsigned short)) != 0)
+		{
+			std::cerr << "replay: frame " << index << " differs from the one recorded" << std::endl;
+			return false;
+		}
+	}
+
+	if (replay.GetNextFrame(frame))
+	{
+		std::cerr << "replay: more frames were replayed than recorded" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Check the largest delta encoded frame replays, and a frame chunk claiming more than that fails cleanly
+*/
+static bool CheckChunkSizes(
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height							//!< The number of rows in a frame
+	)
+{
+	// differences alternating between a byte and 16 bits each take a token of their own, 2.5 bytes a pixel
+	std::vector<unsigned short> pixels(width * height);
+	for (unsigned int pixel = 0; pixel < pixels.size(); ++pixel)
+	{
+		pixels[pixel] = static_cast<unsigned short>((pixel % 4) < 2 ? 1000 + (pixel % 2) : pixel % 2);
+	}
+
+	std::vector<unsigned char> encoded;
+	EncodeDepthDeltas(&pixels[0], nullptr, static_cast<unsigned int>(pixels.size()), encoded);
+
+	CDepthRecordingWriter writer;
+	bool written = writer.Open(RecordingName, width, height) && writer.WriteEncodedFrame(0, DepthFrameEncoding::KeyDelta, &encoded[0], static_cast<unsigned int>(encoded.size()));
+	writer.Close();
+
+	// then a frame chunk with a corrupt size, nearly 4GB
+	static const unsigned char CorruptChunk[] = { 'F', 'R', 'A', 'M', 0xf0, 0xff, 0xff, 0xff };
+	FILE *const file = fopen(RecordingName, "ab");
+	written = written && file != nullptr && fwrite(CorruptChunk, sizeof(CorruptChunk), 1, file) == 1;
+	if (file != nullptr)
+	{
+		fclose(file);
+	}
+
+	if (!written)
+	{
+		std::cerr << "replay: could not write " << RecordingName << std::endl;
+		return false;
+	}
+
+	bool passed = true;
+	CDepthReplaySource replay;
+	DepthFrame frame;
+	if (!replay.Open(RecordingName, ReplaySpeed::AsFastAsPossible) || !replay.GetNextFrame(frame)
+		|| memcmp(frame.pixels, &pixels[0], pixels.size() * sizeof(unsigned short)) != 0)
+	{
+		std::cerr << "replay: a frame delta encoded in " << encoded.size() << " bytes didn't replay, " << replay.GetError() << std::endl;
+		passed = false;
+	}
+	else if (replay.GetNextFrame(frame) || strcmp(replay.GetError(), "A depth frame chunk is too large") != 0)
+	{
+		std::cerr << "replay: a frame chunk claiming nearly 4GB gave \"" << replay.GetError() << "\"" << std::endl;
+		passed = false;
+	}
+
+	remove(RecordingName);
+	return passed;
+}
+
+/*
+ *	\brief Check depth recordings replay the frames written to them and time reading them back
+*/
+bool RunReplayBenchmarks(
+		CBenchmark &benchmark,						//!< The benchmark runner
+		const DepthFrames &frames					//!< The frames to record
+	)
+{
+	if (!CheckChunkSizes(frames.width, frames.height))
+		return false;
+
+	CDepthRecordingWriter writer;
+	bool passed = writer.Open(RecordingName, frames.width, frames.height);
+	for (unsigned int index = 0; passed && index < frames.count; ++index)
+	{
+		passed = writer.WriteFrame(index * FrameInterval, frames.GetFrame(index));
+	}
+	writer.Close();
+
+	if (!passed)
+	{
+		std::cerr << "replay: could not write " << RecordingName << std::endl;
+		return false;
+	}
+
+	CDepthReplaySource replay;
+	passed = replay.Open(RecordingName, ReplaySpeed::AsFastAsPossible) && CheckReplay(replay, frames);
+
+	// real time replay should take as long as the frames took to record
+	if (passed && frames.count >= 3)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		DepthFrame frame;
+		replay.Open(RecordingName, ReplaySpeed::RealTime);
+		for (unsigned int index = 0; index < 3; ++index)
+		{
+			replay.GetNextFrame(frame);
+		}
+
+		const long long elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+		if (elapsed < static_cast<long long>(FrameInterval * 2))
+		{
+			std::cerr << "replay: real time replay of 3 frames took " << elapsed << "us" << std::endl;
+			passed = false;
+		}
+	}
+
+	// reading frames back as fast as possible, rewinding at the end of the recording
+	replay.Open(RecordingName, ReplaySpeed::AsFastAsPossible);
+	benchmark.Run("replay/read", frames.width, [&]() {
+		DepthFrame frame;
+		if (!replay.GetNextFrame(frame))
+		{
+			replay.Rewind();
+			replay.GetNextFrame(frame);
+		}
+	}, frames.width * frames.height);
+
+	remove(RecordingName);
+	return passed;
+}
@@ -0,0 +1,295 @@
+#include "Benchmarks.h"
+#include "../kinect/CDepthColorTable.h"
+#include "../kinect/CScreenshotWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
+static const char *const ScreenshotName = "VisCraftBenchmark.screenshot";
+static const unsigned int TimedScreenshots = 9;		// screenshots timed for the capture time check
+
+/*
+ *	\brief Get the microseconds since a time point
+*/
+static long long GetMicroseconds(
+		const std::chrono::steady_clock::time_point &start	//!< The time to measure from
+	)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ *	\brief Decode a 24 bit QOI image back into blue, green, red, unused pixels, false if it is malformed
+*/
+static bool DecodeQoi(
+		const std::vector<unsigned char> &encoded,	//!< The bytes of the file
+		unsigned int width,							//!< The expected number of pixels in a row
+		unsigned int height,						//!< The expected number of rows
+		std::vector<unsigned char> &pixels			//!< Receives the pixels
+	)
+{
+	static const unsigned int HeaderSize = 14;
+	static const unsigned int EndSize = 8;
+
+	if (encoded.size() < HeaderSize + EndSize || memcmp(&encoded[0], "qoif", 4) != 0 || encoded[12] != 3)
+		return false;
+
+	const unsigned int fileWidth = (encoded[4] << 24) | (encoded[5] << 16) | (encoded[6] << 8) | encoded[7];
+	const unsigned int fileHeight = (encoded[8] << 24) | (encoded[9] << 16) | (encoded[10] << 8) | encoded[11];
+	if (fileWidth != width || fileHeight != height)
+		return false;
+
+	unsigned char seen[64][3] = { { 0 } };
+	unsigned char color[3] = { 0, 0, 0 };		// red, green, blue
+	unsigned int run = 0;
+	size_t position = HeaderSize;
+	const size_t end = encoded.size() - EndSize;
+
+	pixels.assign(width * height * 4, 0);
+	for (unsigned int pixel = 0; pixel < width * height; ++pixel)
+	{
+		if (run > 0)
+		{
+			run--;
+		}
+		else
+		{
+			if (position >= end)
+				return false;
+
+			const unsigned int op = encoded[position++];
+			if (op == 0xfe)
+			{
+				if (position + 3 > end)
+					return false;
+				color[0] = encoded[position++];
+				color[1] = encoded[position++];
+				color[2] = encoded[position++];
+			}
+			else if ((op & 0xc0) == 0x00)
+			{
+				memcpy(color, seen[op], 3);
+			}
+			else if ((op & 0xc0) == 0x40)
+			{
+				color[0] = static_cast<unsigned char>(color[0] + ((op >> 4) & 3) - 2);
+				color[1] = static_cast<unsigned char>(color[1] + ((op >> 2) & 3) - 2);
+				color[2] = static_cast<unsigned char>(color[2] + (op & 3) - 2);
+			}
+			else if ((op & 0xc0) == 0x80)
+			{
+				if (position >= end)
+					return false;
+				const int green = static_cast<int>(op & 0x3f) - 32;
+				const unsigned int next = encoded[position++];
+				color[0] = static_cast<unsigned char>(color[0] + green + static_cast<int>(next >> 4) - 8);
+				color[1] = static_cast<unsigned char>(color[1] + green);
+				color[2] = static_cast<unsigned char>(color[2] + green + static_cast<int>(next & 0x0f) - 8);
+			}
+			else if (op != 0xff)
+			{
+				run = op & 0x3f;
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		memcpy(seen[((color[0] * 3) + (color[1] * 5) + (color[2] * 7) + (255 * 11)) % 64], color, 3);
+		pixels[(pixel * 4) + 0] = color[2];
+		pixels[(pixel * 4) + 1] = color[1];
+		pixels[(pixel * 4) + 2] = color[0];
+	}
+
+	return position == end;
+}
+
+/*
+ *	\brief Check a saved screenshot holds a frame, ignoring the unused byte of each pixel
+*/
+static bool CheckScreenshotFile(
+		const std::string &fileName,				//!< The file to check
+		const unsigned char *pixels,				//!< The frame which was saved, rows packed together
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows in the frame
+		ScreenshotFormat::Enum format				//!< The format of the file
+	)
+{
+	std::ifstream file(fileName.c_str(), std::ios::binary);
+	std::vector<unsigned char> encoded((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	const unsigned int count = width * height;
+	std::vector<unsigned char> decoded;
+	if (format == ScreenshotFormat::Qoi)
+	{
+		if (!DecodeQoi(encoded, width, height, decoded))
+		{
+			std::cerr << "screenshot: " << fileName << " is not a valid QOI image" << std::endl;
+			return false;
+		}
+	}
+	else
+	{
+		static const unsigned int HeadersSize = 54;
+		if (encoded.size() != HeadersSize + (count * 4) || encoded[0] != 'B' || encoded[1] != 'M')
+		{
+			std::cerr << "screenshot: " << fileName << " is not a " << width << "x" << height << " bitmap" << std::endl;
+			return false;
+		}
+		decoded.assign(encoded.begin() + HeadersSize, encoded.end());
+	}
+
+	for (unsigned int pixel = 0; pixel < count; ++pixel)
+	{
+		if (memcmp(&decoded[pixel * 4], pixels + (pixel * 4), 3) != 0)
+		{
+			std::cerr << "screenshot: pixel " << pixel << " of " << fileName << " differs from the frame" << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Check the screenshot writer saves the frames pushed, and that pushing doesn't wait on the disk
+*/
+static bool CheckWriter(
+		const std::vector<unsigned char> &colors,	//!< The color frames, rows packed together
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows in a frame
+		unsigned int frameCount,					//!< The number of color frames
+		ScreenshotFormat::Enum format				//!< The format to save in
+	)
+{
+	const unsigned int frameSize = width * height * 4;
+	const char *const formatName = format == ScreenshotFormat::Qoi ? "qoi" : "bitmap";
+
+	// the color stream's rows are padded out to the texture pitch
+	const unsigned int pitch = (width * 4) + 64;
+	std::vector<unsigned char> pitched(pitch * height * frameCount);
+	for (unsigned int row = 0; row < height * frameCount; ++row)
+	{
+		memcpy(&pitched[row * pitch], &colors[row * width * 4], width * 4);
+	}
+
+	CScreenshotWriter writer;
+	writer.Create(width, height, format);
+
+	// more screenshots than the queue holds, without waiting, so some are dropped
+	const unsigned int burst = CScreenshotWriter::QueueCapacity * 2;
+	unsigned int accepted = 0;
+	for (unsigned int index = 0; index < burst; ++index)
+	{
+		std::stringstream name;
+		name << ScreenshotName << index;
+		if (writer.Push(&pitched[(index % frameCount) * pitch * height], pitch, name.str())) accepted++;
+	}
+
+	// a push waits for nothing but the copy, a synchronous save waits for the encode and the disk
+	std::vector<long long> pushTimes;
+	std::vector<long long> saveTimes;
+	for (unsigned int index = 0; index < TimedScreenshots; ++index)
+	{
+		while (writer.GetScreenshotsWritten() + writer.GetScreenshotsFailed() < accepted)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		const unsigned int frame = (burst + index) % frameCount;
+
+		std::stringstream name;
+		name << ScreenshotName << (burst + index);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (writer.Push(&pitched[frame * pitch * height], pitch, name.str())) accepted++;
+		pushTimes.push_back(GetMicroseconds(start));
+
+		start = std::chrono::steady_clock::now();
+		SaveScreenshot(ScreenshotName, &colors[frame * frameSize], width, height, format);
+		saveTimes.push_back(GetMicroseconds(start));
+	}
+
+	writer.Destroy();
+	remove(ScreenshotName);
+
+	bool passed = true;
+	if (writer.GetScreenshotsFailed() != 0 || writer.GetScreenshotsWritten() != accepted || accepted + writer.GetScreenshotsDropped() != burst + TimedScreenshots
+		|| accepted < CScreenshotWriter::QueueCapacity + TimedScreenshots)
+	{
+		std::cerr << "screenshot: pushed " << (burst + TimedScreenshots) << " " << formatName << "s, accepted " << accepted << ", wrote "
+			<< writer.GetScreenshotsWritten() << ", dropped " << writer.GetScreenshotsDropped() << ", failed " << writer.GetScreenshotsFailed() << std::endl;
+		passed = false;
+	}
+
+	for (unsigned int index = 0; index < burst + TimedScreenshots; ++index)
+	{
+		std::stringstream name;
+		name << ScreenshotName << index << GetScreenshotExtension(format);
+
+		// dropped screenshots leave no file behind
+		std::ifstream file(name.str().c_str());
+		if (file.is_open())
+		{
+			file.close();
+			passed = CheckScreenshotFile(name.str(), &colors[(index % frameCount) * frameSize], width, height, format) && passed;
+			remove(name.str().c_str());
+		}
+	}
+
+	std::sort(pushTimes.begin(), pushTimes.end());
+	std::sort(saveTimes.begin(), saveTimes.end());
+	const long long push = pushTimes[pushTimes.size() / 2];
+	const long long save = saveTimes[saveTimes.size() / 2];
+
+	std::cout << "# screenshot: " << formatName << " push " << push << "us, synchronous save " << save << "us" << std::endl;
+
+	// with one core the woken write thread runs inside the timed push, so the times say nothing
+	if (std::thread::hardware_concurrency() > 1 && push * 2 > save)
+	{
+		std::cerr << "screenshot: pushing a " << formatName << " took " << push << "us, more than half the " << save << "us to save it" << std::endl;
+		passed = false;
+	}
+
+	return passed;
+}
+
+/*
+ *	\brief Check screenshots are saved off the capture thread and time encoding them
+*/
+bool RunScreenshotBenchmarks(
+		CBenchmark &benchmark,						//!< The benchmark runner
+		const DepthFrames &frames					//!< The frames to color into screenshots
+	)
+{
+	// the tinted depth view stands in for the color stream, it has the same layout
+	const unsigned int width = frames.width;
+	const unsigned int height = frames.height;
+	const unsigned int frameCount = frames.count < 4 ? frames.count : 4;
+	const unsigned int frameSize = width * height * 4;
+
+	CDepthColorTable table;
+	std::vector<unsigned char> colors(frameSize * frameCount);
+	for (unsigned int frame = 0; frame < frameCount; ++frame)
+	{
+		table.Convert(frames.GetFrame(frame), width * height, reinterpret_cast<unsigned int *>(&colors[frame * frameSize]));
+	}
+
+	bool passed = true;
+	if (benchmark.IsEnabled("screenshot"))
+	{
+		passed = CheckWriter(colors, width, height, frameCount, ScreenshotFormat::Bitmap) && passed;
+		passed = CheckWriter(colors, width, height, frameCount, ScreenshotFormat::Qoi) && passed;
+	}
+
+	std::vector<unsigned char> encoded;
+	benchmark.Run("screenshot/encode/bitmap", width, [&]() { EncodeScreenshot(&colors[0], width, height, ScreenshotFormat::Bitmap, encoded); }, width * height);
+	benchmark.Run("screenshot/encode/qoi", width, [&]() { EncodeScreenshot(&colors[0], width, height, ScreenshotFormat::Qoi, encoded); }, width * height);
+
+	return passed;
+}
@@ -0,0 +1,244 @@
+#include "Benchmarks.h"
+#include "HandShapes.h"
+#include "../kinect/CBlobLabeller.h"
+#include "../kinect/CHandShapeClassifier.h"
+#include "../kinect/CHandStateHysteresis.h"
+#include "../kinect/DepthBand.h"
+#include <fstream>
+#include <math.h>
+#include <stdlib.h>
+
+// the hand band CHand uses
+static const int NearPoint = 832;
+static const int FarPoint = 1344;
+
+// the hysteresis CHand applies to the openness
+static const float OpenThreshold = 0.5f;
+static const float CloseThreshold = 0.35f;
+static const unsigned int FramesToChange = 3;
+
+/*
+ *	\brief Check the classifier counts the fingers of drawn hands and tells open hands from fists
+*/
+static bool CheckDrawnHands(
+		CHandShapeClassifier &classifier			//!< The classifier
+	)
+{
+	static const unsigned int FingerCounts[] = { 0, 2, 3, 4, 5 };
+	static const float Scales[] = { 0.85f, 1.0f, 1.15f };
+	static const float Rotations[] = { -0.35f, 0.0f, 0.35f };
+
+	CBlobLabeller labeller;
+	labeller.Create(HandMaskSize, HandMaskSize);
+
+	std::vector<unsigned char> mask;
+	bool passed = true;
+	unsigned int noisyShapes = 0;
+	unsigned int noisyCorrect = 0;
+
+	srand(1);
+	for (unsigned int fingers = 0; fingers < sizeof(FingerCounts) / sizeof(FingerCounts[0]); ++fingers)
+	{
+		for (unsigned int scale = 0; scale < sizeof(Scales) / sizeof(Scales[0]); ++scale)
+		{
+			for (unsigned int rotation = 0; rotation < sizeof(Rotations) / sizeof(Rotations[0]); ++rotation)
+			{
+				for (unsigned int noisy = 0; noisy < 2; ++noisy)
+				{
+					DrawHand(FingerCounts[fingers], Scales[scale], Rotations[rotation], noisy != 0, mask);
+
+					MaskArea area;
+					unsigned int startX, startY;
+					if (!FindHandArea(&mask[0], HandMaskSize, HandMaskSize, labeller, area, startX, startY))
+					{
+						std::cerr << "shape: no hand found in a drawn hand with " << FingerCounts[fingers] << " fingers" << std::endl;
+						passed = false;
+						continue;
+					}
+
+					const HandShape shape = classifier.Classify(&mask[0], HandMaskSize, area, startX, startY);
+
+					// two fingers are as likely a loose fist as an open hand, so only the count is checked
+					const bool open = shape.openness >= OpenThreshold;
+					const bool correct = FingerCounts[fingers] == 2 || open == (FingerCounts[fingers] >= 3);
+
+					if (noisy != 0)
+					{
+						noisyShapes++;
+						noisyCorrect += correct ? 1 : 0;
+					}
+					else if (!correct || shape.fingers != FingerCounts[fingers])
+					{
+						std::cerr << "shape: a drawn hand with " << FingerCounts[fingers] << " fingers at scale " << Scales[scale] << " and lean " << Rotations[rotation]
+							<< " read as " << shape.fingers << " fingers, openness " << shape.openness << ", solidity " << shape.solidity << std::endl;
+						passed = false;
+					}
+				}
+			}
+		}
+	}
+
+	// a ragged outline may cost a finger, but should rarely change open to closed
+	std::cout << "# shape: " << noisyCorrect << " of " << noisyShapes << " noisy drawn hands classified correctly" << std::endl;
+	if (noisyCorrect * 10 < noisyShapes * 9)
+	{
+		std::cerr << "shape: only " << noisyCorrect << " of " << noisyShapes << " noisy drawn hands classified correctly" << std::endl;
+		passed = false;
+	}
+
+	return passed;
+}
+
+/*
+ *	\brief Check the hysteresis holds its state through short runs of disagreeing frames
+*/
+static bool CheckHysteresis()
+{
+	// open, a two frame dip, a closed run, a frame between the thresholds, then open again
+	static const float Openness[] = { 0.9f, 0.1f, 0.1f, 0.9f, 0.1f, 0.1f, 0.1f, 0.2f, 0.45f, 0.2f, 0.9f, 0.9f, 0.4f, 0.9f };
+	static const bool Expected[] = { true, true, true, true, true, true, false, false, false, false, false, false, false, true };
+
+	CHandStateHysteresis hysteresis(OpenThreshold, CloseThreshold, FramesToChange);
+	hysteresis.Reset(true);
+
+	for (unsigned int frame = 0; frame < sizeof(Openness) / sizeof(Openness[0]); ++frame)
+	{
+		if (hysteresis.Update(Openness[frame]) != Expected[frame])
+		{
+			std::cerr << "shape: the hysteresis was " << (hysteresis.IsOpen() ? "open" : "closed") << " at frame " << frame << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Load the hand state labels of a recording, one character a frame, 'o' for open, 'c' for closed and anything else for no label
+*/
+static bool LoadHandLabels(
+		const std::string &fileName,				//!< The labels file
+		std::string &labels							//!< Receives the labels
+	)
+{
+	std::ifstream file(fileName.c_str());
+	if (!file.is_open())
+		return false;
+
+	labels.clear();
+	char label;
+	while (file.get(label))
+	{
+		if (label != '\r' && label != '\n')
+		{
+			labels.push_back(label);
+		}
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Classify the hand in each frame as CHand would and compare with the recording's labels
+*/
+static void EvaluateLabels(
+		const DepthFrames &frames,					//!< The frames of the recording
+		const std::string &labels,					//!< One label a frame
+		CHandShapeClassifier &classifier			//!< The classifier
+	)
+{
+	const unsigned int frameSize = frames.width * frames.height;
+	std::vector<unsigned char> mask(frameSize);
+
+	CBlobLabeller labeller;
+	labeller.Create(frames.width, frames.height);
+
+	CHandStateHysteresis hysteresis(OpenThreshold, CloseThreshold, FramesToChange);
+	bool found = false;
+
+	unsigned int labelled = 0;
+	unsigned int rawCorrect = 0;
+	unsigned int filteredCorrect = 0;
+	unsigned int missed = 0;
+
+	for (unsigned int frame = 0; frame < frames.count && frame < labels.size(); ++frame)
+	{
+		ThresholdDepthBand(frames.GetFrame(frame), frames.width, 0, frames.height, NearPoint, FarPoint, &mask[0]);
+
+		MaskArea area;
+		unsigned int startX, startY;
+		const bool hand = FindHandArea(&mask[0], frames.width, frames.height, labeller, area, startX, startY);
+
+		bool open = false;
+		bool filtered = false;
+		if (hand)
+		{
+			const HandShape shape = classifier.Classify(&mask[0], frames.width, area, startX, startY);
+			open = shape.openness >= OpenThreshold;
+
+			if (!found) hysteresis.Reset(open);
+			filtered = hysteresis.Update(shape.openness);
+		}
+		found = hand;
+
+		if (labels[frame] != 'o' && labels[frame] != 'c')
+			continue;
+
+		labelled++;
+		if (!hand)
+		{
+			missed++;
+			continue;
+		}
+
+		const bool labelledOpen = labels[frame] == 'o';
+		rawCorrect += open == labelledOpen ? 1 : 0;
+		filteredCorrect += filtered == labelledOpen ? 1 : 0;
+	}
+
+	std::cout << "# shape: " << labelled << " labelled frames, " << missed << " without a hand, " << rawCorrect << " classified correctly, "
+		<< filteredCorrect << " after hysteresis" << std::endl;
+}
+
+/*
+ *	\brief Check the hand shape classifier on drawn hands and the hysteresis, and time classifying
+*/
+bool RunShapeBenchmarks(
+		CBenchmark &benchmark,						//!< The benchmark runner
+		const DepthFrames &frames,					//!< The frames to classify the hand in
+		const std::string &labelsFile				//!< The hand state labels of the frames, empty if there are none
+	)
+{
+	CHandShapeClassifier classifier;
+
+	bool passed = CheckDrawnHands(classifier);
+	passed = CheckHysteresis() && passed;
+
+	std::string labels;
+	if (!labelsFile.empty() && LoadHandLabels(labelsFile, labels))
+	{
+		EvaluateLabels(frames, labels, classifier);
+	}
+
+	// classifying a drawn open hand and fist, as CHand does every frame it finds the hand
+	CBlobLabeller labeller;
+	labeller.Create(HandMaskSize, HandMaskSize);
+
+	static const unsigned int Shapes[] = { 5, 0 };
+	static const char *const ShapeNames[] = { "shape/classify/open", "shape/classify/fist" };
+	for (unsigned int shape = 0; shape < 2; ++shape)
+	{
+		std::vector<unsigned char> mask;
+		DrawHand(Shapes[shape], 1.0f, 0.0f, true, mask);
+
+		MaskArea area;
+		unsigned int startX, startY;
+		if (FindHandArea(&mask[0], HandMaskSize, HandMaskSize, labeller, area, startX, startY))
+		{
+			benchmark.Run(ShapeNames[shape], HandMaskSize, [&]() { classifier.Classify(&mask[0], HandMaskSize, area, startX, startY); },
+				(area.right - area.left) * (area.bottom - area.top));
+		}
+	}
+
+	return passed;
+}
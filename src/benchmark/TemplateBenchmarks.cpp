@@ -0,0 +1,248 @@
+#include "Benchmarks.h"
+#include "HandShapes.h"
+#include "../kinect/CBlobLabeller.h"
+#include "../kinect/DistanceTransform.h"
+#include "../kinect/SobelEdges.h"
+#include "../kinect/gestures/CGestureHandClosed.h"
+#include "../kinect/gestures/CGestureHandOpen.h"
+#include <math.h>
+#include <stdlib.h>
+
+// the smallest Sobel gradient CHand takes as an edge
+static const unsigned int EdgeThreshold = 3;
+
+// how far a template may fit from the drawn palm, in pixels, and from the drawn size, as a fraction
+static const float PositionTolerance = 3.0f;
+static const float ScaleTolerance = 0.1f;
+
+/*
+ *	\brief Get the chamfer distance between two pixels with nothing in the way
+*/
+static unsigned int GetChamferDistance(
+		int fromX,									//!< The column of the first pixel
+		int fromY,									//!< The row of the first pixel
+		int toX,									//!< The column of the second pixel
+		int toY										//!< The row of the second pixel
+	)
+{
+	const unsigned int across = static_cast<unsigned int>(abs(toX - fromX));
+	const unsigned int down = static_cast<unsigned int>(abs(toY - fromY));
+	const unsigned int diagonal = across < down ? across : down;
+	const unsigned int straight = (across > down ? across : down) - diagonal;
+
+	return (diagonal * 4) + (straight * DISTANCE_UNITS_PER_PIXEL);
+}
+
+/*
+ *	\brief Check the distance transform against the distance to every edge, inside an area of a random edge map
+*/
+static bool CheckDistanceTransform()
+{
+	static const unsigned int Width = 97;
+	static const unsigned int Height = 71;
+	static const unsigned short Untouched = 12345;
+
+	const MaskArea area = { 13, 7, 81, 66 };
+
+	std::vector<unsigned char> edges(Width * Height);
+	std::vector<unsigned short> distance(Width * Height);
+
+	srand(3);
+	for (unsigned int trial = 0; trial < 3; ++trial)
+	{
+		// sparse edges, then none at all in the area
+		const unsigned int density = trial == 0 ? 50 : trial == 1 ? 400 : 0;
+		for (unsigned int pixel = 0; pixel < edges.size(); ++pixel)
+		{
+			edges[pixel] = density != 0 && (rand() % density) == 0 ? 1 : 0;
+		}
+
+		distance.assign(distance.size(), Untouched);
+		ComputeDistanceTransform(&edges[0], Width, area, &distance[0]);
+
+		for (unsigned int y = 0; y < Height; ++y)
+		{
+			for (unsigned int x = 0; x < Width; ++x)
+			{
+				const bool inside = x >= area.left && x < area.right && y >= area.top && y < area.bottom;
+
+				// only edges inside the area count, and a straight chamfer path always stays inside a rectangle
+				unsigned int expected = inside ? NO_EDGE_DISTANCE : Untouched;
+				for (unsigned int edgeY = area.top; inside && edgeY < area.bottom; ++edgeY)
+				{
+					for (unsigned int edgeX = area.left; edgeX < area.right; ++edgeX)
+					{
+						if (edges[(edgeY * Width) + edgeX] == 0)
+							continue;
+
+						const unsigned int edgeDistance = GetChamferDistance(x, y, edgeX, edgeY);
+						if (edgeDistance < expected) expected = edgeDistance;
+					}
+				}
+
+				if (distance[(y * Width) + x] != expected)
+				{
+					std::cerr << "template: the distance at " << x << ", " << y << " was " << distance[(y * Width) + x] << " not " << expected << std::endl;
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Find the edges of a drawn hand and their distance transform, false if there is no hand
+*/
+static bool PrepareDrawnHand(
+		const std::vector<unsigned char> &mask,		//!< The mask of the hand
+		CBlobLabeller &labeller,					//!< Labels the blobs of the mask
+		std::vector<unsigned char> &edges,			//!< Receives the edges of the hand area
+		std::vector<unsigned short> &magnitude,		//!< Receives the gradient magnitudes of the hand area
+		std::vector<unsigned short> &distance,		//!< Receives the distance transform of the hand area
+		MaskArea &area								//!< Receives the hand area
+	)
+{
+	unsigned int startX, startY;
+	if (!FindHandArea(&mask[0], HandMaskSize, HandMaskSize, labeller, area, startX, startY))
+		return false;
+
+	edges.assign(HandMaskSize * HandMaskSize, 0);
+	magnitude.assign(HandMaskSize * HandMaskSize, 0);
+	distance.assign(HandMaskSize * HandMaskSize, 0);
+
+	DetectSobelEdges(&mask[0], HandMaskSize, HandMaskSize, area, EdgeThreshold, &magnitude[0], &edges[0]);
+	ComputeDistanceTransform(&edges[0], HandMaskSize, area, &distance[0]);
+	return true;
+}
+
+/*
+ *	\brief Check the open hand and fist templates each fit their own drawn hands better than the other, and fit where the hand was drawn
+*/
+static bool CheckDrawnHands(
+		CDeformableTemplateModel &openTemplate,				//!< The open hand template
+		CDeformableTemplateModel &closedTemplate			//!< The fist template
+	)
+{
+	static const unsigned int FingerCounts[] = { 0, 5 };
+	static const float Scales[] = { 0.85f, 1.0f, 1.15f };
+	static const float Rotations[] = { -0.15f, 0.0f, 0.15f };
+
+	CBlobLabeller labeller;
+	labeller.Create(HandMaskSize, HandMaskSize);
+
+	std::vector<unsigned char> mask;
+	std::vector<unsigned char> edges;
+	std::vector<unsigned short> magnitude;
+	std::vector<unsigned short> distance;
+
+	bool passed = true;
+	unsigned int noisyShapes = 0;
+	unsigned int noisyCorrect = 0;
+
+	srand(1);
+	for (unsigned int fingers = 0; fingers < sizeof(FingerCounts) / sizeof(FingerCounts[0]); ++fingers)
+	{
+		for (unsigned int scale = 0; scale < sizeof(Scales) / sizeof(Scales[0]); ++scale)
+		{
+			for (unsigned int rotation = 0; rotation < sizeof(Rotations) / sizeof(Rotations[0]); ++rotation)
+			{
+				for (unsigned int noisy = 0; noisy < 2; ++noisy)
+				{
+					DrawHand(FingerCounts[fingers], Scales[scale], Rotations[rotation], noisy != 0, mask);
+
+					MaskArea area;
+					if (!PrepareDrawnHand(mask, labeller, edges, magnitude, distance, area))
+					{
+						std::cerr << "template: no hand found in a drawn hand with " << FingerCounts[fingers] << " fingers" << std::endl;
+						passed = false;
+						continue;
+					}
+
+					TemplateMatch openMatch, closedMatch;
+					const bool openMatched = openTemplate.Match(&edges[0], &distance[0], HandMaskSize, area, openMatch);
+					const bool closedMatched = closedTemplate.Match(&edges[0], &distance[0], HandMaskSize, area, closedMatch);
+
+					const bool open = FingerCounts[fingers] != 0;
+					const bool correct = open ? openMatch.score < closedMatch.score : closedMatch.score < openMatch.score;
+
+					if (noisy != 0)
+					{
+						noisyShapes++;
+						noisyCorrect += correct ? 1 : 0;
+						continue;
+					}
+
+					if (!correct || !(open ? openMatched : closedMatched))
+					{
+						std::cerr << "template: a drawn hand with " << FingerCounts[fingers] << " fingers at scale " << Scales[scale] << " and lean " << Rotations[rotation]
+							<< " scored " << openMatch.score << " open and " << closedMatch.score << " closed" << std::endl;
+						passed = false;
+						continue;
+					}
+
+					// an upright hand is the template's own shape, so it should fit where it was drawn
+					const TemplateMatch &match = open ? openMatch : closedMatch;
+					const float palmX = HandMaskSize * 0.5f;
+					const float palmY = HandMaskSize * 0.55f;
+					const float palmWidth = 40.0f * Scales[scale];
+					if (Rotations[rotation] == 0.0f && (fabs(match.x - palmX) > PositionTolerance || fabs(match.y - palmY) > PositionTolerance || fabs(match.scale - palmWidth) > palmWidth * ScaleTolerance))
+					{
+						std::cerr << "template: a drawn hand with " << FingerCounts[fingers] << " fingers at scale " << Scales[scale] << " fit at " << match.x << ", " << match.y
+							<< " scale " << match.scale << " not " << palmX << ", " << palmY << " scale " << palmWidth << std::endl;
+						passed = false;
+					}
+				}
+			}
+		}
+	}
+
+	std::cout << "# template: " << noisyCorrect << " of " << noisyShapes << " noisy drawn hands matched the right template" << std::endl;
+	if (noisyCorrect * 10 < noisyShapes * 9)
+	{
+		std::cerr << "template: only " << noisyCorrect << " of " << noisyShapes << " noisy drawn hands matched the right template" << std::endl;
+		passed = false;
+	}
+
+	return passed;
+}
+
+/*
+ *	\brief Check the distance transform and the hand templates, and time them as CHand runs them every frame
+*/
+bool RunTemplateBenchmarks(
+		CBenchmark &benchmark						//!< The benchmark runner
+	)
+{
+	CGestureHandOpen openTemplate;
+	CGestureHandClosed closedTemplate;
+
+	bool passed = CheckDistanceTransform();
+	passed = CheckDrawnHands(openTemplate, closedTemplate) && passed;
+
+	CBlobLabeller labeller;
+	labeller.Create(HandMaskSize, HandMaskSize);
+
+	std::vector<unsigned char> mask;
+	std::vector<unsigned char> edges;
+	std::vector<unsigned short> magnitude;
+	std::vector<unsigned short> distance;
+
+	srand(2);
+	DrawHand(5, 1.0f, 0.0f, true, mask);
+
+	MaskArea area;
+	if (PrepareDrawnHand(mask, labeller, edges, magnitude, distance, area))
+	{
+		const unsigned int areaSize = (area.right - area.left) * (area.bottom - area.top);
+
+		benchmark.Run("template/distance", HandMaskSize, [&]() { ComputeDistanceTransform(&edges[0], HandMaskSize, area, &distance[0]); }, areaSize);
+
+		TemplateMatch match;
+		benchmark.Run("template/match/open", HandMaskSize, [&]() { openTemplate.Match(&edges[0], &distance[0], HandMaskSize, area, match); }, areaSize);
+		benchmark.Run("template/match/closed", HandMaskSize, [&]() { closedTemplate.Match(&edges[0], &distance[0], HandMaskSize, area, match); }, areaSize);
+	}
+
+	return passed;
+}
@@ -0,0 +1,498 @@
+#include "Benchmarks.h"
+#include "../terrain/CHeightField.h"
+#include "../terrain/CHeightMapLoader.h"
+#include "../terrain/CHeightPyramid.h"
+#include "../terrain/CTerrainStatistics.h"
+#include "../terrain/TerrainBrushStamps.h"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// the size of the heightmap the loader checks use, 32 coarse rows and 16 bands
+static const unsigned int LoaderMapSize = 256;
+
+// where the loader checks cancel, part way through the coarse rows and the full resolution bands
+static const unsigned int CancelCoarseRows = 10;
+static const unsigned int CancelRows = 5 * CHeightMapLoader::BandRows;
+
+// the edits and queries the pyramid checks make on each plane, and the queries timed
+static const unsigned int PyramidEdits = 40;
+static const unsigned int PyramidQueries = 20;
+static const unsigned int TimedQueries = 256;
+
+// the size of the plane the statistics checks stroke, and the strokes made on it
+static const unsigned int StatisticsMapSize = 48;
+static const unsigned int StatisticsStrokes = 300;
+
+/*
+ *	\brief The height the loader checks write at a point, a whole number so it survives the bitmap exactly
+*/
+static float GetPatternHeight(
+		unsigned int x,								//!< The column
+		unsigned int z								//!< The row
+	)
+{
+	return static_cast<float>(((x * 7) + (z * 13)) % 256);
+}
+
+/*
+ *	\brief Check the rows a load published, and the coarse preview once it is ready, hold the heights written
+*/
+static bool CheckLoadedHeights(
+		const char *name,							//!< What the load was
+		const CHeightMapLoader &loader				//!< The loader
+	)
+{
+	if (loader.IsCoarseReady())
+	{
+		for (unsigned int z = 0; z < LoaderMapSize; z += CHeightMapLoader::CoarseStep)
+		{
+			for (unsigned int x = 0; x < LoaderMapSize; x += CHeightMapLoader::CoarseStep)
+			{
+				if (loader.GetCoarseHeight(x, z) != GetPatternHeight(x, z))
+				{
+					std::cerr << "terrain: " << name << " the coarse height at " << x << "," << z << " is " << loader.GetCoarseHeight(x, z)
+						<< " instead of " << GetPatternHeight(x, z) << std::endl;
+					return false;
+				}
+			}
+		}
+	}
+
+	for (unsigned int z = 0; z < loader.GetRowsDecoded(); ++z)
+	{
+		for (unsigned int x = 0; x < LoaderMapSize; ++x)
+		{
+			const float height = loader.GetHeights()[(z * LoaderMapSize) + x];
+			if (height != GetPatternHeight(x, z))
+			{
+				std::cerr << "terrain: " << name << " the height at " << x << "," << z << " is " << height << " instead of " << GetPatternHeight(x, z) << std::endl;
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Check the state a load ended in and the rows it published
+*/
+static bool CheckLoadState(
+		const char *name,							//!< What the load was
+		const CHeightMapLoader &loader,				//!< The loader
+		HeightMapLoadState::Enum state,				//!< The state it should have ended in
+		bool coarseReady,							//!< Should the coarse preview have been published
+		unsigned int rowsDecoded					//!< The full resolution rows it should have published
+	)
+{
+	if (loader.GetState() != state || loader.IsCoarseReady() != coarseReady || loader.GetRowsDecoded() != rowsDecoded)
+	{
+		std::cerr << "terrain: " << name << " ended in state " << loader.GetState() << " instead of " << state << ", "
+			<< (loader.IsCoarseReady() ? "with" : "without") << " the coarse preview and " << loader.GetRowsDecoded() << " of " << rowsDecoded << " rows" << std::endl;
+		return false;
+	}
+
+	return CheckLoadedHeights(name, loader);
+}
+
+/*
+ *	\brief Check a load cancelled during the coarse pass and again part way through the bands stops there, and loads fully when restarted
+*/
+static bool CheckLoaderCancel()
+{
+	static const char *const FileName = "VisCraftLoaderCheck.bmp";
+
+	CHeightField heightField;
+	heightField.Create(LoaderMapSize, 0.0f);
+	HeightPlane plane = heightField.GetPlane();
+	for (unsigned int z = 0; z < LoaderMapSize; ++z)
+	{
+		for (unsigned int x = 0; x < LoaderMapSize; ++x)
+		{
+			plane.At(x, z) = GetPatternHeight(x, z);
+		}
+	}
+
+	if (!heightField.Save(FileName))
+	{
+		std::cerr << "terrain: couldn't write the loader's heightmap, " << heightField.GetError() << std::endl;
+		return false;
+	}
+
+	CHeightMapLoader loader;
+	bool passed = true;
+
+	// the decode thread calls back as it publishes, so the cancel lands at the same row every run
+	loader.SetProgressCallback([&](unsigned int coarseRows, unsigned int rows) {
+		if (rows == 0 && coarseRows == CancelCoarseRows)
+		{
+			loader.Cancel();
+		}
+	});
+
+	loader.Start(FileName);
+	loader.Wait();
+	passed = CheckLoadState("a load cancelled in the coarse pass", loader, HeightMapLoadState::Cancelled, false, 0) && passed;
+
+	loader.SetProgressCallback([&](unsigned int, unsigned int rows) {
+		if (rows == CancelRows)
+		{
+			loader.Cancel();
+		}
+	});
+
+	loader.Start(FileName);
+	loader.Wait();
+	passed = CheckLoadState("a load cancelled part way through the bands", loader, HeightMapLoadState::Cancelled, true, CancelRows) && passed;
+
+	loader.SetProgressCallback(std::function<void (unsigned int, unsigned int)>());
+	loader.Start(FileName);
+	loader.Wait();
+	passed = CheckLoadState("the restarted load", loader, HeightMapLoadState::Complete, true, LoaderMapSize) && passed;
+
+	remove(FileName);
+	return passed;
+}
+
+/*
+ *	\brief Find the lowest, highest and average heights of an area the slow way
+*/
+static void ScanRange(
+		const std::vector<float> &heights,			//!< The plane, packed
+		unsigned int width,							//!< The number of columns in the plane
+		const TerrainArea &area,					//!< The area to scan, not empty
+		float &minimum,								//!< Receives the lowest height
+		float &maximum,								//!< Receives the highest height
+		float &average								//!< Receives the average height
+	)
+{
+	minimum = FLT_MAX;
+	maximum = -FLT_MAX;
+	double total = 0.0;
+
+	for (unsigned int z = area.top; z < area.bottom; ++z)
+	{
+		for (unsigned int x = area.left; x < area.right; ++x)
+		{
+			const float height = heights[(z * width) + x];
+			if (height < minimum) minimum = height;
+			if (height > maximum) maximum = height;
+			total += height;
+		}
+	}
+
+	average = static_cast<float>(total / ((area.right - area.left) * (area.bottom - area.top)));
+}
+
+/*
+ *	\brief Check a minimum, maximum and average against a scan, the average to within rounding
+*/
+static bool CheckRange(
+		const char *what,							//!< What was measured
+		const TerrainArea &area,					//!< The area measured
+		float minimum,								//!< The lowest height found
+		float maximum,								//!< The highest height found
+		float average,								//!< The average height found
+		float expectedMinimum,						//!< The lowest height scanned
+		float expectedMaximum,						//!< The highest height scanned
+		float expectedAverage						//!< The average height scanned
+	)
+{
+	if (minimum != expectedMinimum || maximum != expectedMaximum || fabs(average - expectedAverage) > 0.001f * (1.0f + fabs(expectedAverage)))
+	{
+		std::cerr << "terrain: the pyramid's " << what << " " << area.left << "," << area.top << " to " << area.right << "," << area.bottom
+			<< " has " << minimum << " to " << maximum << " averaging " << average << " instead of "
+			<< expectedMinimum << " to " << expectedMaximum << " averaging " << expectedAverage << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Get a random area of a plane, never empty
+*/
+static TerrainArea GetRandomArea(
+		unsigned int width,							//!< The number of columns in the plane
+		unsigned int height							//!< The number of rows in the plane
+	)
+{
+	TerrainArea area;
+	area.left = rand() % width;
+	area.top = rand() % height;
+	area.right = area.left + 1 + (rand() % (width - area.left));
+	area.bottom = area.top + 1 + (rand() % (height - area.top));
+	return area;
+}
+
+/*
+ *	\brief Check every square level cell and random range queries against scans, after random edits each updated by its area
+*/
+static bool CheckPyramid(
+		unsigned int width,							//!< The number of columns in the plane
+		unsigned int height							//!< The number of rows in the plane
+	)
+{
+	std::vector<float> heights(width * height);
+	for (unsigned int sample = 0; sample < heights.size(); ++sample)
+	{
+		heights[sample] = static_cast<float>((rand() % 2001) - 1000) * 0.125f;
+	}
+
+	CHeightPyramid pyramid;
+	pyramid.Create(width, height);
+	pyramid.Rebuild(&heights[0], 1);
+
+	for (unsigned int edit = 0; edit < PyramidEdits; ++edit)
+	{
+		// the first pass checks the rebuild
+		if (edit != 0)
+		{
+			const TerrainArea dirty = GetRandomArea(width, height);
+			for (unsigned int z = dirty.top; z < dirty.bottom; ++z)
+			{
+				for (unsigned int x = dirty.left; x < dirty.right; ++x)
+				{
+					heights[(z * width) + x] = static_cast<float>((rand() % 2001) - 1000) * 0.125f;
+				}
+			}
+
+			pyramid.Update(&heights[0], 1, dirty);
+		}
+
+		float expectedMinimum, expectedMaximum, expectedAverage;
+		for (unsigned int level = 0; level < pyramid.GetLevelCount(); ++level)
+		{
+			for (unsigned int z = 0; z < pyramid.GetLevelHeight(level); ++z)
+			{
+				for (unsigned int x = 0; x < pyramid.GetLevelWidth(level); ++x)
+				{
+					TerrainArea covered;
+					covered.left = x << level;
+					covered.top = z << level;
+					covered.right = (x + 1) << level < width ? (x + 1) << level : width;
+					covered.bottom = (z + 1) << level < height ? (z + 1) << level : height;
+
+					ScanRange(heights, width, covered, expectedMinimum, expectedMaximum, expectedAverage);
+					const HeightPyramidCell &cell = pyramid.GetCell(level, x, z);
+					if (!CheckRange("cell", covered, cell.minimum, cell.maximum, cell.average, expectedMinimum, expectedMaximum, expectedAverage))
+						return false;
+				}
+			}
+		}
+
+		for (unsigned int query = 0; query < PyramidQueries; ++query)
+		{
+			const TerrainArea area = GetRandomArea(width, height);
+
+			float minimum, maximum, average;
+			if (!pyramid.QueryRange(area, minimum, maximum, average))
+			{
+				std::cerr << "terrain: the pyramid found nothing in " << area.left << "," << area.top << " to " << area.right << "," << area.bottom << std::endl;
+				return false;
+			}
+
+			ScanRange(heights, width, area, expectedMinimum, expectedMaximum, expectedAverage);
+			if (!CheckRange("query", area, minimum, maximum, average, expectedMinimum, expectedMaximum, expectedAverage))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Check the statistics against a scan of the plane, the histogram against the same bins counted directly
+*/
+static bool CheckStatisticsScan(
+		const char *name,							//!< What the plane holds
+		unsigned int stroke,						//!< The number of strokes made
+		const HeightPlane &plane,					//!< The plane
+		const CTerrainStatistics &statistics		//!< The statistics kept over it
+	)
+{
+	std::vector<float> sorted;
+	double total = 0.0;
+	unsigned int histogram[CTerrainStatistics::HistogramBins] = { 0 };
+
+	const float histogramMinimum = statistics.GetHistogramMinimum();
+	const float binSize = statistics.GetHistogramBinSize();
+	for (unsigned int z = 0; z < plane.height; ++z)
+	{
+		for (unsigned int x = 0; x < plane.width; ++x)
+		{
+			const float height = plane.At(x, z);
+			sorted.push_back(height);
+			total += height;
+
+			// every height must lie within the histogram, else the bins at either end are wrong
+			const int bin = static_cast<int>((height - histogramMinimum) / binSize);
+			if (bin < 0 || bin >= static_cast<int>(CTerrainStatistics::HistogramBins))
+			{
+				std::cerr << "terrain: " << name << " after " << stroke << " strokes has a height of " << height << " outside the histogram" << std::endl;
+				return false;
+			}
+			histogram[bin]++;
+		}
+	}
+
+	std::sort(sorted.begin(), sorted.end());
+	const float mean = static_cast<float>(total / sorted.size());
+	if (statistics.GetMinimum() != sorted.front() || statistics.GetMaximum() != sorted.back() || fabs(statistics.GetMean() - mean) > 0.0001f * (1.0f + fabs(mean)))
+	{
+		std::cerr << "terrain: " << name << " after " << stroke << " strokes has statistics of " << statistics.GetMinimum() << " to " << statistics.GetMaximum()
+			<< " averaging " << statistics.GetMean() << " instead of " << sorted.front() << " to " << sorted.back() << " averaging " << mean << std::endl;
+		return false;
+	}
+
+	for (unsigned int bin = 0; bin < CTerrainStatistics::HistogramBins; ++bin)
+	{
+		if (statistics.GetHistogramCount(bin) != histogram[bin])
+		{
+			std::cerr << "terrain: " << name << " after " << stroke << " strokes counts " << statistics.GetHistogramCount(bin) << " heights in bin " << bin
+				<< " instead of " << histogram[bin] << std::endl;
+			return false;
+		}
+	}
+
+	// the percentile interpolates within the bin holding the height at that rank, so it is within a bin of it
+	static const float Fractions[] = { 0.0f, 0.05f, 0.25f, 0.5f, 0.75f, 0.95f, 1.0f };
+	for (unsigned int fraction = 0; fraction < sizeof(Fractions) / sizeof(Fractions[0]); ++fraction)
+	{
+		const float target = Fractions[fraction] * sorted.size();
+		const unsigned int rank = target < 1.0f ? 0 : static_cast<unsigned int>(ceil(target)) - 1;
+		const float percentile = statistics.GetHeightAtPercentile(Fractions[fraction]);
+		if (fabs(percentile - sorted[rank]) > binSize * 1.001f)
+		{
+			std::cerr << "terrain: " << name << " after " << stroke << " strokes puts the " << Fractions[fraction] << " percentile at " << percentile
+				<< " instead of " << sorted[rank] << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Check the statistics through random brush strokes, each taken out before the stamp and put back after, against a scan after every stroke
+*/
+static bool CheckStatistics(
+		const char *name,							//!< What the plane holds
+		float baseHeight,							//!< The middle of the random heights
+		float spread								//!< How far the random heights reach either side of the middle
+	)
+{
+	CHeightField heightField;
+	heightField.Create(StatisticsMapSize, 0.0f);
+	const HeightPlane plane = heightField.GetPlane();
+	for (unsigned int z = 0; z < StatisticsMapSize; ++z)
+	{
+		for (unsigned int x = 0; x < StatisticsMapSize; ++x)
+		{
+			plane.At(x, z) = baseHeight + (spread * static_cast<float>((rand() % 2001) - 1000) * 0.001f);
+		}
+	}
+
+	CHeightPyramid pyramid;
+	pyramid.Create(StatisticsMapSize, StatisticsMapSize);
+	pyramid.Rebuild(plane.heights, plane.stride);
+
+	CTerrainStatistics statistics(&pyramid);
+	statistics.Rebuild(plane.heights, plane.stride, StatisticsMapSize, StatisticsMapSize);
+	if (!CheckStatisticsScan(name, 0, plane, statistics))
+		return false;
+
+	for (unsigned int stroke = 1; stroke <= StatisticsStrokes; ++stroke)
+	{
+		// centers off the edges too, whose stamps are clipped
+		const float x = static_cast<float>(rand() % (StatisticsMapSize + 8)) - 4.0f + ((rand() % 100) * 0.01f);
+		const float z = static_cast<float>(rand() % (StatisticsMapSize + 8)) - 4.0f + ((rand() % 100) * 0.01f);
+		const int size = 1 + (rand() % 5);
+
+		const TerrainArea area = GetStampArea(plane, x, z, size);
+		statistics.BeginUpdate(plane.heights, plane.stride, area);
+
+		// the large offsets carry heights out of the histogram and rebin it
+		switch (rand() % 5)
+		{
+		case 0: StampOffset(plane, x, z, size, spread * 0.1f, 0.75f); break;
+		case 1: StampOffset(plane, x, z, size, -spread * ((rand() % 2) == 0 ? 0.1f : 2.0f), 0.75f); break;
+		case 2: StampLevel(plane, x, z, size); break;
+		case 3: StampSmooth(plane, x, z, size, 0.5f); break;
+		default: StampNoise(plane, x, z, size, spread * 0.05f); break;
+		}
+
+		pyramid.Update(plane.heights, plane.stride, area);
+		statistics.Update(plane.heights, plane.stride, area);
+		if (!CheckStatisticsScan(name, stroke, plane, statistics))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Check the background heightmap loader, the height pyramid and the statistics, and time a whole background load and range queries
+*/
+bool RunTerrainBenchmarks(
+		CBenchmark &benchmark,						//!< The benchmark runner
+		unsigned int mapSize						//!< The width and height of the heightmap
+	)
+{
+	bool passed = CheckLoaderCancel();
+
+	// odd sizes leave part covered cells on the edges, a single column halves only its rows
+	srand(1);
+	passed = CheckPyramid(45, 29) && passed;
+	passed = CheckPyramid(64, 64) && passed;
+	passed = CheckPyramid(1, 37) && passed;
+
+	// every height the same side of zero catches a histogram or mean which assumes the range straddles it
+	passed = CheckStatistics("a mixed plane", 0.0f, 40.0f) && passed;
+	passed = CheckStatistics("an all positive plane", 1000.0f, 40.0f) && passed;
+	passed = CheckStatistics("an all negative plane", -1000.0f, 40.0f) && passed;
+
+	static const char *const FileName = "VisCraftLoaderBenchmark.bmp";
+	CHeightField heightField;
+	heightField.Create(mapSize, 0.0f);
+	if (benchmark.IsEnabled("load/background") && heightField.Save(FileName))
+	{
+		CHeightMapLoader loader;
+		benchmark.Run("load/background", mapSize, [&]() {
+			loader.Start(FileName);
+			loader.Wait();
+		});
+
+		remove(FileName);
+	}
+
+	// range queries over random areas of a flat plane, the cells read don't depend on the heights
+	if (benchmark.IsEnabled("pyramid/query"))
+	{
+		std::vector<float> heights(mapSize * mapSize, 0.0f);
+		CHeightPyramid pyramid;
+		pyramid.Create(mapSize, mapSize);
+		pyramid.Rebuild(&heights[0], 1);
+
+		std::vector<TerrainArea> areas(TimedQueries);
+		for (unsigned int area = 0; area < TimedQueries; ++area)
+		{
+			areas[area] = GetRandomArea(mapSize, mapSize);
+		}
+
+		volatile float sink = 0.0f;
+		unsigned int area = 0;
+		benchmark.Run("pyramid/query", mapSize, [&]() {
+			float minimum, maximum, average;
+			pyramid.QueryRange(areas[area], minimum, maximum, average);
+			sink = sink + minimum + maximum + average;
+			area = (area + 1) % TimedQueries;
+		});
+	}
+
+	return passed;
+}
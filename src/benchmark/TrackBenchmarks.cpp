@@ -0,0 +1,458 @@
+#include "Benchmarks.h"
+#include "../kinect/CBlobLabeller.h"
+#include "../kinect/CDepthPyramid.h"
+#include "../kinect/CHandSearchWindow.h"
+#include "../kinect/DepthBand.h"
+#include <chrono>
+#include <vector>
+
+// the hand band CHand thresholds, in millimetres
+static const int NearPoint = 832;
+static const int FarPoint = 1344;
+
+// the pixels around the last hand CHand searches first
+static const unsigned int WindowMargin = 48;
+
+// the smallest blob CHand keeps, the furthest it follows the palm and the widths of a hand
+static const unsigned int MinimumBlobArea = 64;
+static const float MaximumHandJump = 80.0f;
+static const unsigned int SmallestHand = 30;
+static const unsigned int LargestHand = 90;
+
+// the levels of the depth pyramid CKinect builds, the hand is acquired in the coarsest
+static const unsigned int PyramidLevels = 3;
+
+// the hand is hidden for a few frames every so often, as when it drops out of the band
+static const unsigned int DropoutPeriod = 15;
+static const unsigned int DropoutFrames = 3;
+
+/*
+ *	\brief Follows the hand through the frames the way CHand::Segment does
+*/
+struct HandTracker
+{
+	CHandSearchWindow			search;							//!< The window searched
+	CDepthPyramid				pyramid;						//!< The depth pyramid of the frame
+	bool						coarse;							//!< Is a lost hand acquired in the pyramid, rather than the whole frame
+	CBlobLabeller				labeller;						//!< Labels the blobs of the band
+	std::vector<unsigned char>	mask;							//!< The band mask
+	bool						tracking;						//!< Was a hand found last frame
+	float						palmX;							//!< The column of the last palm
+	float						palmY;							//!< The row of the last palm
+	MaskArea					handArea;						//!< The last hand area, right and bottom exclusive
+};
+
+/*
+ *	\brief Set up a tracker, a margin as big as the frame without coarse acquisition always searches the whole frame
+*/
+static void CreateTracker(
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows
+		unsigned int margin,						//!< The pixels around the last hand searched first
+		bool coarse,								//!< Acquire a lost hand in the pyramid
+		HandTracker &tracker						//!< The tracker
+	)
+{
+	tracker.search.Create(width, height, margin);
+	tracker.pyramid.Create(width, height, PyramidLevels);
+	tracker.coarse = coarse;
+	tracker.labeller.Create(width, height);
+	tracker.mask.assign(width * height, 0);
+	tracker.tracking = false;
+	tracker.palmX = 0.0f;
+	tracker.palmY = 0.0f;
+
+	const MaskArea empty = { 0, 0, 0, 0 };
+	tracker.handArea = empty;
+}
+
+/*
+ *	\brief Search a window for the hand blob, the one nearest the last palm or else the largest as wide as a hand
+*/
+static const MaskBlob *SearchWindow(
+		HandTracker &tracker,						//!< The tracker
+		const unsigned short *depthPixels,			//!< The packed depth pixels of the frame
+		const MaskArea &window						//!< The window to search
+	)
+{
+	const unsigned int width = tracker.search.GetFrame().right;
+	const MaskArea bandArea = ThresholdDepthWindow(depthPixels, width, window, NearPoint, FarPoint, &tracker.mask[0]);
+	tracker.search.AddSearch(window);
+	tracker.labeller.Label(&tracker.mask[0], bandArea, MinimumBlobArea);
+
+	const std::vector<MaskBlob> &blobs = tracker.labeller.GetBlobs();
+	if (tracker.tracking)
+	{
+		const MaskBlob *nearest = nullptr;
+		float nearestDistance = MaximumHandJump * MaximumHandJump;
+		for (unsigned int blob = 0; blob < blobs.size(); ++blob)
+		{
+			const float blobWidth = static_cast<float>(blobs[blob].bounds.right - 1 - blobs[blob].bounds.left);
+			const float palmX = blobs[blob].bounds.left + (blobWidth * 0.5f) - tracker.palmX;
+			const float palmY = blobs[blob].bounds.top + (blobWidth * 0.65f) - tracker.palmY;
+
+			const float distance = (palmX * palmX) + (palmY * palmY);
+			if (distance < nearestDistance)
+			{
+				nearestDistance = distance;
+				nearest = &blobs[blob];
+			}
+		}
+
+		if (nearest != nullptr)
+			return nearest;
+	}
+
+	const MaskBlob *largest = nullptr;
+	for (unsigned int blob = 0; blob < blobs.size(); ++blob)
+	{
+		const unsigned int blobWidth = blobs[blob].bounds.right - 1 - blobs[blob].bounds.left;
+		if (blobWidth >= SmallestHand && blobWidth <= LargestHand && (largest == nullptr || blobs[blob].area > largest->area))
+		{
+			largest = &blobs[blob];
+		}
+	}
+
+	return largest;
+}
+
+/*
+ *	\brief Find the hand in a frame, searching around the last one first, false if there is no hand
+*/
+static bool TrackHand(
+		HandTracker &tracker,						//!< The tracker
+		const unsigned short *depthPixels			//!< The packed depth pixels of the frame
+	)
+{
+	const MaskBlob *handBlob = nullptr;
+	if (tracker.coarse)
+	{
+		tracker.pyramid.Build(depthPixels);
+		if (tracker.search.IsWindowed() || tracker.search.Acquire(tracker.pyramid, NearPoint, FarPoint, MinimumBlobArea, SmallestHand, LargestHand))
+		{
+			handBlob = SearchWindow(tracker, depthPixels, tracker.search.GetWindow());
+		}
+	}
+	else
+	{
+		handBlob = SearchWindow(tracker, depthPixels, tracker.search.GetWindow());
+	}
+
+	if (tracker.search.IsWindowed())
+	{
+		bool cut = handBlob == nullptr;
+		if (!cut)
+		{
+			MaskArea handBounds = handBlob->bounds;
+			handBounds.bottom = handBounds.top + static_cast<unsigned int>((handBounds.right - 1 - handBounds.left) * 1.3f) + 1;
+			cut = tracker.search.IsCut(handBounds);
+		}
+
+		if (cut)
+		{
+			handBlob = SearchWindow(tracker, depthPixels, tracker.search.GetFrame());
+		}
+	}
+
+	tracker.tracking = false;
+	if (handBlob != nullptr)
+	{
+		// the hand area hangs from the top of the blob, 1.3 times as tall as it is wide
+		const unsigned int left = handBlob->bounds.left;
+		const unsigned int right = handBlob->bounds.right - 1;
+		const unsigned int top = handBlob->bounds.top;
+		const unsigned int bottom = top + static_cast<unsigned int>((right - left) * 1.3f);
+
+		tracker.tracking = right - left >= SmallestHand && right - left <= LargestHand && bottom <= tracker.search.GetFrame().bottom;
+		if (tracker.tracking)
+		{
+			const MaskArea handArea = { left, top, right + 1, bottom };
+			tracker.handArea = handArea;
+			tracker.palmX = left + ((right - left) * 0.5f);
+			tracker.palmY = top + ((bottom - top) * 0.5f);
+		}
+	}
+
+	if (tracker.tracking)
+	{
+		tracker.search.Follow(tracker.handArea);
+	}
+	else
+	{
+		tracker.search.Reset();
+	}
+
+	return tracker.tracking;
+}
+
+/*
+ *	\brief Copy frames, hiding the hand for a few frames every so often by dropping the depth of every pixel in the band
+*/
+static void AddDropouts(
+		const DepthFrames &frames,					//!< The frames
+		DepthFrames &dropped						//!< Receives the frames with the hand hidden in some
+	)
+{
+	dropped = frames;
+
+	const unsigned int frameSize = frames.width * frames.height;
+	for (unsigned int frame = 0; frame < frames.count; ++frame)
+	{
+		if ((frame % DropoutPeriod) < DropoutPeriod - DropoutFrames)
+			continue;
+
+		unsigned short *pixels = &dropped.pixels[frame * frameSize];
+		for (unsigned int pixel = 0; pixel < frameSize; ++pixel)
+		{
+			const int depth = pixels[pixel] >> 3;
+			if (depth >= NearPoint && depth < FarPoint) pixels[pixel] = 0;
+		}
+	}
+}
+
+/*
+ *	\brief Check thresholding a window gives the same mask and bounds inside it as thresholding the whole frame, and writes nothing outside it
+*/
+static bool CheckWindowThreshold(
+		const DepthFrames &frames					//!< The frames to threshold
+	)
+{
+	// odd edges check the pixels either side of the vectorised columns
+	const MaskArea windows[] = {
+		{ 0, 0, frames.width, frames.height },
+		{ 201, 57, 391, 300 },
+		{ 3, 0, 18, frames.height },
+		{ frames.width - 37, 100, frames.width, 101 },
+		{ 250, 90, 250, 200 }
+	};
+	static const unsigned char Untouched = 0xab;
+
+	const unsigned int frameSize = frames.width * frames.height;
+	std::vector<unsigned char> wholeMask(frameSize);
+	std::vector<unsigned char> windowMask(frameSize);
+
+	bool passed = true;
+	for (unsigned int frame = 0; frame < frames.count; ++frame)
+	{
+		ThresholdDepthBand(frames.GetFrame(frame), frames.width, 0, frames.height, NearPoint, FarPoint, &wholeMask[0]);
+
+		for (unsigned int index = 0; index < sizeof(windows) / sizeof(windows[0]); ++index)
+		{
+			const MaskArea &window = windows[index];
+			windowMask.assign(frameSize, Untouched);
+			const MaskArea bounds = ThresholdDepthWindow(frames.GetFrame(frame), frames.width, window, NearPoint, FarPoint, &windowMask[0]);
+
+			MaskArea expected = { window.right, window.bottom, 0, 0 };
+			unsigned int wrong = 0;
+			for (unsigned int y = 0; y < frames.height; ++y)
+			{
+				for (unsigned int x = 0; x < frames.width; ++x)
+				{
+					const unsigned int pixel = (y * frames.width) + x;
+					const bool inside = x >= window.left && x < window.right && y >= window.top && y < window.bottom;
+					if (!inside)
+					{
+						if (windowMask[pixel] != Untouched) wrong++;
+						continue;
+					}
+
+					if (windowMask[pixel] != wholeMask[pixel]) wrong++;
+					if (wholeMask[pixel] == 0)
+						continue;
+
+					if (x < expected.left) expected.left = x;
+					if (x + 1 > expected.right) expected.right = x + 1;
+					if (y < expected.top) expected.top = y;
+					expected.bottom = y + 1;
+				}
+			}
+
+			const bool sameBounds = (bounds.IsEmpty() && expected.IsEmpty()) || (bounds.left == expected.left && bounds.top == expected.top
+				&& bounds.right == expected.right && bounds.bottom == expected.bottom);
+			if (wrong != 0 || !sameBounds)
+			{
+				std::cerr << "track: thresholding window " << index << " of frame " << frame << " got " << wrong << " pixels wrong"
+					<< (sameBounds ? "" : " and the wrong bounds") << std::endl;
+				passed = false;
+			}
+		}
+	}
+
+	return passed;
+}
+
+/*
+ *	\brief Check searching around the last hand finds the same hand as searching the whole frame, on frames with and without dropouts
+*/
+static bool CheckWindowedTracking(
+		const char *name,							//!< The name of the frames
+		const DepthFrames &frames					//!< The frames to track the hand through
+	)
+{
+	HandTracker windowed;
+	HandTracker whole;
+	CreateTracker(frames.width, frames.height, WindowMargin, true, windowed);
+	CreateTracker(frames.width, frames.height, frames.width + frames.height, false, whole);
+
+	// twice through, the hand wraps around from the last frame to the first
+	unsigned int mismatches = 0;
+	for (unsigned int played = 0; played < frames.count * 2; ++played)
+	{
+		const unsigned short *depthPixels = frames.GetFrame(played % frames.count);
+		const bool windowedFound = TrackHand(windowed, depthPixels);
+		const bool wholeFound = TrackHand(whole, depthPixels);
+
+		const MaskArea &a = windowed.handArea;
+		const MaskArea &b = whole.handArea;
+		if (windowedFound != wholeFound || (wholeFound && (a.left != b.left || a.top != b.top || a.right != b.right || a.bottom != b.bottom)))
+		{
+			mismatches++;
+		}
+	}
+
+	const double windowedPixels = static_cast<double>(windowed.search.GetPixelsSearched()) / windowed.search.GetFrameCount();
+	const double wholePixels = static_cast<double>(whole.search.GetPixelsSearched()) / whole.search.GetFrameCount();
+	std::cout << "# track: " << name << " searched " << windowedPixels << " pixels a frame around the hand against " << wholePixels
+		<< ", " << windowed.search.GetFullSearches() << " of " << windowed.search.GetFrameCount() << " frames searched the whole frame" << std::endl;
+
+	bool passed = true;
+	if (mismatches != 0)
+	{
+		std::cerr << "track: " << name << " found a different hand searching around the last one in " << mismatches << " frames" << std::endl;
+		passed = false;
+	}
+
+	// the generated hand is a sixth of the frame across, the window around it should be well under half the frame
+	if (windowedPixels > wholePixels * 0.5)
+	{
+		std::cerr << "track: " << name << " searched " << windowedPixels << " pixels a frame around the hand, the whole frame is " << wholePixels << std::endl;
+		passed = false;
+	}
+
+	return passed;
+}
+
+/*
+ *	\brief Measure how many frames the hand takes to be found again after each time it is lost, and how long the frame which finds it takes
+*/
+static void MeasureReacquisition(
+		const char *name,							//!< The name of the frames
+		const DepthFrames &frames					//!< The frames to track the hand through
+	)
+{
+	HandTracker tracker;
+	CreateTracker(frames.width, frames.height, WindowMargin, true, tracker);
+
+	unsigned int losses = 0;
+	unsigned int reacquisitions = 0;
+	unsigned int lostFrames = 0;
+	unsigned int longestLoss = 0;
+	unsigned int currentLoss = 0;
+	bool wasTracking = false;
+
+	double trackedMicroseconds = 0.0;
+	double reacquireMicroseconds = 0.0;
+	unsigned int trackedCount = 0;
+	unsigned int reacquireCount = 0;
+
+	for (unsigned int played = 0; played < frames.count * 2; ++played)
+	{
+		const bool windowed = tracker.search.IsWindowed();
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		const bool found = TrackHand(tracker, frames.GetFrame(played % frames.count));
+		const double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+		if (found && windowed)
+		{
+			trackedMicroseconds += microseconds;
+			trackedCount++;
+		}
+
+		if (found && !windowed && played != 0)
+		{
+			reacquireMicroseconds += microseconds;
+			reacquireCount++;
+		}
+
+		if (!found)
+		{
+			// only count the frames after a hand was followed, not the wait for the first one
+			if (wasTracking) losses++;
+			if (wasTracking || currentLoss != 0) currentLoss++;
+		}
+		else if (currentLoss != 0)
+		{
+			reacquisitions++;
+			lostFrames += currentLoss;
+			if (currentLoss > longestLoss) longestLoss = currentLoss;
+			currentLoss = 0;
+		}
+
+		wasTracking = found;
+	}
+
+	std::cout << "# track: " << name << " lost the hand " << losses << " times, it was found again " << reacquisitions << " times after " << (reacquisitions == 0 ? 0.0 : static_cast<double>(lostFrames) / reacquisitions)
+		<< " frames on average, " << longestLoss << " at most, finding it again took " << (reacquireCount == 0 ? 0.0 : reacquireMicroseconds / reacquireCount)
+		<< "us a frame against " << (trackedCount == 0 ? 0.0 : trackedMicroseconds / trackedCount) << "us following it" << std::endl;
+}
+
+/*
+ *	\brief Check searching around the last hand finds the same hand as the whole frame, and measure and time the pixels it saves
+*/
+bool RunTrackBenchmarks(
+		CBenchmark &benchmark,						//!< The benchmark runner
+		const DepthFrames &frames					//!< The frames to track the hand through
+	)
+{
+	// the generated hand is always in the frame, so the saving and the dropouts are known
+	DepthFrames generated;
+	GenerateDepthFrames(640, 480, 30, generated);
+
+	DepthFrames generatedDropouts;
+	AddDropouts(generated, generatedDropouts);
+
+	bool passed = CheckWindowThreshold(generated);
+	passed = CheckWindowedTracking("generated", generated) && passed;
+	passed = CheckWindowedTracking("generated with dropouts", generatedDropouts) && passed;
+
+	DepthFrames dropouts;
+	AddDropouts(frames, dropouts);
+
+	MeasureReacquisition("the frames", frames);
+	MeasureReacquisition("the frames with dropouts", dropouts);
+
+	const unsigned int frameSize = frames.width * frames.height;
+
+	HandTracker windowed;
+	CreateTracker(frames.width, frames.height, WindowMargin, true, windowed);
+
+	unsigned int frame = 0;
+	benchmark.Run("track/window", frames.width, [&]() {
+		TrackHand(windowed, frames.GetFrame(frame));
+		frame = (frame + 1) % frames.count;
+	}, frameSize);
+
+	HandTracker whole;
+	CreateTracker(frames.width, frames.height, frames.width + frames.height, false, whole);
+
+	frame = 0;
+	benchmark.Run("track/frame", frames.width, [&]() {
+		TrackHand(whole, frames.GetFrame(frame));
+		frame = (frame + 1) % frames.count;
+	}, frameSize);
+
+	// a lost hand, searched for over the whole frame
+	HandTracker lost;
+	CreateTracker(frames.width, frames.height, WindowMargin, true, lost);
+
+	frame = 0;
+	benchmark.Run("track/reacquire", frames.width, [&]() {
+		lost.tracking = false;
+		lost.search.Reset();
+		TrackHand(lost, frames.GetFrame(frame));
+		frame = (frame + 1) % frames.count;
+	}, frameSize);
+
+	return passed;
+}
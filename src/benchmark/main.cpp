@@ -0,0 +1,201 @@
+/*
+ *	VisCraftBenchmark - times the terrain, brush and kinect hot paths without a window or GPU.
+ *
+ *	Usage: VisCraftBenchmark [map size] [name filter] [seconds per benchmark] [depth recording]
+ *
+ *	One CSV row is printed per benchmark, ns_per_op is the column to compare between builds. Every
+ *	Run*Benchmarks suite checks its code before timing it, whatever the filter, and a failed check
+ *	makes the run return 1; lines starting with '#' are measurements the checks print. The kinect
+ *	suites use the frames of the depth recording, as written by CDepthRecordingWriter, or generated
+ *	640x480 frames when none is given. See Benchmarks.h for what each suite checks.
+ *
+ *	Builds on Linux with the top level CMakeLists.txt, ctest runs the checks alone. The audio ring
+ *	and the pipelines share data between threads without locks, so check them under ThreadSanitizer
+ *	after changing them, in a build of their own:
+ *
+ *		cmake -S . -B tsan -DCMAKE_BUILD_TYPE=RelWithDebInfo -DCMAKE_CXX_FLAGS=-fsanitize=thread
+ *		cmake --build tsan && tsan/VisCraftBenchmark 64 audio 0.01
+ *
+ *	which must finish without a ThreadSanitizer warning, and checks-only in place of audio runs
+ *	every suite's checks the same way.
+*/
+
+#include "Benchmarks.h"
+#include "../terrain/CHeightField.h"
+#include "../terrain/CHeightPyramid.h"
+#include "../terrain/CTerrainStatistics.h"
+#include "../terrain/TerrainBrushStamps.h"
+#include "../terrain/TerrainGenerators.h"
+#include "../terrain/TerrainMesh.h"
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static const unsigned int VertexSize = 8;		// position, texture and normal, the same layout as CTerrain's HeightMap
+static const unsigned int CenterCount = 1024;	// the number of brush positions cycled through
+
+static const unsigned int DepthFrameWidth = 640;		// the resolution of the kinect depth stream
+static const unsigned int DepthFrameHeight = 480;
+static const unsigned int GeneratedDepthFrames = 30;	// a second of depth frames
+
+/*
+ *	\brief The brushes and the stamps they apply, with the mouse falloff
+*/
+struct BrushBenchmark
+{
+	const char					*name;							//!< The name of the brush
+	TerrainArea					(*stamp)(const HeightPlane &plane, float x, float z, int size);
+};
+
+static TerrainArea StampRaise(const HeightPlane &plane, float x, float z, int size) { return StampOffset(plane, x, z, size, 1.0f, 0.75f); }
+static TerrainArea StampLower(const HeightPlane &plane, float x, float z, int size) { return StampOffset(plane, x, z, size, -1.0f, 0.75f); }
+static TerrainArea StampDeform(const HeightPlane &plane, float x, float z, int size) { return StampOffset(plane, x, z, size, -0.25f, 0.75f); }
+static TerrainArea StampLevelBrush(const HeightPlane &plane, float x, float z, int size) { return StampLevel(plane, x, z, size); }
+static TerrainArea StampSmoothBrush(const HeightPlane &plane, float x, float z, int size) { return StampSmooth(plane, x, z, size, 0.1f); }
+static TerrainArea StampNoiseBrush(const HeightPlane &plane, float x, float z, int size) { return StampNoise(plane, x, z, size, 0.125f); }
+
+int main(int argc, char *argv[])
+{
+	const unsigned int mapSize = argc > 1 ? static_cast<unsigned int>(atoi(argv[1])) : 512;
+	const std::string filter = argc > 2 ? argv[2] : "";
+	const double seconds = argc > 3 ? atof(argv[3]) : 0.25;
+	const std::string recording = argc > 4 ? argv[4] : "";
+
+	if (mapSize < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " [map size] [name filter] [seconds per benchmark] [depth recording]" << std::endl;
+		return 2;
+	}
+
+	DepthFrames depthFrames;
+	if (recording.empty())
+	{
+		GenerateDepthFrames(DepthFrameWidth, DepthFrameHeight, GeneratedDepthFrames, depthFrames);
+	}
+	else if (!LoadDepthFrames(recording, depthFrames))
+	{
+		return 2;
+	}
+
+	CBenchmark benchmark(std::cout, filter, seconds);
+	benchmark.WriteHeader();
+
+	// an interleaved vertex grid like CTerrain's, filled with repeatable hills
+	std::vector<float> vertices(mapSize * mapSize * VertexSize, 0.0f);
+	for (unsigned int z = 0; z < mapSize; ++z)
+	{
+		for (unsigned int x = 0; x < mapSize; ++x)
+		{
+			vertices[((z * mapSize) + x) * VertexSize] = static_cast<float>(x);
+			vertices[(((z * mapSize) + x) * VertexSize) + 2] = static_cast<float>(z);
+		}
+	}
+
+	HeightPlane plane;
+	plane.heights = &vertices[1];
+	plane.stride = VertexSize;
+	plane.width = mapSize;
+	plane.height = mapSize;
+	GenerateFractal(plane, 1, 6, 64.0f, 60.0f, 0.5f);
+
+	// heightfield load, from a bitmap written by the batch tool's writer
+	{
+		static const char *const FileName = "VisCraftBenchmark.bmp";
+
+		CHeightField heightField;
+		heightField.Create(mapSize, 0.0f);
+		GenerateFractal(heightField.GetPlane(), 1, 6, 64.0f, 60.0f, 0.5f);
+
+		if (benchmark.IsEnabled("load") && heightField.Save(FileName))
+		{
+			benchmark.Run("load", mapSize, [&]() { heightField.Load(FileName); });
+			remove(FileName);
+		}
+	}
+
+	// mesh building, the same work CTerrain does after every brush stroke
+	std::vector<float> faceNormals((mapSize - 1) * (mapSize - 1) * 3);
+	std::vector<float> triangles((mapSize - 1) * (mapSize - 1) * 6 * VertexSize);
+
+	benchmark.Run("normals", mapSize, [&]() { CalculatePlaneNormals(plane, &faceNormals[0], &vertices[5], VertexSize); });
+	benchmark.Run("vertices", mapSize, [&]() { BuildTriangleList(&vertices[0], VertexSize, mapSize, mapSize, &triangles[0]); });
+
+	// the brushes, each stroke stamps the heights and updates the pyramid and statistics
+	CHeightPyramid pyramid;
+	pyramid.Create(mapSize, mapSize);
+	pyramid.Rebuild(plane.heights, plane.stride);
+
+	CTerrainStatistics statistics(&pyramid);
+	statistics.Rebuild(plane.heights, plane.stride, mapSize, mapSize);
+
+	srand(1);
+	std::vector<float> centers(CenterCount * 2);
+	for (unsigned int center = 0; center < centers.size(); ++center)
+	{
+		centers[center] = static_cast<float>(rand() % mapSize) + ((rand() % 100) * 0.01f);
+	}
+
+	static const BrushBenchmark Brushes[] = {
+		{ "raise", &StampRaise },
+		{ "lower", &StampLower },
+		{ "deform", &StampDeform },
+		{ "level", &StampLevelBrush },
+		{ "smooth", &StampSmoothBrush },
+		{ "noise", &StampNoiseBrush }
+	};
+
+	for (unsigned int brush = 0; brush < sizeof(Brushes) / sizeof(Brushes[0]); ++brush)
+	{
+		// IBrush clamps the size between 1 and 5
+		for (int size = 1; size <= 5; ++size)
+		{
+			std::stringstream name;
+			name << "brush/" << Brushes[brush].name << "/" << size;
+
+			unsigned int center = 0;
+			benchmark.Run(name.str(), mapSize, [&]() {
+				const TerrainArea area = GetStampArea(plane, centers[center * 2], centers[(center * 2) + 1], size);
+				statistics.BeginUpdate(plane.heights, plane.stride, area);
+				Brushes[brush].stamp(plane, centers[center * 2], centers[(center * 2) + 1], size);
+				pyramid.Update(plane.heights, plane.stride, area);
+				statistics.Update(plane.heights, plane.stride, area);
+				center = (center + 1) % CenterCount;
+			});
+		}
+	}
+
+	// height lookups, as used by the gizmo every frame
+	{
+		volatile float sink = 0.0f;
+		unsigned int center = 0;
+		benchmark.Run("lookup", mapSize, [&]() {
+			const float *const height = plane.GetNearest(centers[center * 2], centers[(center * 2) + 1]);
+			sink = sink + (height != nullptr ? *height : 0.0f);
+			center = (center + 1) % CenterCount;
+		});
+	}
+
+	// the background heightmap loader, then the kinect depth stream conversion and hand finding, run by the kinect thread 30 times a second
+	bool passed = RunTerrainBenchmarks(benchmark, mapSize);
+	passed = RunDepthBenchmarks(benchmark) && passed;
+	passed = RunHandBenchmarks(benchmark, depthFrames) && passed;
+	passed = RunReplayBenchmarks(benchmark, depthFrames) && passed;
+	passed = RunRecordBenchmarks(benchmark, depthFrames) && passed;
+	passed = RunScreenshotBenchmarks(benchmark, depthFrames) && passed;
+	passed = RunShapeBenchmarks(benchmark, depthFrames, recording.empty() ? "" : recording + ".labels") && passed;
+	passed = RunTemplateBenchmarks(benchmark) && passed;
+	passed = RunPipelineBenchmarks(benchmark, depthFrames) && passed;
+	passed = RunFilterBenchmarks(benchmark, depthFrames) && passed;
+	passed = RunPyramidBenchmarks(benchmark, depthFrames) && passed;
+	passed = RunTrackBenchmarks(benchmark, depthFrames) && passed;
+	passed = RunCalibrationBenchmarks(benchmark, depthFrames) && passed;
+	passed = RunAudioBenchmarks(benchmark) && passed;
+
+	if (!passed)
+	{
+		return 1;
+	}
+
+	return 0;
+}
@@ -25,28 +25,11 @@ void CBrushDeform::Apply(
 	if (moveAmount == 0.0f)
 		return;
 
-	for (int xOffset = -m_size; xOffset <= m_size; ++xOffset)
-	{
-		for (int zOffset = -m_size; zOffset <= m_size; ++zOffset)
-		{
-			HeightMap *hmap = terrain->GetTerrainVertexAt(gizmo->Position().x + xOffset, gizmo->Position().z + zOffset);
-			if (hmap == nullptr)
-			{
-				continue;
-			}
-
-			float scale = 1;
-			if (xOffset < 0) scale += -xOffset; else scale += xOffset;
-			if (zOffset < 0) scale += -zOffset; else scale += zOffset;
-			scale *= 0.75f;
-
-			const float scaledMovedAmount = moveAmount / (scale);
-
-			hmap->position.y -= scaledMovedAmount;
-		}
-	}
-
-	terrain->UpdateHeightMap();
+	const HeightPlane plane = terrain->GetHeightPlane();
+	const TerrainArea area = GetStampArea(plane, gizmo->Position().x, gizmo->Position().z, m_size);
+	terrain->BeginHeightMapUpdate(area);
+	StampOffset(plane, gizmo->Position().x, gizmo->Position().z, m_size, -moveAmount, 0.75f);
+	terrain->UpdateHeightMap(area);
 	gizmo->DragData().lastY = mousePos.y;
 }
 
@@ -65,27 +48,10 @@ void CBrushDeform::Apply(
 	if (moveAmount == 0.0f)
 		return;
 
-	for (int xOffset = -m_size; xOffset <= m_size; ++xOffset)
-	{
-		for (int zOffset = -m_size; zOffset <= m_size; ++zOffset)
-		{
-			HeightMap *hmap = terrain->GetTerrainVertexAt(gizmo->Position().x + xOffset, gizmo->Position().z + zOffset);
-			if (hmap == nullptr)
-			{
-				continue;
-			}
-
-			float scale = 1;
-			if (xOffset < 0) scale += -xOffset; else scale += xOffset;
-			if (zOffset < 0) scale += -zOffset; else scale += zOffset;
-			scale *= 0.75f;
-
-			const float scaledMovedAmount = moveAmount / (scale);
-
-			hmap->position.y -= scaledMovedAmount;
-		}
-	}
-
-	terrain->UpdateHeightMap();
+	const HeightPlane plane = terrain->GetHeightPlane();
+	const TerrainArea area = GetStampArea(plane, gizmo->Position().x, gizmo->Position().z, m_size);
+	terrain->BeginHeightMapUpdate(area);
+	StampOffset(plane, gizmo->Position().x, gizmo->Position().z, m_size, -moveAmount, 0.75f);
+	terrain->UpdateHeightMap(area);
 	gizmo->DragData().lastY = mousePos.y;
 }
\ No newline at end of file
@@ -19,26 +19,11 @@ void CBrushLevel::Apply(
 	if (!input->IsMouseDown(MouseButton::Right))
 		return;
 
-	HeightMap *centerhmap = terrain->GetTerrainVertexAt(gizmo->Position().x, gizmo->Position().z);
-	if (centerhmap == nullptr)
-	{
-		return;
-	}
-
-	for (int xOffset = -m_size; xOffset <= m_size; ++xOffset)
-	{
-		for (int zOffset = -m_size; zOffset <= m_size; ++zOffset)
-		{
-			HeightMap *hmap = terrain->GetTerrainVertexAt(gizmo->Position().x + xOffset, gizmo->Position().z + zOffset);
-			if (hmap == nullptr)
-			{
-				continue;
-			}
-			hmap->position.y = centerhmap->position.y;
-		}
-	}
-
-	terrain->UpdateHeightMap();
+	const HeightPlane plane = terrain->GetHeightPlane();
+	const TerrainArea area = GetStampArea(plane, gizmo->Position().x, gizmo->Position().z, m_size);
+	terrain->BeginHeightMapUpdate(area);
+	StampLevel(plane, gizmo->Position().x, gizmo->Position().z, m_size);
+	terrain->UpdateHeightMap(area);
 }
 
 void CBrushLevel::Apply( 
@@ -50,24 +35,9 @@ void CBrushLevel::Apply(
 	if (!kinect->GetHandState() == HandState::ClosedFist)
 		return;
 
-	HeightMap *centerhmap = terrain->GetTerrainVertexAt(gizmo->Position().x, gizmo->Position().z);
-	if (centerhmap == nullptr)
-	{
-		return;
-	}
-
-	for (int xOffset = -m_size; xOffset <= m_size; ++xOffset)
-	{
-		for (int zOffset = -m_size; zOffset <= m_size; ++zOffset)
-		{
-			HeightMap *hmap = terrain->GetTerrainVertexAt(gizmo->Position().x + xOffset, gizmo->Position().z + zOffset);
-			if (hmap == nullptr)
-			{
-				continue;
-			}
-			hmap->position.y = centerhmap->position.y;
-		}
-	}
-
-	terrain->UpdateHeightMap();
+	const HeightPlane plane = terrain->GetHeightPlane();
+	const TerrainArea area = GetStampArea(plane, gizmo->Position().x, gizmo->Position().z, m_size);
+	terrain->BeginHeightMapUpdate(area);
+	StampLevel(plane, gizmo->Position().x, gizmo->Position().z, m_size);
+	terrain->UpdateHeightMap(area);
 }
\ No newline at end of file
@@ -19,29 +19,11 @@ void CBrushNoise::Apply(
 	if (!input->IsMouseDown(MouseButton::Right))
 		return;
 
-	D3DXVECTOR2 position = D3DXVECTOR2(gizmo->Position().x, gizmo->Position().z);
-
-	HeightMap *centerhmap = terrain->GetTerrainVertexAt(position.x, position.y);
-	if (centerhmap == nullptr)
-	{
-		return;
-	}
-
-	for (int xOffset = -m_size; xOffset <= m_size; ++xOffset)
-	{
-		for (int zOffset = -m_size; zOffset <= m_size; ++zOffset)
-		{
-			HeightMap *hmap = terrain->GetTerrainVertexAt(position.x + xOffset, position.y + zOffset);
-			if (hmap == nullptr)
-			{
-				continue;
-			}
-			float noise = (500 - (rand() % 1000)) * 0.00025f;
-			hmap->position.y += noise;
-		}
-	}
-
-	terrain->UpdateHeightMap();
+	const HeightPlane plane = terrain->GetHeightPlane();
+	const TerrainArea area = GetStampArea(plane, gizmo->Position().x, gizmo->Position().z, m_size);
+	terrain->BeginHeightMapUpdate(area);
+	StampNoise(plane, gizmo->Position().x, gizmo->Position().z, m_size, 0.125f);
+	terrain->UpdateHeightMap(area);
 }
 
 void CBrushNoise::Apply( 
@@ -53,27 +35,9 @@ void CBrushNoise::Apply(
 	if (!kinect->GetHandState() == HandState::ClosedFist)
 		return;
 
-	D3DXVECTOR2 position = D3DXVECTOR2(gizmo->Position().x, gizmo->Position().z);
-
-	HeightMap *centerhmap = terrain->GetTerrainVertexAt(position.x, position.y);
-	if (centerhmap == nullptr)
-	{
-		return;
-	}
-
-	for (int xOffset = -m_size; xOffset <= m_size; ++xOffset)
-	{
-		for (int zOffset = -m_size; zOffset <= m_size; ++zOffset)
-		{
-			HeightMap *hmap = terrain->GetTerrainVertexAt(position.x + xOffset, position.y + zOffset);
-			if (hmap == nullptr)
-			{
-				continue;
-			}
-			float noise = (500 - (rand() % 1000)) * 0.00025f;
-			hmap->position.y += noise;
-		}
-	}
-
-	terrain->UpdateHeightMap();
+	const HeightPlane plane = terrain->GetHeightPlane();
+	const TerrainArea area = GetStampArea(plane, gizmo->Position().x, gizmo->Position().z, m_size);
+	terrain->BeginHeightMapUpdate(area);
+	StampNoise(plane, gizmo->Position().x, gizmo->Position().z, m_size, 0.125f);
+	terrain->UpdateHeightMap(area);
 }
\ No newline at end of file
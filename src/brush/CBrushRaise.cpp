@@ -19,28 +19,11 @@ void CBrushRaise::Apply(
 	if (!input->IsMouseDown(MouseButton::Right))
 		return;
 
-	for (int xOffset = -m_size; xOffset <= m_size; ++xOffset)
-	{
-		for (int zOffset = -m_size; zOffset <= m_size; ++zOffset)
-		{
-			HeightMap *hmap = terrain->GetTerrainVertexAt(gizmo->Position().x + xOffset, gizmo->Position().z + zOffset);
-			if (hmap == nullptr)
-			{
-				continue;
-			}
-
-			float scale = 1;
-			if (xOffset < 0) scale += -xOffset; else scale += xOffset;
-			if (zOffset < 0) scale += -zOffset; else scale += zOffset;
-			scale *= 0.75f;
-
-			const float scaledMovedAmount = -(m_strength / (scale));
-
-			hmap->position.y -= scaledMovedAmount;
-		}
-	}
-
-	terrain->UpdateHeightMap();
+	const HeightPlane plane = terrain->GetHeightPlane();
+	const TerrainArea area = GetStampArea(plane, gizmo->Position().x, gizmo->Position().z, m_size);
+	terrain->BeginHeightMapUpdate(area);
+	StampOffset(plane, gizmo->Position().x, gizmo->Position().z, m_size, m_strength, 0.75f);
+	terrain->UpdateHeightMap(area);
 }
 
 void CBrushRaise::Apply( 
@@ -52,26 +35,9 @@ void CBrushRaise::Apply(
 	if (!kinect->GetHandState() == HandState::ClosedFist)
 		return;
 
-	for (int xOffset = -m_size; xOffset <= m_size; ++xOffset)
-	{
-		for (int zOffset = -m_size; zOffset <= m_size; ++zOffset)
-		{
-			HeightMap *hmap = terrain->GetTerrainVertexAt(gizmo->Position().x + xOffset, gizmo->Position().z + zOffset);
-			if (hmap == nullptr)
-			{
-				continue;
-			}
-
-			float scale = 1;
-			if (xOffset < 0) scale += -xOffset; else scale += xOffset;
-			if (zOffset < 0) scale += -zOffset; else scale += zOffset;
-			scale *= 5.0f;
-
-			const float scaledMovedAmount = -(m_strength / (scale));
-
-			hmap->position.y -= scaledMovedAmount;
-		}
-	}
-
-	terrain->UpdateHeightMap();
+	const HeightPlane plane = terrain->GetHeightPlane();
+	const TerrainArea area = GetStampArea(plane, gizmo->Position().x, gizmo->Position().z, m_size);
+	terrain->BeginHeightMapUpdate(area);
+	StampOffset(plane, gizmo->Position().x, gizmo->Position().z, m_size, m_strength, 5.0f);
+	terrain->UpdateHeightMap(area);
 }
\ No newline at end of file
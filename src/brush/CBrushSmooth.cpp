@@ -19,31 +19,11 @@ void CBrushSmooth::Apply(
 	if (!input->IsMouseDown(MouseButton::Right))
 		return;
 
-	D3DXVECTOR2 position = D3DXVECTOR2(gizmo->Position().x, gizmo->Position().z);
-	const float averageHeight = terrain->CalculateAverageTerrainHeight(position, m_size);
-
-	HeightMap *centerhmap = terrain->GetTerrainVertexAt(position.x, position.y);
-	if (centerhmap == nullptr)
-	{
-		return;
-	}
-
-	for (int xOffset = -m_size; xOffset <= m_size; ++xOffset)
-	{
-		for (int zOffset = -m_size; zOffset <= m_size; ++zOffset)
-		{
-			HeightMap *hmap = terrain->GetTerrainVertexAt(position.x + xOffset, position.y + zOffset);
-			if (hmap == nullptr)
-			{
-				continue;
-			}
-			
-			float diff = hmap->position.y - averageHeight;
-			hmap->position.y -= diff * 0.1f;
-		}
-	}
-
-	terrain->UpdateHeightMap();
+	const HeightPlane plane = terrain->GetHeightPlane();
+	const TerrainArea area = GetStampArea(plane, gizmo->Position().x, gizmo->Position().z, m_size);
+	terrain->BeginHeightMapUpdate(area);
+	StampSmooth(plane, gizmo->Position().x, gizmo->Position().z, m_size, 0.1f);
+	terrain->UpdateHeightMap(area);
 }
 
 void CBrushSmooth::Apply( 
@@ -55,29 +35,9 @@ void CBrushSmooth::Apply(
 	if (!kinect->GetHandState() == HandState::ClosedFist)
 		return;
 
-	D3DXVECTOR2 position = D3DXVECTOR2(gizmo->Position().x, gizmo->Position().z);
-	const float averageHeight = terrain->CalculateAverageTerrainHeight(position, m_size);
-
-	HeightMap *centerhmap = terrain->GetTerrainVertexAt(position.x, position.y);
-	if (centerhmap == nullptr)
-	{
-		return;
-	}
-
-	for (int xOffset = -m_size; xOffset <= m_size; ++xOffset)
-	{
-		for (int zOffset = -m_size; zOffset <= m_size; ++zOffset)
-		{
-			HeightMap *hmap = terrain->GetTerrainVertexAt(position.x + xOffset, position.y + zOffset);
-			if (hmap == nullptr)
-			{
-				continue;
-			}
-
-			float diff = hmap->position.y - averageHeight;
-			hmap->position.y -= diff * 0.1f;
-		}
-	}
-
-	terrain->UpdateHeightMap();
+	const HeightPlane plane = terrain->GetHeightPlane();
+	const TerrainArea area = GetStampArea(plane, gizmo->Position().x, gizmo->Position().z, m_size);
+	terrain->BeginHeightMapUpdate(area);
+	StampSmooth(plane, gizmo->Position().x, gizmo->Position().z, m_size, 0.1f);
+	terrain->UpdateHeightMap(area);
 }
\ No newline at end of file
@@ -240,6 +240,15 @@ void CGizmo::Control(
 	{
 		m_inputType = InputType::Mouse;
 	}
+	else
+	{
+		// take the latest hand the tracker published once a frame, the brushes read the same sample
+		kinect->UpdateHand();
+		if (kinect->GetHandState() != HandState::NotFound)
+		{
+			m_inputType = InputType::Kinect;
+		}
+	}
 
 	IBrush *const brush = m_brush[m_currentBrush];	
 
@@ -396,6 +396,9 @@ bool CShader::RenderLightPass(
 	lightDataPtr->lightDirection = m_light->GetDirection();
 	lightDataPtr->colorRender = CVisCraft::GetInstance()->GetTerrain()->GetFlag(TERRAIN_FLAG_COLORRENDER);
 
+	const CTerrainStatistics *const statistics = CVisCraft::GetInstance()->GetTerrain()->GetStatistics();
+	lightDataPtr->heightRange = D3DXVECTOR4(statistics->GetMinimum(), statistics->GetMaximum(), statistics->GetMean(), 0.0f);
+
 	// Unlock the constant buffer.
 	m_renderer->GetDeviceContext()->Unmap(m_lightBuffer, 0);
 
@@ -25,6 +25,7 @@ private:
 		D3DXVECTOR4 diffuseColor;														//!< The diffuse color of the scene
 		D3DXVECTOR3 lightDirection;														//!< The direction of the sun light
 		float colorRender;																//!< Should the scene be rendered in color mode?
+		D3DXVECTOR4 heightRange;														//!< The terrain min, max and mean height used by the color ramp
 	};
 
 	struct TerrainTexture 
@@ -17,6 +17,13 @@ CTerrain::CTerrain()
 
 	m_normalsBuffer = nullptr;
 
+	m_pyramid = nullptr;
+	m_statistics = nullptr;
+
+	m_loader = nullptr;
+	m_loadedRows = 0;
+	m_previewApplied = false;
+
 	m_size = D3DXVECTOR2(128, 128);
 }
 
@@ -25,7 +32,9 @@ CTerrain::CTerrain()
 */
 CTerrain::~CTerrain()
 {
-
+	SafeDelete(m_loader);
+	SafeDelete(m_statistics);
+	SafeDelete(m_pyramid);
 }
 
 /*
@@ -56,9 +65,30 @@ bool CTerrain::Create(
 	SafeDelete(m_heightMap);
 	m_heightMap = heightMap;
 
+	RebuildHeightStatistics();
+
 	return true;
 }
 
+/*
+ *	\brief Reallocate and rebuild the height pyramid and statistics from the whole heightmap
+*/
+void CTerrain::RebuildHeightStatistics()
+{
+	if (m_pyramid == nullptr)
+	{
+		m_pyramid = new CHeightPyramid();
+		m_statistics = new CTerrainStatistics(m_pyramid);
+	}
+
+	const unsigned int width = static_cast<unsigned int>(m_size.x);
+	const unsigned int height = static_cast<unsigned int>(m_size.y);
+
+	m_pyramid->Create(width, height);
+	m_pyramid->Rebuild(&m_heightMap[0].position.y, sizeof(HeightMap) / sizeof(float));
+	m_statistics->Rebuild(&m_heightMap[0].position.y, sizeof(HeightMap) / sizeof(float), width, height);
+}
+
 /*
  *	\brief Setup the terrain buffers to a default state
 */
@@ -76,30 +106,16 @@ const bool CTerrain::InitializeBuffers(
 
 	m_indexCount = m_vertexCount = (static_cast<unsigned int>(m_size.x) - 1) * (static_cast<unsigned int>(m_size.y) - 1) * 6;
 
+	static_assert(sizeof(VertexType) == sizeof(HeightMap), "The vertices are copied straight from the heightmap");
+
 	VertexType *const vertices = new VertexType[m_vertexCount];
+	BuildTriangleList(&heightMap[0].position.x, sizeof(HeightMap) / sizeof(float), static_cast<unsigned int>(m_size.x), static_cast<unsigned int>(m_size.y), &vertices[0].position.x);
 
+	// every vertex is unique, so the index buffer just counts up
 	unsigned long *const indices = new unsigned long[m_indexCount];
-
-	unsigned int index = 0;
-
-	for (int z = 0; z < (m_size.y - 1); ++z)
+	for (unsigned int index = 0; index < m_indexCount; ++index)
 	{
-		for(int x = 0; x < (m_size.x - 1); ++x)
-		{
-			const int bottomLeft	= static_cast<int>(m_size.y * z) + x;				
-			const int bottomRight	= static_cast<int>(m_size.y * z) + (x + 1);			
-			const int topLeft		= static_cast<int>(m_size.y * (z + 1)) + x;			
-			const int topRight		= static_cast<int>(m_size.y * (z + 1)) + (x + 1);	
-
-			AddVertex(vertices, indices, heightMap[topLeft],		index);
-			AddVertex(vertices, indices, heightMap[topRight],		index);
-
-			AddVertex(vertices, indices, heightMap[bottomLeft],		index);
-			AddVertex(vertices, indices, heightMap[bottomLeft],		index);
-
-			AddVertex(vertices, indices, heightMap[topRight],		index);
-			AddVertex(vertices, indices, heightMap[bottomRight],	index);
-		}
+		indices[index] = index;
 	}
 
 	// Set up the description of the static vertex buffer.
@@ -157,154 +173,25 @@ const bool CTerrain::InitializeBuffers(
 	return true;
 }
 
-/*
- *	\brief Add a vertex at a given x,z coordinate
-*/
-void CTerrain::AddVertex( 
-		VertexType *vertices,
-		unsigned long *indices,
-		const HeightMap &hm, 
-		unsigned int &index 
-	)
-{
-	vertices[index].position = hm.position;
-	vertices[index].texture = hm.texture;
-	vertices[index].normal = hm.normal;
-	indices[index] = index;
-	index++;
-}
-
 /*
  *	\brief Calculate the normals of the terrain
 */
 bool CTerrain::CalculateNormals(
-		HeightMap *heightMap							//!< 
+		HeightMap *heightMap							//!< The heightmap to calculate the normals of
 	)
 {
 	// If our normal buffer doesn't exist, create it
 	if (m_normalsBuffer == nullptr) {
-		m_normalsBuffer = new VectorType[static_cast<int>((m_size.x - 1) * (m_size.y - 1))];
+		m_normalsBuffer = new float[static_cast<int>((m_size.x - 1) * (m_size.y - 1)) * 3];
 	}
 
-	float vertex1[3], vertex2[3], vertex3[3], vector1[3], vector2[3], sum[3], length;
+	HeightPlane plane;
+	plane.heights = &heightMap[0].position.y;
+	plane.stride = sizeof(HeightMap) / sizeof(float);
+	plane.width = static_cast<unsigned int>(m_size.x);
+	plane.height = static_cast<unsigned int>(m_size.y);
 
-	// Go through all the faces in the mesh and calculate their normals.
-	for (int z = 0; z < (m_size.y - 1); ++z)
-	{
-		for (int x = 0; x < (m_size.x - 1); ++x)
-		{
-			int index1 = static_cast<int>((z * m_size.y) + x);
-			int index2 = static_cast<int>((z * m_size.y) + (x + 1));
-			int index3 = static_cast<int>(((z + 1) * m_size.y) + x);
-
-			// Get three vertices from the face.
-			vertex1[0] = heightMap[index1].position.x;
-			vertex1[1] = heightMap[index1].position.y;
-			vertex1[2] = heightMap[index1].position.z;
-
-			vertex2[0] = heightMap[index2].position.x;
-			vertex2[1] = heightMap[index2].position.y;
-			vertex2[2] = heightMap[index2].position.z;
-
-			vertex3[0] = heightMap[index3].position.x;
-			vertex3[1] = heightMap[index3].position.y;
-			vertex3[2] = heightMap[index3].position.z;
-
-			// Calculate the two vectors for this face.
-			vector1[0] = vertex1[0] - vertex3[0];
-			vector1[1] = vertex1[1] - vertex3[1];
-			vector1[2] = vertex1[2] - vertex3[2];
-			vector2[0] = vertex3[0] - vertex2[0];
-			vector2[1] = vertex3[1] - vertex2[1];
-			vector2[2] = vertex3[2] - vertex2[2];
-
-			int index = static_cast<int>((z * (m_size.y - 1)) + x);
-
-			// Calculate the cross product of those two vectors to get the un-normalized value for this face normal.
-			m_normalsBuffer[index].position.x = (vector1[1] * vector2[2]) - (vector1[2] * vector2[1]);
-			m_normalsBuffer[index].position.y = (vector1[2] * vector2[0]) - (vector1[0] * vector2[2]);
-			m_normalsBuffer[index].position.z = (vector1[0] * vector2[1]) - (vector1[1] * vector2[0]);
-		}
-	}
-
-	// Now go through all the vertices and take an average of each face normal 	
-	// that the vertex touches to get the averaged normal for that vertex.
-	for (int z = 0; z < m_size.y; ++z)
-	{
-		for (int x = 0; x < m_size.x; ++x)
-		{
-			// Initialize the sum.
-			sum[0] = 0.0f;
-			sum[1] = 0.0f;
-			sum[2] = 0.0f;
-
-			// Initialize the count.
-			int count = 0;
-
-			// Bottom left face.
-			if (((x - 1) >= 0) && ((z - 1) >= 0))
-			{
-				int index = static_cast<int>(((z - 1) * (m_size.y - 1)) + (x - 1));
-
-				sum[0] += m_normalsBuffer[index].position.x;
-				sum[1] += m_normalsBuffer[index].position.y;
-				sum[2] += m_normalsBuffer[index].position.z;
-				count++;
-			}
-
-			// Bottom right face.
-			if ((x < (m_size.x - 1)) && ((z - 1) >= 0))
-			{
-				int index = static_cast<int>(((z - 1) * (m_size.y - 1)) + x);
-
-				sum[0] += m_normalsBuffer[index].position.x;
-				sum[1] += m_normalsBuffer[index].position.y;
-				sum[2] += m_normalsBuffer[index].position.z;
-				count++;
-			}
-
-			// Upper left face.
-			if (((x - 1) >= 0) && (z < (m_size.y - 1)))
-			{
-				int index = static_cast<int>((z * (m_size.y - 1)) + (x - 1));
-
-				sum[0] += m_normalsBuffer[index].position.x;
-				sum[1] += m_normalsBuffer[index].position.y;
-				sum[2] += m_normalsBuffer[index].position.z;
-				count++;
-			}
-
-			// Upper right face.
-			if ((x < (m_size.x - 1)) && (z < (m_size.y - 1)))
-			{
-				int index = static_cast<int>((z * (m_size.y - 1)) + x);
-
-				sum[0] += m_normalsBuffer[index].position.x;
-				sum[1] += m_normalsBuffer[index].position.y;
-				sum[2] += m_normalsBuffer[index].position.z;
-				count++;
-			}
-
-			// Take the average of the faces touching this vertex.
-			sum[0] = (sum[0] / static_cast<float>(count));
-			sum[1] = (sum[1] / static_cast<float>(count));
-			sum[2] = (sum[2] / static_cast<float>(count));
-
-			// Calculate the length of this normal.
-			length = sqrt((sum[0] * sum[0]) + (sum[1] * sum[1]) + (sum[2] * sum[2]));
-
-			// Get an index to the vertex location in the height map array.
-			int index = static_cast<int>((z * m_size.y) + x);
-
-			// Normalize the final shared normal for this vertex and store it in the height map array.
-			heightMap[index].normal.x = (sum[0] / length);
-			heightMap[index].normal.y = (sum[1] / length);
-			heightMap[index].normal.z = (sum[2] / length);
-		}
-	}
-
-	// Release the temporary normals.
-	//delete [] normals;
+	CalculatePlaneNormals(plane, m_normalsBuffer, &heightMap[0].normal.x, sizeof(HeightMap) / sizeof(float));
 
 	return true;
 }
@@ -375,8 +262,8 @@ void CTerrain::Release()
 {
 	SafeRelease(m_indexBuffer);
 	SafeRelease(m_vertexBuffer);
-	SafeDelete(m_heightMap);
-	SafeDelete(m_normalsBuffer);
+	SafeArrayDelete(m_heightMap);
+	SafeArrayDelete(m_normalsBuffer);
 }
 
 /*
@@ -404,143 +291,217 @@ void CTerrain::Update()
 }
 
 /*
- *	\brief Update the buffers from the current height map
+ *	\brief Update the buffers and rebuild the statistics from the current height map
 */
 void CTerrain::UpdateHeightMap()
 {
-	if (!CalculateNormals(m_heightMap))
-		return;
+	// every height may have changed without being taken out of the statistics first
+	m_pyramid->Rebuild(&m_heightMap[0].position.y, sizeof(HeightMap) / sizeof(float));
+	m_statistics->Rebuild(&m_heightMap[0].position.y, sizeof(HeightMap) / sizeof(float), static_cast<unsigned int>(m_size.x), static_cast<unsigned int>(m_size.y));
 
-	D3D11_MAPPED_SUBRESOURCE resource;
-	const HRESULT result = m_renderer->GetDeviceContext()->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource);
-	if (FAILED(result))	
+	UpdateVertexBuffer();
+}
+
+/*
+ *	\brief Take an area out of the statistics before it is modified, the heightmap must still hold the old heights
+*/
+void CTerrain::BeginHeightMapUpdate(
+		const TerrainArea &area						//!< The area of the heightmap about to change
+	)
+{
+	if (area.IsEmpty())
 		return;
 
-	VertexType *const vertices = static_cast<VertexType*>(resource.pData);
+	m_statistics->BeginUpdate(&m_heightMap[0].position.y, sizeof(HeightMap) / sizeof(float), area);
+}
 
-	unsigned long *const indices = new unsigned long[m_indexCount];
+/*
+ *	\brief Update the buffers after an area of the height map has been modified, after BeginHeightMapUpdate for the same area
+*/
+void CTerrain::UpdateHeightMap(
+		const TerrainArea &area						//!< The area of the heightmap which changed
+	)
+{
+	if (area.IsEmpty())
+		return;
 
-	unsigned int index = 0;
+	// only the parents of the modified cells are re-reduced, the statistics read the new root
+	m_pyramid->Update(&m_heightMap[0].position.y, sizeof(HeightMap) / sizeof(float), area);
+	m_statistics->Update(&m_heightMap[0].position.y, sizeof(HeightMap) / sizeof(float), area);
 
-	for (int z = 0; z < (m_size.y - 1); ++z)
-	{
-		for(int x = 0; x < (m_size.x - 1); ++x)
-		{
-			const int bottomLeft	= static_cast<int>(m_size.y * z) + x;				
-			const int bottomRight	= static_cast<int>(m_size.y * z) + (x+1);			
-			const int topLeft		= static_cast<int>(m_size.y * (z+1)) + x;			
-			const int topRight		= static_cast<int>(m_size.y * (z+1)) + (x+1);	
+	UpdateVertexBuffer();
+}
 
-			AddVertex(vertices, indices, m_heightMap[topLeft],		index);
-			AddVertex(vertices, indices, m_heightMap[topRight],		index);
+/*
+ *	\brief Recalculate the normals and refill the vertex buffer from the heightmap
+*/
+void CTerrain::UpdateVertexBuffer()
+{
+	if (!CalculateNormals(m_heightMap))
+		return;
 
-			AddVertex(vertices, indices, m_heightMap[bottomLeft],	index);
-			AddVertex(vertices, indices, m_heightMap[bottomLeft],	index);
+	D3D11_MAPPED_SUBRESOURCE resource;
+	const HRESULT result = m_renderer->GetDeviceContext()->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource);
+	if (FAILED(result))	
+		return;
 
-			AddVertex(vertices, indices, m_heightMap[topRight],		index);
-			AddVertex(vertices, indices, m_heightMap[bottomRight],	index);
-		}
-	}
+	VertexType *const vertices = static_cast<VertexType*>(resource.pData);
+	BuildTriangleList(&m_heightMap[0].position.x, sizeof(HeightMap) / sizeof(float), static_cast<unsigned int>(m_size.x), static_cast<unsigned int>(m_size.y), &vertices[0].position.x);
 
 	m_renderer->GetDeviceContext()->Unmap(m_vertexBuffer, 0);
-
-	delete[] indices;
 }
 
 /*
- *	\brief Load a height map into the terrain
+ *	\brief Start loading a height map into the terrain in the background
 */
 const bool CTerrain::LoadHeightMap( 
 		const char *heightmapLocation,				//!< The location of the heightmap to load
 		HightMapType::Enum heightmapType			//!< The type of heightmap the file conatins
 	)
 {
-	FILE *file = nullptr;
-	if (fopen_s(&file, heightmapLocation, "rb") != 0)
+	if (m_loader == nullptr)
 	{
-		VISASSERT(false, "Failed to open the heightmap file");
-		return false;
+		m_loader = new CHeightMapLoader();
 	}
 
-	BITMAPFILEHEADER fileHeader;
-	if(fread(&fileHeader, sizeof(BITMAPFILEHEADER), 1, file) != 1)
+	// lock the terrain until the last band has been copied in
+	EnableFlag(TERRAIN_FLAG_LOCK | TERRAIN_FLAG_LOADING);
+	m_loadedRows = 0;
+	m_previewApplied = false;
+
+	if (!m_loader->Start(heightmapLocation))
 	{
-		VISASSERT(false, "Failed to read heightmap header");
+		FinishLoading();
 		return false;
 	}
 
-	BITMAPINFOHEADER fileInfo;
-	if(fread(&fileInfo, sizeof(BITMAPINFOHEADER), 1, file) != 1)
+	return true;
+}
+
+/*
+ *	\brief Copy any newly loaded heightmap rows into the terrain, called once per frame
+*/
+void CTerrain::UpdateLoading()
+{
+	if (!GetFlag(TERRAIN_FLAG_LOADING))
+		return;
+
+	// read the state before the rows, the final band is always published before the state changes
+	const HeightMapLoadState::Enum state = m_loader->GetState();
+
+	if (state == HeightMapLoadState::Failed)
 	{
-		VISASSERT(false, "Failed to read heightmap info header");
-		return false;
+		VISASSERT(false, m_loader->GetError());
+		FinishLoading();
+		return;
 	}
 
-	if (fileInfo.biWidth != fileInfo.biHeight)
+	// the terrain is resized to the new map as soon as the coarse preview is available
+	if (!m_previewApplied)
 	{
-		VISASSERT(false, "Heightmap image is not square");
-		return false;
+		if (!m_loader->IsCoarseReady())
+		{
+			if (state != HeightMapLoadState::Loading)
+				FinishLoading();
+			return;
+		}
+
+		if (!ApplyCoarseHeightMap())
+		{
+			VISASSERT(false, "Failed to create the terrain buffers for the heightmap");
+			m_loader->Cancel();
+			FinishLoading();
+			return;
+		}
+
+		m_previewApplied = true;
 	}
 
-	if (fileInfo.biBitCount / 8 != 3)
+	// refine the rows which have finished decoding since the last frame
+	const unsigned int rowsDecoded = m_loader->GetRowsDecoded();
+	if (rowsDecoded > m_loadedRows)
 	{
-		VISASSERT(false, "The height map is not a 24 bit image");
-		return false;
-	}
+		const unsigned int width = static_cast<unsigned int>(m_size.x);
 
-	m_size = D3DXVECTOR2(static_cast<float>(fileInfo.biWidth), static_cast<float>(fileInfo.biHeight));
+		TerrainArea area;
+		area.left = 0;
+		area.top = m_loadedRows;
+		area.right = width;
+		area.bottom = rowsDecoded;
 
-	const unsigned int imageSize = static_cast<const unsigned int>(m_size.x * m_size.y * 3);
+		BeginHeightMapUpdate(area);
 
-	unsigned char *const image = new unsigned char[imageSize];
+		const float *const heights = m_loader->GetHeights();
+		for (unsigned int index = m_loadedRows * width; index < rowsDecoded * width; ++index)
+		{
+			m_heightMap[index].position.y = heights[index];
+		}
 
-	fseek(file, fileHeader.bfOffBits, SEEK_SET);
+		m_loadedRows = rowsDecoded;
+		UpdateHeightMap(area);
+	}
 
-	if (fread(image, 1, imageSize, file) != imageSize)
+	if (state != HeightMapLoadState::Loading)
 	{
-		VISASSERT(false, "Failed to read image data");
-		delete[] image;
-		return false;
+		FinishLoading();
 	}
+}
+
+/*
+ *	\brief Cancel a background heightmap load, keeping the rows loaded so far
+*/
+void CTerrain::CancelLoading()
+{
+	if (!GetFlag(TERRAIN_FLAG_LOADING))
+		return;
 
-	fclose(file);
+	m_loader->Cancel();
+	m_loader->Wait();
+	FinishLoading();
+}
+
+/*
+ *	\brief Resize the terrain to the loading heightmap and fill it from the coarse preview
+*/
+const bool CTerrain::ApplyCoarseHeightMap()
+{
+	const unsigned int size = m_loader->GetSize();
 
 	// free the old buffers
 	Release();
 
-	// get the image data into a height map array
-	m_heightMap = new HeightMap[static_cast<int>(m_size.x * m_size.y)];
-	
-	unsigned int y = 0;
+	m_size = D3DXVECTOR2(static_cast<float>(size), static_cast<float>(size));
+	m_heightMap = new HeightMap[size * size];
 
-	// Read the image data into the height map.
-	for (int z = 0; z < m_size.y; ++z)
+	for (unsigned int z = 0; z < size; ++z)
 	{
-		for (int x = 0; x < m_size.x; ++x)
+		for (unsigned int x = 0; x < size; ++x)
 		{
-			const float height = image[y];
-
-			const int index = static_cast<int>(m_size.y * z) + x;
+			const unsigned int index = (size * z) + x;
 			m_heightMap[index].position.x = static_cast<float>(x);
-			m_heightMap[index].position.y = height;
+			m_heightMap[index].position.y = m_loader->GetCoarseHeight(x, z);
 			m_heightMap[index].position.z = static_cast<float>(z);
-
-			y += 3;
 		}
 	}
 
-	// load in the height map data to our buffers
 	if (!InitializeBuffers(m_heightMap))
-	{
-		delete[] image;
 		return false;
-	}
 
-	delete[] image;
+	RebuildHeightStatistics();
 
 	return true;
 }
 
+/*
+ *	\brief Unlock the terrain once a background load has ended
+*/
+void CTerrain::FinishLoading()
+{
+	DisableFlag(TERRAIN_FLAG_LOCK | TERRAIN_FLAG_LOADING);
+	m_loadedRows = 0;
+	m_previewApplied = false;
+}
+
 /*
  *	\brief Gets the y height of the terrain at a given x and z location
 */
@@ -549,42 +510,37 @@ HeightMap *CTerrain::GetTerrainVertexAt(
 		const float z															//!< The z coord to look up the vertex from 
 	) const
 {
-	D3DXVECTOR2 lookupVec = D3DXVECTOR2(x, z);
-
-	int closestVertIndex = -1;
-	float lastDistance = m_size.x * m_size.y;
-
-	const int heightMapSize = static_cast<int>(m_size.x * m_size.y);
-	for (int heightMapIndex = 0; heightMapIndex < heightMapSize; ++heightMapIndex)
+	// vertex x, z sits at world x, z so the closest vertex is found by rounding
+	const HeightPlane plane = GetHeightPlane();
+	const float *const height = plane.GetNearest(x, z);
+	if (height == nullptr) 
 	{
-		if (GetFlag(TERRAIN_FLAG_LOCK)) {
-			return nullptr;
-		}
-
-		const HeightMap hmap = m_heightMap[heightMapIndex];
-
-		if (hmap.position.x - x > 1 || hmap.position.x - x < -1)
-			continue;
+		return nullptr;
+	}
 
-		if (hmap.position.z - z > 1 || hmap.position.z - z < -1)
-			continue;
+	return &m_heightMap[static_cast<unsigned int>(height - plane.heights) / plane.stride];
+}
 
-		const D3DXVECTOR2 currentVec = D3DXVECTOR2(hmap.position.x, hmap.position.z);
-		const D3DXVECTOR2 distanceVec = currentVec - lookupVec;
-		const float currentDistance = sqrt((distanceVec.x * distanceVec.x) + (distanceVec.y * distanceVec.y));
-		if (currentDistance < lastDistance)
-		{
-			lastDistance = currentDistance;
-			closestVertIndex = heightMapIndex;
-		}
-	}
+/*
+ *	\brief Get a view of the heights for the brush stamps, empty while the terrain is locked
+*/
+const HeightPlane CTerrain::GetHeightPlane() const
+{
+	HeightPlane plane;
+	plane.heights = nullptr;
+	plane.stride = sizeof(HeightMap) / sizeof(float);
+	plane.width = 0;
+	plane.height = 0;
 
-	if (closestVertIndex == -1) 
+	if (GetFlag(TERRAIN_FLAG_LOCK) || m_heightMap == nullptr)
 	{
-		return nullptr;
+		return plane;
 	}
 
-	return &m_heightMap[closestVertIndex];
+	plane.heights = &m_heightMap[0].position.y;
+	plane.width = static_cast<unsigned int>(m_size.x);
+	plane.height = static_cast<unsigned int>(m_size.y);
+	return plane;
 }
 
 /*
@@ -628,121 +584,32 @@ float CTerrain::CalculateAverageTerrainHeight(
 		int area
 	)
 {
-	float count = 0.0f;
-	float height = 0.0f;
-
-	for (int xOffset = -area; xOffset <= area; ++xOffset)
-	{
-		for (int zOffset = -area; zOffset <= area; ++zOffset)
-		{
-			HeightMap *hmap = GetTerrainVertexAt(position.x + xOffset, position.y + zOffset);
-			if (hmap == nullptr)
-			{
-				continue;
-			}
-
-			height += hmap->position.y;
-			count++;
-		}
-	}
-
-	return height / count;	
+	return GetStampAverage(GetHeightPlane(), position.x, position.y, area);
 }
 
 void CTerrain::SaveHeightMap( 
 		char* fileName 
 	)
 {
-
-	const int size = static_cast<int>(m_size.x * m_size.y) * 3;
-
-	BITMAPFILEHEADER bmfh;
-	BITMAPINFOHEADER info;
-	memset ( &bmfh, 0, sizeof (BITMAPFILEHEADER ) );
-	memset ( &info, 0, sizeof (BITMAPINFOHEADER ) );
-
-	bmfh.bfType = 0x4d42;       // 0x4d42 = 'BM'
-	bmfh.bfReserved1 = 0;
-	bmfh.bfReserved2 = 0;
-	bmfh.bfSize = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER) + size;
-	bmfh.bfOffBits = 0x36;
-
-	info.biSize = sizeof(BITMAPINFOHEADER);
-	info.biWidth = static_cast<LONG>(m_size.x);
-	info.biHeight = static_cast<LONG>(m_size.y);
-	info.biPlanes = 1;	
-	info.biBitCount = 24;
-	info.biCompression = BI_RGB;	
-	info.biSizeImage = 0;
-	info.biXPelsPerMeter = 0x0ec4;  
-	info.biYPelsPerMeter = 0x0ec4;     
-	info.biClrUsed = 0;	
-	info.biClrImportant = 0; 	
-
-	HANDLE file = CreateFile(fileName , GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
-	if (NULL == file)
-	{
-		CloseHandle (file);
-		return;
-	}
-
-	unsigned long bwritten;
-	if (WriteFile (file, &bmfh, sizeof ( BITMAPFILEHEADER ), &bwritten, NULL ) == false)
-	{	
-		CloseHandle(file);
-		return;
-	}
-
-	if (WriteFile(file, &info, sizeof ( BITMAPINFOHEADER ), &bwritten, NULL) == false)
-	{	
-		CloseHandle(file);
-		return;
-	}
-
-	const float min = GetLowestTerrainPoint(); 
-	//const float max = GetHighestTerrainPoint(); 
-
-	BYTE *fileBuffer = new BYTE[size];
-
-	for (int terrainIndex = 0; terrainIndex < size; terrainIndex += 3)
+	const HeightPlane plane = GetHeightPlane();
+	if (!SaveHeightMapBitmap(fileName, plane, m_statistics->GetMinimum(), m_statistics->GetMaximum()))
 	{
-		HeightMap *hmap = &m_heightMap[terrainIndex / 3];
-		const BYTE color = static_cast<BYTE>((hmap->position.y - min));
-		fileBuffer[terrainIndex] = fileBuffer[terrainIndex+1] = fileBuffer[terrainIndex+2] = color;
-	}
-	
-	if (WriteFile(file, fileBuffer, size, &bwritten, NULL ) == false)
-	{	
-		CloseHandle(file);
-		return;
+		VISASSERT(false, "Failed to save the heightmap");
 	}
-	delete[] fileBuffer;
-
-	CloseHandle(file);
 }
 
+/*
+ *	\brief Get the lowest height in the terrain
+*/
 const float CTerrain::GetLowestTerrainPoint()
 {
-	float lowest = 0;
-	for (int terrainIndex = 0; terrainIndex < m_size.x * m_size.y; ++terrainIndex)
-	{
-		if (m_heightMap[terrainIndex].position.y < lowest)
-		{
-			lowest = m_heightMap[terrainIndex].position.y;
-		}
-	}
-	return lowest;
+	return m_statistics->GetMinimum();
 }
 
+/*
+ *	\brief Get the highest height in the terrain
+*/
 const float CTerrain::GetHighestTerrainPoint()
 {
-	float highest = 0;
-	for (int terrainIndex = 0; terrainIndex < m_size.x * m_size.y; ++terrainIndex)
-	{
-		if (m_heightMap[terrainIndex].position.y > highest)
-		{
-			highest = m_heightMap[terrainIndex].position.y;
-		}
-	}
-	return highest;
+	return m_statistics->GetMaximum();
 }
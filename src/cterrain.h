@@ -4,6 +4,12 @@
 	Header file includes
 */
 #include "crenderer.h"
+#include "terrain/CHeightMapLoader.h"
+#include "terrain/CHeightPyramid.h"
+#include "terrain/CTerrainStatistics.h"
+#include "terrain/HeightMapWriter.h"
+#include "terrain/TerrainBrushStamps.h"
+#include "terrain/TerrainMesh.h"
 #include <stdio.h>
 
 struct HightMapType {
@@ -20,11 +26,6 @@ struct HeightMap
 	D3DXVECTOR3 normal;
 };
 
-struct VectorType 
-{ 
-	D3DXVECTOR3 position;
-};
-
 union TerrainFlags 
 {
 	struct 
@@ -37,6 +38,9 @@ union TerrainFlags
 
 		unsigned int colorrender : 1;
 		#define TERRAIN_FLAG_COLORRENDER	0x04
+
+		unsigned int loading : 1;								//!< Is a heightmap being loaded in the background
+		#define TERRAIN_FLAG_LOADING		0x08
 	};
 
 	unsigned int allflags;
@@ -62,25 +66,24 @@ private:
 	unsigned int			m_indexCount;						//!< The number of indecies
 
 	HeightMap				*m_heightMap;						//!< The heightmap of ther terrain, used for modifying the terrain buffers		
-	VectorType				*m_normalsBuffer;					//!< 
+	float					*m_normalsBuffer;					//!< Scratch face normals, three floats per face
 
 	ID3D11Buffer			*m_vertexBuffer;					//!< Terrain D3D11 vertex buffer
 	ID3D11Buffer			*m_indexBuffer;						//!< Terrain D3D11 index buffer
 
+	CHeightPyramid			*m_pyramid;							//!< Min/max/average mip pyramid over the heightmap
+	CTerrainStatistics		*m_statistics;						//!< Running min/max/mean/histogram of the heightmap
+
+	CHeightMapLoader		*m_loader;							//!< Background heightmap loader
+	unsigned int			m_loadedRows;						//!< The number of loaded rows copied into the heightmap
+	bool					m_previewApplied;					//!< Has the terrain been resized to the coarse preview
+
 private:
 							//! Initialize the terrains vertex buffers
 	const bool				InitializeBuffers(
 								HeightMap *heightMap			//!< Heightmap to initalize the buffers too
 							);
 
-							//! Add a vertex at a given x,z coordinate
-	void					AddVertex(
-								VertexType *vertices,			//!< A pointer to the vertex array
-								unsigned long *indices,			//!< A pointer to the index array
-								const HeightMap &hm,
-								unsigned int &index				//!< The index into the arrays this vertex represents
-							);
-
 							//! Calculate the normals of the terrain
 	bool					CalculateNormals(
 								HeightMap *heightMap			//!< The heightmap to calculate the normals of
@@ -91,6 +94,18 @@ private:
 								HeightMap *heightMap			//!< The heightmap to calculate the normals of
 							);
 
+							//! Reallocate and rebuild the height pyramid and statistics from the whole heightmap
+	void					RebuildHeightStatistics();
+
+							//! Recalculate the normals and refill the vertex buffer from the heightmap
+	void					UpdateVertexBuffer();
+
+							//! Resize the terrain to the loading heightmap and fill it from the coarse preview
+	const bool				ApplyCoarseHeightMap();
+
+							//! Unlock the terrain once a background load has ended
+	void					FinishLoading();
+
 public:
 							//! Class constructor
 							CTerrain();
@@ -109,21 +124,52 @@ public:
 							//! Update the terrain for the D3D11 renderer
 	void					Update();
 
-							//! Update the buffers from the current heightmap
+							//! Update the buffers and rebuild the statistics from the current heightmap
 	void					UpdateHeightMap();
 
+							//! Take an area out of the statistics before it is modified, the heightmap must still hold the old heights
+	void					BeginHeightMapUpdate(
+								const TerrainArea &area			//!< The area of the heightmap about to change
+							);
+
+							//! Update the buffers after an area of the heightmap has been modified, after BeginHeightMapUpdate for the same area
+	void					UpdateHeightMap(
+								const TerrainArea &area			//!< The area of the heightmap which changed
+							);
+
+							//! Get a view of the heights for the brush stamps, empty while the terrain is locked
+	const HeightPlane		GetHeightPlane() const;
+
+							//! Get the min/max/average mip pyramid of the heightmap
+	const CHeightPyramid	*GetHeightPyramid() const
+							{
+								return m_pyramid;
+							}
+
+							//! Get the running statistics of the heightmap
+	const CTerrainStatistics *GetStatistics() const
+							{
+								return m_statistics;
+							}
+
 							//! Returns the index count
 	inline unsigned int		GetIndexCount() const
 							{
 								return m_indexCount;
 							}
 
-							//! Load a height map into the terrain
+							//! Start loading a height map into the terrain in the background
 	const bool				LoadHeightMap(
 								const char *heightmapLocation,									//!< The location of the heightmap to load
 								HightMapType::Enum heightmapType = HightMapType::IMAGE			//!< The type of heightmap the file conatins
 							);
 
+							//! Copy any newly loaded heightmap rows into the terrain, called once per frame
+	void					UpdateLoading();
+
+							//! Cancel a background heightmap load, keeping the rows loaded so far
+	void					CancelLoading();
+
 							//! 
 	void					EnableFlag(
 								unsigned int flag
@@ -177,9 +223,9 @@ public:
 								char* fileName 
 							);
 
-							//! 
+							//! Get the lowest height in the terrain
 	const float				GetLowestTerrainPoint();
 
-							//!
+							//! Get the highest height in the terrain
 	const float				GetHighestTerrainPoint();
 };
\ No newline at end of file
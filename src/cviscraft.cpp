@@ -292,6 +292,16 @@ bool CVisCraft::Update()
 		m_terrain->GetFlag(TERRAIN_FLAG_COLORRENDER) ? m_terrain->DisableFlag(TERRAIN_FLAG_COLORRENDER) : m_terrain->EnableFlag(TERRAIN_FLAG_COLORRENDER);
 	}	
 
+	// toggle recording the kinect depth stream
+	if (m_kinect != nullptr && m_input->IsKeyPressed(DIK_F3) == true)
+	{
+		while (m_input->IsKeyPressed(DIK_F3)) m_input->Update();
+		if (m_kinect->IsRecordingDepth())
+			m_kinect->StopDepthRecording();
+		else
+			m_kinect->StartDepthRecording();
+	}
+
 	// change brushes
 	// toggle wireframe mode
 	if (m_input->IsKeyPressed(DIK_1) == true)
@@ -381,6 +391,12 @@ bool CVisCraft::Update()
 
 	m_camera->Control(m_input);
 
+	// pull in any heightmap rows the background loader has finished
+	m_terrain->UpdateLoading();
+
+	// keep the water just below the lowest few percent of the terrain
+	m_water->SetWaterLevel(m_terrain->GetStatistics()->GetHeightAtPercentile(0.05f) - 1.0f);
+
 	if (!m_gui->IsVisible()) {
 		m_gizmo->Control(m_input, m_terrain, m_camera, m_kinect);
 	}
@@ -575,6 +591,7 @@ bool CVisCraft::CreateSplashScreen()
 
 void CVisCraft::NewTerrain()
 {
+	m_terrain->CancelLoading();
 	m_terrain->Reset();
 }
 
@@ -597,10 +614,12 @@ void CVisCraft::OpenTerrain()
 
 	BOOL result = GetOpenFileName(&ofn);
 	if (result == TRUE) {
+		// the terrain stays locked until the background load has finished
 		m_terrain->LoadHeightMap(fileName);
 	}
-
-	m_terrain->DisableFlag(TERRAIN_FLAG_LOCK);
+	else if (!m_terrain->GetFlag(TERRAIN_FLAG_LOADING)) {
+		m_terrain->DisableFlag(TERRAIN_FLAG_LOCK);
+	}
 }
 
 D3DXVECTOR2 CVisCraft::GetWindowDimension() const
@@ -610,6 +629,10 @@ D3DXVECTOR2 CVisCraft::GetWindowDimension() const
 
 void CVisCraft::SaveTerrain()
 {
+	// don't save a partially loaded heightmap
+	if (m_terrain->GetFlag(TERRAIN_FLAG_LOADING))
+		return;
+
 	m_terrain->EnableFlag(TERRAIN_FLAG_LOCK);
 
 	char fileName[MAX_PATH] = "";
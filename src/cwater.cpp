@@ -11,6 +11,8 @@ CWater::CWater()
 
 	m_texture = nullptr;
 	m_sampleState = nullptr;
+
+	m_level = -1.0f;
 }
 
 CWater::~CWater()
@@ -120,7 +122,7 @@ void CWater::Render(
 	m_mesh->PrepareRender(renderer);
 
 	D3DXMATRIX xformmat, scalemat;
-	D3DXMatrixTranslation(&xformmat, 64, -1.0f, 64); 
+	D3DXMatrixTranslation(&xformmat, 64, m_level, 64); 
 	D3DXMatrixScaling(&scalemat, 0.9f, 1.0f, 0.9f);
 
 	D3DXMatrixMultiply (&world, &scalemat, &xformmat);
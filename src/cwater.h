@@ -27,6 +27,8 @@ private:
 	ID3D11ShaderResourceView			*m_texture;							//!< 
 	ID3D11SamplerState					*m_sampleState;						//!< 
 
+	float								m_level;							//!< The height of the water plain
+
 public:
 										//! Classs constructor
 										CWater();
@@ -47,4 +49,12 @@ public:
 											D3DXMATRIX projection	//!< 
 										);
 
+										//! Set the height of the water plain
+	void								SetWaterLevel(
+											const float level		//!< The new height of the water
+										)
+										{
+											m_level = level;
+										}
+
 };
\ No newline at end of file
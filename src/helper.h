@@ -4,7 +4,9 @@
 	Header file includes
 */
 
-#include <windows.h>
+#ifdef _WIN32
+	#include <windows.h>
+#endif
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -13,7 +15,16 @@
 	Custom Assert
 */
 
-#ifndef NDEBUG
+#ifndef _WIN32
+	// no message box without windows, report the failure on the console instead
+	#define VISASSERT(condition, message) \
+	do { \
+		if (!(condition)) { \
+			std::cerr << "Assert Failed: \"" #condition "\" In " << __FILE__ \
+				<< "(" << __LINE__ << ") \"" << message << "\"" << std::endl; \
+		} \
+	} while (false)
+#elif !defined(NDEBUG)
 	#define VISASSERT(condition, message) \
 	do { \
 		if (!(condition)) { \
@@ -65,6 +76,7 @@ void SafeArrayDelete(T*& ptr) {
 	}
 }
 
+#ifdef _WIN32
 /*!
  * \brief destroy a window and null the pointer
  */
@@ -76,6 +88,7 @@ void SafeDestroyWindow(T*& ptr) {
 		ptr = nullptr;
 	}
 }
+#endif
 
 /*!
  * \brief release and null a pointer
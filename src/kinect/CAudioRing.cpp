@@ -0,0 +1,308 @@
+#include "CAudioRing.h"
+#include <chrono>
+
+/*
+ *	\brief Class constructor
+*/
+CAudioRing::CAudioRing() :
+	m_bytes(nullptr),
+	m_mask(0),
+	m_blockAlign(1),
+	m_readPosition(0),
+	m_writePosition(0),
+	m_waiting(false),
+	m_closed(false),
+	m_stamps(nullptr),
+	m_stampCount(0),
+	m_bytesWritten(0),
+	m_bytesRead(0),
+	m_bytesDropped(0),
+	m_overruns(0),
+	m_fullest(0)
+{
+	for (unsigned int bucket = 0; bucket < OccupancyBuckets; ++bucket)
+	{
+		m_occupancy[bucket] = 0;
+	}
+}
+
+/*
+ *	\brief Class destructor
+*/
+CAudioRing::~CAudioRing()
+{
+	delete[] m_bytes;
+	m_bytes = nullptr;
+
+	delete[] m_stamps;
+	m_stamps = nullptr;
+}
+
+/*
+ *	\brief Allocate the ring and empty it, only while neither thread is using it
+*/
+void CAudioRing::Create(
+		unsigned int capacity,						//!< The number of bytes held, a power of two
+		unsigned int blockAlign						//!< The bytes in a sample of every channel, dividing the capacity
+	)
+{
+	delete[] m_bytes;
+	m_bytes = new std::atomic<unsigned char>[capacity];
+	for (unsigned int byte = 0; byte < capacity; ++byte)
+	{
+		m_bytes[byte].store(0, std::memory_order_relaxed);
+	}
+
+	m_mask = capacity - 1;
+	m_blockAlign = blockAlign;
+	m_readPosition = 0;
+	m_writePosition = 0;
+	m_waiting = false;
+	m_closed = false;
+
+	delete[] m_stamps;
+	m_stampCount = (capacity + StampBytes - 1) / StampBytes;
+	m_stamps = new std::atomic<unsigned int>[m_stampCount];
+	m_created = std::chrono::steady_clock::now();
+	for (unsigned int stamp = 0; stamp < m_stampCount; ++stamp)
+	{
+		m_stamps[stamp] = 0;
+	}
+
+	m_bytesWritten = 0;
+	m_bytesRead = 0;
+	m_bytesDropped = 0;
+	m_overruns = 0;
+	m_fullest = 0;
+	for (unsigned int bucket = 0; bucket < OccupancyBuckets; ++bucket)
+	{
+		m_occupancy[bucket] = 0;
+	}
+
+	m_readLatency.Reset();
+}
+
+/*
+ *	\brief Add captured bytes, overwriting the oldest unread bytes when there isn't room. Only call from the capture thread
+*/
+void CAudioRing::Write(
+		const unsigned char *data,					//!< The bytes, whole samples
+		unsigned int bytes							//!< The number of bytes
+	)
+{
+	if (bytes == 0)
+		return;
+
+	// more than the ring holds, only the newest of them can be kept
+	const unsigned int given = bytes;
+	const unsigned int capacity = m_mask + 1;
+	unsigned int dropped = 0;
+	if (bytes > capacity)
+	{
+		dropped = bytes - capacity;
+		data += dropped;
+		bytes -= dropped;
+	}
+
+	// make room by moving the reader past the oldest bytes, in whole samples, before they are overwritten.
+	// A reader part way through a sample may need more dropped than is unread, the rest comes off the new bytes
+	const unsigned int write = m_writePosition.load(std::memory_order_relaxed);
+	unsigned int read = m_readPosition.load(std::memory_order_acquire);
+	unsigned int skipped = 0;
+	while (write + bytes - read > capacity)
+	{
+		const unsigned int unread = write - read;
+		const unsigned int overflow = write + bytes - read - capacity;
+		const unsigned int overwritten = ((overflow + m_blockAlign - 1) / m_blockAlign) * m_blockAlign;
+		const unsigned int passed = overwritten < unread ? overwritten : unread;
+
+		if (m_readPosition.compare_exchange_weak(read, read + passed, std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			skipped = overwritten - passed;
+			dropped += overwritten;
+			break;
+		}
+	}
+
+	data += skipped;
+	bytes -= skipped;
+
+	const unsigned int start = write & m_mask;
+	CopyIn(write, data, bytes);
+
+	// stamp every stretch the bytes landed in, they are published to the reader with the position
+	if (bytes != 0)
+	{
+		const unsigned int now = GetMicroseconds();
+		const unsigned int firstStamp = start / StampBytes;
+		const unsigned int stamps = (((start % StampBytes) + bytes - 1) / StampBytes) + 1;
+		for (unsigned int stamp = 0; stamp < stamps; ++stamp)
+		{
+			m_stamps[(firstStamp + stamp) % m_stampCount].store(now, std::memory_order_relaxed);
+		}
+	}
+
+	m_writePosition.store(write + bytes);
+	WakeReader();
+
+	CountWrite(given, dropped, write + bytes - m_readPosition.load(std::memory_order_acquire));
+}
+
+/*
+ *	\brief Copy out up to a number of the oldest unread bytes, returning how many were copied. Only call from the reader
+*/
+unsigned int CAudioRing::Read(
+		unsigned char *data,						//!< Receives the bytes
+		unsigned int bytes							//!< The most bytes to copy
+	)
+{
+	const unsigned int capacity = m_mask + 1;
+	for (;;)
+	{
+		unsigned int read = m_readPosition.load(std::memory_order_acquire);
+		const unsigned int available = m_writePosition.load(std::memory_order_acquire) - read;
+
+		// the capture thread overwrote past the position just loaded, load it again
+		if (available > capacity)
+			continue;
+
+		const unsigned int count = available < bytes ? available : bytes;
+		if (count == 0)
+			return 0;
+
+		const unsigned int start = read & m_mask;
+		CopyOut(read, data, count);
+		const unsigned int written = m_stamps[start / StampBytes].load(std::memory_order_relaxed);
+
+		// the copy only holds if the capture thread didn't move the position to overwrite the bytes meanwhile
+		if (m_readPosition.compare_exchange_strong(read, read + count, std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			m_bytesRead += count;
+			m_readLatency.Add(GetMicroseconds() - written);
+			return count;
+		}
+	}
+}
+
+/*
+ *	\brief Wait until there are bytes to read, the ring is closed or the time is up, true if there are bytes. Only call from the reader
+*/
+bool CAudioRing::Wait(
+		unsigned int milliseconds					//!< The longest time to wait, or Forever
+	)
+{
+	if (GetSize() != 0)
+		return true;
+
+	// the capture thread stores its position then checks for a waiting reader, the reader marks itself waiting
+	// then checks the position, so one of them always sees the other
+	std::unique_lock<std::mutex> lock(m_wakeMutex);
+	m_waiting = true;
+
+	auto ready = [this]() {
+		return m_writePosition.load() != m_readPosition.load() || m_closed;
+	};
+
+	if (milliseconds == Forever)
+	{
+		m_wake.wait(lock, ready);
+	}
+	else
+	{
+		m_wake.wait_for(lock, std::chrono::milliseconds(milliseconds), ready);
+	}
+
+	m_waiting = false;
+	return GetSize() != 0;
+}
+
+/*
+ *	\brief Wake the reader for good, once nothing more will be written
+*/
+void CAudioRing::Close()
+{
+	m_closed = true;
+
+	std::lock_guard<std::mutex> lock(m_wakeMutex);
+	m_wake.notify_all();
+}
+
+/*
+ *	\brief Copy bytes into the ring from a position, wrapping at its end
+*/
+void CAudioRing::CopyIn(
+		unsigned int position,						//!< The position of the first byte
+		const unsigned char *data,					//!< The bytes
+		unsigned int bytes							//!< The number of bytes
+	)
+{
+	// the acquire of the swap which made room keeps these stores after it
+	for (unsigned int byte = 0; byte < bytes; ++byte)
+	{
+		m_bytes[(position + byte) & m_mask].store(data[byte], std::memory_order_relaxed);
+	}
+}
+
+/*
+ *	\brief Copy bytes out of the ring from a position, wrapping at its end
+*/
+void CAudioRing::CopyOut(
+		unsigned int position,						//!< The position of the first byte
+		unsigned char *data,						//!< Receives the bytes
+		unsigned int bytes							//!< The number of bytes
+	) const
+{
+	// the release of the reader's swap keeps these loads before it
+	for (unsigned int byte = 0; byte < bytes; ++byte)
+	{
+		data[byte] = m_bytes[(position + byte) & m_mask].load(std::memory_order_relaxed);
+	}
+}
+
+/*
+ *	\brief Wake the reader if it is waiting
+*/
+void CAudioRing::WakeReader()
+{
+	// the reader holds the mutex from its last check until it sleeps, taking it here means the wake can't land in between
+	if (m_waiting)
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_wake.notify_one();
+	}
+}
+
+/*
+ *	\brief Get the time since the ring was created, in microseconds, wrapping after about 71 minutes
+*/
+unsigned int CAudioRing::GetMicroseconds() const
+{
+	// only differences of a few seconds are taken, which the wrap doesn't change
+	return static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_created).count());
+}
+
+/*
+ *	\brief Count a write, how full it left the ring and how much it dropped
+*/
+void CAudioRing::CountWrite(
+		unsigned int bytes,							//!< The number of bytes given to write
+		unsigned int dropped,						//!< The number of them, or of the unread bytes, dropped
+		unsigned int unread							//!< The number of unread bytes the write left
+	)
+{
+	m_bytesWritten += bytes;
+	if (dropped != 0)
+	{
+		m_bytesDropped += dropped;
+		m_overruns++;
+	}
+
+	// only the capture thread writes the fullest, so it needs no compare and swap
+	if (unread > m_fullest)
+	{
+		m_fullest = unread;
+	}
+
+	const unsigned long long bucket = (static_cast<unsigned long long>(unread) * OccupancyBuckets) / (m_mask + 1);
+	m_occupancy[bucket < OccupancyBuckets ? bucket : OccupancyBuckets - 1]++;
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "CLatencyHistogram.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+/*
+ *	\brief A fixed ring of captured audio bytes between one capture thread and one reader.
+ *	The capture thread writes without ever waiting; when the reader falls a whole ring
+ *	behind, the oldest bytes are overwritten, and dropped a whole sample at a time so the
+ *	reader stays on a sample boundary, though a reader part way through a sample then gets
+ *	the rest of a later one. Neither side takes a lock to move bytes. A reader
+ *	with nothing to read can wait, the capture thread only wakes it when it is waiting.
+ *
+ *	Both sides move the read position, the reader past what it read and the capture
+ *	thread past what it overwrites, each with a compare and swap. The capture thread moves
+ *	it before overwriting, so a reader which copied bytes as they were overwritten fails
+ *	its swap, throws the copy away and reads again from the new position. The bytes are
+ *	atomics, copied one at a time with relaxed loads and stores, so a copy which overlaps
+ *	an overwrite only ever sees stale or new bytes and is never a data race. The swaps
+ *	order the copies: a reader whose swap succeeds copied before the overwrite began.
+ *
+ *	The ring counts the bytes written, read and dropped, how full each write left it, and
+ *	how long the oldest byte of each read had waited since it was written. Every stretch
+ *	of StampBytes holds the time it was last written, so the wait is measured to within
+ *	that much audio. The counts can be read from any thread.
+*/
+class CAudioRing {
+public:
+	static const unsigned int		Forever = ~0u;						//!< Wait until there is something to read or the ring is closed
+	static const unsigned int		StampBytes = 256;					//!< The bytes of the ring sharing one write time, 8 milliseconds of the kinect's audio
+	static const unsigned int		OccupancyBuckets = 8;				//!< The number of equal parts of the ring writes are counted by how full they left it
+
+private:
+	std::atomic<unsigned char>		*m_bytes;							//!< The ring, indexed by position modulo its size
+	unsigned int					m_mask;								//!< The size of the ring less one, the size is a power of two
+	unsigned int					m_blockAlign;						//!< The bytes in a sample of every channel, the oldest bytes are dropped in whole samples
+
+	std::atomic<unsigned int>		m_readPosition;						//!< The number of bytes ever read or overwritten
+	std::atomic<unsigned int>		m_writePosition;					//!< The number of bytes ever written, only written by the capture thread
+	std::atomic<bool>				m_waiting;							//!< Is the reader waiting for bytes
+	std::atomic<bool>				m_closed;							//!< Has the capture stopped, a waiting reader gives up
+
+	std::mutex						m_wakeMutex;						//!< Guards the reader's check before it sleeps, so a wake can't be missed
+	std::condition_variable			m_wake;								//!< Wakes the waiting reader
+
+	std::chrono::steady_clock::time_point	m_created;					//!< When the ring was created, the write times count from it
+	std::atomic<unsigned int>		*m_stamps;							//!< When each StampBytes of the ring were last written, in microseconds since creation
+	unsigned int					m_stampCount;						//!< The number of write times
+
+	std::atomic<unsigned long long>	m_bytesWritten;						//!< The number of bytes given to write, kept or not
+	std::atomic<unsigned long long>	m_bytesRead;						//!< The number of bytes read
+	std::atomic<unsigned long long>	m_bytesDropped;						//!< The number of bytes given to write which were never read, overwritten or skipped
+	std::atomic<unsigned long long>	m_overruns;							//!< The number of writes which dropped bytes
+	std::atomic<unsigned int>		m_fullest;							//!< The most unread bytes a write left
+	std::atomic<unsigned int>		m_occupancy[OccupancyBuckets];		//!< The number of writes which left the ring filled to each part
+	CLatencyHistogram				m_readLatency;						//!< How long the oldest byte of each read had waited since it was written
+
+private:
+									//! Copy bytes into the ring from a position, wrapping at its end
+	void							CopyIn(
+										unsigned int position,			//!< The position of the first byte
+										const unsigned char *data,		//!< The bytes
+										unsigned int bytes				//!< The number of bytes
+									);
+
+									//! Copy bytes out of the ring from a position, wrapping at its end
+	void							CopyOut(
+										unsigned int position,			//!< The position of the first byte
+										unsigned char *data,			//!< Receives the bytes
+										unsigned int bytes				//!< The number of bytes
+									) const;
+
+									//! Wake the reader if it is waiting
+	void							WakeReader();
+
+									//! Get the time since the ring was created, in microseconds, wrapping after about 71 minutes
+	unsigned int					GetMicroseconds() const;
+
+									//! Count a write, how full it left the ring and how much it dropped
+	void							CountWrite(
+										unsigned int bytes,				//!< The number of bytes given to write
+										unsigned int dropped,			//!< The number of them, or of the unread bytes, dropped
+										unsigned int unread				//!< The number of unread bytes the write left
+									);
+
+public:
+									//! Class constructor
+									CAudioRing();
+
+									//! Class destructor
+									~CAudioRing();
+
+									//! Allocate the ring, empty it and zero its counts, only while neither thread is using it
+	void							Create(
+										unsigned int capacity,			//!< The number of bytes held, a power of two
+										unsigned int blockAlign			//!< The bytes in a sample of every channel, dividing the capacity
+									);
+
+									//! Add captured bytes, overwriting the oldest unread bytes when there isn't room. Only call from the capture thread
+	void							Write(
+										const unsigned char *data,		//!< The bytes, whole samples
+										unsigned int bytes				//!< The number of bytes
+									);
+
+									//! Copy out up to a number of the oldest unread bytes, returning how many were copied. Only call from the reader
+	unsigned int					Read(
+										unsigned char *data,			//!< Receives the bytes
+										unsigned int bytes				//!< The most bytes to copy
+									);
+
+									//! Wait until there are bytes to read, the ring is closed or the time is up, true if there are bytes. Only call from the reader
+	bool							Wait(
+										unsigned int milliseconds		//!< The longest time to wait, or Forever
+									);
+
+									//! Wake the reader for good, once nothing more will be written
+	void							Close();
+
+									//! Get the number of bytes held
+	unsigned int					GetCapacity() const
+									{
+										return m_mask + 1;
+									}
+
+									//! Get the number of unread bytes, which may already be out of date on the other thread
+	unsigned int					GetSize() const
+									{
+										// the read position first, it never passes a write position loaded after it
+										const unsigned int read = m_readPosition.load(std::memory_order_acquire);
+										return m_writePosition.load(std::memory_order_acquire) - read;
+									}
+
+									//! Has the ring been closed
+	bool							IsClosed() const
+									{
+										return m_closed;
+									}
+
+									//! Get the number of bytes given to write, including those dropped
+	unsigned long long				GetBytesWritten() const
+									{
+										return m_bytesWritten;
+									}
+
+									//! Get the number of bytes read
+	unsigned long long				GetBytesRead() const
+									{
+										return m_bytesRead;
+									}
+
+									//! Get the number of bytes written which will never be read, because the reader fell a ring behind
+	unsigned long long				GetBytesDropped() const
+									{
+										return m_bytesDropped;
+									}
+
+									//! Get the number of writes which dropped bytes
+	unsigned long long				GetOverruns() const
+									{
+										return m_overruns;
+									}
+
+									//! Get the most unread bytes a write has left
+	unsigned int					GetFullest() const
+									{
+										return m_fullest;
+									}
+
+									//! Get the number of writes which left the ring filled to a part of it, the last part also holds a full ring
+	unsigned int					GetOccupancyCount(
+										unsigned int bucket				//!< The part, each the capacity over OccupancyBuckets
+									) const
+									{
+										return m_occupancy[bucket];
+									}
+
+									//! Get how long the oldest byte of each read had waited since it was written
+	const CLatencyHistogram			&GetReadLatency() const
+									{
+										return m_readLatency;
+									}
+};
@@ -0,0 +1,245 @@
+#include "CBlobLabeller.h"
+
+/*
+ *	\brief Class constructor
+*/
+CBlobLabeller::CBlobLabeller() :
+	m_width(0),
+	m_height(0)
+{
+	const MaskArea emptyArea = { 0, 0, 0, 0 };
+	m_area = emptyArea;
+}
+
+/*
+ *	\brief Class destructor
+*/
+CBlobLabeller::~CBlobLabeller()
+{
+
+}
+
+/*
+ *	\brief Allocate the label buffer for a given mask size
+*/
+void CBlobLabeller::Create(
+		unsigned int width,							//!< The number of pixels in a row of the mask
+		unsigned int height							//!< The number of rows in the mask
+	)
+{
+	m_width = width;
+	m_height = height;
+	m_labels.assign(width * height, 0);
+
+	// a checkerboard is the worst case, but a few thousand labels covers real masks
+	m_parents.reserve(4096);
+	m_moments.reserve(4096);
+	m_blobNumbers.reserve(4096);
+}
+
+/*
+ *	\brief Start a new provisional label
+*/
+unsigned int CBlobLabeller::NewLabel()
+{
+	const unsigned int label = static_cast<unsigned int>(m_parents.size());
+	m_parents.push_back(label);
+
+	const Moments empty = { 0, { m_width, m_height, 0, 0 }, 0.0, 0.0, 0.0, 0.0, 0.0 };
+	m_moments.push_back(empty);
+
+	return label;
+}
+
+/*
+ *	\brief Find the root label of the set a label belongs to
+*/
+unsigned int CBlobLabeller::FindRoot(
+		unsigned int label							//!< The label to find the root of
+	)
+{
+	// halve the path on the way up so later finds are shorter
+	while (m_parents[label] != label)
+	{
+		m_parents[label] = m_parents[m_parents[label]];
+		label = m_parents[label];
+	}
+
+	return label;
+}
+
+/*
+ *	\brief Join the sets two labels belong to, the lower root becomes the root
+*/
+unsigned int CBlobLabeller::Join(
+		unsigned int first,							//!< A label in the first set
+		unsigned int second							//!< A label in the second set
+	)
+{
+	const unsigned int firstRoot = FindRoot(first);
+	const unsigned int secondRoot = FindRoot(second);
+
+	if (firstRoot < secondRoot)
+	{
+		m_parents[secondRoot] = firstRoot;
+		return firstRoot;
+	}
+
+	m_parents[firstRoot] = secondRoot;
+	return secondRoot;
+}
+
+/*
+ *	\brief Label the blobs of an area of the mask, returning the number of blobs found
+*/
+unsigned int CBlobLabeller::Label(
+		const unsigned char *mask,					//!< The mask, non zero pixels are labelled
+		const MaskArea &area,						//!< The area of the mask to label, pixels outside it are ignored
+		unsigned int minimumArea					//!< Blobs with fewer pixels than this are dropped
+	)
+{
+	m_area = area;
+	if (m_area.right > m_width) m_area.right = m_width;
+	if (m_area.bottom > m_height) m_area.bottom = m_height;
+
+	m_parents.clear();
+	m_moments.clear();
+	m_blobs.clear();
+
+	if (m_area.IsEmpty())
+		return 0;
+
+	// label 0 is the background
+	NewLabel();
+
+	// first pass, provisional labels from the west, north west, north and north east neighbours
+	for (unsigned int y = m_area.top; y < m_area.bottom; ++y)
+	{
+		const unsigned char *maskRow = mask + (y * m_width);
+		unsigned int *labelRow = &m_labels[y * m_width];
+		const unsigned int *aboveRow = y > m_area.top ? labelRow - m_width : nullptr;
+
+		for (unsigned int x = m_area.left; x < m_area.right; ++x)
+		{
+			if (maskRow[x] == 0)
+			{
+				labelRow[x] = 0;
+				continue;
+			}
+
+			const unsigned int west = x > m_area.left ? labelRow[x - 1] : 0;
+			const unsigned int northWest = aboveRow != nullptr && x > m_area.left ? aboveRow[x - 1] : 0;
+			const unsigned int north = aboveRow != nullptr ? aboveRow[x] : 0;
+			const unsigned int northEast = aboveRow != nullptr && x + 1 < m_area.right ? aboveRow[x + 1] : 0;
+
+			// the west and north west pixels already touch the north pixel, and each
+			// other, so only the north east can bring a new set into contact
+			unsigned int label;
+			if (north != 0)
+			{
+				label = north;
+			}
+			else if (northEast != 0)
+			{
+				label = northEast;
+				if (west != 0) Join(west, northEast);
+				else if (northWest != 0) Join(northWest, northEast);
+			}
+			else if (west != 0)
+			{
+				label = west;
+			}
+			else if (northWest != 0)
+			{
+				label = northWest;
+			}
+			else
+			{
+				label = NewLabel();
+			}
+
+			labelRow[x] = label;
+
+			Moments &moments = m_moments[label];
+			moments.area++;
+			if (x < moments.bounds.left) moments.bounds.left = x;
+			if (x >= moments.bounds.right) moments.bounds.right = x + 1;
+			if (y < moments.bounds.top) moments.bounds.top = y;
+			moments.bounds.bottom = y + 1;
+			moments.sumX += x;
+			moments.sumY += y;
+			moments.sumXX += static_cast<double>(x) * x;
+			moments.sumYY += static_cast<double>(y) * y;
+			moments.sumXY += static_cast<double>(x) * y;
+		}
+	}
+
+	// merge the moments of each label into its root, roots are always the lowest label of a set
+	const unsigned int labelCount = static_cast<unsigned int>(m_parents.size());
+	m_blobNumbers.assign(labelCount, 0);
+
+	for (unsigned int label = 1; label < labelCount; ++label)
+	{
+		const unsigned int root = FindRoot(label);
+		if (root == label)
+			continue;
+
+		m_parents[label] = root;
+
+		const Moments &from = m_moments[label];
+		Moments &to = m_moments[root];
+		to.area += from.area;
+		if (from.bounds.left < to.bounds.left) to.bounds.left = from.bounds.left;
+		if (from.bounds.right > to.bounds.right) to.bounds.right = from.bounds.right;
+		if (from.bounds.top < to.bounds.top) to.bounds.top = from.bounds.top;
+		if (from.bounds.bottom > to.bounds.bottom) to.bounds.bottom = from.bounds.bottom;
+		to.sumX += from.sumX;
+		to.sumY += from.sumY;
+		to.sumXX += from.sumXX;
+		to.sumYY += from.sumYY;
+		to.sumXY += from.sumXY;
+	}
+
+	// number the roots large enough to keep as blobs, every other label now points straight at its root
+	for (unsigned int label = 1; label < labelCount; ++label)
+	{
+		const unsigned int root = m_parents[label];
+		if (root != label)
+		{
+			m_blobNumbers[label] = m_blobNumbers[root];
+			continue;
+		}
+
+		const Moments &moments = m_moments[label];
+		if (moments.area < minimumArea)
+			continue;
+
+		const double area = moments.area;
+		const double centroidX = moments.sumX / area;
+		const double centroidY = moments.sumY / area;
+
+		MaskBlob blob;
+		blob.area = moments.area;
+		blob.bounds = moments.bounds;
+		blob.centroidX = static_cast<float>(centroidX);
+		blob.centroidY = static_cast<float>(centroidY);
+		blob.varianceX = static_cast<float>((moments.sumXX / area) - (centroidX * centroidX));
+		blob.varianceY = static_cast<float>((moments.sumYY / area) - (centroidY * centroidY));
+		blob.covariance = static_cast<float>((moments.sumXY / area) - (centroidX * centroidY));
+
+		m_blobs.push_back(blob);
+		m_blobNumbers[label] = static_cast<unsigned int>(m_blobs.size());
+	}
+
+	// second pass, replace the provisional labels with blob numbers
+	for (unsigned int y = m_area.top; y < m_area.bottom; ++y)
+	{
+		unsigned int *labelRow = &m_labels[y * m_width];
+		for (unsigned int x = m_area.left; x < m_area.right; ++x)
+		{
+			labelRow[x] = m_blobNumbers[labelRow[x]];
+		}
+	}
+
+	return static_cast<unsigned int>(m_blobs.size());
+}
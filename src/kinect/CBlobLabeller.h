@@ -0,0 +1,107 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "DepthBand.h"
+#include <vector>
+
+/*
+ *	\brief A connected blob of mask pixels
+*/
+struct MaskBlob
+{
+	unsigned int			area;								//!< The number of pixels in the blob
+	MaskArea				bounds;								//!< The bounding box of the blob
+	float					centroidX;							//!< The mean column of the blob's pixels
+	float					centroidY;							//!< The mean row of the blob's pixels
+	float					varianceX;							//!< The second central moment of the columns, over the area
+	float					varianceY;							//!< The second central moment of the rows, over the area
+	float					covariance;							//!< The second central moment of the columns and rows, over the area
+};
+
+/*
+ *	\brief Labels the 8-connected blobs of a one byte mask with a two pass union-find.
+ *	The first pass gives each pixel a provisional label from its already visited
+ *	neighbours, joining labels which meet, and accumulates the area, bounds and
+ *	moments of each label. The label sets are then merged into blobs and the second
+ *	pass rewrites the pixels with their blob number. Blobs are numbered in the order
+ *	their first pixel is met, scanning rows top to bottom.
+*/
+class CBlobLabeller {
+private:
+
+	struct Moments
+	{
+		unsigned int			area;							//!< The number of pixels given the label
+		MaskArea				bounds;							//!< The bounding box of the pixels
+		double					sumX;							//!< The sum of the columns
+		double					sumY;							//!< The sum of the rows
+		double					sumXX;							//!< The sum of the squared columns
+		double					sumYY;							//!< The sum of the squared rows
+		double					sumXY;							//!< The sum of the columns times the rows
+	};
+
+private:
+	unsigned int				m_width;						//!< The number of pixels in a row of the mask
+	unsigned int				m_height;						//!< The number of rows in the mask
+	MaskArea					m_area;							//!< The area of the mask labelled last
+	std::vector<unsigned int>	m_labels;						//!< The label of each pixel, 0 for the background
+	std::vector<unsigned int>	m_parents;						//!< The union-find parent of each provisional label
+	std::vector<Moments>		m_moments;						//!< The accumulated moments of each provisional label
+	std::vector<unsigned int>	m_blobNumbers;					//!< The blob number of each provisional label, 0 if it was too small
+	std::vector<MaskBlob>		m_blobs;						//!< The blobs found in the mask
+
+private:
+								//! Start a new provisional label
+	unsigned int				NewLabel();
+
+								//! Find the root label of the set a label belongs to
+	unsigned int				FindRoot(
+									unsigned int label			//!< The label to find the root of
+								);
+
+								//! Join the sets two labels belong to, the lower root becomes the root
+	unsigned int				Join(
+									unsigned int first,			//!< A label in the first set
+									unsigned int second			//!< A label in the second set
+								);
+
+public:
+								//! Class constructor
+								CBlobLabeller();
+
+								//! Class destructor
+								~CBlobLabeller();
+
+								//! Allocate the label buffer for a given mask size
+	void						Create(
+									unsigned int width,			//!< The number of pixels in a row of the mask
+									unsigned int height			//!< The number of rows in the mask
+								);
+
+								//! Label the blobs of an area of the mask, returning the number of blobs found
+	unsigned int				Label(
+									const unsigned char *mask,	//!< The mask, non zero pixels are labelled
+									const MaskArea &area,		//!< The area of the mask to label, pixels outside it are ignored
+									unsigned int minimumArea	//!< Blobs with fewer pixels than this are dropped
+								);
+
+								//! Get the blobs found by the last label
+	const std::vector<MaskBlob>	&GetBlobs() const
+								{
+									return m_blobs;
+								}
+
+								//! Get the blob number of a pixel, 1 for the first blob and 0 for none
+	unsigned int				GetBlobNumber(
+									unsigned int x,				//!< The column of the pixel
+									unsigned int y				//!< The row of the pixel
+								) const
+								{
+									if (x < m_area.left || x >= m_area.right || y < m_area.top || y >= m_area.bottom)
+										return 0;
+
+									return m_labels[(y * m_width) + x];
+								}
+};
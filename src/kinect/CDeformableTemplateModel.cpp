@@ -1,10 +1,30 @@
 #include "CDeformableTemplateModel.h"
+#include "DistanceTransform.h"
+#include <float.h>
+#include <math.h>
 
-CDeformableTemplateModel::CDeformableTemplateModel()
+// edges further from an outline point than this, in pixels, count as this far so one bad point can't sink a pose
+static const float TRUNCATE_DISTANCE = 8.0f;
+
+// the coarse search covers a quarter of the hand area's width either side of the guessed position,
+// at this step in pixels, halved down to a pixel as it refines, and these scales either side of the guessed scale
+static const float SEARCH_RADIUS = 0.25f;
+static const int COARSE_STEP = 4;
+static const float COARSE_SCALES[] = { 0.75f, 0.85f, 0.95f, 1.05f, 1.15f, 1.25f };
+
+// the coarse step is halved this many times, refining the best candidates with every point
+static const unsigned int REFINE_LEVELS = 2;
+static const unsigned int CANDIDATES = 4;
+
+CDeformableTemplateModel::CDeformableTemplateModel(
+		float matchDistance
+	) :
+	m_left(0.0f),
+	m_right(0.0f),
+	m_top(0.0f),
+	m_matchDistance(matchDistance)
 {
-	m_center.color.Set(0, 0, 0);
-	m_center.position.Set(0, 0);
-	m_center.tolerance = 0;
+
 }
 
 CDeformableTemplateModel::~CDeformableTemplateModel()
@@ -12,87 +32,372 @@ CDeformableTemplateModel::~CDeformableTemplateModel()
 
 }
 
-void CDeformableTemplateModel::SetCenterPoint( 
-		SAM::TVector<float, 2> position, 
-		SAM::TVector<BYTE, 3> color, 
-		unsigned int tolerance 
+void CDeformableTemplateModel::AddCapsule(
+		float startX,
+		float startY,
+		float endX,
+		float endY,
+		float radius
 	)
 {
-	m_center.color = color;
-	m_center.position = position;
-	m_center.tolerance = tolerance;
+	TemplateCapsule capsule;
+	capsule.start.x = startX;
+	capsule.start.y = startY;
+	capsule.end.x = endX;
+	capsule.end.y = endY;
+	capsule.radius = radius;
+	m_capsules.push_back(capsule);
+}
+
+bool CDeformableTemplateModel::IsInsideOtherCapsule(
+		const TemplatePoint &point,
+		unsigned int capsule
+	) const
+{
+	for (unsigned int other = 0; other < m_capsules.size(); ++other)
+	{
+		if (other == capsule)
+			continue;
+
+		const TemplateCapsule &shape = m_capsules[other];
+		const float spineX = shape.end.x - shape.start.x;
+		const float spineY = shape.end.y - shape.start.y;
+		const float lengthSquared = (spineX * spineX) + (spineY * spineY);
+
+		float along = lengthSquared > 0.0f ? (((point.x - shape.start.x) * spineX) + ((point.y - shape.start.y) * spineY)) / lengthSquared : 0.0f;
+		along = along < 0.0f ? 0.0f : along > 1.0f ? 1.0f : along;
+
+		const float offsetX = point.x - (shape.start.x + (spineX * along));
+		const float offsetY = point.y - (shape.start.y + (spineY * along));
+		const float inside = shape.radius * 0.98f;
+		if ((offsetX * offsetX) + (offsetY * offsetY) < inside * inside)
+			return true;
+	}
+
+	return false;
 }
 
+void CDeformableTemplateModel::BuildOutline(
+		float spacing
+	)
+{
+	static const float Pi = 3.14159265f;
+
+	m_points.clear();
+	m_coarsePoints.clear();
+
+	for (unsigned int capsule = 0; capsule < m_capsules.size(); ++capsule)
+	{
+		const TemplateCapsule &shape = m_capsules[capsule];
+		const float spineX = shape.end.x - shape.start.x;
+		const float spineY = shape.end.y - shape.start.y;
+		const float length = sqrt((spineX * spineX) + (spineY * spineY));
+
+		// a capsule with no length is a circle, its caps meet whichever way the spine points
+		const float directionX = length > 0.0f ? spineX / length : 0.0f;
+		const float directionY = length > 0.0f ? spineY / length : 1.0f;
+		const float directionAngle = atan2(directionY, directionX);
+
+		std::vector<TemplatePoint> boundary;
+
+		// the two straight sides
+		const unsigned int sideSteps = static_cast<unsigned int>(ceil(length / spacing));
+		for (unsigned int step = 0; step < sideSteps; ++step)
+		{
+			const float along = (length * step) / sideSteps;
+			for (int side = -1; side <= 1; side += 2)
+			{
+				TemplatePoint point;
+				point.x = shape.start.x + (directionX * along) - (directionY * shape.radius * side);
+				point.y = shape.start.y + (directionY * along) + (directionX * shape.radius * side);
+				boundary.push_back(point);
+			}
+		}
+
+		// the round caps, the end cap facing along the spine and the start cap facing back
+		const unsigned int capSteps = static_cast<unsigned int>(ceil((Pi * shape.radius) / spacing));
+		for (unsigned int step = 0; step < capSteps; ++step)
+		{
+			const float angle = (Pi * step) / capSteps - (Pi * 0.5f);
+
+			TemplatePoint endPoint;
+			endPoint.x = shape.end.x + (cos(directionAngle + angle) * shape.radius);
+			endPoint.y = shape.end.y + (sin(directionAngle + angle) * shape.radius);
+			boundary.push_back(endPoint);
+
+			TemplatePoint startPoint;
+			startPoint.x = shape.start.x - (cos(directionAngle + angle) * shape.radius);
+			startPoint.y = shape.start.y - (sin(directionAngle + angle) * shape.radius);
+			boundary.push_back(startPoint);
+		}
+
+		// only the parts of the boundary which aren't covered by the rest of the shape are outline
+		for (unsigned int point = 0; point < boundary.size(); ++point)
+		{
+			if (!IsInsideOtherCapsule(boundary[point], capsule))
+			{
+				m_points.push_back(boundary[point]);
+			}
+		}
+	}
 
-void CDeformableTemplateModel::AddPoint(
-		SAM::TVector<float, 2> position,
-		SAM::TVector<BYTE, 3> color,
-		unsigned int tolerance
+	m_left = FLT_MAX;
+	m_right = -FLT_MAX;
+	m_top = FLT_MAX;
+	for (unsigned int point = 0; point < m_points.size(); ++point)
+	{
+		if (m_points[point].x < m_left) m_left = m_points[point].x;
+		if (m_points[point].x > m_right) m_right = m_points[point].x;
+		if (m_points[point].y < m_top) m_top = m_points[point].y;
+
+		if (point % 4 == 0)
+		{
+			m_coarsePoints.push_back(m_points[point]);
+		}
+	}
+}
+
+void CDeformableTemplateModel::PlacePoints(
+		const std::vector<TemplatePoint> &points,
+		float scale,
+		std::vector<PixelOffset> &offsets
 	)
 {
-	SamplePoint newSamplePoint;
-	newSamplePoint.position = position;
-	newSamplePoint.color = color;
-	newSamplePoint.tolerance = tolerance;
-	m_points.push_back(newSamplePoint);
+	offsets.resize(points.size());
+	for (unsigned int point = 0; point < points.size(); ++point)
+	{
+		offsets[point].x = static_cast<int>(floor((points[point].x * scale) + 0.5f));
+		offsets[point].y = static_cast<int>(floor((points[point].y * scale) + 0.5f));
+	}
 }
 
-bool CDeformableTemplateModel::Test( 
-		RGBQUAD *data,
+float CDeformableTemplateModel::Score(
+		const unsigned short *distance,
 		unsigned int width,
-		unsigned int height,
-		SAM::TVector<unsigned int, 4> &area
+		const MaskArea &area,
+		const std::vector<PixelOffset> &offsets,
+		int x,
+		int y,
+		float bound
+	) const
+{
+	static const unsigned int Truncate = static_cast<unsigned int>(TRUNCATE_DISTANCE) * DISTANCE_UNITS_PER_PIXEL;
+
+	// the mean over the points inside the area is at least the sum over every point, so stop once that passes the bound
+	const float limit = bound * DISTANCE_UNITS_PER_PIXEL * offsets.size();
+
+	// move the area rather than each point
+	const int left = static_cast<int>(area.left) - x;
+	const int right = static_cast<int>(area.right) - x;
+	const int top = static_cast<int>(area.top) - y;
+	const int bottom = static_cast<int>(area.bottom) - y;
+	const int origin = (y * static_cast<int>(width)) + x;
+
+	unsigned int sum = 0;
+	unsigned int counted = 0;
+	for (unsigned int point = 0; point < offsets.size(); ++point)
+	{
+		const PixelOffset &offset = offsets[point];
+		if (offset.x < left || offset.x >= right || offset.y < top || offset.y >= bottom)
+			continue;
+
+		const unsigned int pointDistance = distance[origin + (offset.y * static_cast<int>(width)) + offset.x];
+		sum += pointDistance < Truncate ? pointDistance : Truncate;
+		counted++;
+
+		if (sum > limit)
+			return FLT_MAX;
+	}
+
+	// a pose with most of the outline off the hand area says little about the hand
+	if (counted * 2 < offsets.size())
+		return FLT_MAX;
+
+	return static_cast<float>(sum) / (counted * DISTANCE_UNITS_PER_PIXEL);
+}
+
+void CDeformableTemplateModel::KeepBest(
+		std::vector<Candidate> &best,
+		const Candidate &candidate
 	)
 {
-	if (m_points.empty())
-		return false;
+	if (best.size() == CANDIDATES && candidate.score >= best.back().score)
+		return;
+
+	// neighbouring candidates refine to the same poses, only keep each pose once
+	for (unsigned int index = 0; index < best.size(); ++index)
+	{
+		if (best[index].x == candidate.x && best[index].y == candidate.y && fabs(best[index].scale - candidate.scale) < 0.001f)
+			return;
+	}
 
-	int handWidth = 0; //area[HandAreaSamplePoint::Right] - area[HandAreaSamplePoint::Left];
-	int handHeight = 0; //area[HandAreaSamplePoint::Bottom] - area[HandAreaSamplePoint::Top];
+	// insert in order, dropping the worst once the list is full
+	std::vector<Candidate>::iterator position = best.begin();
+	while (position != best.end() && position->score <= candidate.score)
+	{
+		++position;
+	}
 
-	for (int xoffset = 0; xoffset < handWidth; ++xoffset)
+	best.insert(position, candidate);
+	if (best.size() > CANDIDATES)
 	{
-		for (int yoffset = 0; yoffset < handHeight; ++yoffset)
+		best.pop_back();
+	}
+}
+
+float CDeformableTemplateModel::ScoreEdges(
+		const unsigned char *edges,
+		unsigned int width,
+		const MaskArea &area,
+		const Candidate &pose
+	)
+{
+	static const unsigned int Truncate = static_cast<unsigned int>(TRUNCATE_DISTANCE) * DISTANCE_UNITS_PER_PIXEL;
+
+	const unsigned int areaWidth = area.right - area.left;
+	const unsigned int areaHeight = area.bottom - area.top;
+	const MaskArea wholeArea = { 0, 0, areaWidth, areaHeight };
+
+	m_outlineMask.assign(areaWidth * areaHeight, 0);
+	m_outlineDistance.resize(areaWidth * areaHeight);
+
+	PlacePoints(m_points, pose.scale, m_offsets);
+	for (unsigned int point = 0; point < m_offsets.size(); ++point)
+	{
+		const int column = pose.x + m_offsets[point].x - static_cast<int>(area.left);
+		const int row = pose.y + m_offsets[point].y - static_cast<int>(area.top);
+		if (column >= 0 && column < static_cast<int>(areaWidth) && row >= 0 && row < static_cast<int>(areaHeight))
 		{
-			// Draw the DTM to see if the data is somewhat nice
-			SAM::TVector<float, 2> position = m_center.position;
+			m_outlineMask[(row * areaWidth) + column] = 1;
+		}
+	}
 
-			const int left = static_cast<int>(area[HandAreaSamplePoint::Left] + position.X()) + xoffset;
-			const int top = static_cast<int>(area[HandAreaSamplePoint::Top] + position.Y()) + yoffset;
+	ComputeDistanceTransform(&m_outlineMask[0], areaWidth, wholeArea, &m_outlineDistance[0]);
 
-			DrawBox(data, width, height, left, top, 10);
+	unsigned int sum = 0;
+	unsigned int counted = 0;
+	for (unsigned int row = 0; row < areaHeight; ++row)
+	{
+		const unsigned char *rowEdges = edges + ((area.top + row) * width) + area.left;
+		const unsigned short *rowDistance = &m_outlineDistance[row * areaWidth];
 
-			for (unsigned int pointIndex = 0; pointIndex < m_points.size(); ++ pointIndex)
-			{
-				SAM::TVector<float, 2> p = m_points[pointIndex].position;
-				DrawBox(data, width, height, static_cast<int>(left + p.X()), static_cast<int>(top + p.Y()), 6);
-			}
+		for (unsigned int column = 0; column < areaWidth; ++column)
+		{
+			if (rowEdges[column] == 0)
+				continue;
+
+			sum += rowDistance[column] < Truncate ? rowDistance[column] : Truncate;
+			counted++;
 		}
 	}
 
-	return false;
+	return counted > 0 ? static_cast<float>(sum) / (counted * DISTANCE_UNITS_PER_PIXEL) : 0.0f;
 }
 
-void CDeformableTemplateModel::DrawBox( 
-		RGBQUAD *data,
-		unsigned int w,
-		unsigned int h,
-		unsigned int x, 
-		unsigned int y, 
-		unsigned int t 
+bool CDeformableTemplateModel::Match(
+		const unsigned char *edges,
+		const unsigned short *distance,
+		unsigned int width,
+		const MaskArea &area,
+		TemplateMatch &match
 	)
 {
-	int halfSize = static_cast<unsigned int>(t * 0.5f);
+	match.x = 0.0f;
+	match.y = 0.0f;
+	match.scale = 0.0f;
+	match.outlineScore = FLT_MAX;
+	match.edgeScore = FLT_MAX;
+	match.score = FLT_MAX;
+
+	if (m_points.empty() || area.IsEmpty() || m_right <= m_left)
+		return false;
+
+	// guess the template spans the width of the area and hangs from its top
+	const float areaWidth = static_cast<float>(area.right - area.left);
+	const float areaCenter = (area.left + area.right - 1) * 0.5f;
+	const float scaleGuess = areaWidth / (m_right - m_left);
+	const float templateCenter = (m_left + m_right) * 0.5f;
+
+	const int coarseSteps = static_cast<int>((areaWidth * SEARCH_RADIUS) / COARSE_STEP);
+	const int centerX = static_cast<int>(floor(areaCenter + 0.5f));
+
+	std::vector<Candidate> best;
+	best.reserve(CANDIDATES + 1);
+
+	for (unsigned int scaleIndex = 0; scaleIndex < sizeof(COARSE_SCALES) / sizeof(COARSE_SCALES[0]); ++scaleIndex)
+	{
+		const float scale = scaleGuess * COARSE_SCALES[scaleIndex];
+		const int guessX = centerX - static_cast<int>(floor((templateCenter * scale) + 0.5f));
+		const int guessY = static_cast<int>(area.top) - static_cast<int>(floor((m_top * scale) + 0.5f));
+		PlacePoints(m_coarsePoints, scale, m_offsets);
+
+		for (int stepY = -coarseSteps; stepY <= coarseSteps; ++stepY)
+		{
+			for (int stepX = -coarseSteps; stepX <= coarseSteps; ++stepX)
+			{
+				Candidate candidate;
+				candidate.x = guessX + (stepX * COARSE_STEP);
+				candidate.y = guessY + (stepY * COARSE_STEP);
+				candidate.scale = scale;
+
+				const float bound = best.size() == CANDIDATES ? best.back().score : FLT_MAX;
+				candidate.score = Score(distance, width, area, m_offsets, candidate.x, candidate.y, bound);
+				if (candidate.score < FLT_MAX)
+				{
+					KeepBest(best, candidate);
+				}
+			}
+		}
+	}
 
-	for (int xo = -halfSize; xo <= halfSize; ++xo)
+	// refine around each of the best, halving the steps each level, scoring with every point
+	int step = COARSE_STEP;
+	float scaleStep = (COARSE_SCALES[1] - COARSE_SCALES[0]) * scaleGuess;
+	for (unsigned int level = 0; level < REFINE_LEVELS && !best.empty(); ++level)
 	{
-		for (int yo = -halfSize; yo <= halfSize; ++yo)
+		step = step > 1 ? step / 2 : 1;
+		scaleStep *= 0.5f;
+
+		const std::vector<Candidate> centers = best;
+		best.clear();
+
+		for (unsigned int center = 0; center < centers.size(); ++center)
 		{
-			const unsigned int pixel = ((y + yo) * w) + (x + xo);
-			if (pixel >= (w * h)) continue;
-			data[pixel].rgbGreen = 255;
-			data[pixel].rgbBlue = 255;
+			for (int scaleOffset = -1; scaleOffset <= 1; ++scaleOffset)
+			{
+				const float scale = centers[center].scale + (scaleOffset * scaleStep);
+				PlacePoints(m_points, scale, m_offsets);
+
+				for (int offsetY = -1; offsetY <= 1; ++offsetY)
+				{
+					for (int offsetX = -1; offsetX <= 1; ++offsetX)
+					{
+						Candidate candidate;
+						candidate.x = centers[center].x + (offsetX * step);
+						candidate.y = centers[center].y + (offsetY * step);
+						candidate.scale = scale;
+
+						const float bound = best.size() == CANDIDATES ? best.back().score : FLT_MAX;
+						candidate.score = Score(distance, width, area, m_offsets, candidate.x, candidate.y, bound);
+						if (candidate.score < FLT_MAX)
+						{
+							KeepBest(best, candidate);
+						}
+					}
+				}
+			}
 		}
 	}
-	
+
+	if (best.empty())
+		return false;
+
+	match.x = static_cast<float>(best.front().x);
+	match.y = static_cast<float>(best.front().y);
+	match.scale = best.front().scale;
+	match.outlineScore = best.front().score;
+	match.edgeScore = ScoreEdges(edges, width, area, best.front());
+	match.score = (match.outlineScore + match.edgeScore) * 0.5f;
+
+	return match.score <= m_matchDistance;
 }
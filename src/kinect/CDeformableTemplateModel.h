@@ -1,7 +1,6 @@
 #pragma once
 
-#include <Windows.h>
-#include <SAM.h>
+#include "DepthBand.h"
 #include <vector>
 
 struct HandAreaSamplePoint {
@@ -13,56 +12,147 @@ struct HandAreaSamplePoint {
 	};
 };
 
+/*
+ *	\brief A point on the outline of a template, in template units
+*/
+struct TemplatePoint
+{
+	float						x;									//!< The distance right of the template's origin
+	float						y;									//!< The distance below the template's origin
+};
+
+/*
+ *	\brief Where a template fits an edge map best, and how well
+*/
+struct TemplateMatch
+{
+	float						x;									//!< The column the template's origin fits at
+	float						y;									//!< The row the template's origin fits at
+	float						scale;								//!< The number of pixels in a template unit
+	float						outlineScore;						//!< The mean distance from the outline to the nearest edge, in pixels
+	float						edgeScore;							//!< The mean distance from the edges to the nearest outline point, in pixels
+	float						score;								//!< The mean of the outline and edge scores
+};
+
+/*
+ *	\brief A shape matched against the edges of the hand by chamfer matching.
+ *	The shape is built from capsules, and its outline is sampled into points once.
+ *	Matching scores a pose by looking up the distance transform of the edge map under
+ *	each outline point, so a pose costs one lookup a point. Poses are searched coarse
+ *	to fine: a wide grid of positions and scales scored with a quarter of the points,
+ *	then the best few refined with every point at finer and finer steps. A shape can sit
+ *	on part of a bigger one's edges, a fist on an open hand's palm, so the best pose is
+ *	also scored the other way, from each edge to the outline drawn at that pose.
+*/
 class CDeformableTemplateModel {
 private:
 
-	struct SamplePoint {
-		SAM::TVector<float, 2>		position;
-		SAM::TVector<BYTE, 3>		color;
-		unsigned int				tolerance;
+	struct TemplateCapsule {
+		TemplatePoint				start;
+		TemplatePoint				end;
+		float						radius;
+	};
+
+	struct Candidate {
+		int							x;
+		int							y;
+		float						scale;
+		float						score;
+	};
+
+	struct PixelOffset {
+		int							x;
+		int							y;
 	};
 
 private:
 
-	SamplePoint															m_center;
-	std::vector<SamplePoint>											m_points;
+	std::vector<TemplateCapsule>										m_capsules;				//!< The capsules the shape is made of
+	std::vector<TemplatePoint>											m_points;				//!< The outline of the shape
+	std::vector<TemplatePoint>											m_coarsePoints;			//!< Every fourth point of the outline, for the coarse search
+	float																m_left;					//!< The leftmost point of the outline
+	float																m_right;				//!< The rightmost point of the outline
+	float																m_top;					//!< The highest point of the outline
+	float																m_matchDistance;		//!< The highest score which is a match, in pixels
+	std::vector<unsigned char>											m_outlineMask;			//!< The outline drawn at the best pose, over the hand area
+	std::vector<unsigned short>											m_outlineDistance;		//!< The distance transform of the drawn outline
+	std::vector<PixelOffset>											m_offsets;				//!< The outline points placed at the scale being searched
 
-public:
-																		//! Class constructor
-																		CDeformableTemplateModel();
+private:
+																		//! Is a point inside any capsule other than one, by more than a margin
+	bool																IsInsideOtherCapsule(
+																			const TemplatePoint &point,		//!< The point to test
+																			unsigned int capsule			//!< The capsule the point is on
+																		) const;
 
-																		//! Class destructor
-																		~CDeformableTemplateModel();
+																		//! Scale outline points to the nearest pixels around the template's origin
+	static void															PlacePoints(
+																			const std::vector<TemplatePoint> &points, //!< The outline points to place
+																			float scale,					//!< The number of pixels in a template unit
+																			std::vector<PixelOffset> &offsets	//!< Receives the pixel offset of each point
+																		);
 
-																		//! Set the center point of the DTM
-	void																SetCenterPoint(
-																			SAM::TVector<float, 2> position,
-																			SAM::TVector<BYTE, 3> color,
-																			unsigned int tolerance
+																		//! Score a pose, giving up once it can't beat a score
+	float																Score(
+																			const unsigned short *distance,	//!< The distance transform of the edges
+																			unsigned int width,				//!< The number of pixels in a row
+																			const MaskArea &area,			//!< The area the distance transform covers
+																			const std::vector<PixelOffset> &offsets, //!< The outline points placed at the pose's scale
+																			int x,							//!< The column of the template's origin
+																			int y,							//!< The row of the template's origin
+																			float bound						//!< The score to beat
+																		) const;
+
+																		//! Score how far the edges are from the outline drawn at a pose
+	float																ScoreEdges(
+																			const unsigned char *edges,		//!< The edge mask of the hand
+																			unsigned int width,				//!< The number of pixels in a row
+																			const MaskArea &area,			//!< The hand area
+																			const Candidate &pose			//!< The pose to draw the outline at
+																		);
+
+																		//! Keep a candidate in a list of the best, sorted by score
+	static void															KeepBest(
+																			std::vector<Candidate> &best,	//!< The best candidates so far
+																			const Candidate &candidate		//!< The candidate to consider
 																		);
 
-																		//! Add a sample point to the DTM
-	void																AddPoint(
-																			SAM::TVector<float, 2> position,
-																			SAM::TVector<BYTE, 3> color,
-																			unsigned int tolerance
+protected:
+																		//! Add a capsule to the shape, in template units
+	void																AddCapsule(
+																			float startX,					//!< The x coord of the start of the capsule's spine
+																			float startY,					//!< The y coord of the start of the capsule's spine
+																			float endX,						//!< The x coord of the end of the capsule's spine
+																			float endY,						//!< The y coord of the end of the capsule's spine
+																			float radius					//!< The radius of the capsule
 																		);
 
-																		//! Test the DTM against a buffer of data
-	bool																Test(
-																			RGBQUAD *data,
-																			unsigned int width,
-																			unsigned int height,
-																			SAM::TVector<unsigned int, 4> &area
+																		//! Sample the outline of the capsules added so far, the parts not hidden inside another capsule
+	void																BuildOutline(
+																			float spacing					//!< The distance between outline points, in template units
+																		);
+
+public:
+																		//! Class constructor
+																		CDeformableTemplateModel(
+																			float matchDistance				//!< The highest score which is a match, in pixels
 																		);
-	
-																		//! 
-	void																DrawBox(
-																			RGBQUAD *data,
-																			unsigned int w,
-																			unsigned int h,
-																			unsigned int x, 
-																			unsigned int y, 
-																			unsigned int t  
+
+																		//! Class destructor
+	virtual																~CDeformableTemplateModel();
+
+																		//! Find where the template best fits the edges of a hand area, true if it fits well enough to match
+	bool																Match(
+																			const unsigned char *edges,		//!< The edge mask of the hand
+																			const unsigned short *distance,	//!< The distance transform of the hand's edges, see ComputeDistanceTransform
+																			unsigned int width,				//!< The number of pixels in a row
+																			const MaskArea &area,			//!< The hand area the distance transform covers
+																			TemplateMatch &match			//!< Receives the best fit, even when it isn't a match
 																		);
-};
\ No newline at end of file
+
+																		//! Get the outline of the template, in template units
+	const std::vector<TemplatePoint>									&GetPoints() const
+																		{
+																			return m_points;
+																		}
+};
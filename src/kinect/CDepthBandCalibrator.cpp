@@ -0,0 +1,243 @@
+#include "CDepthBandCalibrator.h"
+#include <string.h>
+
+// Depths nearer than the sensor can see, in millimetres, and further than a hand held out is looked for
+static const int MINIMUM_DEPTH = 400;
+static const int MAXIMUM_HAND_DEPTH = 2500;
+
+// How much of the histogram each new frame replaces, and the frames counted before a peak is looked for
+static const float HISTORY_RATE = 0.2f;
+static const unsigned int WARM_UP_FRAMES = 5;
+
+// The share of the readings three neighbouring bins need for a peak, a hand at arm's length has about 1%
+static const float SIGNIFICANT_SHARE = 0.005f;
+
+// The band reaches this far either side of the hand, the width of the old fixed band
+static const int BAND_HALF_WIDTH = 256;
+
+// How far the peak must move, and for how many frames in a row, before the band follows it
+static const int HYSTERESIS = 96;
+static const unsigned int FRAMES_TO_MOVE = 5;
+
+// The first bin which can hold a reading the sensor could have seen
+static const unsigned int FIRST_BIN = (MINIMUM_DEPTH + CDepthBandCalibrator::BinWidth - 1) / CDepthBandCalibrator::BinWidth;
+
+/*
+ *	\brief Class constructor
+*/
+CDepthBandCalibrator::CDepthBandCalibrator() :
+	m_defaultNear(0),
+	m_defaultFar(0),
+	m_nearPoint(0),
+	m_farPoint(0),
+	m_handDepth(0),
+	m_calibrated(false),
+	m_pendingDepth(0),
+	m_pendingFrames(0),
+	m_frameCount(0),
+	m_counts(BinCount * 4, 0),
+	m_histogram(BinCount, 0.0f)
+{
+
+}
+
+/*
+ *	\brief Class destructor
+*/
+CDepthBandCalibrator::~CDepthBandCalibrator()
+{
+
+}
+
+/*
+ *	\brief Set the band to use until calibrated, and forget every frame counted
+*/
+void CDepthBandCalibrator::Create(
+		int nearPoint,								//!< The nearest depth in the band, in millimetres
+		int farPoint								//!< One past the furthest depth in the band, in millimetres
+	)
+{
+	m_defaultNear = nearPoint;
+	m_defaultFar = farPoint;
+	Reset();
+}
+
+/*
+ *	\brief Forget every frame counted and go back to the band given at creation
+*/
+void CDepthBandCalibrator::Reset()
+{
+	m_nearPoint = m_defaultNear;
+	m_farPoint = m_defaultFar;
+	m_handDepth = 0;
+	m_calibrated = false;
+	m_pendingDepth = 0;
+	m_pendingFrames = 0;
+	m_frameCount = 0;
+	m_histogram.assign(BinCount, 0.0f);
+}
+
+/*
+ *	\brief Count the depths of a frame, or a level of its pyramid, and move the band if the hand has moved. True if the band moved
+*/
+bool CDepthBandCalibrator::AddFrame(
+		const unsigned short *depthPixels,			//!< The packed depth pixels, player bits are ignored
+		unsigned int pixelCount						//!< The number of pixels
+	)
+{
+	CountFrame(depthPixels, pixelCount);
+
+	unsigned int peakBin;
+	unsigned int lastBin;
+	if (m_frameCount < WARM_UP_FRAMES || !FindHandPeak(peakBin, lastBin))
+	{
+		m_pendingFrames = 0;
+		return false;
+	}
+
+	// a hand held where the band already is doesn't move it
+	const int handDepth = static_cast<int>((peakBin * BinWidth) + (BinWidth / 2));
+	const int fromBand = handDepth > m_handDepth ? handDepth - m_handDepth : m_handDepth - handDepth;
+	if (m_calibrated && fromBand <= HYSTERESIS)
+	{
+		m_pendingFrames = 0;
+		return false;
+	}
+
+	// elsewhere, it has to stay about there for a few frames first
+	const int fromPending = handDepth > m_pendingDepth ? handDepth - m_pendingDepth : m_pendingDepth - handDepth;
+	if (m_pendingFrames == 0 || fromPending > static_cast<int>(BinWidth))
+	{
+		m_pendingDepth = handDepth;
+		m_pendingFrames = 0;
+	}
+
+	if (++m_pendingFrames < FRAMES_TO_MOVE)
+		return false;
+
+	const int nearPoint = handDepth - BAND_HALF_WIDTH;
+	const int farPoint = handDepth + BAND_HALF_WIDTH;
+	const int lastDepth = static_cast<int>((lastBin + 1) * BinWidth);
+
+	m_handDepth = handDepth;
+	m_nearPoint = nearPoint > MINIMUM_DEPTH ? nearPoint : MINIMUM_DEPTH;
+	m_farPoint = farPoint < lastDepth ? farPoint : lastDepth;
+	m_calibrated = true;
+	m_pendingFrames = 0;
+	return true;
+}
+
+/*
+ *	\brief Count a frame's depths into the histogram
+*/
+void CDepthBandCalibrator::CountFrame(
+		const unsigned short *depthPixels,			//!< The packed depth pixels
+		unsigned int pixelCount						//!< The number of pixels
+	)
+{
+	// the top byte of a packed pixel is its 32mm bin. Four pixels a step each go to their own count,
+	// so runs of the same depth don't wait on the increment of the pixel before
+	memset(&m_counts[0], 0, m_counts.size() * sizeof(unsigned int));
+	unsigned int *counts = &m_counts[0];
+
+	unsigned int pixel = 0;
+	for (; pixel + 4 <= pixelCount; pixel += 4)
+	{
+		counts[((depthPixels[pixel] >> 8) << 2)]++;
+		counts[((depthPixels[pixel + 1] >> 8) << 2) + 1]++;
+		counts[((depthPixels[pixel + 2] >> 8) << 2) + 2]++;
+		counts[((depthPixels[pixel + 3] >> 8) << 2) + 3]++;
+	}
+
+	for (; pixel < pixelCount; ++pixel)
+	{
+		counts[(depthPixels[pixel] >> 8) << 2]++;
+	}
+
+	// pixels with no reading, or nearer than the sensor can see, aren't part of the scene
+	unsigned int totals[BinCount];
+	unsigned int readings = 0;
+	for (unsigned int bin = FIRST_BIN; bin < BinCount; ++bin)
+	{
+		totals[bin] = counts[bin << 2] + counts[(bin << 2) + 1] + counts[(bin << 2) + 2] + counts[(bin << 2) + 3];
+		readings += totals[bin];
+	}
+
+	if (readings == 0)
+		return;
+
+	// the first frame fills the histogram, later ones blend into it
+	const float rate = m_frameCount == 0 ? 1.0f : HISTORY_RATE;
+	for (unsigned int bin = FIRST_BIN; bin < BinCount; ++bin)
+	{
+		const float share = static_cast<float>(totals[bin]) / readings;
+		m_histogram[bin] += (share - m_histogram[bin]) * rate;
+	}
+
+	m_frameCount++;
+}
+
+/*
+ *	\brief Get the share of a bin and its two neighbours, a hand's depth spreads over a couple of bins
+*/
+float CDepthBandCalibrator::GetNeighbourhood(
+		unsigned int bin							//!< The bin, not the first or last
+	) const
+{
+	return m_histogram[bin - 1] + m_histogram[bin] + m_histogram[bin + 1];
+}
+
+/*
+ *	\brief Find the nearest significant peak within reach and the furthest bin the band can reach behind it, false if there is none
+*/
+bool CDepthBandCalibrator::FindHandPeak(
+		unsigned int &peakBin,						//!< Receives the bin of the peak
+		unsigned int &lastBin						//!< Receives the furthest bin before a further peak
+	) const
+{
+	const unsigned int maximumBin = MAXIMUM_HAND_DEPTH / BinWidth;
+
+	unsigned int bin = FIRST_BIN + 1;
+	while (bin <= maximumBin && GetNeighbourhood(bin) < SIGNIFICANT_SHARE)
+	{
+		++bin;
+	}
+
+	if (bin > maximumBin)
+		return false;
+
+	// climb to the top of the peak, a slope still rising past the furthest a hand can be is cut off there
+	while (bin < maximumBin && m_histogram[bin + 1] >= m_histogram[bin])
+	{
+		++bin;
+	}
+
+	peakBin = bin;
+
+	// the band stops in the valley before a further peak, such as the body behind the hand
+	const unsigned int bandBin = (((bin * BinWidth) + (BinWidth / 2) + BAND_HALF_WIDTH) / BinWidth);
+	unsigned int valleyBin = bin;
+	bool left = false;
+	lastBin = bandBin;
+
+	for (bin = peakBin + 1; bin <= bandBin && bin + 1 < BinCount; ++bin)
+	{
+		const float share = GetNeighbourhood(bin);
+		if (share < GetNeighbourhood(valleyBin))
+		{
+			valleyBin = bin;
+		}
+
+		if (share < SIGNIFICANT_SHARE)
+		{
+			left = true;
+		}
+		else if (left && share > GetNeighbourhood(valleyBin) * 2.0f)
+		{
+			lastBin = valleyBin;
+			break;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include <vector>
+
+/*
+ *	\brief Finds the band of depths the hand is held in from a histogram of recent frames.
+ *	Each frame's depths are counted into 32 millimetre bins, which are the top byte of a
+ *	packed pixel, and blended into a histogram which forgets older frames. The nearest
+ *	significant peak within reach is taken to be the outstretched hand, and the band is
+ *	set around it, stopping short of a further peak such as the body behind the hand.
+ *	The band only moves once the peak has been somewhere else for a few frames in a row,
+ *	so noise and a hand briefly dropped don't make it jump. Until a peak is found the
+ *	band given at creation is kept.
+*/
+class CDepthBandCalibrator {
+public:
+	static const unsigned int		BinWidth = 32;						//!< The millimetres of depth each bin covers
+	static const unsigned int		BinCount = 256;						//!< The number of bins, covering every depth a packed pixel can hold
+
+private:
+	int								m_defaultNear;						//!< The nearest depth of the band used before calibrating, in millimetres
+	int								m_defaultFar;						//!< One past the furthest depth of the band used before calibrating
+	int								m_nearPoint;						//!< The nearest depth in the band, in millimetres
+	int								m_farPoint;							//!< One past the furthest depth in the band, in millimetres
+	int								m_handDepth;						//!< The depth of the peak the band is set around, 0 before calibrating
+	bool							m_calibrated;						//!< Has the band been set around a peak
+
+	int								m_pendingDepth;						//!< The depth of a peak the band may move to
+	unsigned int					m_pendingFrames;					//!< The number of frames in a row the peak was near the pending depth
+	unsigned int					m_frameCount;						//!< The number of frames counted since the last reset
+
+	std::vector<unsigned int>		m_counts;							//!< Four interleaved counts a bin for the frame being counted
+	std::vector<float>				m_histogram;						//!< The share of the recent frames' readings in each bin
+
+private:
+									//! Count a frame's depths into the histogram
+	void							CountFrame(
+										const unsigned short *depthPixels,	//!< The packed depth pixels
+										unsigned int pixelCount			//!< The number of pixels
+									);
+
+									//! Get the share of a bin and its two neighbours
+	float							GetNeighbourhood(
+										unsigned int bin				//!< The bin, not the first or last
+									) const;
+
+									//! Find the nearest significant peak within reach and the furthest bin the band can reach behind it, false if there is none
+	bool							FindHandPeak(
+										unsigned int &peakBin,			//!< Receives the bin of the peak
+										unsigned int &lastBin			//!< Receives the furthest bin before a further peak
+									) const;
+
+public:
+									//! Class constructor
+									CDepthBandCalibrator();
+
+									//! Class destructor
+									~CDepthBandCalibrator();
+
+									//! Set the band to use until calibrated, and forget every frame counted
+	void							Create(
+										int nearPoint,					//!< The nearest depth in the band, in millimetres
+										int farPoint					//!< One past the furthest depth in the band, in millimetres
+									);
+
+									//! Forget every frame counted and go back to the band given at creation
+	void							Reset();
+
+									//! Count the depths of a frame, or a level of its pyramid, and move the band if the hand has moved. True if the band moved
+	bool							AddFrame(
+										const unsigned short *depthPixels,	//!< The packed depth pixels, player bits are ignored
+										unsigned int pixelCount			//!< The number of pixels
+									);
+
+									//! Get the nearest depth in the band, in millimetres
+	int								GetNearPoint() const
+									{
+										return m_nearPoint;
+									}
+
+									//! Get one past the furthest depth in the band, in millimetres
+	int								GetFarPoint() const
+									{
+										return m_farPoint;
+									}
+
+									//! Get the depth of the peak the band was set around, 0 before calibrating
+	int								GetHandDepth() const
+									{
+										return m_handDepth;
+									}
+
+									//! Has the band been set around the hand
+	bool							IsCalibrated() const
+									{
+										return m_calibrated;
+									}
+
+									//! Get the share of the recent frames' readings in a bin
+	float							GetShare(
+										unsigned int bin				//!< The bin, each BinWidth millimetres deep
+									) const
+									{
+										return m_histogram[bin];
+									}
+};
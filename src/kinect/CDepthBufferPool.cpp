@@ -0,0 +1,167 @@
+#include "CDepthBufferPool.h"
+#include <stdint.h>
+
+/*
+ *	\brief Class constructor
+*/
+CDepthBuffer::CDepthBuffer() :
+	m_pool(nullptr),
+	m_references(0),
+	m_pixels(nullptr),
+	m_used(false)
+{
+
+}
+
+/*
+ *	\brief Class destructor
+*/
+CDepthBuffer::~CDepthBuffer()
+{
+
+}
+
+/*
+ *	\brief Take another reference to the buffer, only while holding one already
+*/
+void CDepthBuffer::AddReference()
+{
+	m_references++;
+}
+
+/*
+ *	\brief Give up a reference, the buffer goes back to its pool with the last one
+*/
+void CDepthBuffer::Release()
+{
+	// whoever drops the count to 0 was the last holder, nobody else can take a reference now
+	if (--m_references == 0)
+	{
+		m_pool->Return(this);
+	}
+}
+
+/*
+ *	\brief Class constructor
+*/
+CDepthBufferPool::CDepthBufferPool() :
+	m_buffers(nullptr),
+	m_bufferCount(0),
+	m_width(0),
+	m_height(0),
+	m_acquired(0),
+	m_reused(0),
+	m_exhausted(0),
+	m_released(0)
+{
+
+}
+
+/*
+ *	\brief Class destructor
+*/
+CDepthBufferPool::~CDepthBufferPool()
+{
+	delete[] m_buffers;
+	m_buffers = nullptr;
+}
+
+/*
+ *	\brief Allocate the buffers, false if any buffer of the pool is still held
+*/
+bool CDepthBufferPool::Create(
+		unsigned int width,							//!< The number of pixels in a row of a buffer
+		unsigned int height,						//!< The number of rows of a buffer
+		unsigned int bufferCount					//!< The number of buffers
+	)
+{
+	if (GetOutstanding() != 0)
+		return false;
+
+	delete[] m_buffers;
+	m_buffers = new CDepthBuffer[bufferCount];
+	m_bufferCount = bufferCount;
+	m_width = width;
+	m_height = height;
+
+	// the storage is over allocated by an alignment, the pixels start at the first boundary inside it
+	const size_t pixelBytes = width * height * sizeof(unsigned short);
+	for (unsigned int buffer = 0; buffer < bufferCount; ++buffer)
+	{
+		m_buffers[buffer].m_pool = this;
+		m_buffers[buffer].m_storage.assign(pixelBytes + Alignment, 0);
+
+		const uintptr_t start = reinterpret_cast<uintptr_t>(&m_buffers[buffer].m_storage[0]);
+		const uintptr_t aligned = (start + Alignment - 1) & ~static_cast<uintptr_t>(Alignment - 1);
+		m_buffers[buffer].m_pixels = reinterpret_cast<unsigned short *>(aligned);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_free.clear();
+		m_free.reserve(bufferCount);
+		for (unsigned int buffer = bufferCount; buffer > 0; --buffer)
+		{
+			m_free.push_back(&m_buffers[buffer - 1]);
+		}
+	}
+
+	m_acquired = 0;
+	m_reused = 0;
+	m_exhausted = 0;
+	m_released = 0;
+	return true;
+}
+
+/*
+ *	\brief Take a free buffer holding its first reference, null if every buffer is held
+*/
+CDepthBuffer *CDepthBufferPool::Acquire()
+{
+	CDepthBuffer *buffer;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_free.empty())
+		{
+			m_exhausted++;
+			return nullptr;
+		}
+
+		// the buffer released last is handed out first, its pixels are the likeliest to still be cached
+		buffer = m_free.back();
+		m_free.pop_back();
+
+		if (buffer->m_used)
+		{
+			m_reused++;
+		}
+
+		buffer->m_used = true;
+	}
+
+	buffer->m_references = 1;
+	m_acquired++;
+	return buffer;
+}
+
+/*
+ *	\brief Get the number of buffers nobody holds
+*/
+unsigned int CDepthBufferPool::GetFreeCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return static_cast<unsigned int>(m_free.size());
+}
+
+/*
+ *	\brief Take back a buffer whose last reference was released
+*/
+void CDepthBufferPool::Return(
+		CDepthBuffer *buffer						//!< The buffer
+	)
+{
+	// the free list has room for every buffer, so this never allocates
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_free.push_back(buffer);
+	m_released++;
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+class CDepthBufferPool;
+
+/*
+ *	\brief A pooled buffer of depth pixels, shared between the holders of its references.
+ *	Whoever acquires the buffer holds the first reference, anyone it hands the buffer to
+ *	takes one of their own, and the buffer goes back to its pool when the last is released.
+*/
+class CDepthBuffer {
+	friend class CDepthBufferPool;
+
+private:
+	CDepthBufferPool				*m_pool;							//!< The pool the buffer goes back to
+	std::atomic<unsigned int>		m_references;						//!< The number of holders of the buffer
+	std::vector<unsigned char>		m_storage;							//!< The pixels, with room to align them
+	unsigned short					*m_pixels;							//!< The aligned pixels inside the storage
+	bool							m_used;								//!< Has the buffer been acquired before
+
+public:
+									//! Class constructor
+									CDepthBuffer();
+
+									//! Class destructor
+									~CDepthBuffer();
+
+									//! Take another reference to the buffer, only while holding one already
+	void							AddReference();
+
+									//! Give up a reference, the buffer goes back to its pool with the last one
+	void							Release();
+
+									//! Get the pixels, row by row
+	unsigned short					*GetPixels()
+									{
+										return m_pixels;
+									}
+
+									//! Get the pixels, row by row
+	const unsigned short			*GetPixels() const
+									{
+										return m_pixels;
+									}
+
+									//! Get the number of holders of the buffer
+	unsigned int					GetReferences() const
+									{
+										return m_references;
+									}
+};
+
+/*
+ *	\brief A fixed pool of depth frame buffers, allocated once and handed out by reference.
+ *	The pixels of each buffer start on a cache line, so no two buffers share one and the
+ *	vectorised passes over a frame start aligned. Acquiring never allocates or waits; when
+ *	every buffer is held it fails and is counted, so the caller drops the frame. The pool
+ *	counts buffers acquired, reused and never released, so leaks show up in the log.
+ *	Buffers are acquired on one thread but may be released on any.
+*/
+class CDepthBufferPool {
+	friend class CDepthBuffer;
+
+public:
+	static const unsigned int		Alignment = 64;						//!< The byte boundary the pixels of each buffer start on
+
+private:
+	CDepthBuffer					*m_buffers;							//!< Every buffer of the pool
+	unsigned int					m_bufferCount;						//!< The number of buffers
+	std::vector<CDepthBuffer *>		m_free;								//!< The buffers nobody holds
+	mutable std::mutex				m_mutex;							//!< Guards the free buffers
+	unsigned int					m_width;							//!< The number of pixels in a row of a buffer
+	unsigned int					m_height;							//!< The number of rows of a buffer
+
+	std::atomic<unsigned long long>	m_acquired;							//!< The number of buffers handed out
+	std::atomic<unsigned long long>	m_reused;							//!< The number of buffers handed out which had been handed out before
+	std::atomic<unsigned long long>	m_exhausted;						//!< The number of times every buffer was held
+	std::atomic<unsigned long long>	m_released;							//!< The number of buffers which came back
+
+private:
+									//! Take back a buffer whose last reference was released
+	void							Return(
+										CDepthBuffer *buffer			//!< The buffer
+									);
+
+public:
+									//! Class constructor
+									CDepthBufferPool();
+
+									//! Class destructor
+									~CDepthBufferPool();
+
+									//! Allocate the buffers, false if any buffer of the pool is still held
+	bool							Create(
+										unsigned int width,				//!< The number of pixels in a row of a buffer
+										unsigned int height,			//!< The number of rows of a buffer
+										unsigned int bufferCount		//!< The number of buffers
+									);
+
+									//! Take a free buffer holding its first reference, null if every buffer is held
+	CDepthBuffer					*Acquire();
+
+									//! Get the number of pixels in a row of a buffer
+	unsigned int					GetWidth() const
+									{
+										return m_width;
+									}
+
+									//! Get the number of rows of a buffer
+	unsigned int					GetHeight() const
+									{
+										return m_height;
+									}
+
+									//! Get the number of buffers
+	unsigned int					GetBufferCount() const
+									{
+										return m_bufferCount;
+									}
+
+									//! Get the number of buffers nobody holds
+	unsigned int					GetFreeCount() const;
+
+									//! Get the number of buffers still held, every one of them once everything is done with is a leak
+	unsigned long long				GetOutstanding() const
+									{
+										return m_acquired - m_released;
+									}
+
+									//! Get the number of buffers handed out since the pool was created
+	unsigned long long				GetAcquired() const
+									{
+										return m_acquired;
+									}
+
+									//! Get the number of buffers handed out which had been handed out before
+	unsigned long long				GetReused() const
+									{
+										return m_reused;
+									}
+
+									//! Get the number of times a buffer was wanted when every buffer was held
+	unsigned long long				GetExhausted() const
+									{
+										return m_exhausted;
+									}
+};
@@ -0,0 +1,155 @@
+#include "CDepthColorTable.h"
+
+#ifdef DEPTH_COLOR_TABLE_AVX2
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define AVX2_FUNCTION
+	#else
+		#define AVX2_FUNCTION __attribute__((target("avx2")))
+	#endif
+#endif
+
+static const int g_IntensityShiftByPlayerR[] = { 1, 2, 0, 2, 0, 0, 2, 0 };
+static const int g_IntensityShiftByPlayerG[] = { 1, 2, 2, 0, 2, 0, 0, 1 };
+static const int g_IntensityShiftByPlayerB[] = { 1, 0, 2, 2, 0, 2, 0, 2 };
+
+/*
+ *	\brief Class constructor, builds the table
+*/
+CDepthColorTable::CDepthColorTable() :
+	m_table(Entries),
+	m_useAVX2(IsAVX2Supported())
+{
+	for (unsigned int pixel = 0; pixel < Entries; ++pixel)
+	{
+		m_table[pixel] = CalculateColor(static_cast<unsigned short>(pixel));
+	}
+}
+
+/*
+ *	\brief Class destructor
+*/
+CDepthColorTable::~CDepthColorTable()
+{
+
+}
+
+/*
+ *	\brief Calculate the color of a depth pixel without the table
+*/
+unsigned int CDepthColorTable::CalculateColor(
+		unsigned short pixel						//!< The raw depth pixel, depth in the top 13 bits and player in the bottom 3
+	)
+{
+	// the same unpacking as NuiDepthPixelToDepth and NuiDepthPixelToPlayerIndex
+	const unsigned short realDepth = pixel >> 3;
+	const unsigned short player = pixel & 7;
+
+	// transform 13-bit depth information into an 8-bit intensity appropriate
+	// for display (we disregard information in most significant bit)
+	const unsigned char intensity = static_cast<unsigned char>(~(realDepth >> 4));
+
+	// tint the intensity by dividing by per-player values
+	const unsigned int red = intensity >> g_IntensityShiftByPlayerR[player];
+	const unsigned int green = intensity >> g_IntensityShiftByPlayerG[player];
+	const unsigned int blue = intensity >> g_IntensityShiftByPlayerB[player];
+
+	return (red << 16) | (green << 8) | blue;
+}
+
+/*
+ *	\brief Convert a run of depth pixels with the fastest path the CPU supports
+*/
+void CDepthColorTable::Convert(
+		const unsigned short *depth,				//!< The raw depth pixels
+		unsigned int count,							//!< The number of pixels to convert
+		unsigned int *colors						//!< Receives the packed colors
+	) const
+{
+#ifdef DEPTH_COLOR_TABLE_AVX2
+	if (m_useAVX2)
+	{
+		ConvertAVX2(depth, count, colors);
+		return;
+	}
+#endif
+
+	ConvertScalar(depth, count, colors);
+}
+
+/*
+ *	\brief Convert a run of depth pixels one table lookup at a time
+*/
+void CDepthColorTable::ConvertScalar(
+		const unsigned short *depth,				//!< The raw depth pixels
+		unsigned int count,							//!< The number of pixels to convert
+		unsigned int *colors						//!< Receives the packed colors
+	) const
+{
+	const unsigned int *const table = &m_table[0];
+
+	for (unsigned int pixel = 0; pixel < count; ++pixel)
+	{
+		colors[pixel] = table[depth[pixel]];
+	}
+}
+
+#ifdef DEPTH_COLOR_TABLE_AVX2
+
+/*
+ *	\brief Convert a run of depth pixels eight at a time with AVX2 gathers, the CPU must support AVX2
+*/
+AVX2_FUNCTION void CDepthColorTable::ConvertAVX2(
+		const unsigned short *depth,				//!< The raw depth pixels
+		unsigned int count,							//!< The number of pixels to convert
+		unsigned int *colors						//!< Receives the packed colors
+	) const
+{
+	const int *const table = reinterpret_cast<const int*>(&m_table[0]);
+
+	unsigned int pixel = 0;
+	for (; pixel + 8 <= count; pixel += 8)
+	{
+		// widen eight pixels to 32 bit indices and gather their colors
+		const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&depth[pixel]));
+		const __m256i indices = _mm256_cvtepu16_epi32(packed);
+		const __m256i gathered = _mm256_i32gather_epi32(table, indices, 4);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&colors[pixel]), gathered);
+	}
+
+	// the frame size is a multiple of 8, but finish any odd tail anyway
+	for (; pixel < count; ++pixel)
+	{
+		colors[pixel] = m_table[depth[pixel]];
+	}
+}
+
+#endif
+
+/*
+ *	\brief Can the AVX2 path be used on this CPU
+*/
+bool CDepthColorTable::IsAVX2Supported()
+{
+#if !defined(DEPTH_COLOR_TABLE_AVX2)
+	return false;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	// the OS must save the YMM registers as well as the CPU supporting AVX2
+	__cpuid(info, 1);
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	if (!osxsave || (_xgetbv(0) & 6) != 6)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include <vector>
+
+// The AVX2 gather path needs a compiler which knows the AVX2 intrinsics
+#if defined(__GNUC__) || (defined(_MSC_VER) && _MSC_VER >= 1800)
+	#define DEPTH_COLOR_TABLE_AVX2
+#endif
+
+/*
+ *	\brief Converts raw Kinect depth pixels into tinted RGBQUAD colors through a
+ *	65536 entry table indexed by the whole packed pixel, depth and player index together.
+ *	Colors are packed as 0x00RRGGBB, the same memory layout as an RGBQUAD.
+*/
+class CDepthColorTable {
+public:
+	static const unsigned int		Entries = 65536;					//!< One entry for every possible depth pixel
+
+private:
+	std::vector<unsigned int>		m_table;							//!< The packed color of every depth pixel
+	bool							m_useAVX2;							//!< Does Convert use the AVX2 gather path
+
+public:
+									//! Class constructor, builds the table
+									CDepthColorTable();
+
+									//! Class destructor
+									~CDepthColorTable();
+
+									//! Calculate the color of a depth pixel without the table
+	static unsigned int				CalculateColor(
+										unsigned short pixel			//!< The raw depth pixel, depth in the top 13 bits and player in the bottom 3
+									);
+
+									//! Look up the color of a single depth pixel
+	unsigned int					GetColor(
+										unsigned short pixel			//!< The raw depth pixel
+									) const
+									{
+										return m_table[pixel];
+									}
+
+									//! Convert a run of depth pixels with the fastest path the CPU supports
+	void							Convert(
+										const unsigned short *depth,	//!< The raw depth pixels
+										unsigned int count,				//!< The number of pixels to convert
+										unsigned int *colors			//!< Receives the packed colors
+									) const;
+
+									//! Convert a run of depth pixels one table lookup at a time
+	void							ConvertScalar(
+										const unsigned short *depth,	//!< The raw depth pixels
+										unsigned int count,				//!< The number of pixels to convert
+										unsigned int *colors			//!< Receives the packed colors
+									) const;
+
+#ifdef DEPTH_COLOR_TABLE_AVX2
+									//! Convert a run of depth pixels eight at a time with AVX2 gathers, the CPU must support AVX2
+	void							ConvertAVX2(
+										const unsigned short *depth,	//!< The raw depth pixels
+										unsigned int count,				//!< The number of pixels to convert
+										unsigned int *colors			//!< Receives the packed colors
+									) const;
+#endif
+
+									//! Can the AVX2 path be used on this CPU
+	static bool						IsAVX2Supported();
+};
@@ -0,0 +1,146 @@
+#include "CDepthPyramid.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+	#define DEPTH_PYRAMID_SSE2
+	#include <emmintrin.h>
+#endif
+
+// Packed pixels below this have no depth reading, only player bits
+static const unsigned short NO_READING_LIMIT = 8;
+
+// Clears the player bits of a packed pixel
+static const unsigned short DEPTH_BITS = 0xfff8;
+
+/*
+ *	\brief Get the nearest of two packed pixels, a pixel with no reading is further than any other
+*/
+static unsigned short GetNearest(
+		unsigned short first,						//!< The first packed pixel
+		unsigned short second						//!< The second packed pixel
+	)
+{
+	// taking the reading limit off wraps the pixels with no reading round to the top of the range
+	const unsigned short firstBiased = static_cast<unsigned short>(first - NO_READING_LIMIT);
+	const unsigned short secondBiased = static_cast<unsigned short>(second - NO_READING_LIMIT);
+	return firstBiased < secondBiased ? first : second;
+}
+
+/*
+ *	\brief Class constructor
+*/
+CDepthPyramid::CDepthPyramid() :
+	m_levelCount(0),
+	m_frame(nullptr)
+{
+
+}
+
+/*
+ *	\brief Class destructor
+*/
+CDepthPyramid::~CDepthPyramid()
+{
+
+}
+
+/*
+ *	\brief Allocate the levels for a frame size
+*/
+void CDepthPyramid::Create(
+		unsigned int width,							//!< The number of pixels in a row of the frame
+		unsigned int height,						//!< The number of rows of the frame
+		unsigned int levelCount						//!< The number of levels, including the frame itself
+	)
+{
+	m_levelCount = levelCount;
+	m_widths.resize(levelCount);
+	m_heights.resize(levelCount);
+	m_levels.resize(levelCount);
+	m_frame = nullptr;
+
+	// an odd column or row is left out of the level above
+	for (unsigned int level = 0; level < levelCount; ++level)
+	{
+		m_widths[level] = width >> level;
+		m_heights[level] = height >> level;
+
+		if (level != 0)
+		{
+			m_levels[level].assign((m_widths[level] * m_heights[level]) + 1, 0);
+		}
+	}
+}
+
+/*
+ *	\brief Build every level from a depth frame, which must outlive the pyramid's use
+*/
+void CDepthPyramid::Build(
+		const unsigned short *depthPixels			//!< The packed depth pixels of the frame
+	)
+{
+	m_frame = depthPixels;
+
+	for (unsigned int level = 1; level < m_levelCount; ++level)
+	{
+		BuildLevel(level);
+	}
+}
+
+/*
+ *	\brief Build one level from the level below it
+*/
+void CDepthPyramid::BuildLevel(
+		unsigned int level							//!< The level to build, 1 or more
+	)
+{
+	const unsigned short *below = GetLevel(level - 1);
+	const unsigned int belowWidth = m_widths[level - 1];
+	const unsigned int width = m_widths[level];
+	const unsigned int height = m_heights[level];
+	unsigned short *pixels = &m_levels[level][0];
+
+#ifdef DEPTH_PYRAMID_SSE2
+	// the pixels are biased so a signed compare orders them as GetNearest does
+	const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000 + NO_READING_LIMIT));
+	const __m128i flip = _mm_set1_epi16(static_cast<short>(0x8000));
+	const __m128i limit = _mm_set1_epi16(static_cast<short>(NO_READING_LIMIT));
+	const __m128i depthBits = _mm_set1_epi16(static_cast<short>(DEPTH_BITS));
+#endif
+
+	for (unsigned int row = 0; row < height; ++row)
+	{
+		const unsigned short *top = below + (row * 2 * belowWidth);
+		const unsigned short *bottom = top + belowWidth;
+		unsigned short *levelRow = pixels + (row * width);
+
+		unsigned int column = 0;
+
+#ifdef DEPTH_PYRAMID_SSE2
+		for (; column + 8 <= width; column += 8)
+		{
+			const __m128i *topPixels = reinterpret_cast<const __m128i *>(top + (column * 2));
+			const __m128i *bottomPixels = reinterpret_cast<const __m128i *>(bottom + (column * 2));
+
+			// the nearest of each column pair, then of each pair of columns
+			const __m128i left = _mm_min_epi16(_mm_sub_epi16(_mm_loadu_si128(topPixels), bias), _mm_sub_epi16(_mm_loadu_si128(bottomPixels), bias));
+			const __m128i right = _mm_min_epi16(_mm_sub_epi16(_mm_loadu_si128(topPixels + 1), bias), _mm_sub_epi16(_mm_loadu_si128(bottomPixels + 1), bias));
+
+			// sign extending both halves of each 32 bit lane keeps the minimum of the low halves a whole 32 bit value
+			const __m128i leftNearest = _mm_min_epi16(_mm_srai_epi32(_mm_slli_epi32(left, 16), 16), _mm_srai_epi32(left, 16));
+			const __m128i rightNearest = _mm_min_epi16(_mm_srai_epi32(_mm_slli_epi32(right, 16), 16), _mm_srai_epi32(right, 16));
+			const __m128i nearest = _mm_packs_epi32(leftNearest, rightNearest);
+
+			// undo the bias, then clear the player bits, which also clears pixels with no reading to 0
+			const __m128i unbiased = _mm_add_epi16(_mm_xor_si128(nearest, flip), limit);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(levelRow + column), _mm_and_si128(unbiased, depthBits));
+		}
+#endif
+
+		for (; column < width; ++column)
+		{
+			const unsigned short topNearest = GetNearest(top[column * 2], top[(column * 2) + 1]);
+			const unsigned short bottomNearest = GetNearest(bottom[column * 2], bottom[(column * 2) + 1]);
+			levelRow[column] = GetNearest(topNearest, bottomNearest) & DEPTH_BITS;
+		}
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include <vector>
+
+/*
+ *	\brief A pyramid of packed depth frames, each level half the size of the one below.
+ *	Level 0 is the depth frame itself, each pixel of a higher level holds the nearest
+ *	depth of the 2x2 pixels under it, so a hand held in front of the body is never lost
+ *	to the wall behind it. Pixels with no reading are skipped, a level only has no
+ *	reading where none of the pixels under it did. Levels keep the depth packed in the
+ *	top 13 bits with the player bits cleared, so the depth band threshold works on any
+ *	level. Rows are reduced 16 pixels at a time with SSE2 where the compiler targets x86.
+*/
+class CDepthPyramid {
+private:
+	unsigned int							m_levelCount;				//!< The number of levels, including the frame itself
+	std::vector<unsigned int>				m_widths;					//!< The number of pixels in a row of each level
+	std::vector<unsigned int>				m_heights;					//!< The number of rows of each level
+	std::vector<std::vector<unsigned short>>	m_levels;				//!< The pixels of each level above the frame
+	const unsigned short					*m_frame;					//!< The depth frame the pyramid was last built from
+
+public:
+											//! Class constructor
+											CDepthPyramid();
+
+											//! Class destructor
+											~CDepthPyramid();
+
+											//! Allocate the levels for a frame size
+	void									Create(
+												unsigned int width,				//!< The number of pixels in a row of the frame
+												unsigned int height,			//!< The number of rows of the frame
+												unsigned int levelCount			//!< The number of levels, including the frame itself
+											);
+
+											//! Build every level from a depth frame, which must outlive the pyramid's use
+	void									Build(
+												const unsigned short *depthPixels	//!< The packed depth pixels of the frame
+											);
+
+											//! Build one level from the level below it
+	void									BuildLevel(
+												unsigned int level				//!< The level to build, 1 or more
+											);
+
+											//! Get the number of levels, including the frame itself
+	unsigned int							GetLevelCount() const
+											{
+												return m_levelCount;
+											}
+
+											//! Get the number of pixels in a row of a level
+	unsigned int							GetLevelWidth(
+												unsigned int level				//!< The level, 0 for the frame
+											) const
+											{
+												return m_widths[level];
+											}
+
+											//! Get the number of rows of a level
+	unsigned int							GetLevelHeight(
+												unsigned int level				//!< The level, 0 for the frame
+											) const
+											{
+												return m_heights[level];
+											}
+
+											//! Get the packed depth pixels of a level
+	const unsigned short					*GetLevel(
+												unsigned int level				//!< The level, 0 for the frame
+											) const
+											{
+												return level == 0 ? m_frame : &m_levels[level][0];
+											}
+};
@@ -0,0 +1,200 @@
+#include "CDepthRecorder.h"
+#include <string.h>
+
+/*
+ *	\brief Class constructor
+*/
+CDepthRecorder::CDepthRecorder() :
+	m_recording(false),
+	m_width(0),
+	m_height(0),
+	m_queueStart(0),
+	m_queueCount(0),
+	m_queueReady(0),
+	m_framesWritten(0),
+	m_framesDropped(0),
+	m_maximumQueueDepth(0),
+	m_bytesWritten(0)
+{
+
+}
+
+/*
+ *	\brief Class destructor, finishes the recording
+*/
+CDepthRecorder::~CDepthRecorder()
+{
+	Stop();
+}
+
+/*
+ *	\brief Start recording to a new file, stopping any recording in progress
+*/
+bool CDepthRecorder::Start(
+		const std::string &fileName,				//!< The location to write the recording to
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height							//!< The number of rows in a frame
+	)
+{
+	Stop();
+
+	if (!m_writer.Open(fileName, width, height))
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_error = "Failed to create the depth recording";
+		return false;
+	}
+
+	// the buffers are allocated up front so pushing a frame never allocates
+	for (unsigned int slot = 0; slot < QueueCapacity; ++slot)
+	{
+		m_queue[slot].pixels.resize(width * height);
+	}
+
+	m_framesWritten = 0;
+	m_framesDropped = 0;
+	m_maximumQueueDepth = 0;
+	m_bytesWritten = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_error.clear();
+		m_width = width;
+		m_height = height;
+		m_queueStart = 0;
+		m_queueCount = 0;
+		m_queueReady = 0;
+		m_recording = true;
+	}
+
+	m_thread = std::thread(&CDepthRecorder::WriteThread, this);
+	return true;
+}
+
+/*
+ *	\brief Stop accepting frames, write the ones still queued and close the file
+*/
+void CDepthRecorder::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_recording = false;
+	}
+
+	m_frameQueued.notify_one();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+
+	m_writer.Close();
+}
+
+/*
+ *	\brief Queue a frame to be written, false if it was dropped or nothing is being recorded
+*/
+bool CDepthRecorder::Push(
+		const DepthFrame &frame						//!< The frame to record
+	)
+{
+	unsigned int slot;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_recording)
+			return false;
+
+		if (m_queueCount == QueueCapacity || frame.width != m_width || frame.height != m_height)
+		{
+			m_framesDropped++;
+			return false;
+		}
+
+		// claim the slot, the write thread only reads filled slots
+		slot = (m_queueStart + m_queueCount) % QueueCapacity;
+		m_queueCount++;
+
+		if (m_queueCount > m_maximumQueueDepth)
+		{
+			m_maximumQueueDepth = m_queueCount;
+		}
+	}
+
+	// copy outside the lock so the write thread can carry on with the frame before
+	m_queue[slot].timestamp = frame.timestamp;
+	memcpy(&m_queue[slot].pixels[0], frame.pixels, frame.width * frame.height * sizeof(unsigned short));
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queueReady++;
+	}
+
+	m_frameQueued.notify_one();
+	return true;
+}
+
+/*
+ *	\brief The encode and write thread entry point
+*/
+void CDepthRecorder::WriteThread()
+{
+	const unsigned int pixelCount = m_width * m_height;
+
+	std::vector<unsigned short> previous(pixelCount);
+	std::vector<unsigned char> encoded;
+	unsigned int framesSinceKey = 0;
+	bool failed = false;
+
+	for (;;)
+	{
+		unsigned int slot;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (m_queueReady == 0 && (m_recording || m_queueCount > 0))
+			{
+				m_frameQueued.wait(lock);
+			}
+
+			// stopped, and every queued frame has been written
+			if (m_queueReady == 0)
+				break;
+
+			slot = m_queueStart;
+		}
+
+		const QueuedFrame &frame = m_queue[slot];
+
+		if (!failed)
+		{
+			const bool keyFrame = framesSinceKey == 0;
+			EncodeDepthDeltas(&frame.pixels[0], keyFrame ? nullptr : &previous[0], pixelCount, encoded);
+
+			const DepthFrameEncoding::Enum encoding = keyFrame ? DepthFrameEncoding::KeyDelta : DepthFrameEncoding::FrameDelta;
+			if (m_writer.WriteEncodedFrame(frame.timestamp, encoding, encoded.empty() ? nullptr : &encoded[0], static_cast<unsigned int>(encoded.size())))
+			{
+				memcpy(&previous[0], &frame.pixels[0], pixelCount * sizeof(unsigned short));
+				framesSinceKey = (framesSinceKey + 1) % KeyFrameInterval;
+				m_framesWritten++;
+				m_bytesWritten += encoded.size();
+			}
+			else
+			{
+				failed = true;
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (failed)
+			{
+				// keep emptying the queue so the capture thread sees dropped frames rather than a stall
+				if (m_error.empty()) m_error = "Failed to write to the depth recording";
+				m_framesDropped++;
+			}
+
+			m_queueStart = (m_queueStart + 1) % QueueCapacity;
+			m_queueCount--;
+			m_queueReady--;
+		}
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "DepthRecording.h"
+#include "IDepthFrameSource.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/*
+ *	\brief Records depth frames to a depth recording without holding up the thread capturing them.
+ *	Pushed frames are copied into a fixed ring of frame buffers and a background thread
+ *	delta encodes and writes them. When every buffer is waiting to be written the frame
+ *	is dropped and counted rather than making the capture thread wait for the disk.
+*/
+class CDepthRecorder {
+public:
+	static const unsigned int		QueueCapacity = 8;					//!< The number of frames which can wait to be written
+	static const unsigned int		KeyFrameInterval = 30;				//!< Every this many frames written is a key frame
+
+private:
+
+	struct QueuedFrame
+	{
+		unsigned long long				timestamp;						//!< When the frame was captured, in microseconds
+		std::vector<unsigned short>		pixels;							//!< The pixels of the frame
+	};
+
+private:
+	std::thread						m_thread;							//!< The encode and write thread
+	mutable std::mutex				m_mutex;							//!< Guards the queue and the recording state
+	std::condition_variable			m_frameQueued;						//!< Signalled when a frame is queued or the recording stops
+
+	CDepthRecordingWriter			m_writer;							//!< Writes the encoded frames, only used by the write thread
+	std::string						m_error;							//!< A description of why the recording failed
+	bool							m_recording;						//!< Are frames being accepted
+	unsigned int					m_width;							//!< The number of pixels in a row
+	unsigned int					m_height;							//!< The number of rows in a frame
+
+	QueuedFrame						m_queue[QueueCapacity];				//!< The ring of frames waiting to be written
+	unsigned int					m_queueStart;						//!< The index of the oldest queued frame
+	unsigned int					m_queueCount;						//!< The number of queued frames, including one being filled
+	unsigned int					m_queueReady;						//!< The number of queued frames which have been filled
+
+	std::atomic<unsigned int>		m_framesWritten;					//!< The number of frames written
+	std::atomic<unsigned int>		m_framesDropped;					//!< The number of frames dropped because the queue was full
+	std::atomic<unsigned int>		m_maximumQueueDepth;				//!< The most frames ever waiting to be written
+	std::atomic<unsigned long long>	m_bytesWritten;						//!< The number of encoded frame bytes written
+
+private:
+									//! The encode and write thread entry point
+	void							WriteThread();
+
+public:
+									//! Class constructor
+									CDepthRecorder();
+
+									//! Class destructor, finishes the recording
+									~CDepthRecorder();
+
+									//! Start recording to a new file, stopping any recording in progress
+	bool							Start(
+										const std::string &fileName,	//!< The location to write the recording to
+										unsigned int width,				//!< The number of pixels in a row
+										unsigned int height				//!< The number of rows in a frame
+									);
+
+									//! Stop accepting frames, write the ones still queued and close the file
+	void							Stop();
+
+									//! Queue a frame to be written, false if it was dropped or nothing is being recorded
+	bool							Push(
+										const DepthFrame &frame			//!< The frame to record
+									);
+
+									//! Are frames being accepted
+	bool							IsRecording() const
+									{
+										std::lock_guard<std::mutex> lock(m_mutex);
+										return m_recording;
+									}
+
+									//! Get the number of frames written since the recording started
+	unsigned int					GetFramesWritten() const
+									{
+										return m_framesWritten;
+									}
+
+									//! Get the number of frames dropped since the recording started
+	unsigned int					GetFramesDropped() const
+									{
+										return m_framesDropped;
+									}
+
+									//! Get the most frames which have been waiting to be written at once
+	unsigned int					GetMaximumQueueDepth() const
+									{
+										return m_maximumQueueDepth;
+									}
+
+									//! Get the number of encoded frame bytes written since the recording started
+	unsigned long long				GetBytesWritten() const
+									{
+										return m_bytesWritten;
+									}
+
+									//! Get a description of why the recording failed, empty if it hasn't
+	std::string						GetError() const
+									{
+										std::lock_guard<std::mutex> lock(m_mutex);
+										return m_error;
+									}
+};
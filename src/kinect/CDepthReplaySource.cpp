@@ -0,0 +1,198 @@
+#include "CDepthReplaySource.h"
+#include <string.h>
+#include <thread>
+
+/*
+ *	\brief Read a little endian 32 bit value from a byte buffer
+*/
+static unsigned int GetU32(
+		const unsigned char *bytes					//!< The first byte of the value
+	)
+{
+	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<unsigned int>(bytes[3]) << 24);
+}
+
+/*
+ *	\brief Class constructor
+*/
+CDepthReplaySource::CDepthReplaySource() :
+	m_speed(ReplaySpeed::AsFastAsPossible),
+	m_width(0),
+	m_height(0),
+	m_framesRead(0),
+	m_firstTimestamp(0)
+{
+
+}
+
+/*
+ *	\brief Class destructor
+*/
+CDepthReplaySource::~CDepthReplaySource()
+{
+
+}
+
+/*
+ *	\brief Set the replay as failed with a given reason
+*/
+bool CDepthReplaySource::Fail(
+		const char *error							//!< Why the recording could not be read
+	)
+{
+	m_error = error;
+	return false;
+}
+
+/*
+ *	\brief Open a recording and read its header
+*/
+bool CDepthReplaySource::Open(
+		const std::string &fileName,				//!< The recording to replay
+		ReplaySpeed::Enum speed						//!< How quickly the frames are handed out
+	)
+{
+	m_file.close();
+	m_file.clear();
+	m_error.clear();
+	m_speed = speed;
+	m_framesRead = 0;
+
+	m_file.open(fileName.c_str(), std::ios::binary);
+	if (!m_file)
+		return Fail("Failed to open the depth recording");
+
+	unsigned char header[DepthRecordingHeaderSize];
+	if (!m_file.read(reinterpret_cast<char *>(header), DepthRecordingHeaderSize))
+		return Fail("Failed to read the depth recording header");
+
+	if (memcmp(header, "VCDR", 4) != 0)
+		return Fail("The file is not a depth recording");
+
+	if (GetU32(header + 4) > DepthRecordingVersion)
+		return Fail("The depth recording was written by a newer version");
+
+	m_width = GetU32(header + 8);
+	m_height = GetU32(header + 12);
+	if (m_width == 0 || m_height == 0 || m_width > 4096 || m_height > 4096)
+		return Fail("The depth recording has a bad frame size");
+
+	m_pixels.resize(m_width * m_height);
+	return true;
+}
+
+/*
+ *	\brief Go back to the first frame
+*/
+void CDepthReplaySource::Rewind()
+{
+	m_file.clear();
+	m_file.seekg(DepthRecordingHeaderSize);
+	m_framesRead = 0;
+}
+
+/*
+ *	\brief Decode a frame chunk's payload into the pixels
+*/
+bool CDepthReplaySource::DecodeFrame(
+		DepthFrame &frame							//!< Receives the frame
+	)
+{
+	const unsigned int pixelCount = m_width * m_height;
+	if (m_chunk.size() < DepthFrameChunkHeaderSize)
+		return Fail("A depth frame chunk is too small");
+
+	const unsigned char *payload = &m_chunk[0];
+	frame.timestamp = GetU32(payload) | (static_cast<unsigned long long>(GetU32(payload + 4)) << 32);
+	const unsigned int encoding = GetU32(payload + 8);
+
+	const unsigned char *data = payload + DepthFrameChunkHeaderSize;
+	const unsigned int dataSize = static_cast<unsigned int>(m_chunk.size()) - DepthFrameChunkHeaderSize;
+
+	if (encoding == DepthFrameEncoding::Raw)
+	{
+		if (dataSize != pixelCount * 2)
+			return Fail("A raw depth frame is the wrong size");
+
+		for (unsigned int pixel = 0; pixel < pixelCount; ++pixel)
+		{
+			m_pixels[pixel] = static_cast<unsigned short>(data[pixel * 2] | (data[(pixel * 2) + 1] << 8));
+		}
+	}
+	else if (encoding == DepthFrameEncoding::KeyDelta || encoding == DepthFrameEncoding::FrameDelta)
+	{
+		// frame deltas decode in place over the frame before them
+		if (encoding == DepthFrameEncoding::FrameDelta && m_framesRead == 0)
+			return Fail("The depth recording starts without a key frame");
+
+		const unsigned short *previous = encoding == DepthFrameEncoding::FrameDelta ? &m_pixels[0] : nullptr;
+		if (!DecodeDepthDeltas(data, dataSize, previous, pixelCount, &m_pixels[0]))
+			return Fail("A delta encoded depth frame is malformed");
+	}
+	else
+	{
+		return Fail("A depth frame uses an unknown encoding");
+	}
+
+	frame.width = m_width;
+	frame.height = m_height;
+	frame.pixels = &m_pixels[0];
+	frame.buffer = nullptr;
+	return true;
+}
+
+/*
+ *	\brief Wait for the next frame, its pixels stay valid until the next call. False once there are no more frames
+*/
+bool CDepthReplaySource::GetNextFrame(
+		DepthFrame &frame							//!< Receives the frame
+	)
+{
+	if (!m_file.is_open() || !m_error.empty())
+		return false;
+
+	for (;;)
+	{
+		unsigned char chunkHeader[DepthChunkHeaderSize];
+		if (!m_file.read(reinterpret_cast<char *>(chunkHeader), DepthChunkHeaderSize))
+		{
+			// a clean end of the recording lands exactly on a chunk boundary
+			if (m_file.gcount() != 0)
+				Fail("The depth recording ends part way through a chunk");
+			return false;
+		}
+
+		const unsigned int chunkSize = GetU32(chunkHeader + 4);
+		if (memcmp(chunkHeader, "FRAM", 4) != 0)
+		{
+			m_file.seekg(chunkSize, std::ios::cur);
+			continue;
+		}
+
+		// a raw frame is 2 bytes a pixel, a delta encoded one at most 3, a token and a 16 bit difference each
+		if (chunkSize > DepthFrameChunkHeaderSize + (m_width * m_height * 3))
+			return Fail("A depth frame chunk is too large");
+
+		m_chunk.resize(chunkSize);
+		if (chunkSize > 0 && !m_file.read(reinterpret_cast<char *>(&m_chunk[0]), chunkSize))
+			return Fail("The depth recording ends part way through a frame");
+
+		if (!DecodeFrame(frame))
+			return false;
+
+		break;
+	}
+
+	if (m_framesRead == 0)
+	{
+		m_firstTimestamp = frame.timestamp;
+		m_firstFrameTime = Clock::now();
+	}
+	else if (m_speed == ReplaySpeed::RealTime && frame.timestamp > m_firstTimestamp)
+	{
+		std::this_thread::sleep_until(m_firstFrameTime + std::chrono::microseconds(frame.timestamp - m_firstTimestamp));
+	}
+
+	m_framesRead++;
+	return true;
+}
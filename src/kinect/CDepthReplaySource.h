@@ -0,0 +1,95 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "DepthRecording.h"
+#include "IDepthFrameSource.h"
+#include <chrono>
+
+struct ReplaySpeed {
+	enum Enum {
+		RealTime,						//!< Frames are handed out at the rate they were recorded
+		AsFastAsPossible,				//!< Frames are handed out as soon as they are read
+		Noof
+	};
+};
+
+/*
+ *	\brief Replays the frames of a depth recording, streaming them from the file one at a time.
+ *	At real time speed GetNextFrame sleeps until the frame is due, measured from when the
+ *	first frame was handed out, so the tracking code sees the same timing as the sensor.
+*/
+class CDepthReplaySource : public IDepthFrameSource {
+private:
+	typedef std::chrono::steady_clock	Clock;
+
+private:
+	std::ifstream					m_file;						//!< The recording being replayed
+	std::string						m_error;					//!< A description of why the recording could not be read
+	ReplaySpeed::Enum				m_speed;					//!< How quickly the frames are handed out
+	unsigned int					m_width;					//!< The number of pixels in a row
+	unsigned int					m_height;					//!< The number of rows in a frame
+	unsigned int					m_framesRead;				//!< The number of frames handed out since the start
+	std::vector<unsigned char>		m_chunk;					//!< The payload of the chunk being read
+	std::vector<unsigned short>		m_pixels;					//!< The pixels of the last frame handed out
+
+	unsigned long long				m_firstTimestamp;			//!< The timestamp of the first frame handed out
+	Clock::time_point				m_firstFrameTime;			//!< When the first frame was handed out
+
+private:
+									//! Set the replay as failed with a given reason
+	bool							Fail(
+										const char *error		//!< Why the recording could not be read
+									);
+
+									//! Decode a frame chunk's payload into the pixels
+	bool							DecodeFrame(
+										DepthFrame &frame		//!< Receives the frame
+									);
+
+public:
+									//! Class constructor
+									CDepthReplaySource();
+
+									//! Class destructor
+									~CDepthReplaySource();
+
+									//! Open a recording and read its header
+	bool							Open(
+										const std::string &fileName,	//!< The recording to replay
+										ReplaySpeed::Enum speed			//!< How quickly the frames are handed out
+									);
+
+									//! Wait for the next frame, its pixels stay valid until the next call. False once there are no more frames
+	virtual bool					GetNextFrame(
+										DepthFrame &frame		//!< Receives the frame
+									);
+
+									//! Go back to the first frame
+	void							Rewind();
+
+									//! Get the number of pixels in a row
+	unsigned int					GetWidth() const
+									{
+										return m_width;
+									}
+
+									//! Get the number of rows in a frame
+	unsigned int					GetHeight() const
+									{
+										return m_height;
+									}
+
+									//! Get the number of frames handed out since the start
+	unsigned int					GetFramesRead() const
+									{
+										return m_framesRead;
+									}
+
+									//! Get a description of why the recording could not be read, empty at the end of a good recording
+	const char						*GetError() const
+									{
+										return m_error.c_str();
+									}
+};
@@ -0,0 +1,271 @@
+#include "CFramePipeline.h"
+#include <string.h>
+
+/*
+ *	\brief Class constructor
+*/
+CFramePipeline::CFramePipeline() :
+	m_stageCount(0),
+	m_running(false),
+	m_width(0),
+	m_height(0),
+	m_framesPushed(0),
+	m_framesDropped(0),
+	m_framesCompleted(0),
+	m_framesCopied(0)
+{
+
+}
+
+/*
+ *	\brief Class destructor, stops the stage threads
+*/
+CFramePipeline::~CFramePipeline()
+{
+	Stop();
+}
+
+/*
+ *	\brief Add a stage after the ones already added, false if the pipeline is running or full
+*/
+bool CFramePipeline::AddStage(
+		const std::string &name,					//!< The name the stage is reported under
+		const PipelineStageFunction &process		//!< What the stage does to each frame, called on the stage's thread
+	)
+{
+	if (m_running || m_stageCount == MaximumStages)
+		return false;
+
+	m_stages[m_stageCount].name = name;
+	m_stages[m_stageCount].process = process;
+	m_stageCount++;
+	return true;
+}
+
+/*
+ *	\brief Allocate the pooled frames and start a thread for each stage, stopping the pipeline first if it is running
+ *	Fails if a source still holds one of the pipeline's depth buffers.
+*/
+bool CFramePipeline::Start(
+		unsigned int width,							//!< The number of pixels in a row of a frame
+		unsigned int height							//!< The number of rows in a frame
+	)
+{
+	Stop();
+
+	// the frames and their buffers are allocated up front so pushing a frame never allocates
+	if (m_stageCount == 0 || !m_buffers.Create(width, height, PoolSize + SourceBuffers))
+		return false;
+
+	m_width = width;
+	m_height = height;
+
+	m_free.Clear();
+	for (unsigned int frame = 0; frame < PoolSize; ++frame)
+	{
+		m_pool[frame].width = width;
+		m_pool[frame].height = height;
+		m_pool[frame].buffer = nullptr;
+		m_pool[frame].depth = nullptr;
+		m_pool[frame].pyramid.Create(width, height, PyramidLevels);
+		m_free.TryPush(&m_pool[frame]);
+	}
+
+	m_pushLatency.Reset();
+	m_endToEnd.Reset();
+	m_framesPushed = 0;
+	m_framesDropped = 0;
+	m_framesCompleted = 0;
+	m_framesCopied = 0;
+
+	m_running = true;
+	for (unsigned int stage = 0; stage < m_stageCount; ++stage)
+	{
+		m_stages[stage].input.Clear();
+		m_stages[stage].latency.Reset();
+		m_stages[stage].wait.Reset();
+		m_stages[stage].thread = std::thread(&CFramePipeline::StageThread, this, stage);
+	}
+
+	return true;
+}
+
+/*
+ *	\brief Stop the stage threads, frames still in flight are abandoned and their buffers released
+*/
+void CFramePipeline::Stop()
+{
+	m_running = false;
+
+	for (unsigned int stage = 0; stage < m_stageCount; ++stage)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_stages[stage].mutex);
+			m_stages[stage].wake.notify_one();
+		}
+
+		if (m_stages[stage].thread.joinable())
+		{
+			m_stages[stage].thread.join();
+		}
+	}
+
+	// with every stage stopped the frames waiting for one go back to the pool, so no buffer leaks
+	for (unsigned int stage = 0; stage < m_stageCount; ++stage)
+	{
+		PipelineFrame *frame;
+		while (m_stages[stage].input.TryPop(frame))
+		{
+			ReleaseBuffer(*frame);
+			m_free.TryPush(frame);
+		}
+	}
+}
+
+/*
+ *	\brief Take a reference to a frame's pooled buffer, or copy the frame into one, false if it was dropped. Always call from the same thread
+*/
+bool CFramePipeline::Push(
+		const DepthFrame &frame						//!< The frame to process
+	)
+{
+	if (!m_running)
+		return false;
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	const unsigned long long sequence = m_framesPushed++;
+
+	if (frame.width != m_width || frame.height != m_height)
+	{
+		m_framesDropped++;
+		return false;
+	}
+
+	// a pooled frame is shared, only a frame the source will overwrite needs a buffer of its own
+	CDepthBuffer *buffer = frame.buffer;
+	if (buffer != nullptr)
+	{
+		buffer->AddReference();
+	}
+	else
+	{
+		buffer = m_buffers.Acquire();
+		if (buffer == nullptr)
+		{
+			m_framesDropped++;
+			return false;
+		}
+	}
+
+	PipelineFrame *pooled;
+	if (!m_free.TryPop(pooled))
+	{
+		buffer->Release();
+		m_framesDropped++;
+		return false;
+	}
+
+	if (frame.buffer == nullptr)
+	{
+		memcpy(buffer->GetPixels(), frame.pixels, frame.width * frame.height * sizeof(unsigned short));
+		m_framesCopied++;
+	}
+
+	pooled->timestamp = frame.timestamp;
+	pooled->sequence = sequence;
+	pooled->buffer = buffer;
+	pooled->depth = frame.buffer != nullptr ? frame.pixels : buffer->GetPixels();
+
+	pooled->pushedAt = start;
+	pooled->queuedAt = std::chrono::steady_clock::now();
+	m_pushLatency.Add(GetMicroseconds(start, pooled->queuedAt));
+
+	Forward(m_stages[0], pooled);
+	return true;
+}
+
+/*
+ *	\brief Queue a frame for a stage and wake it
+*/
+void CFramePipeline::Forward(
+		Stage &stage,								//!< The stage to hand the frame to
+		PipelineFrame *frame						//!< The frame
+	)
+{
+	// there are only as many frames as ring slots, so the push can't fail
+	stage.input.TryPush(frame);
+
+	// taking the lock means the stage is either asleep and gets woken, or hasn't checked its ring yet
+	std::lock_guard<std::mutex> lock(stage.mutex);
+	stage.wake.notify_one();
+}
+
+/*
+ *	\brief A stage's worker thread entry point
+*/
+void CFramePipeline::StageThread(
+		unsigned int index							//!< The index of the stage
+	)
+{
+	Stage &stage = m_stages[index];
+	const bool last = index + 1 == m_stageCount;
+
+	while (m_running)
+	{
+		PipelineFrame *frame;
+		if (!stage.input.TryPop(frame))
+		{
+			std::unique_lock<std::mutex> lock(stage.mutex);
+			while (m_running && stage.input.IsEmpty())
+			{
+				stage.wake.wait(lock);
+			}
+
+			continue;
+		}
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		stage.wait.Add(GetMicroseconds(frame->queuedAt, start));
+
+		stage.process(*frame);
+
+		frame->queuedAt = std::chrono::steady_clock::now();
+		stage.latency.Add(GetMicroseconds(start, frame->queuedAt));
+
+		if (!last)
+		{
+			Forward(m_stages[index + 1], frame);
+			continue;
+		}
+
+		// back to the pool before it counts as done, so an idle pipeline has every frame and buffer free
+		m_endToEnd.Add(GetMicroseconds(frame->pushedAt, frame->queuedAt));
+		ReleaseBuffer(*frame);
+		m_free.TryPush(frame);
+		m_framesCompleted++;
+	}
+}
+
+/*
+ *	\brief Release a frame's reference to its depth buffer
+*/
+void CFramePipeline::ReleaseBuffer(
+		PipelineFrame &frame						//!< The frame
+	)
+{
+	frame.buffer->Release();
+	frame.buffer = nullptr;
+	frame.depth = nullptr;
+}
+
+/*
+ *	\brief Get the number of microseconds between two times
+*/
+unsigned long long CFramePipeline::GetMicroseconds(
+		const std::chrono::steady_clock::time_point &from,	//!< The earlier time
+		const std::chrono::steady_clock::time_point &to		//!< The later time
+	)
+{
+	const long long microseconds = std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+	return microseconds > 0 ? static_cast<unsigned long long>(microseconds) : 0;
+}
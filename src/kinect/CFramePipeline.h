@@ -0,0 +1,225 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "CDepthBufferPool.h"
+#include "CDepthPyramid.h"
+#include "CLatencyHistogram.h"
+#include "HandFrame.h"
+#include "IDepthFrameSource.h"
+#include "SpscRing.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ *	\brief A depth frame on its way through the pipeline, and what each stage made of it
+*/
+struct PipelineFrame
+{
+	unsigned int					width;								//!< The number of pixels in a row
+	unsigned int					height;								//!< The number of rows in the frame
+	unsigned long long				timestamp;							//!< When the sensor captured the frame, in microseconds
+	unsigned long long				sequence;							//!< The number of frames pushed before this one
+	CDepthBuffer					*buffer;							//!< The pooled buffer holding the depth, the frame holds a reference to it until the last stage
+	const unsigned short			*depth;								//!< The packed depth pixels, in the buffer
+	CDepthPyramid					pyramid;							//!< The depth at lower resolutions, built by a stage for the stages after it
+	HandFrame						hand;								//!< Where the hand is and what state it is in
+
+	std::chrono::steady_clock::time_point	pushedAt;					//!< When the frame was pushed into the pipeline
+	std::chrono::steady_clock::time_point	queuedAt;					//!< When the frame was last handed to a stage
+};
+
+typedef std::function<void (PipelineFrame &frame)>	PipelineStageFunction;
+
+/*
+ *	\brief Runs depth frames through a chain of stages, each on its own thread.
+ *	A fixed pool of frames, and of depth buffers for their pixels, is allocated when the
+ *	pipeline starts. A source which fills buffers of the pipeline's pool hands its frames
+ *	over by reference, only frames from elsewhere are copied into a buffer. Pushing a frame
+ *	hands it to the first stage; each stage hands it to the next through a single producer
+ *	single consumer ring, and the last stage releases the depth buffer and gives the frame
+ *	back to the free ring. A slow stage therefore only holds up the stages after it, and
+ *	when every pooled frame or buffer is still in flight a new frame is dropped and counted
+ *	instead of making the thread pushing it wait. Every stage keeps a histogram of how long it took and how long
+ *	frames queued for it, and the pipeline keeps one of the time from push to the last stage.
+*/
+class CFramePipeline {
+public:
+	static const unsigned int		MaximumStages = 8;					//!< The most stages a pipeline can have
+	static const unsigned int		PoolSize = 4;						//!< The number of frames which can be in flight at once
+	static const unsigned int		SourceBuffers = 1;					//!< The depth buffers a source can hold on top of the frames in flight
+	static const unsigned int		PyramidLevels = 3;					//!< The levels of each frame's depth pyramid, 640x480 down to 160x120
+
+private:
+
+	typedef CSpscRing<PipelineFrame *, PoolSize>	FrameRing;
+
+	struct Stage {
+		std::string					name;								//!< The name the stage is reported under
+		PipelineStageFunction		process;							//!< What the stage does to each frame
+		std::thread					thread;								//!< The stage's worker
+		FrameRing					input;								//!< The frames waiting for the stage
+		std::mutex					mutex;								//!< Guards sleeping on the wake condition
+		std::condition_variable		wake;								//!< Signalled when a frame is queued or the pipeline stops
+		CLatencyHistogram			latency;							//!< How long the stage took over each frame
+		CLatencyHistogram			wait;								//!< How long each frame queued before the stage took it
+	};
+
+private:
+	Stage							m_stages[MaximumStages];			//!< The stages, in the order frames go through them
+	unsigned int					m_stageCount;						//!< The number of stages added
+	PipelineFrame					m_pool[PoolSize];					//!< Every frame the pipeline can hold
+	FrameRing						m_free;								//!< The frames no stage holds, filled by the last stage and emptied by push
+	CDepthBufferPool				m_buffers;							//!< The depth buffers of the frames, and of the source filling them
+	std::atomic<bool>				m_running;							//!< Are the stage threads running
+	unsigned int					m_width;							//!< The number of pixels in a row of a frame
+	unsigned int					m_height;							//!< The number of rows in a frame
+
+	CLatencyHistogram				m_pushLatency;						//!< How long each push took to take its frame in
+	CLatencyHistogram				m_endToEnd;							//!< How long each frame took from push to leaving the last stage
+	std::atomic<unsigned long long>	m_framesPushed;						//!< The number of frames offered to the pipeline
+	std::atomic<unsigned long long>	m_framesDropped;					//!< The number of frames dropped because no pooled frame or buffer was free
+	std::atomic<unsigned long long>	m_framesCompleted;					//!< The number of frames which left the last stage
+	std::atomic<unsigned long long>	m_framesCopied;						//!< The number of frames copied in because they weren't in a pooled buffer
+
+private:
+									//! A stage's worker thread entry point
+	void							StageThread(
+										unsigned int index				//!< The index of the stage
+									);
+
+									//! Queue a frame for a stage and wake it
+	void							Forward(
+										Stage &stage,					//!< The stage to hand the frame to
+										PipelineFrame *frame			//!< The frame
+									);
+
+									//! Release a frame's reference to its depth buffer
+	static void						ReleaseBuffer(
+										PipelineFrame &frame			//!< The frame
+									);
+
+									//! Get the number of microseconds between two times
+	static unsigned long long		GetMicroseconds(
+										const std::chrono::steady_clock::time_point &from,	//!< The earlier time
+										const std::chrono::steady_clock::time_point &to		//!< The later time
+									);
+
+public:
+									//! Class constructor
+									CFramePipeline();
+
+									//! Class destructor, stops the stage threads
+									~CFramePipeline();
+
+									//! Add a stage after the ones already added, false if the pipeline is running or full
+	bool							AddStage(
+										const std::string &name,		//!< The name the stage is reported under
+										const PipelineStageFunction &process	//!< What the stage does to each frame, called on the stage's thread
+									);
+
+									//! Allocate the pooled frames and start a thread for each stage, stopping the pipeline first if it is running. False if a source still holds a buffer
+	bool							Start(
+										unsigned int width,				//!< The number of pixels in a row of a frame
+										unsigned int height				//!< The number of rows in a frame
+									);
+
+									//! Stop the stage threads, frames still in flight are abandoned and their buffers released
+	void							Stop();
+
+									//! Take a reference to a frame's pooled buffer, or copy the frame into one, false if it was dropped. Always call from the same thread
+	bool							Push(
+										const DepthFrame &frame			//!< The frame to process
+									);
+
+									//! Is every frame pushed either dropped or out of the last stage, ask from the thread which pushes
+	bool							IsIdle() const
+									{
+										return m_framesPushed == m_framesDropped + m_framesCompleted;
+									}
+
+									//! Get the number of stages
+	unsigned int					GetStageCount() const
+									{
+										return m_stageCount;
+									}
+
+									//! Get the name of a stage
+	const std::string				&GetStageName(
+										unsigned int stage				//!< The index of the stage
+									) const
+									{
+										return m_stages[stage].name;
+									}
+
+									//! Get how long a stage took over each frame
+	const CLatencyHistogram			&GetStageLatency(
+										unsigned int stage				//!< The index of the stage
+									) const
+									{
+										return m_stages[stage].latency;
+									}
+
+									//! Get how long frames queued before a stage took them
+	const CLatencyHistogram			&GetStageWait(
+										unsigned int stage				//!< The index of the stage
+									) const
+									{
+										return m_stages[stage].wait;
+									}
+
+									//! Get the pool of depth buffers, which a source can fill to hand its frames over without a copy
+	CDepthBufferPool				&GetBufferPool()
+									{
+										return m_buffers;
+									}
+
+									//! Get the pool of depth buffers
+	const CDepthBufferPool			&GetBufferPool() const
+									{
+										return m_buffers;
+									}
+
+									//! Get how long each push took to take its frame in
+	const CLatencyHistogram			&GetPushLatency() const
+									{
+										return m_pushLatency;
+									}
+
+									//! Get how long frames took from push to leaving the last stage
+	const CLatencyHistogram			&GetEndToEndLatency() const
+									{
+										return m_endToEnd;
+									}
+
+									//! Get the number of frames offered to the pipeline since it started
+	unsigned long long				GetFramesPushed() const
+									{
+										return m_framesPushed;
+									}
+
+									//! Get the number of frames dropped since the pipeline started
+	unsigned long long				GetFramesDropped() const
+									{
+										return m_framesDropped;
+									}
+
+									//! Get the number of frames which left the last stage since the pipeline started
+	unsigned long long				GetFramesCompleted() const
+									{
+										return m_framesCompleted;
+									}
+
+									//! Get the number of frames copied in since the pipeline started, because they weren't in a pooled buffer
+	unsigned long long				GetFramesCopied() const
+									{
+										return m_framesCopied;
+									}
+};
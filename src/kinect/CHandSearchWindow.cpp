@@ -0,0 +1,176 @@
+#include "CHandSearchWindow.h"
+
+/*
+ *	\brief Class constructor
+*/
+CHandSearchWindow::CHandSearchWindow() :
+	m_margin(0),
+	m_frameCount(0),
+	m_fullSearches(0),
+	m_pixelsSearched(0)
+{
+	const MaskArea empty = { 0, 0, 0, 0 };
+	m_frame = empty;
+	m_window = empty;
+}
+
+/*
+ *	\brief Class destructor
+*/
+CHandSearchWindow::~CHandSearchWindow()
+{
+
+}
+
+/*
+ *	\brief Set the frame size and the margin, and search the whole frame next
+*/
+void CHandSearchWindow::Create(
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows
+		unsigned int margin							//!< The pixels the window reaches past the hand area on each side
+	)
+{
+	const MaskArea frame = { 0, 0, width, height };
+	m_frame = frame;
+	m_window = frame;
+	m_margin = margin;
+
+	m_frameCount = 0;
+	m_fullSearches = 0;
+	m_pixelsSearched = 0;
+}
+
+/*
+ *	\brief Lose the hand, so the whole frame is searched next, ending the frame
+*/
+void CHandSearchWindow::Reset()
+{
+	m_window = m_frame;
+	m_frameCount++;
+}
+
+/*
+ *	\brief Follow a hand found this frame, so the area around it is searched next, ending the frame
+*/
+void CHandSearchWindow::Follow(
+		const MaskArea &handArea					//!< The hand area, right and bottom exclusive
+	)
+{
+	SetWindow(handArea, m_margin);
+	m_frameCount++;
+}
+
+/*
+ *	\brief Search around where a lost hand might be this frame, rather than the whole frame
+*/
+void CHandSearchWindow::Focus(
+		const MaskArea &candidate,					//!< Where the hand might be, right and bottom exclusive
+		unsigned int margin							//!< The pixels the window reaches past the candidate on each side
+	)
+{
+	SetWindow(candidate, margin);
+}
+
+/*
+ *	\brief Set the window to an area grown by a margin on every side, inside the frame
+*/
+void CHandSearchWindow::SetWindow(
+		const MaskArea &area,						//!< The area
+		unsigned int margin							//!< The pixels the window reaches past the area on each side
+	)
+{
+	m_window.left = area.left > margin ? area.left - margin : 0;
+	m_window.top = area.top > margin ? area.top - margin : 0;
+	m_window.right = area.right + margin < m_frame.right ? area.right + margin : m_frame.right;
+	m_window.bottom = area.bottom + margin < m_frame.bottom ? area.bottom + margin : m_frame.bottom;
+}
+
+/*
+ *	\brief Look for a lost hand in the coarsest level of a depth pyramid and focus on the likeliest blob, false if there is none
+*/
+bool CHandSearchWindow::Acquire(
+		const CDepthPyramid &pyramid,				//!< The depth pyramid of the frame
+		int nearPoint,								//!< The nearest depth in the hand band, in millimetres
+		int farPoint,								//!< One past the furthest depth in the hand band, in millimetres
+		unsigned int minimumArea,					//!< The fewest frame pixels a blob can have
+		unsigned int smallestHand,					//!< The narrowest a hand can be, in frame pixels
+		unsigned int largestHand					//!< The widest a hand can be, in frame pixels
+	)
+{
+	const unsigned int level = pyramid.GetLevelCount() - 1;
+	const unsigned int scale = 1 << level;
+	const unsigned int width = pyramid.GetLevelWidth(level);
+	const unsigned int height = pyramid.GetLevelHeight(level);
+
+	if (m_coarseMask.size() != width * height)
+	{
+		m_coarseMask.resize(width * height);
+		m_coarseLabeller.Create(width, height);
+	}
+
+	const MaskArea levelArea = { 0, 0, width, height };
+	const MaskArea bandArea = ThresholdDepthWindow(pyramid.GetLevel(level), width, levelArea, nearPoint, farPoint, &m_coarseMask[0]);
+	AddSearch(levelArea);
+
+	m_coarseLabeller.Label(&m_coarseMask[0], bandArea, minimumArea / (scale * scale));
+
+	// the largest blob about as wide as a hand, each side of a coarse blob is only known to a coarse pixel
+	const std::vector<MaskBlob> &blobs = m_coarseLabeller.GetBlobs();
+	const MaskBlob *handBlob = nullptr;
+	for (unsigned int blob = 0; blob < blobs.size(); ++blob)
+	{
+		const unsigned int blobWidth = (blobs[blob].bounds.right - 1 - blobs[blob].bounds.left) * scale;
+		if (blobWidth + (scale * 2) < smallestHand || blobWidth > largestHand + (scale * 2))
+			continue;
+
+		if (handBlob == nullptr || blobs[blob].area > handBlob->area)
+		{
+			handBlob = &blobs[blob];
+		}
+	}
+
+	if (handBlob == nullptr)
+		return false;
+
+	// the hand area hangs 1.3 widths below the top of the blob, the margin covers the coarse pixels at its edges
+	MaskArea candidate;
+	candidate.left = handBlob->bounds.left * scale;
+	candidate.top = handBlob->bounds.top * scale;
+	candidate.right = handBlob->bounds.right * scale;
+	candidate.bottom = candidate.top + static_cast<unsigned int>((candidate.right - candidate.left) * 1.3f);
+
+	Focus(candidate, scale * 2);
+	return true;
+}
+
+/*
+ *	\brief Count the pixels of a search
+*/
+void CHandSearchWindow::AddSearch(
+		const MaskArea &searched					//!< The area searched
+	)
+{
+	m_pixelsSearched += static_cast<unsigned long long>(searched.right - searched.left) * (searched.bottom - searched.top);
+
+	if (searched.left == m_frame.left && searched.top == m_frame.top && searched.right == m_frame.right && searched.bottom == m_frame.bottom)
+	{
+		m_fullSearches++;
+	}
+}
+
+/*
+ *	\brief Could a hand found in the window have been cut off by its edge, rather than ending inside it
+*/
+bool CHandSearchWindow::IsCut(
+		const MaskArea &handBounds					//!< The bounds of the hand blob and the pixels around its hand area which are needed
+	) const
+{
+	// the arm carries on below the hand, so a blob may run off the bottom, but the pixels below the hand area mustn't
+	if (handBounds.left <= m_window.left && m_window.left != m_frame.left) return true;
+	if (handBounds.top <= m_window.top && m_window.top != m_frame.top) return true;
+	if (handBounds.right >= m_window.right && m_window.right != m_frame.right) return true;
+	if (handBounds.bottom > m_window.bottom && m_window.bottom != m_frame.bottom) return true;
+
+	return false;
+}
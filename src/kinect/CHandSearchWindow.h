@@ -0,0 +1,124 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "CBlobLabeller.h"
+#include "CDepthPyramid.h"
+#include "DepthBand.h"
+#include <vector>
+
+/*
+ *	\brief The window of the depth frame the hand is searched for in.
+ *	While a hand is followed only the hand area grown by a margin on every side is searched,
+ *	the hand only moves a few pixels between frames. When no hand was found last frame, or
+ *	the hand found in the window runs into its edge, the whole frame is searched instead.
+ *	A lost hand is looked for in the coarsest level of the depth pyramid first, a sixteenth
+ *	of the pixels, and only the area around the likeliest blob there is searched in full.
+ *	The number of pixels searched is counted, so the saving can be measured.
+*/
+class CHandSearchWindow {
+private:
+	unsigned int				m_margin;						//!< The pixels the window reaches past the hand area on each side
+	MaskArea					m_frame;						//!< The whole frame
+	MaskArea					m_window;						//!< The window to search next frame, the whole frame when no hand is followed
+
+	std::vector<unsigned char>	m_coarseMask;					//!< The depth band of the coarsest pyramid level
+	CBlobLabeller				m_coarseLabeller;				//!< Splits the coarse band into blobs
+
+	unsigned long long			m_frameCount;					//!< The number of frames searched
+	unsigned long long			m_fullSearches;					//!< The number of searches of the whole frame
+	unsigned long long			m_pixelsSearched;				//!< The number of pixels searched over every frame
+
+private:
+								//! Set the window to an area grown by a margin on every side, inside the frame
+	void						SetWindow(
+									const MaskArea &area,		//!< The area
+									unsigned int margin			//!< The pixels the window reaches past the area on each side
+								);
+
+public:
+								//! Class constructor
+								CHandSearchWindow();
+
+								//! Class destructor
+								~CHandSearchWindow();
+
+								//! Set the frame size and the margin, and search the whole frame next
+	void						Create(
+									unsigned int width,			//!< The number of pixels in a row
+									unsigned int height,		//!< The number of rows
+									unsigned int margin			//!< The pixels the window reaches past the hand area on each side
+								);
+
+								//! Lose the hand, so the whole frame is searched next, ending the frame
+	void						Reset();
+
+								//! Follow a hand found this frame, so the area around it is searched next, ending the frame
+	void						Follow(
+									const MaskArea &handArea	//!< The hand area, right and bottom exclusive
+								);
+
+								//! Search around where a lost hand might be this frame, rather than the whole frame
+	void						Focus(
+									const MaskArea &candidate,	//!< Where the hand might be, right and bottom exclusive
+									unsigned int margin			//!< The pixels the window reaches past the candidate on each side
+								);
+
+								//! Look for a lost hand in the coarsest level of a depth pyramid and focus on the likeliest blob, false if there is none
+	bool						Acquire(
+									const CDepthPyramid &pyramid,	//!< The depth pyramid of the frame
+									int nearPoint,				//!< The nearest depth in the hand band, in millimetres
+									int farPoint,				//!< One past the furthest depth in the hand band, in millimetres
+									unsigned int minimumArea,	//!< The fewest frame pixels a blob can have
+									unsigned int smallestHand,	//!< The narrowest a hand can be, in frame pixels
+									unsigned int largestHand	//!< The widest a hand can be, in frame pixels
+								);
+
+								//! Count the pixels of a search
+	void						AddSearch(
+									const MaskArea &searched	//!< The area searched
+								);
+
+								//! Could a hand found in the window have been cut off by its edge, rather than ending inside it
+	bool						IsCut(
+									const MaskArea &handBounds	//!< The bounds of the hand blob and the pixels around its hand area which are needed
+								) const;
+
+								//! Get the window to search this frame
+	const MaskArea				&GetWindow() const
+								{
+									return m_window;
+								}
+
+								//! Get the whole frame
+	const MaskArea				&GetFrame() const
+								{
+									return m_frame;
+								}
+
+								//! Is only a window around the last hand searched
+	bool						IsWindowed() const
+								{
+									return m_window.left != m_frame.left || m_window.top != m_frame.top
+										|| m_window.right != m_frame.right || m_window.bottom != m_frame.bottom;
+								}
+
+								//! Get the number of frames searched
+	unsigned long long			GetFrameCount() const
+								{
+									return m_frameCount;
+								}
+
+								//! Get the number of searches of the whole frame
+	unsigned long long			GetFullSearches() const
+								{
+									return m_fullSearches;
+								}
+
+								//! Get the number of pixels searched over every frame
+	unsigned long long			GetPixelsSearched() const
+								{
+									return m_pixelsSearched;
+								}
+};
@@ -0,0 +1,304 @@
+#include "CHandShapeClassifier.h"
+#include <algorithm>
+#include <math.h>
+
+// The eight neighbours of a pixel, clockwise from the east with rows running down
+static const int NeighbourX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static const int NeighbourY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+// The neighbour index of each offset, indexed by the row offset + 1 then the column offset + 1
+static const unsigned int NeighbourIndex[3][3] = { { 5, 6, 7 }, { 4, 0, 0 }, { 3, 2, 1 } };
+
+// The first pixel of a blob scanning rows top to bottom always has a background pixel to the west
+static const unsigned int StartBacktrack = 4;
+
+// A valley between fingers is at least this deep, in pixels and as a fraction of the square root of the hull area
+static const float MinimumValleyDepth = 6.0f;
+static const float ValleyDepthFraction = 0.2f;
+
+// The sides of a valley between fingers meet at no more than a right angle, this is the cosine of the widest
+static const float MinimumValleyCosine = 0.0f;
+
+// The solidity of a fist, and of a hand with its fingers spread
+static const float FistSolidity = 0.9f;
+static const float OpenSolidity = 0.65f;
+
+// How much the finger count and the solidity each count towards the openness
+static const float FingerWeight = 0.65f;
+static const float SolidityWeight = 0.35f;
+
+/*
+ *	\brief Get twice the signed area of the triangle of three points, positive when they turn clockwise on screen
+*/
+static int Cross(
+		const ContourPoint &origin,					//!< The point the other two are measured from
+		const ContourPoint &first,					//!< The first point
+		const ContourPoint &second					//!< The second point
+	)
+{
+	return ((first.x - origin.x) * (second.y - origin.y)) - ((first.y - origin.y) * (second.x - origin.x));
+}
+
+/*
+ *	\brief Orders contour indices by the column then the row of their points
+*/
+struct ContourPointOrder
+{
+	const std::vector<ContourPoint>	*contour;					//!< The contour the indices refer to
+
+	bool					operator()(
+								unsigned int first,				//!< The index of the first point
+								unsigned int second				//!< The index of the second point
+							) const
+							{
+								const ContourPoint &a = (*contour)[first];
+								const ContourPoint &b = (*contour)[second];
+								return a.x < b.x || (a.x == b.x && a.y < b.y);
+							}
+};
+
+/*
+ *	\brief Class constructor
+*/
+CHandShapeClassifier::CHandShapeClassifier()
+{
+
+}
+
+/*
+ *	\brief Class destructor
+*/
+CHandShapeClassifier::~CHandShapeClassifier()
+{
+
+}
+
+/*
+ *	\brief Classify the blob containing the start pixel, which must be its top left pixel
+*/
+HandShape CHandShapeClassifier::Classify(
+		const unsigned char *mask,					//!< The mask, non zero pixels are the hand
+		unsigned int width,							//!< The number of pixels in a row of the mask
+		const MaskArea &area,						//!< The hand area, pixels outside it are background
+		unsigned int startX,						//!< The column of the blob's first pixel in the area, scanning rows top to bottom
+		unsigned int startY							//!< The row of the blob's first pixel in the area
+	)
+{
+	HandShape shape = { 0.0f, 0.0f, 1.0f, 0, 0.0f };
+
+	TraceContour(mask, width, area, startX, startY);
+	FindHull();
+	FindDefects();
+
+	if (m_hull.size() < 3)
+		return shape;
+
+	// the shoelace formula over the outline and over the hull
+	int twiceArea = 0;
+	for (unsigned int point = 0; point < m_contour.size(); ++point)
+	{
+		const ContourPoint &current = m_contour[point];
+		const ContourPoint &next = m_contour[(point + 1) % m_contour.size()];
+		twiceArea += (current.x * next.y) - (next.x * current.y);
+	}
+
+	int twiceHullArea = 0;
+	for (unsigned int point = 0; point < m_hullWork.size(); ++point)
+	{
+		const ContourPoint &current = m_contour[m_hullWork[point]];
+		const ContourPoint &next = m_contour[m_hullWork[(point + 1) % m_hullWork.size()]];
+		twiceHullArea += (current.x * next.y) - (next.x * current.y);
+	}
+
+	shape.area = fabs(twiceArea * 0.5f);
+	shape.hullArea = fabs(twiceHullArea * 0.5f);
+	if (shape.hullArea < 1.0f)
+		return shape;
+
+	shape.solidity = shape.area / shape.hullArea;
+
+	// deep narrow dips are the valleys between fingers, the wrist and noise make wide or shallow ones
+	const float minimumDepth = std::max(MinimumValleyDepth, ValleyDepthFraction * sqrt(shape.hullArea));
+
+	m_fingerValleys.clear();
+	for (unsigned int defect = 0; defect < m_defects.size(); ++defect)
+	{
+		const ConvexityDefect &dip = m_defects[defect];
+		if (dip.depth < minimumDepth)
+			continue;
+
+		const ContourPoint &start = m_contour[dip.start];
+		const ContourPoint &end = m_contour[dip.end];
+		const ContourPoint &deepest = m_contour[dip.deepest];
+
+		const float startX = static_cast<float>(start.x - deepest.x);
+		const float startY = static_cast<float>(start.y - deepest.y);
+		const float endX = static_cast<float>(end.x - deepest.x);
+		const float endY = static_cast<float>(end.y - deepest.y);
+		const float lengths = sqrt(((startX * startX) + (startY * startY)) * ((endX * endX) + (endY * endY)));
+		if (lengths <= 0.0f || ((startX * endX) + (startY * endY)) / lengths < MinimumValleyCosine)
+			continue;
+
+		m_fingerValleys.push_back(defect);
+	}
+
+	// every valley sits between two fingers
+	const unsigned int valleys = static_cast<unsigned int>(m_fingerValleys.size());
+	shape.fingers = valleys == 0 ? 0 : valleys >= 4 ? 5 : valleys + 1;
+
+	const float fingerEvidence = shape.fingers >= 3 ? 1.0f : shape.fingers == 2 ? 0.6f : 0.0f;
+	float solidityEvidence = (FistSolidity - shape.solidity) / (FistSolidity - OpenSolidity);
+	solidityEvidence = solidityEvidence < 0.0f ? 0.0f : solidityEvidence > 1.0f ? 1.0f : solidityEvidence;
+
+	shape.openness = (fingerEvidence * FingerWeight) + (solidityEvidence * SolidityWeight);
+	return shape;
+}
+
+/*
+ *	\brief Trace the outer contour of the blob containing the start pixel
+*/
+void CHandShapeClassifier::TraceContour(
+		const unsigned char *mask,					//!< The mask, non zero pixels are the hand
+		unsigned int width,							//!< The number of pixels in a row of the mask
+		const MaskArea &area,						//!< Pixels outside this area are background
+		unsigned int startX,						//!< The column of the start pixel
+		unsigned int startY							//!< The row of the start pixel
+	)
+{
+	m_contour.clear();
+
+	if (startX < area.left || startX >= area.right || startY < area.top || startY >= area.bottom || mask[(startY * width) + startX] == 0)
+		return;
+
+	const ContourPoint start = { static_cast<int>(startX), static_cast<int>(startY) };
+	m_contour.push_back(start);
+
+	// each pixel of the outline is met at most once from each of its 8 sides
+	const unsigned int maximumLength = (area.right - area.left) * (area.bottom - area.top) * 8;
+
+	ContourPoint current = start;
+	unsigned int backtrack = StartBacktrack;
+
+	// Moore neighbour tracing, stopping when the start pixel is entered the way it was first left
+	while (m_contour.size() < maximumLength)
+	{
+		unsigned int direction = 8;
+		for (unsigned int turn = 1; turn <= 8; ++turn)
+		{
+			const unsigned int candidate = (backtrack + turn) % 8;
+			const int x = current.x + NeighbourX[candidate];
+			const int y = current.y + NeighbourY[candidate];
+
+			if (x >= static_cast<int>(area.left) && x < static_cast<int>(area.right) && y >= static_cast<int>(area.top) && y < static_cast<int>(area.bottom)
+				&& mask[(y * width) + x] != 0)
+			{
+				direction = candidate;
+				break;
+			}
+		}
+
+		// a lone pixel
+		if (direction == 8)
+			break;
+
+		// the background pixel checked last becomes the backtrack of the next pixel
+		const unsigned int checked = (direction + 7) % 8;
+		const ContourPoint next = { current.x + NeighbourX[direction], current.y + NeighbourY[direction] };
+		backtrack = NeighbourIndex[(current.y + NeighbourY[checked]) - next.y + 1][(current.x + NeighbourX[checked]) - next.x + 1];
+
+		if (next.x == start.x && next.y == start.y && backtrack == StartBacktrack)
+			break;
+
+		m_contour.push_back(next);
+		current = next;
+	}
+}
+
+/*
+ *	\brief Find the convex hull of the contour
+*/
+void CHandShapeClassifier::FindHull()
+{
+	m_hull.clear();
+	m_hullWork.clear();
+
+	const unsigned int count = static_cast<unsigned int>(m_contour.size());
+	if (count < 3)
+		return;
+
+	for (unsigned int point = 0; point < count; ++point)
+	{
+		m_hull.push_back(point);
+	}
+
+	ContourPointOrder order = { &m_contour };
+	std::sort(m_hull.begin(), m_hull.end(), order);
+
+	// Andrew's monotone chain, the lower then the upper half, dropping points on the edges
+	for (unsigned int point = 0; point < count; ++point)
+	{
+		while (m_hullWork.size() >= 2 && Cross(m_contour[m_hullWork[m_hullWork.size() - 2]], m_contour[m_hullWork.back()], m_contour[m_hull[point]]) <= 0)
+			m_hullWork.pop_back();
+		m_hullWork.push_back(m_hull[point]);
+	}
+
+	const size_t lowerSize = m_hullWork.size() + 1;
+	for (int point = static_cast<int>(count) - 2; point >= 0; --point)
+	{
+		while (m_hullWork.size() >= lowerSize && Cross(m_contour[m_hullWork[m_hullWork.size() - 2]], m_contour[m_hullWork.back()], m_contour[m_hull[point]]) <= 0)
+			m_hullWork.pop_back();
+		m_hullWork.push_back(m_hull[point]);
+	}
+
+	// the last point is the first again
+	m_hullWork.pop_back();
+
+	// the hull points follow the contour round in the same order, which the defects rely on
+	m_hull = m_hullWork;
+	std::sort(m_hull.begin(), m_hull.end());
+}
+
+/*
+ *	\brief Find the dips of the contour between consecutive hull points
+*/
+void CHandShapeClassifier::FindDefects()
+{
+	m_defects.clear();
+
+	const unsigned int count = static_cast<unsigned int>(m_contour.size());
+	const unsigned int hullCount = static_cast<unsigned int>(m_hull.size());
+	if (hullCount < 3)
+		return;
+
+	for (unsigned int hullPoint = 0; hullPoint < hullCount; ++hullPoint)
+	{
+		const unsigned int first = m_hull[hullPoint];
+		const unsigned int last = hullPoint + 1 < hullCount ? m_hull[hullPoint + 1] : m_hull[0] + count;
+
+		const ContourPoint &start = m_contour[first];
+		const ContourPoint &end = m_contour[last % count];
+
+		const float edgeX = static_cast<float>(end.x - start.x);
+		const float edgeY = static_cast<float>(end.y - start.y);
+		const float edgeLength = sqrt((edgeX * edgeX) + (edgeY * edgeY));
+		if (edgeLength <= 0.0f)
+			continue;
+
+		ConvexityDefect defect = { first, last % count, first, 0.0f };
+		for (unsigned int point = first + 1; point < last; ++point)
+		{
+			const unsigned int index = point % count;
+			const float depth = fabs(static_cast<float>(Cross(start, end, m_contour[index]))) / edgeLength;
+			if (depth > defect.depth)
+			{
+				defect.depth = depth;
+				defect.deepest = index;
+			}
+		}
+
+		if (defect.depth > 0.0f)
+		{
+			m_defects.push_back(defect);
+		}
+	}
+}
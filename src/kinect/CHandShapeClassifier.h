@@ -0,0 +1,112 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "DepthBand.h"
+#include <vector>
+
+/*
+ *	\brief A pixel on the outline of the hand
+*/
+struct ContourPoint
+{
+	int						x;									//!< The column of the pixel
+	int						y;									//!< The row of the pixel
+};
+
+/*
+ *	\brief A stretch of the outline which dips in from the convex hull, such as the valley between two fingers
+*/
+struct ConvexityDefect
+{
+	unsigned int			start;								//!< The contour index of the hull point the defect starts at
+	unsigned int			end;								//!< The contour index of the hull point the defect ends at
+	unsigned int			deepest;							//!< The contour index of the point furthest from the hull
+	float					depth;								//!< The distance of the deepest point from the hull, in pixels
+};
+
+/*
+ *	\brief What the classifier found out about the shape of a hand
+*/
+struct HandShape
+{
+	float					area;								//!< The area inside the outline, in pixels
+	float					hullArea;							//!< The area inside the convex hull, in pixels
+	float					solidity;							//!< The area over the hull area, near 1 for a fist
+	unsigned int			fingers;							//!< The number of spread fingers counted
+	float					openness;							//!< How sure the classifier is the hand is open, between 0 and 1
+};
+
+/*
+ *	\brief Classifies a hand as open or closed from the shape of its outline.
+ *	The outer contour of the hand's blob is traced inside the hand area, the
+ *	convex hull of the contour is found and the places the contour dips in from
+ *	the hull are measured. Deep, narrow dips are the valleys between spread
+ *	fingers; a fist has none and fills most of its hull. The buffers are kept
+ *	between frames so classifying doesn't allocate once they have grown.
+*/
+class CHandShapeClassifier {
+private:
+	std::vector<ContourPoint>		m_contour;							//!< The outline of the hand, clockwise
+	std::vector<unsigned int>		m_hull;								//!< The contour indices of the convex hull, in contour order
+	std::vector<unsigned int>		m_hullWork;							//!< The hull being built
+	std::vector<ConvexityDefect>	m_defects;							//!< The dips between consecutive hull points
+	std::vector<unsigned int>		m_fingerValleys;					//!< The indices of the defects counted as valleys between fingers
+
+private:
+									//! Trace the outer contour of the blob containing the start pixel
+	void							TraceContour(
+										const unsigned char *mask,		//!< The mask, non zero pixels are the hand
+										unsigned int width,				//!< The number of pixels in a row of the mask
+										const MaskArea &area,			//!< Pixels outside this area are background
+										unsigned int startX,			//!< The column of the start pixel
+										unsigned int startY				//!< The row of the start pixel
+									);
+
+									//! Find the convex hull of the contour
+	void							FindHull();
+
+									//! Find the dips of the contour between consecutive hull points
+	void							FindDefects();
+
+public:
+									//! Class constructor
+									CHandShapeClassifier();
+
+									//! Class destructor
+									~CHandShapeClassifier();
+
+									//! Classify the blob containing the start pixel, which must be its top left pixel
+	HandShape						Classify(
+										const unsigned char *mask,		//!< The mask, non zero pixels are the hand
+										unsigned int width,				//!< The number of pixels in a row of the mask
+										const MaskArea &area,			//!< The hand area, pixels outside it are background
+										unsigned int startX,			//!< The column of the blob's first pixel in the area, scanning rows top to bottom
+										unsigned int startY				//!< The row of the blob's first pixel in the area
+									);
+
+									//! Get the outline traced by the last classify
+	const std::vector<ContourPoint>	&GetContour() const
+									{
+										return m_contour;
+									}
+
+									//! Get the contour indices of the convex hull found by the last classify
+	const std::vector<unsigned int>	&GetHull() const
+									{
+										return m_hull;
+									}
+
+									//! Get the dips found by the last classify
+	const std::vector<ConvexityDefect>	&GetDefects() const
+									{
+										return m_defects;
+									}
+
+									//! Get the indices into GetDefects of the valleys between fingers found by the last classify
+	const std::vector<unsigned int>	&GetFingerValleys() const
+									{
+										return m_fingerValleys;
+									}
+};
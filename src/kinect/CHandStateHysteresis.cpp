@@ -0,0 +1,65 @@
+#include "CHandStateHysteresis.h"
+
+/*
+ *	\brief Class constructor
+*/
+CHandStateHysteresis::CHandStateHysteresis(
+		float openThreshold,						//!< The openness at or above which the hand is seen as open
+		float closeThreshold,						//!< The openness at or below which the hand is seen as closed, below the open threshold
+		unsigned int framesToChange					//!< The number of frames in a row needed to change state
+	) :
+	m_openThreshold(openThreshold),
+	m_closeThreshold(closeThreshold),
+	m_framesToChange(framesToChange),
+	m_open(true),
+	m_changingFrames(0)
+{
+
+}
+
+/*
+ *	\brief Class destructor
+*/
+CHandStateHysteresis::~CHandStateHysteresis()
+{
+
+}
+
+/*
+ *	\brief Start again from a known state, such as when the hand is found again
+*/
+void CHandStateHysteresis::Reset(
+		bool open									//!< Is the hand open
+	)
+{
+	m_open = open;
+	m_changingFrames = 0;
+}
+
+/*
+ *	\brief Add the openness of a frame, returning whether the hand is open
+*/
+bool CHandStateHysteresis::Update(
+		float openness								//!< How sure the classifier is the hand is open, between 0 and 1
+	)
+{
+	// frames between the thresholds neither count towards a change nor against it
+	const bool disagrees = m_open ? openness <= m_closeThreshold : openness >= m_openThreshold;
+	const bool agrees = m_open ? openness >= m_openThreshold : openness <= m_closeThreshold;
+
+	if (disagrees)
+	{
+		m_changingFrames++;
+		if (m_changingFrames >= m_framesToChange)
+		{
+			m_open = !m_open;
+			m_changingFrames = 0;
+		}
+	}
+	else if (agrees)
+	{
+		m_changingFrames = 0;
+	}
+
+	return m_open;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+/*
+ *	\brief Turns a noisy per frame openness into a steady open or closed decision.
+ *	The hand only becomes open once the openness has stayed above the open threshold
+ *	for a number of frames in a row, and only closes once it has stayed below the
+ *	lower close threshold as long, so a frame or two of a bad outline can't flip it.
+*/
+class CHandStateHysteresis {
+private:
+	float							m_openThreshold;					//!< The openness at or above which the hand is seen as open
+	float							m_closeThreshold;					//!< The openness at or below which the hand is seen as closed
+	unsigned int					m_framesToChange;					//!< The number of frames in a row needed to change state
+	bool							m_open;								//!< Is the hand open
+	unsigned int					m_changingFrames;					//!< The number of frames in a row which disagreed with the state
+
+public:
+									//! Class constructor
+									CHandStateHysteresis(
+										float openThreshold,			//!< The openness at or above which the hand is seen as open
+										float closeThreshold,			//!< The openness at or below which the hand is seen as closed, below the open threshold
+										unsigned int framesToChange		//!< The number of frames in a row needed to change state
+									);
+
+									//! Class destructor
+									~CHandStateHysteresis();
+
+									//! Start again from a known state, such as when the hand is found again
+	void							Reset(
+										bool open						//!< Is the hand open
+									);
+
+									//! Add the openness of a frame, returning whether the hand is open
+	bool							Update(
+										float openness					//!< How sure the classifier is the hand is open, between 0 and 1
+									);
+
+									//! Is the hand open
+	bool							IsOpen() const
+									{
+										return m_open;
+									}
+};
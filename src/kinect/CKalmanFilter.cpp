@@ -0,0 +1,136 @@
+#include "CKalmanFilter.h"
+
+// How unsure a new track is of its velocity, in pixels a second, about the speed of a fast sweep across the frame
+static const float INITIAL_VELOCITY_ERROR = 500.0f;
+
+/*
+ *	\brief Class constructor
+*/
+CKalmanFilter::CKalmanFilter(
+		const KalmanSettings &settings				//!< The tunable settings
+	) :
+	m_settings(settings)
+{
+	Reset();
+}
+
+/*
+ *	\brief Class destructor
+*/
+CKalmanFilter::~CKalmanFilter()
+{
+
+}
+
+/*
+ *	\brief Forget every position, such as when the hand is lost
+*/
+void CKalmanFilter::Reset()
+{
+	for (unsigned int axis = 0; axis < 2; ++axis)
+	{
+		StartAxis(m_axes[axis], 0.0f);
+	}
+
+	m_lastTime = 0;
+	m_hasPosition = false;
+}
+
+/*
+ *	\brief Start an axis at a measured position with an unknown velocity
+*/
+void CKalmanFilter::StartAxis(
+		Axis &axis,									//!< The axis
+		float measured								//!< The measured position on the axis
+	)
+{
+	axis.position = measured;
+	axis.velocity = 0.0f;
+	axis.covariance[0][0] = m_settings.measurementError * m_settings.measurementError;
+	axis.covariance[0][1] = 0.0f;
+	axis.covariance[1][0] = 0.0f;
+	axis.covariance[1][1] = INITIAL_VELOCITY_ERROR * INITIAL_VELOCITY_ERROR;
+}
+
+/*
+ *	\brief Move an axis on by a time step, then correct it with a measurement
+*/
+void CKalmanFilter::UpdateAxis(
+		Axis &axis,									//!< The axis
+		float measured,								//!< The measured position on the axis
+		float seconds								//!< The time since the last position, in seconds
+	)
+{
+	float (&p)[2][2] = axis.covariance;
+
+	// predict, the position moves on at the velocity and random acceleration adds uncertainty
+	axis.position += axis.velocity * seconds;
+
+	const float q = m_settings.acceleration * m_settings.acceleration;
+	const float t2 = seconds * seconds;
+	const float p00 = p[0][0] + (seconds * (p[1][0] + p[0][1])) + (t2 * p[1][1]) + (q * t2 * t2 * 0.25f);
+	const float p01 = p[0][1] + (seconds * p[1][1]) + (q * t2 * seconds * 0.5f);
+	const float p10 = p[1][0] + (seconds * p[1][1]) + (q * t2 * seconds * 0.5f);
+	const float p11 = p[1][1] + (q * t2);
+
+	// correct, by how far the measurement is from the prediction weighed by their uncertainties
+	const float innovation = measured - axis.position;
+	const float spread = p00 + (m_settings.measurementError * m_settings.measurementError);
+	const float positionGain = p00 / spread;
+	const float velocityGain = p10 / spread;
+
+	axis.position += positionGain * innovation;
+	axis.velocity += velocityGain * innovation;
+
+	p[0][0] = (1.0f - positionGain) * p00;
+	p[0][1] = (1.0f - positionGain) * p01;
+	p[1][0] = p10 - (velocityGain * p00);
+	p[1][1] = p11 - (velocityGain * p01);
+}
+
+/*
+ *	\brief Add a measured position, times must not go backwards
+*/
+void CKalmanFilter::Add(
+		unsigned long long time,					//!< When the position was measured, in microseconds
+		float x,									//!< The measured column
+		float y										//!< The measured row
+	)
+{
+	if (!m_hasPosition)
+	{
+		StartAxis(m_axes[0], x);
+		StartAxis(m_axes[1], y);
+	}
+	else
+	{
+		// a measurement at the same time as the last still corrects the estimate, just without moving it on
+		const float seconds = time > m_lastTime ? static_cast<float>(time - m_lastTime) * 0.000001f : 0.0f;
+		UpdateAxis(m_axes[0], x, seconds);
+		UpdateAxis(m_axes[1], y, seconds);
+	}
+
+	m_lastTime = time;
+	m_hasPosition = true;
+}
+
+/*
+ *	\brief Get the estimated position at a time, false if no position has been added
+*/
+bool CKalmanFilter::Predict(
+		unsigned long long time,					//!< The time to estimate the position at, in microseconds
+		float &x,									//!< Receives the estimated column
+		float &y									//!< Receives the estimated row
+	) const
+{
+	if (!m_hasPosition)
+		return false;
+
+	unsigned long long lead = time > m_lastTime ? time - m_lastTime : 0;
+	if (lead > m_settings.maximumLead) lead = m_settings.maximumLead;
+
+	const float seconds = static_cast<float>(lead) * 0.000001f;
+	x = m_axes[0].position + (m_axes[0].velocity * seconds);
+	y = m_axes[1].position + (m_axes[1].velocity * seconds);
+	return true;
+}
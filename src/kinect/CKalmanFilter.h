@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "IPositionFilter.h"
+
+/*
+ *	\brief The tunable settings of a constant velocity Kalman filter
+*/
+struct KalmanSettings
+{
+	float						acceleration;					//!< The spread of the hand's acceleration, in pixels a second squared, higher follows turns faster
+	float						measurementError;				//!< The spread of the measured position about the true one, in pixels, higher is smoother
+	unsigned long long			maximumLead;					//!< The furthest past the last position it extrapolates, in microseconds
+};
+
+/*
+ *	\brief A Kalman filter which models each axis as a position moving at a constant velocity.
+ *	Each measurement is weighed against the position the model predicted by how uncertain
+ *	each is, and the velocity is corrected along with it. The hand is taken to accelerate at
+ *	random between measurements, the further apart they are the less the prediction is trusted.
+*/
+class CKalmanFilter : public IPositionFilter {
+private:
+
+	struct Axis {
+		float					position;						//!< The estimated position
+		float					velocity;						//!< The estimated velocity, in pixels a second
+		float					covariance[2][2];				//!< The uncertainty of the position and velocity
+	};
+
+private:
+	KalmanSettings				m_settings;						//!< The tunable settings
+	Axis						m_axes[2];						//!< The x and y axes
+	unsigned long long			m_lastTime;						//!< When the last position was measured, in microseconds
+	bool						m_hasPosition;					//!< Has a position been added since the last reset
+
+private:
+								//! Start an axis at a measured position with an unknown velocity
+	void						StartAxis(
+									Axis &axis,					//!< The axis
+									float measured				//!< The measured position on the axis
+								);
+
+								//! Move an axis on by a time step, then correct it with a measurement
+	void						UpdateAxis(
+									Axis &axis,					//!< The axis
+									float measured,				//!< The measured position on the axis
+									float seconds				//!< The time since the last position, in seconds
+								);
+
+public:
+								//! Class constructor
+								CKalmanFilter(
+									const KalmanSettings &settings	//!< The tunable settings
+								);
+
+								//! Class destructor
+	virtual						~CKalmanFilter();
+
+								//! Change the settings, the estimate is kept
+	void						SetSettings(
+									const KalmanSettings &settings	//!< The tunable settings
+								)
+								{
+									m_settings = settings;
+								}
+
+								//! Get the settings
+	const KalmanSettings		&GetSettings() const
+								{
+									return m_settings;
+								}
+
+								//! Forget every position, such as when the hand is lost
+	virtual void				Reset();
+
+								//! Add a measured position, times must not go backwards
+	virtual void				Add(
+									unsigned long long time,	//!< When the position was measured, in microseconds
+									float x,					//!< The measured column
+									float y						//!< The measured row
+								);
+
+								//! Get the estimated position at a time, false if no position has been added
+	virtual bool				Predict(
+									unsigned long long time,	//!< The time to estimate the position at, in microseconds
+									float &x,					//!< Receives the estimated column
+									float &y					//!< Receives the estimated row
+								) const;
+};
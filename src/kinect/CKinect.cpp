@@ -1,8 +1,28 @@
 #include "CKinect.h"
+#include "COneEuroFilter.h"
+#include "../cviscraft.h"
 
-static const int g_IntensityShiftByPlayerR[] = { 1, 2, 0, 2, 0, 0, 2, 0 };
-static const int g_IntensityShiftByPlayerG[] = { 1, 2, 2, 0, 2, 0, 0, 1 };
-static const int g_IntensityShiftByPlayerB[] = { 1, 0, 2, 2, 0, 2, 0, 2 };
+// smooths the held still palm's jitter and follows a sweep of the hand with little lag, see FilterBenchmarks
+static const OneEuroSettings PALM_FILTER_SETTINGS = { 1.0f, 0.05f, 4.0f, 50000 };
+
+// the sensor's latency the palm is predicted past, in microseconds
+static const unsigned long long PALM_LEAD = 16000;
+
+// the least time between two draws of the debug view, about 15 a second, in milliseconds
+static const long long DEBUG_VIEW_INTERVAL = 66;
+
+// the time between writing the audio capture counts to the debug output, in seconds
+static const long long AUDIO_LOG_INTERVAL = 30;
+
+/*
+ *	\brief Get the time on the steady clock, in microseconds
+*/
+static unsigned long long GetSteadyMicroseconds(
+		std::chrono::steady_clock::time_point time		//!< The time
+	)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
 
 CKinect::CKinect() :
 	m_hwndDepth(NULL),
@@ -12,6 +32,7 @@ CKinect::CKinect() :
 	m_depthStreamHandle(NULL),
 	m_colorStreamHandle(NULL),
 	m_nuiProcess(NULL),
+	m_depthProcess(NULL),
 	m_nuiProcessStop(NULL),
 	m_hSpeechEvent(NULL),
 	m_isRunning(false)
@@ -21,6 +42,11 @@ CKinect::CKinect() :
 	m_drawColor = nullptr;
 	m_D2DFactory = nullptr;
 	m_hand = nullptr;
+	m_palmFilter = nullptr;
+	m_palmLead = PALM_LEAD;
+	m_predictedPalm = D3DXVECTOR2(0.0f, 0.0f);
+	m_debugViewsDrawn = 0;
+	m_lastAudioLog = std::chrono::steady_clock::now();
 	m_audioCommandProcessor = nullptr;
 	m_pKinectAudioStream = nullptr;
 	m_voice = nullptr;
@@ -143,8 +169,24 @@ const bool CKinect::Create(
 		return false;
 	}
 
+	m_depthSource.Create(m_nuiSensor, m_depthStreamHandle, &m_pipeline.GetBufferPool());
+	m_screenshotWriter.Create(640, 480, ScreenshotFormat::Bitmap);
+
 	m_hand = new CHand();
 	m_hand->Create(640, 480);
+
+	// the hand band is found from where the user holds their hand, rather than where they were expected to stand
+	m_hand->StartCalibration();
+
+	m_handPosition = CVisCraft::GetInstance()->GetWindowDimension();
+	m_handPosition.x *= 0.5f;
+	m_handPosition.y *= 0.75f;
+	m_oldHandPosition = m_handPosition;
+
+	if (m_palmFilter == nullptr)
+	{
+		m_palmFilter = new COneEuroFilter(PALM_FILTER_SETTINGS);
+	}
 	
 	// Audio
 	hr = InitializeAudioStream();
@@ -177,8 +219,22 @@ const bool CKinect::Create(
 	
 	m_audioCommandProcessor = new CAudioProcessor(gui);
 
-	m_nuiProcessStop = CreateEvent( NULL, FALSE, FALSE, NULL );
+	// each depth frame goes through the stages on their own threads, so a slow stage or a colour
+	// frame or speech event being handled never holds up taking the next frame off the sensor
+	m_pipeline.AddStage("convert", [this](PipelineFrame &frame) { ConvertDepthFrame(frame); });
+	m_pipeline.AddStage("segment", [this](PipelineFrame &frame) { m_hand->Segment(frame.pyramid, frame.hand); });
+	m_pipeline.AddStage("classify", [this](PipelineFrame &frame) { m_hand->Classify(frame.hand); });
+	m_pipeline.AddStage("publish", [this](PipelineFrame &frame) { PublishDepthFrame(frame); });
+
+	// the debug view is drawn after the hand is published, from the frame's data alone, so tracking never waits on it
+	m_debugView.resize(640 * 480);
+	m_pipeline.AddStage("draw", [this](PipelineFrame &frame) { DrawDepthFrame(frame); });
+	m_pipeline.Start(640, 480);
+
+	// the stop event is manual reset, both threads have to see it
+	m_nuiProcessStop = CreateEvent( NULL, TRUE, FALSE, NULL );
 	m_nuiProcess = CreateThread( NULL, 0, Nui_ProcessThread, this, 0, NULL );
+	m_depthProcess = CreateThread( NULL, 0, Nui_DepthThread, this, 0, NULL );
 
 	ShowWindow(m_hwndDepth, SW_SHOW);
 
@@ -341,9 +397,17 @@ DWORD WINAPI CKinect::Nui_ProcessThread()
 	m_isRunning = true;
 	while (m_isRunning)
 	{
+		// the counts build up while speech is recognised, so the audio ring can be sized from a long session
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (m_pKinectAudioStream != nullptr && now - m_lastAudioLog >= std::chrono::seconds(AUDIO_LOG_INTERVAL))
+		{
+			m_lastAudioLog = now;
+			LogAudioCapture();
+		}
+
 		// Wait for any of the events to be signaled
-		static const int numEvents = 4;
-		HANDLE hEvents[numEvents] = { m_nuiProcessStop, m_nextDepthFrameEvent, m_nextColorFrameEvent, m_hSpeechEvent };
+		static const int numEvents = 3;
+		HANDLE hEvents[numEvents] = { m_nuiProcessStop, m_nextColorFrameEvent, m_hSpeechEvent };
 
 		const int eventId = WaitForMultipleObjects( numEvents, hEvents, FALSE, 100 );
 
@@ -361,18 +425,13 @@ DWORD WINAPI CKinect::Nui_ProcessThread()
 			m_isRunning = false;
 			continue;
 
-		// Depth event
+		// Color event
 		case WAIT_OBJECT_0 + 1:
-			Nui_GotDepthAlert();
-			continue;
-
-		// Audio event
-		case WAIT_OBJECT_0 + 2:
 			Nui_GotColorAlert();
 			continue;
 
 		// Audio event
-		case WAIT_OBJECT_0 + 3:
+		case WAIT_OBJECT_0 + 2:
 			ProcessSpeech();
 			continue;
 		}
@@ -381,6 +440,32 @@ DWORD WINAPI CKinect::Nui_ProcessThread()
 	return 0;
 }
 
+DWORD WINAPI CKinect::Nui_DepthThread(LPVOID param)
+{
+	CKinect *kinect = reinterpret_cast<CKinect*>(param);
+	return kinect->Nui_DepthThread();
+}
+
+DWORD WINAPI CKinect::Nui_DepthThread()
+{
+	static const int numEvents = 2;
+	HANDLE hEvents[numEvents] = { m_nuiProcessStop, m_nextDepthFrameEvent };
+
+	for (;;)
+	{
+		const DWORD eventId = WaitForMultipleObjects( numEvents, hEvents, FALSE, 100 );
+		if (eventId == WAIT_OBJECT_0)
+			break;
+
+		if (eventId == WAIT_OBJECT_0 + 1)
+		{
+			Nui_GotDepthAlert();
+		}
+	}
+
+	return 0;
+}
+
 void CKinect::ProcessSpeech()
 {
 	static const float ConfidenceThreshold = 0.15f;
@@ -425,63 +510,6 @@ void CKinect::ProcessSpeech()
 	return;
 }
 
-HRESULT SaveBitmapToFile(BYTE* pBitmapBits, LONG lWidth, LONG lHeight, WORD wBitsPerPixel, char *lpszFilePath)
-{
-	DWORD dwByteCount = lWidth * lHeight * (wBitsPerPixel / 8);
-
-	BITMAPINFOHEADER bmpInfoHeader = {0};
-
-	bmpInfoHeader.biSize        = sizeof(BITMAPINFOHEADER);  // Size of the header
-	bmpInfoHeader.biBitCount    = wBitsPerPixel;             // Bit count
-	bmpInfoHeader.biCompression = BI_RGB;                    // Standard RGB, no compression
-	bmpInfoHeader.biWidth       = lWidth;                    // Width in pixels
-	bmpInfoHeader.biHeight      = -lHeight;                  // Height in pixels, negative indicates it's stored right-side-up
-	bmpInfoHeader.biPlanes      = 1;                         // Default
-	bmpInfoHeader.biSizeImage   = dwByteCount;               // Image size in bytes
-
-	BITMAPFILEHEADER bfh = {0};
-
-	bfh.bfType    = 0x4D42;                                           // 'M''B', indicates bitmap
-	bfh.bfOffBits = bmpInfoHeader.biSize + sizeof(BITMAPFILEHEADER);  // Offset to the start of pixel data
-	bfh.bfSize    = bfh.bfOffBits + bmpInfoHeader.biSizeImage;        // Size of image + headers
-
-	// Create the file on disk to write to
-	HANDLE hFile = CreateFile(lpszFilePath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
-
-	// Return if error opening file
-	if (NULL == hFile) 
-	{
-		return E_ACCESSDENIED;
-	}
-
-	DWORD dwBytesWritten = 0;
-
-	// Write the bitmap file header
-	if (!WriteFile(hFile, &bfh, sizeof(bfh), &dwBytesWritten, NULL) )
-	{
-		CloseHandle(hFile);
-		return E_FAIL;
-	}
-
-	// Write the bitmap info header
-	if (!WriteFile(hFile, &bmpInfoHeader, sizeof(bmpInfoHeader), &dwBytesWritten, NULL) )
-	{
-		CloseHandle(hFile);
-		return E_FAIL;
-	}
-
-	// Write the RGB Data
-	if (!WriteFile(hFile, pBitmapBits, bmpInfoHeader.biSizeImage, &dwBytesWritten, NULL) )
-	{
-		CloseHandle(hFile);
-		return E_FAIL;
-	}    
-
-	// Close the file
-	CloseHandle(hFile);
-	return S_OK;
-}
-
 void CKinect::Nui_GotColorAlert()
 {
 	HRESULT hr;
@@ -519,10 +547,10 @@ void CKinect::Nui_GotColorAlert()
 			date << now.tm_mday << '-' << (now.tm_mon + 1) << '-' << (now.tm_year + 1900) << " " << now.tm_hour << "-" << now.tm_min << "-" << now.tm_sec;
 
 			std::stringstream buf;
-			buf << "./kinect_images/" << date.str() << ".bmp";
+			buf << "./kinect_images/" << date.str();
 
-			// Write out the bitmap to disk
-			SaveBitmapToFile(static_cast<BYTE *>(LockedRect.pBits), 640, 480, 32, const_cast<char*>(buf.str().c_str()));
+			// Copy the frame out, the writer thread encodes and saves it after the texture is unlocked
+			m_screenshotWriter.Push(static_cast<BYTE *>(LockedRect.pBits), LockedRect.Pitch, buf.str());
 			
 			m_lastScreenshot = clock();
 		}
@@ -537,73 +565,148 @@ void CKinect::Nui_GotColorAlert()
 
 void CKinect::Nui_GotDepthAlert()
 {
-	NUI_IMAGE_FRAME imageFrame;
+	// the frame is copied into a pooled buffer the pipeline shares, or dropped if every pooled frame or buffer is still in a stage
+	DepthFrame frame;
+	if (m_depthSource.GetNextFrame(frame))
+	{
+		m_pipeline.Push(frame);
+	}
+}
 
-	HRESULT hr = m_nuiSensor->NuiImageStreamGetNextFrame(
-		m_depthStreamHandle,
-		0,
-		&imageFrame 
-	);
+void CKinect::ConvertDepthFrame(
+		PipelineFrame &frame
+	)
+{
+	// the recorder copies the frame rather than holding its buffer, so a slow disk can't starve the pipeline of buffers
+	if (m_depthRecorder.IsRecording())
+	{
+		const DepthFrame recorded = { frame.width, frame.height, frame.timestamp, frame.depth, nullptr };
+		m_depthRecorder.Push(recorded);
+	}
 
-	if (FAILED(hr))
+	// the lower resolutions the hand is acquired in, built once for any stage which needs them
+	frame.pyramid.Build(frame.depth);
+}
+
+void CKinect::PublishDepthFrame(
+		PipelineFrame &frame
+	)
+{
+	// the render thread takes the latest sample without waiting, see UpdateHand
+	m_handSamples.Publish(HandSample(frame.hand, frame.timestamp, GetSteadyMicroseconds(frame.pushedAt), frame.sequence));
+}
+
+void CKinect::DrawDepthFrame(
+		PipelineFrame &frame
+	)
+{
+	// nobody can see the debug view, or it was put on screen too recently, so nothing is spent on it
+	if (frame.pushedAt - m_lastDebugView < std::chrono::milliseconds(DEBUG_VIEW_INTERVAL) || !IsDepthWindowShown())
 		return;
 
-	INuiFrameTexture *pTexture = imageFrame.pFrameTexture;
-	NUI_LOCKED_RECT LockedRect;
-	pTexture->LockRect( 0, &LockedRect, NULL, 0 );
-	if (LockedRect.Pitch != NULL)
-	{
-		DWORD frameWidth, frameHeight;
+	m_lastDebugView = frame.pushedAt;
+	m_debugViewsDrawn++;
 
-		NuiImageResolutionToSize( imageFrame.eResolution, frameWidth, frameHeight );
+	// draw the bits to the bitmap, RGBQUAD is laid out as the table's 0x00RRGGBB
+	m_depthColors.Convert(frame.depth, frame.width * frame.height, &m_debugView[0]);
 
-		// draw the bits to the bitmap
-		RGBQUAD * rgbrun = m_rgbWk;
-		USHORT * pBufferRun = (USHORT *)LockedRect.pBits;
+	RGBQUAD *colors = reinterpret_cast<RGBQUAD *>(&m_debugView[0]);
+	m_hand->DrawHandMask(frame.depth, frame.hand, colors);
+	m_hand->DrawHandAreaBounds(frame.hand, colors);
 
-		// end pixel is start + width*height - 1
-		USHORT * pBufferEnd = pBufferRun + (frameWidth * frameHeight);
+	m_drawDepth->Draw( (BYTE*) colors, frame.width * frame.height * 4 );
+}
 
-		while ( pBufferRun < pBufferEnd )
-		{
-			*rgbrun = Nui_ShortToQuad_Depth( *pBufferRun );
-			++pBufferRun;
-			++rgbrun;
-		}
-	
-		m_hand->FindFromDepth(m_rgbWk);		
-		m_hand->DrawHandAreaBounds(m_rgbWk);
+void CKinect::LogPipelineLatency() const
+{
+	std::stringstream message;
+	message << "Depth pipeline, " << m_pipeline.GetFramesPushed() << " frames pushed, " << m_pipeline.GetFramesDropped() << " dropped, "
+		<< m_pipeline.GetFramesCompleted() << " completed\n";
 
-		m_drawDepth->Draw( (BYTE*) m_rgbWk, frameWidth * frameHeight * 4 );
+	for (unsigned int stage = 0; stage < m_pipeline.GetStageCount(); ++stage)
+	{
+		const CLatencyHistogram &latency = m_pipeline.GetStageLatency(stage);
+		const CLatencyHistogram &wait = m_pipeline.GetStageWait(stage);
+		message << "  " << m_pipeline.GetStageName(stage) << ": mean " << latency.GetMean() << "us, 99% under " << latency.GetPercentile(99.0f)
+			<< "us, max " << latency.GetMaximum() << "us, queued 99% under " << wait.GetPercentile(99.0f) << "us\n";
 	}
-	else
+
+	const CLatencyHistogram &endToEnd = m_pipeline.GetEndToEndLatency();
+	message << "  end to end: mean " << endToEnd.GetMean() << "us, 99% under " << endToEnd.GetPercentile(99.0f) << "us, max " << endToEnd.GetMaximum() << "us\n";
+
+	message << "  debug view: drawn " << m_debugViewsDrawn << " times\n";
+
+	// every stage and the source have let go of their buffers, so any still held leaked
+	const CDepthBufferPool &buffers = m_pipeline.GetBufferPool();
+	message << "  depth buffers: " << buffers.GetAcquired() << " acquired, " << buffers.GetReused() << " reused, " << buffers.GetExhausted() << " times exhausted, "
+		<< m_pipeline.GetFramesCopied() << " frames copied in, " << buffers.GetOutstanding() << " leaked\n";
+
+	// the segment stage has stopped, so the hand's counts are settled
+	if (m_hand != nullptr && m_hand->GetSearchWindow().GetFrameCount() != 0)
 	{
-		OutputDebugString("Buffer length of received texture is bogus\r\n");
+		const CHandSearchWindow &search = m_hand->GetSearchWindow();
+		message << "  hand search: " << (search.GetPixelsSearched() / search.GetFrameCount()) << " pixels a frame, "
+			<< search.GetFullSearches() << " whole frame searches in " << search.GetFrameCount() << " frames\n";
+
+		const CDepthBandCalibrator &band = m_hand->GetBandCalibrator();
+		message << "  hand band: " << band.GetNearPoint() << " to " << band.GetFarPoint() << "mm, "
+			<< (band.IsCalibrated() ? "calibrated" : "not calibrated") << "\n";
 	}
+	OutputDebugString(message.str().c_str());
+}
 
-	pTexture->UnlockRect( 0 );
+void CKinect::LogAudioCapture() const
+{
+	const CAudioRing &ring = m_pKinectAudioStream->GetAudioRing();
 
-	m_nuiSensor->NuiImageStreamReleaseFrame(m_depthStreamHandle, &imageFrame);
+	std::stringstream message;
+	message << "Audio capture, " << ring.GetBytesWritten() << " bytes captured, " << ring.GetBytesRead() << " read, " << ring.GetBytesDropped() << " dropped ("
+		<< ((ring.GetBytesDropped() * 1000) / AudioAverageBytesPerSecond) << "ms) in " << ring.GetOverruns() << " overruns\n";
+
+	message << "  ring: " << ring.GetCapacity() << " bytes, fullest " << ring.GetFullest() << " (" << ((ring.GetFullest() * 1000ULL) / AudioAverageBytesPerSecond)
+		<< "ms), writes leaving it filled to each eighth:";
+	for (unsigned int bucket = 0; bucket < CAudioRing::OccupancyBuckets; ++bucket)
+	{
+		message << " " << ring.GetOccupancyCount(bucket);
+	}
+	message << "\n";
+
+	const CLatencyHistogram &latency = ring.GetReadLatency();
+	message << "  capture to read: mean " << latency.GetMean() << "us, 99% under " << latency.GetPercentile(99.0f) << "us, max " << latency.GetMaximum()
+		<< "us over " << latency.GetCount() << " reads\n";
+	OutputDebugString(message.str().c_str());
 }
 
-RGBQUAD CKinect::Nui_ShortToQuad_Depth( 
-		USHORT s 
-	)
+const bool CKinect::StartDepthRecording()
 {
-	USHORT RealDepth = NuiDepthPixelToDepth(s);
-	USHORT Player    = NuiDepthPixelToPlayerIndex(s);
+	time_t t = time(0);
+	struct tm now;
+	localtime_s(&now, &t);
+
+	std::stringstream date;
+	date << now.tm_mday << '-' << (now.tm_mon + 1) << '-' << (now.tm_year + 1900) << " " << now.tm_hour << "-" << now.tm_min << "-" << now.tm_sec;
+
+	CreateDirectory("./kinect_recordings", NULL);
+
+	std::stringstream buf;
+	buf << "./kinect_recordings/" << date.str() << ".vcdr";
 
-	// transform 13-bit depth information into an 8-bit intensity appropriate
-	// for display (we disregard information in most significant bit)
-	BYTE intensity = (BYTE)~(RealDepth >> 4);
+	return m_depthRecorder.Start(buf.str(), 640, 480);
+}
+
+void CKinect::StopDepthRecording()
+{
+	m_depthRecorder.Stop();
 
-	// tint the intensity by dividing by per-player values
-	RGBQUAD color;
-	color.rgbRed   = intensity >> g_IntensityShiftByPlayerR[Player];
-	color.rgbGreen = intensity >> g_IntensityShiftByPlayerG[Player];
-	color.rgbBlue  = intensity >> g_IntensityShiftByPlayerB[Player];
+	std::stringstream message;
+	message << "Depth recording stopped, " << m_depthRecorder.GetFramesWritten() << " frames written, "
+		<< m_depthRecorder.GetFramesDropped() << " dropped, " << m_depthRecorder.GetBytesWritten() << " bytes\n";
+	OutputDebugString(message.str().c_str());
+}
 
-	return color;
+const bool CKinect::IsDepthWindowShown() const
+{
+	return IsWindowVisible(m_hwndDepth) && !IsIconic(m_hwndDepth);
 }
 
 void CKinect::Destroy()
@@ -614,26 +717,77 @@ void CKinect::Destroy()
 		Sleep(10);
 	} while (m_isRunning);
 
+	// nothing pushes once the depth thread is gone, then the stages can stop
+	if (m_depthProcess != NULL)
+	{
+		WaitForSingleObject(m_depthProcess, INFINITE);
+		CloseHandle(m_depthProcess);
+		m_depthProcess = NULL;
+	}
+
+	m_depthSource.Destroy();
+	m_pipeline.Stop();
+	LogPipelineLatency();
+
+	m_depthRecorder.Stop();
+	m_screenshotWriter.Destroy();
+
 	if (m_pKinectAudioStream != nullptr) 
 	{
 		m_pKinectAudioStream->StopCapture();
+		LogAudioCapture();
 	}
 
 	SafeDelete(m_drawDepth);
 	SafeDelete(m_drawColor);
 	SafeRelease(m_nuiSensor);
 	SafeReleaseDelete(m_hand);
+	SafeDelete(m_palmFilter);
 	SafeDelete(m_audioCommandProcessor);
 	SafeDelete(m_pKinectAudioStream);
 	SafeRelease(m_voice);
 }
 
-const D3DXVECTOR2 CKinect::GetHandPosition()
+void CKinect::SetPalmFilter(
+		IPositionFilter *filter
+	)
 {
-	return m_hand->GetHandPosition();
+	SafeDelete(m_palmFilter);
+	m_palmFilter = filter;
 }
 
-HandState::Enum CKinect::GetHandState() const
+void CKinect::UpdateHand()
 {
-	return m_hand->GetHandState();
-}
+	// a sample is only read once, so each goes into the filter once
+	if (m_handSamples.Read(m_handSample))
+	{
+		if (m_handSample.state == HandState::NotFound)
+		{
+			m_palmFilter->Reset();
+		}
+		else
+		{
+			m_palmFilter->Add(m_handSample.acquiredAt, m_handSample.palmX, m_handSample.palmY);
+		}
+	}
+
+	// the palm where it will be when this frame reaches the screen, rather than where the last depth frame saw it
+	float palmX = m_handSample.palmX;
+	float palmY = m_handSample.palmY;
+	m_palmFilter->Predict(GetSteadyMicroseconds(std::chrono::steady_clock::now()) + m_palmLead, palmX, palmY);
+	m_predictedPalm = D3DXVECTOR2(palmX, palmY);
+
+	if (m_handSample.state == HandState::OpenHand || m_handSample.state == HandState::ClosedFist)
+	{
+		D3DXVECTOR2 differnce = D3DXVECTOR2(m_handSample.centerX - palmX, m_handSample.centerY - palmY);
+		differnce.x = differnce.x * 0.025f;
+		differnce.y = differnce.y * 0.025f;
+
+		const float sqrLen = (differnce.x*differnce.x + differnce.y*differnce.y);
+		if (sqrLen > 1.0f) {
+			differnce.y = differnce.y * 0.5f;
+			m_oldHandPosition = m_handPosition;
+			m_handPosition = m_handPosition - differnce;
+		}
+	}
+}
\ No newline at end of file
@@ -16,6 +16,14 @@
 #include "KinectAudioStream.h"
 #include "CAudioProcessor.h"
 #include "chand.h"
+#include "CDepthColorTable.h"
+#include "CKinectDepthSource.h"
+#include "CDepthRecorder.h"
+#include "CFramePipeline.h"
+#include "HandSample.h"
+#include "IPositionFilter.h"
+#include "TripleBuffer.h"
+#include "CScreenshotWriter.h"
 
 #include "avi_utils.h"
 //#include <vld.h>
@@ -39,6 +47,7 @@ private:
 	BSTR										m_kinectID;								//!< 
 
 	HANDLE										m_nuiProcess;							//!< 
+	HANDLE										m_depthProcess;							//!< The thread taking depth frames from the sensor into the pipeline
 
 	HANDLE										m_nuiProcessStop;						//!< 
 	HANDLE										m_nextDepthFrameEvent;					//!< 
@@ -47,10 +56,24 @@ private:
 
 	HANDLE										m_depthStreamHandle;					//!< 
 	HANDLE										m_colorStreamHandle;					//!< 
+	CKinectDepthSource							m_depthSource;							//!< Copies the frames out of the depth stream into the pipeline's pooled buffers
+	CDepthRecorder								m_depthRecorder;						//!< Writes the depth frames to disk while recording
+	CFramePipeline								m_pipeline;								//!< Converts, segments, classifies and publishes each depth frame and draws the debug view, a thread a stage
 
-	RGBQUAD										m_rgbWk[640*480];						//!< 
+	CDepthColorTable							m_depthColors;							//!< Depth pixel to color lookup used to draw the depth stream
+	std::vector<unsigned int>					m_debugView;							//!< The colored depth with the hand drawn over it, 0x00RRGGBB, only used by the draw stage
+	std::chrono::steady_clock::time_point		m_lastDebugView;						//!< When the draw stage last put the debug view on screen
+	unsigned long long							m_debugViewsDrawn;						//!< The number of times the debug view was put on screen
+	std::chrono::steady_clock::time_point		m_lastAudioLog;							//!< When the audio capture counts were last written to the debug output
 
 	CHand										*m_hand;								//!< 
+	CTripleBuffer<HandSample>					m_handSamples;							//!< The latest hand sample, published by the pipeline and read by the render thread
+	HandSample									m_handSample;							//!< The hand sample the render thread is using this frame
+	D3DXVECTOR2									m_handPosition;							//!< The screen position the hand moves, only used by the render thread
+	D3DXVECTOR2									m_oldHandPosition;						//!< The hand position before it last moved
+	IPositionFilter								*m_palmFilter;							//!< Smooths the palm of the hand samples and predicts it at the time of each rendered frame
+	unsigned long long							m_palmLead;								//!< How far past now the palm is predicted, to make up for the sensor's latency, in microseconds
+	D3DXVECTOR2									m_predictedPalm;						//!< The palm predicted by the last update, in depth pixels
 
 	KinectAudioStream							*m_pKinectAudioStream;					//!< Audio stream captured from Kinect.
 	ISpStream									*m_pSpeechStream;						//!< Stream given to speech recognition engine
@@ -64,6 +87,7 @@ private:
 	bool										m_isRunning;							//!< The running state of the processing thread
 
 	clock_t										m_lastScreenshot;						//!< 
+	CScreenshotWriter							m_screenshotWriter;						//!< Saves the color stream screenshots off the kinect thread
 	std::vector<std::string>					m_screenshots;				
 
 private:
@@ -76,6 +100,35 @@ private:
 												//! 
 	DWORD WINAPI								Nui_ProcessThread();
 
+												//! The depth acquisition thread entry point
+	static DWORD WINAPI							Nui_DepthThread(
+													LPVOID pParam						//!< The kinect
+												);
+
+												//! Wait for depth frames and push them into the pipeline until stopped
+	DWORD WINAPI								Nui_DepthThread();
+
+												//! Record the frame and build its depth pyramid, the pipeline's conversion stage
+	void										ConvertDepthFrame(
+													PipelineFrame &frame				//!< The frame
+												);
+
+												//! Publish the hand sample to the render thread, the pipeline's publish stage
+	void										PublishDepthFrame(
+													PipelineFrame &frame				//!< The frame
+												);
+
+												//! Color the depth, draw the hand over it and put it on screen, at most every debug view interval and only while the window is shown, the pipeline's draw stage
+	void										DrawDepthFrame(
+													PipelineFrame &frame				//!< The frame
+												);
+
+												//! Write how long each pipeline stage took and how much of each frame the hand was searched in to the debug output
+	void										LogPipelineLatency() const;
+
+												//! Write how much audio was captured, read and dropped, how full the audio ring got and how long audio waited to be read to the debug output
+	void										LogAudioCapture() const;
+
 public:
 												//! Class constructor
 												CKinect();
@@ -98,10 +151,20 @@ public:
 												//! 
 	void										Nui_GotColorAlert();
 
-												//!
-	RGBQUAD										Nui_ShortToQuad_Depth( 
-													USHORT s 
-												);
+												//! Start recording the depth stream to a new file named after the current time
+	const bool									StartDepthRecording();
+
+												//! Stop recording the depth stream
+	void										StopDepthRecording();
+
+												//! Is the depth stream being recorded
+	const bool									IsRecordingDepth() const
+												{
+													return m_depthRecorder.IsRecording();
+												}
+
+												//! Is the depth debug window on screen
+	const bool									IsDepthWindowShown() const;
 
 												//! 
 	HRESULT										StartSpeechRecognition();
@@ -118,15 +181,49 @@ public:
 												//! 
 	void										ProcessSpeech();
 
-												//! 
-	const D3DXVECTOR2							GetHandPosition();
+												//! Take the latest hand sample the tracker published and move the hand position, call once a frame from the render thread
+	void										UpdateHand();
+
+												//! Get the hand sample taken by the last update
+	const HandSample							&GetHandSample() const
+												{
+													return m_handSample;
+												}
+
+												//! Use another filter for the palm, the kinect takes ownership of it
+	void										SetPalmFilter(
+													IPositionFilter *filter			//!< The filter, created with new
+												);
+
+												//! Set how far past the time of each rendered frame the palm is predicted
+	void										SetPalmLead(
+													unsigned long long lead			//!< The lead, in microseconds
+												)
+												{
+													m_palmLead = lead;
+												}
 
-												//! Get the current hand state
-	HandState::Enum								GetHandState() const;
+												//! Get the palm predicted by the last update, in depth pixels
+	const D3DXVECTOR2							GetPredictedPalm() const
+												{
+													return m_predictedPalm;
+												}
+
+												//! Get the hand position moved by the last update
+	const D3DXVECTOR2							GetHandPosition() const
+												{
+													return m_handPosition;
+												}
+
+												//! Get the hand state of the sample taken by the last update
+	HandState::Enum								GetHandState() const
+												{
+													return m_handSample.state;
+												}
 
-												//!
+												//! Undo the last move of the hand position
 	void										ResetHandPosition()
 												{
-													m_hand->ResetHandPosition();
+													m_handPosition = m_oldHandPosition;
 												}
 };
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "CKinectDepthSource.h"
+
+CKinectDepthSource::CKinectDepthSource() :
+	m_nuiSensor(nullptr),
+	m_depthStreamHandle(NULL),
+	m_buffers(nullptr),
+	m_buffer(nullptr)
+{
+
+}
+
+CKinectDepthSource::~CKinectDepthSource()
+{
+	Destroy();
+}
+
+void CKinectDepthSource::Create(
+		INuiSensor *nuiSensor,
+		HANDLE depthStreamHandle,
+		CDepthBufferPool *buffers
+	)
+{
+	Destroy();
+
+	m_nuiSensor = nuiSensor;
+	m_depthStreamHandle = depthStreamHandle;
+	m_buffers = buffers;
+}
+
+void CKinectDepthSource::Destroy()
+{
+	if (m_buffer != nullptr)
+	{
+		m_buffer->Release();
+		m_buffer = nullptr;
+	}
+}
+
+bool CKinectDepthSource::GetNextFrame(
+		DepthFrame &frame
+	)
+{
+	NUI_IMAGE_FRAME imageFrame;
+
+	HRESULT hr = m_nuiSensor->NuiImageStreamGetNextFrame(
+		m_depthStreamHandle,
+		0,
+		&imageFrame 
+	);
+
+	if (FAILED(hr))
+		return false;
+
+	// the last frame's pixels only had to last until now, anyone still using them holds their own reference
+	Destroy();
+
+	INuiFrameTexture *pTexture = imageFrame.pFrameTexture;
+	NUI_LOCKED_RECT LockedRect;
+	pTexture->LockRect( 0, &LockedRect, NULL, 0 );
+
+	DWORD frameWidth, frameHeight;
+	NuiImageResolutionToSize( imageFrame.eResolution, frameWidth, frameHeight );
+
+	bool valid = LockedRect.Pitch != NULL;
+	if (!valid)
+	{
+		OutputDebugString("Buffer length of received texture is bogus\r\n");
+	}
+	else if (frameWidth != m_buffers->GetWidth() || frameHeight != m_buffers->GetHeight())
+	{
+		OutputDebugString("Depth frame doesn't fit the pooled buffers\r\n");
+		valid = false;
+	}
+	else
+	{
+		// every pooled buffer is still being tracked, so this frame is dropped
+		m_buffer = m_buffers->Acquire();
+		valid = m_buffer != nullptr;
+	}
+
+	if (valid)
+	{
+		// copy row by row, the texture's rows may be padded
+		USHORT *pixels = m_buffer->GetPixels();
+		for (DWORD row = 0; row < frameHeight; ++row)
+		{
+			memcpy(&pixels[row * frameWidth], LockedRect.pBits + (row * LockedRect.Pitch), frameWidth * sizeof(USHORT));
+		}
+
+		frame.width = frameWidth;
+		frame.height = frameHeight;
+		frame.timestamp = static_cast<unsigned long long>(imageFrame.liTimeStamp.QuadPart) * 1000;
+		frame.pixels = pixels;
+		frame.buffer = m_buffer;
+	}
+
+	pTexture->UnlockRect( 0 );
+
+	m_nuiSensor->NuiImageStreamReleaseFrame(m_depthStreamHandle, &imageFrame);
+
+	return valid;
+}
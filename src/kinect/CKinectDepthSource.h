@@ -0,0 +1,46 @@
+#pragma once
+
+#include <windows.h>
+#include <NuiApi.h>
+
+#include "CDepthBufferPool.h"
+#include "IDepthFrameSource.h"
+
+/*
+ *	\brief Depth frames from the sensor's depth stream.
+ *	Each frame is copied out of the stream's texture into a pooled depth buffer and the
+ *	frame released straight away, so the sensor never runs out of buffers while the frame
+ *	is being tracked. That copy also drops the texture's row padding, and it is the only
+ *	one, whoever takes the frame shares the pooled buffer by reference. When every pooled
+ *	buffer is held the frame is dropped.
+*/
+class CKinectDepthSource : public IDepthFrameSource {
+private:
+
+	INuiSensor										*m_nuiSensor;									//!< The sensor the stream belongs to
+	HANDLE											m_depthStreamHandle;							//!< The open depth stream
+	CDepthBufferPool								*m_buffers;										//!< The pool the frames are copied into
+	CDepthBuffer									*m_buffer;										//!< The buffer of the last frame, held until the next call
+
+public:
+													//! Class constructor
+													CKinectDepthSource();
+
+													//! Class destructor
+													~CKinectDepthSource();
+
+													//! Take frames from an open depth stream
+	void											Create(
+														INuiSensor *nuiSensor,						//!< The sensor the stream belongs to
+														HANDLE depthStreamHandle,					//!< The open depth stream
+														CDepthBufferPool *buffers					//!< The pool to copy the frames into, which must outlive the source's use
+													);
+
+													//! Release the buffer of the last frame, so the pool gets every buffer back
+	void											Destroy();
+
+													//! Get the frame the stream's event signalled, its pixels stay valid until the next call
+	virtual bool									GetNextFrame(
+														DepthFrame &frame							//!< Receives the frame
+													);
+};
@@ -0,0 +1,118 @@
+#include "CLatencyHistogram.h"
+
+/*
+ *	\brief Class constructor
+*/
+CLatencyHistogram::CLatencyHistogram() :
+	m_count(0),
+	m_total(0),
+	m_maximum(0)
+{
+	for (unsigned int bucket = 0; bucket < BucketCount; ++bucket)
+	{
+		m_buckets[bucket] = 0;
+	}
+}
+
+/*
+ *	\brief Forget every time added
+*/
+void CLatencyHistogram::Reset()
+{
+	for (unsigned int bucket = 0; bucket < BucketCount; ++bucket)
+	{
+		m_buckets[bucket] = 0;
+	}
+
+	m_count = 0;
+	m_total = 0;
+	m_maximum = 0;
+}
+
+/*
+ *	\brief Count a time
+*/
+void CLatencyHistogram::Add(
+		unsigned long long microseconds				//!< The time taken
+	)
+{
+	m_buckets[GetBucket(microseconds)]++;
+	m_count++;
+	m_total += microseconds;
+
+	// keep the largest, even if a reader reset it in between
+	unsigned long long maximum = m_maximum;
+	while (microseconds > maximum && !m_maximum.compare_exchange_weak(maximum, microseconds))
+	{
+	}
+}
+
+/*
+ *	\brief Get the bucket a time is counted in
+*/
+unsigned int CLatencyHistogram::GetBucket(
+		unsigned long long microseconds				//!< The time taken
+	)
+{
+	// the bucket is one more than the index of the highest set bit
+	unsigned int bucket = 0;
+	while (microseconds != 0 && bucket + 1 < BucketCount)
+	{
+		microseconds >>= 1;
+		++bucket;
+	}
+
+	return bucket;
+}
+
+/*
+ *	\brief Get the longest time counted in a bucket, in microseconds
+*/
+unsigned long long CLatencyHistogram::GetBucketLimit(
+		unsigned int bucket							//!< The bucket
+	)
+{
+	return (1ULL << bucket) - 1;
+}
+
+/*
+ *	\brief Get the mean time added, in microseconds
+*/
+double CLatencyHistogram::GetMean() const
+{
+	const unsigned int count = m_count;
+	return count == 0 ? 0.0 : static_cast<double>(m_total) / count;
+}
+
+/*
+ *	\brief Get the limit of the bucket a percentage of the times fall at or under, in microseconds
+*/
+unsigned long long CLatencyHistogram::GetPercentile(
+		float percent								//!< The percentage of times, such as 50 or 99
+	) const
+{
+	unsigned int counts[BucketCount];
+	unsigned int count = 0;
+	for (unsigned int bucket = 0; bucket < BucketCount; ++bucket)
+	{
+		counts[bucket] = m_buckets[bucket];
+		count += counts[bucket];
+	}
+
+	if (count == 0)
+		return 0;
+
+	// the number of times which must be at or under the answer, at least one
+	unsigned long long wanted = static_cast<unsigned long long>((count * static_cast<double>(percent) / 100.0) + 0.5);
+	if (wanted == 0) wanted = 1;
+
+	unsigned long long seen = 0;
+	for (unsigned int bucket = 0; bucket < BucketCount; ++bucket)
+	{
+		seen += counts[bucket];
+		if (seen >= wanted)
+			return GetBucketLimit(bucket);
+	}
+
+	return GetBucketLimit(BucketCount - 1);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include <atomic>
+
+/*
+ *	\brief Counts how long something took in power of two buckets of microseconds.
+ *	The first bucket holds times under a microsecond and each bucket after holds twice the
+ *	range of the one before, so the last of 24 buckets starts past 4 seconds. One thread adds times while
+ *	any other can read the counts, every count is atomic and adding never locks or allocates.
+*/
+class CLatencyHistogram {
+public:
+	static const unsigned int		BucketCount = 24;					//!< The number of buckets, the last also holds anything longer
+
+private:
+	std::atomic<unsigned int>		m_buckets[BucketCount];				//!< The number of times in each bucket
+	std::atomic<unsigned int>		m_count;							//!< The number of times added
+	std::atomic<unsigned long long>	m_total;							//!< The sum of every time added, in microseconds
+	std::atomic<unsigned long long>	m_maximum;							//!< The longest time added, in microseconds
+
+public:
+									//! Class constructor
+									CLatencyHistogram();
+
+									//! Forget every time added
+	void							Reset();
+
+									//! Count a time
+	void							Add(
+										unsigned long long microseconds	//!< The time taken
+									);
+
+									//! Get the bucket a time is counted in
+	static unsigned int				GetBucket(
+										unsigned long long microseconds	//!< The time taken
+									);
+
+									//! Get the longest time counted in a bucket, in microseconds
+	static unsigned long long		GetBucketLimit(
+										unsigned int bucket				//!< The bucket
+									);
+
+									//! Get the number of times in a bucket
+	unsigned int					GetBucketCount(
+										unsigned int bucket				//!< The bucket
+									) const
+									{
+										return m_buckets[bucket];
+									}
+
+									//! Get the number of times added
+	unsigned int					GetCount() const
+									{
+										return m_count;
+									}
+
+									//! Get the mean time added, in microseconds
+	double							GetMean() const;
+
+									//! Get the longest time added, in microseconds
+	unsigned long long				GetMaximum() const
+									{
+										return m_maximum;
+									}
+
+									//! Get the limit of the bucket a percentage of the times fall at or under, in microseconds
+	unsigned long long				GetPercentile(
+										float percent					//!< The percentage of times, such as 50 or 99
+									) const;
+};
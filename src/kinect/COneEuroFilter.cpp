@@ -0,0 +1,124 @@
+#include "COneEuroFilter.h"
+#include <math.h>
+
+/*
+ *	\brief Class constructor
+*/
+COneEuroFilter::COneEuroFilter(
+		const OneEuroSettings &settings				//!< The tunable settings
+	) :
+	m_settings(settings)
+{
+	Reset();
+}
+
+/*
+ *	\brief Class destructor
+*/
+COneEuroFilter::~COneEuroFilter()
+{
+
+}
+
+/*
+ *	\brief Forget every position, such as when the hand is lost
+*/
+void COneEuroFilter::Reset()
+{
+	for (unsigned int axis = 0; axis < 2; ++axis)
+	{
+		m_axes[axis].position = 0.0f;
+		m_axes[axis].speed = 0.0f;
+	}
+
+	m_lastX = 0.0f;
+	m_lastY = 0.0f;
+	m_lastTime = 0;
+	m_hasPosition = false;
+}
+
+/*
+ *	\brief Get the smoothing factor of a low pass filter with a cutoff over a time step
+*/
+float COneEuroFilter::GetSmoothing(
+		float cutoff,								//!< The cutoff frequency, in hertz
+		float seconds								//!< The time step, in seconds
+	)
+{
+	const float timeConstant = 1.0f / (6.2831853f * cutoff);
+	return 1.0f / (1.0f + (timeConstant / seconds));
+}
+
+/*
+ *	\brief Filter one axis of a new position
+*/
+void COneEuroFilter::FilterAxis(
+		Axis &axis,									//!< The axis
+		float last,									//!< The last measured position on the axis
+		float measured,								//!< The new measured position on the axis
+		float seconds								//!< The time since the last position, in seconds
+	)
+{
+	// the speed is smoothed at a fixed cutoff, then sets the cutoff for the position
+	const float speed = (measured - last) / seconds;
+	axis.speed += GetSmoothing(m_settings.derivativeCutoff, seconds) * (speed - axis.speed);
+
+	const float cutoff = m_settings.minimumCutoff + (m_settings.beta * fabs(axis.speed));
+	axis.position += GetSmoothing(cutoff, seconds) * (measured - axis.position);
+}
+
+/*
+ *	\brief Add a measured position, times must not go backwards
+*/
+void COneEuroFilter::Add(
+		unsigned long long time,					//!< When the position was measured, in microseconds
+		float x,									//!< The measured column
+		float y										//!< The measured row
+	)
+{
+	if (!m_hasPosition)
+	{
+		m_axes[0].position = x;
+		m_axes[1].position = y;
+		m_axes[0].speed = 0.0f;
+		m_axes[1].speed = 0.0f;
+	}
+	else if (time > m_lastTime)
+	{
+		const float seconds = static_cast<float>(time - m_lastTime) * 0.000001f;
+		FilterAxis(m_axes[0], m_lastX, x, seconds);
+		FilterAxis(m_axes[1], m_lastY, y, seconds);
+	}
+	else
+	{
+		// two positions at once can't give a speed, the newer one just replaces the older
+		m_axes[0].position = x;
+		m_axes[1].position = y;
+	}
+
+	m_lastX = x;
+	m_lastY = y;
+	m_lastTime = time;
+	m_hasPosition = true;
+}
+
+/*
+ *	\brief Get the estimated position at a time, false if no position has been added
+*/
+bool COneEuroFilter::Predict(
+		unsigned long long time,					//!< The time to estimate the position at, in microseconds
+		float &x,									//!< Receives the estimated column
+		float &y									//!< Receives the estimated row
+	) const
+{
+	if (!m_hasPosition)
+		return false;
+
+	unsigned long long lead = time > m_lastTime ? time - m_lastTime : 0;
+	if (lead > m_settings.maximumLead) lead = m_settings.maximumLead;
+
+	const float seconds = static_cast<float>(lead) * 0.000001f;
+	x = m_axes[0].position + (m_axes[0].speed * seconds);
+	y = m_axes[1].position + (m_axes[1].speed * seconds);
+	return true;
+}
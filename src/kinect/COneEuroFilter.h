@@ -0,0 +1,95 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "IPositionFilter.h"
+
+/*
+ *	\brief The tunable settings of a one euro filter
+*/
+struct OneEuroSettings
+{
+	float						minimumCutoff;					//!< The cutoff frequency while the position is still, in hertz, lower is smoother
+	float						beta;							//!< How much the cutoff rises with speed, in hertz per pixel a second, higher lags less
+	float						derivativeCutoff;				//!< The cutoff frequency of the speed estimate, in hertz
+	unsigned long long			maximumLead;					//!< The furthest past the last position it extrapolates, in microseconds
+};
+
+/*
+ *	\brief A one euro filter, a low pass filter whose cutoff rises with the speed of the position.
+ *	While the hand is held still the cutoff is low and the jitter is smoothed away, when it moves
+ *	quickly the cutoff rises so the filtered position doesn't lag behind. The smoothed speed it
+ *	keeps to set the cutoff also extrapolates the position past the last measurement.
+*/
+class COneEuroFilter : public IPositionFilter {
+private:
+
+	struct Axis {
+		float					position;						//!< The filtered position
+		float					speed;							//!< The filtered speed, in pixels a second
+	};
+
+private:
+	OneEuroSettings				m_settings;						//!< The tunable settings
+	Axis						m_axes[2];						//!< The x and y axes
+	float						m_lastX;						//!< The last measured column
+	float						m_lastY;						//!< The last measured row
+	unsigned long long			m_lastTime;						//!< When the last position was measured, in microseconds
+	bool						m_hasPosition;					//!< Has a position been added since the last reset
+
+private:
+								//! Get the smoothing factor of a low pass filter with a cutoff over a time step
+	static float				GetSmoothing(
+									float cutoff,				//!< The cutoff frequency, in hertz
+									float seconds				//!< The time step, in seconds
+								);
+
+								//! Filter one axis of a new position
+	void						FilterAxis(
+									Axis &axis,					//!< The axis
+									float last,					//!< The last measured position on the axis
+									float measured,				//!< The new measured position on the axis
+									float seconds				//!< The time since the last position, in seconds
+								);
+
+public:
+								//! Class constructor
+								COneEuroFilter(
+									const OneEuroSettings &settings	//!< The tunable settings
+								);
+
+								//! Class destructor
+	virtual						~COneEuroFilter();
+
+								//! Change the settings, the filtered position is kept
+	void						SetSettings(
+									const OneEuroSettings &settings	//!< The tunable settings
+								)
+								{
+									m_settings = settings;
+								}
+
+								//! Get the settings
+	const OneEuroSettings		&GetSettings() const
+								{
+									return m_settings;
+								}
+
+								//! Forget every position, such as when the hand is lost
+	virtual void				Reset();
+
+								//! Add a measured position, times must not go backwards
+	virtual void				Add(
+									unsigned long long time,	//!< When the position was measured, in microseconds
+									float x,					//!< The measured column
+									float y						//!< The measured row
+								);
+
+								//! Get the estimated position at a time, false if no position has been added
+	virtual bool				Predict(
+									unsigned long long time,	//!< The time to estimate the position at, in microseconds
+									float &x,					//!< Receives the estimated column
+									float &y					//!< Receives the estimated row
+								) const;
+};
@@ -0,0 +1,164 @@
+#include "CScreenshotWriter.h"
+#include <string.h>
+
+/*
+ *	\brief Class constructor
+*/
+CScreenshotWriter::CScreenshotWriter() :
+	m_running(false),
+	m_width(0),
+	m_height(0),
+	m_format(ScreenshotFormat::Bitmap),
+	m_queueStart(0),
+	m_queueCount(0),
+	m_queueReady(0),
+	m_screenshotsWritten(0),
+	m_screenshotsDropped(0),
+	m_screenshotsFailed(0)
+{
+
+}
+
+/*
+ *	\brief Class destructor, writes the screenshots still queued
+*/
+CScreenshotWriter::~CScreenshotWriter()
+{
+	Destroy();
+}
+
+/*
+ *	\brief Allocate the buffers and start the write thread
+*/
+void CScreenshotWriter::Create(
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows in a frame
+		ScreenshotFormat::Enum format				//!< The format screenshots are saved in
+	)
+{
+	Destroy();
+
+	// the buffers are allocated up front so taking a screenshot never allocates
+	for (unsigned int slot = 0; slot < QueueCapacity; ++slot)
+	{
+		m_queue[slot].pixels.resize(width * height * 4);
+	}
+
+	m_width = width;
+	m_height = height;
+	m_format = format;
+	m_queueStart = 0;
+	m_queueCount = 0;
+	m_queueReady = 0;
+	m_running = true;
+
+	m_thread = std::thread(&CScreenshotWriter::WriteThread, this);
+}
+
+/*
+ *	\brief Write the screenshots still queued and stop the write thread
+*/
+void CScreenshotWriter::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+	}
+
+	m_screenshotQueued.notify_one();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+/*
+ *	\brief Queue a screenshot to be saved, false if it was dropped
+*/
+bool CScreenshotWriter::Push(
+		const unsigned char *pixels,				//!< The blue, green, red, unused pixels of the frame
+		unsigned int pitch,							//!< The number of bytes from one row to the next
+		const std::string &fileName					//!< The location to save the image to, without the extension
+	)
+{
+	unsigned int slot;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_running || m_queueCount == QueueCapacity)
+		{
+			m_screenshotsDropped++;
+			return false;
+		}
+
+		// claim the slot, the write thread only reads filled slots
+		slot = (m_queueStart + m_queueCount) % QueueCapacity;
+		m_queueCount++;
+	}
+
+	// copy outside the lock so the write thread can carry on with the screenshot before
+	QueuedScreenshot &screenshot = m_queue[slot];
+	screenshot.fileName = fileName + GetScreenshotExtension(m_format);
+
+	const unsigned int rowSize = m_width * 4;
+	if (pitch == rowSize)
+	{
+		memcpy(&screenshot.pixels[0], pixels, rowSize * m_height);
+	}
+	else
+	{
+		for (unsigned int row = 0; row < m_height; ++row)
+		{
+			memcpy(&screenshot.pixels[row * rowSize], pixels + (row * pitch), rowSize);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queueReady++;
+	}
+
+	m_screenshotQueued.notify_one();
+	return true;
+}
+
+/*
+ *	\brief The encode and write thread entry point
+*/
+void CScreenshotWriter::WriteThread()
+{
+	for (;;)
+	{
+		unsigned int slot;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (m_queueReady == 0 && (m_running || m_queueCount > 0))
+			{
+				m_screenshotQueued.wait(lock);
+			}
+
+			// stopped, and every queued screenshot has been written
+			if (m_queueReady == 0)
+				break;
+
+			slot = m_queueStart;
+		}
+
+		const QueuedScreenshot &screenshot = m_queue[slot];
+		if (SaveScreenshot(screenshot.fileName, &screenshot.pixels[0], m_width, m_height, m_format))
+		{
+			m_screenshotsWritten++;
+		}
+		else
+		{
+			m_screenshotsFailed++;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_queueStart = (m_queueStart + 1) % QueueCapacity;
+			m_queueCount--;
+			m_queueReady--;
+		}
+	}
+}
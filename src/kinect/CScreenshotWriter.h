@@ -0,0 +1,94 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "Screenshot.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/*
+ *	\brief Saves screenshots of the color stream without holding up the kinect thread.
+ *	The frame is copied into one of a few pooled buffers, so the caller can unlock the
+ *	texture straight away, and a background thread encodes and writes it. When every
+ *	buffer is waiting to be written the screenshot is dropped and counted.
+*/
+class CScreenshotWriter {
+public:
+	static const unsigned int		QueueCapacity = 3;					//!< The number of screenshots which can wait to be written
+
+private:
+
+	struct QueuedScreenshot
+	{
+		std::string						fileName;						//!< The location to save the image to
+		std::vector<unsigned char>		pixels;							//!< The pixels of the frame, rows packed together
+	};
+
+private:
+	std::thread						m_thread;							//!< The encode and write thread
+	std::mutex						m_mutex;							//!< Guards the queue
+	std::condition_variable			m_screenshotQueued;					//!< Signalled when a screenshot is queued or the writer stops
+
+	bool							m_running;							//!< Is the writer accepting screenshots
+	unsigned int					m_width;							//!< The number of pixels in a row
+	unsigned int					m_height;							//!< The number of rows in a frame
+	ScreenshotFormat::Enum			m_format;							//!< The format screenshots are saved in
+
+	QueuedScreenshot				m_queue[QueueCapacity];				//!< The ring of screenshots waiting to be written
+	unsigned int					m_queueStart;						//!< The index of the oldest queued screenshot
+	unsigned int					m_queueCount;						//!< The number of queued screenshots, including one being filled
+	unsigned int					m_queueReady;						//!< The number of queued screenshots which have been filled
+
+	std::atomic<unsigned int>		m_screenshotsWritten;				//!< The number of screenshots saved
+	std::atomic<unsigned int>		m_screenshotsDropped;				//!< The number of screenshots dropped because the queue was full
+	std::atomic<unsigned int>		m_screenshotsFailed;				//!< The number of screenshots which couldn't be saved
+
+private:
+									//! The encode and write thread entry point
+	void							WriteThread();
+
+public:
+									//! Class constructor
+									CScreenshotWriter();
+
+									//! Class destructor, writes the screenshots still queued
+									~CScreenshotWriter();
+
+									//! Allocate the buffers and start the write thread
+	void							Create(
+										unsigned int width,				//!< The number of pixels in a row
+										unsigned int height,			//!< The number of rows in a frame
+										ScreenshotFormat::Enum format	//!< The format screenshots are saved in
+									);
+
+									//! Write the screenshots still queued and stop the write thread
+	void							Destroy();
+
+									//! Queue a screenshot to be saved, false if it was dropped
+	bool							Push(
+										const unsigned char *pixels,	//!< The blue, green, red, unused pixels of the frame
+										unsigned int pitch,				//!< The number of bytes from one row to the next
+										const std::string &fileName		//!< The location to save the image to, without the extension
+									);
+
+									//! Get the number of screenshots saved
+	unsigned int					GetScreenshotsWritten() const
+									{
+										return m_screenshotsWritten;
+									}
+
+									//! Get the number of screenshots dropped because the queue was full
+	unsigned int					GetScreenshotsDropped() const
+									{
+										return m_screenshotsDropped;
+									}
+
+									//! Get the number of screenshots which couldn't be saved
+	unsigned int					GetScreenshotsFailed() const
+									{
+										return m_screenshotsFailed;
+									}
+};
@@ -0,0 +1,139 @@
+#include "DepthBand.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+	#define DEPTH_BAND_SSE2
+	#include <emmintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#endif
+#endif
+
+static const unsigned int NoColumn = ~0u;
+
+#ifdef DEPTH_BAND_SSE2
+/*
+ *	\brief Get the index of the lowest set bit, bits must not be zero
+*/
+static unsigned int GetLowestBit(
+		unsigned int bits							//!< The bits to search
+	)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, bits);
+	return index;
+#else
+	return __builtin_ctz(bits);
+#endif
+}
+
+/*
+ *	\brief Get the index of the highest set bit, bits must not be zero
+*/
+static unsigned int GetHighestBit(
+		unsigned int bits							//!< The bits to search
+	)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse(&index, bits);
+	return index;
+#else
+	return 31 - __builtin_clz(bits);
+#endif
+}
+#endif
+
+/*
+ *	\brief Threshold a window of the frame into the mask and get the bounds of the pixels in the band
+*/
+MaskArea ThresholdDepthWindow(
+		const unsigned short *depthPixels,			//!< The packed depth pixels of the whole frame, depth in the top 13 bits
+		unsigned int width,							//!< The number of pixels in a row
+		const MaskArea &window,						//!< The window to threshold
+		int nearPoint,								//!< The nearest depth in the band, in millimetres
+		int farPoint,								//!< One past the furthest depth in the band, in millimetres
+		unsigned char *mask							//!< The mask of the whole frame, only the pixels in the window are written
+	)
+{
+	MaskArea area = { window.right, window.bottom, 0, 0 };
+
+#ifdef DEPTH_BAND_SSE2
+	// depths are 13 bit so the signed 16 bit compares are safe
+	const __m128i nearLimit = _mm_set1_epi16(static_cast<short>(nearPoint - 1));
+	const __m128i farLimit = _mm_set1_epi16(static_cast<short>(farPoint));
+	const __m128i one = _mm_set1_epi8(1);
+#endif
+
+	for (unsigned int row = window.top; row < window.bottom; ++row)
+	{
+		const unsigned short *rowPixels = depthPixels + (row * width);
+		unsigned char *rowMask = mask + (row * width);
+
+		unsigned int rowLeft = NoColumn;
+		unsigned int rowRight = 0;
+		unsigned int column = window.left;
+
+#ifdef DEPTH_BAND_SSE2
+		for (; column + 16 <= window.right; column += 16)
+		{
+			const __m128i low = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(rowPixels + column)), 3);
+			const __m128i high = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(rowPixels + column + 8)), 3);
+
+			const __m128i inLow = _mm_and_si128(_mm_cmpgt_epi16(low, nearLimit), _mm_cmplt_epi16(low, farLimit));
+			const __m128i inHigh = _mm_and_si128(_mm_cmpgt_epi16(high, nearLimit), _mm_cmplt_epi16(high, farLimit));
+
+			// saturating the 0 and -1 words gives a 0 or 0xff byte per pixel
+			const __m128i inBand = _mm_packs_epi16(inLow, inHigh);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(rowMask + column), _mm_and_si128(inBand, one));
+
+			const unsigned int bits = static_cast<unsigned int>(_mm_movemask_epi8(inBand));
+			if (bits != 0)
+			{
+				if (rowLeft == NoColumn) rowLeft = column + GetLowestBit(bits);
+				rowRight = column + GetHighestBit(bits) + 1;
+			}
+		}
+#endif
+
+		for (; column < window.right; ++column)
+		{
+			const int depth = rowPixels[column] >> 3;
+			const bool inBand = depth >= nearPoint && depth < farPoint;
+			rowMask[column] = inBand ? 1 : 0;
+
+			if (inBand)
+			{
+				if (rowLeft == NoColumn) rowLeft = column;
+				rowRight = column + 1;
+			}
+		}
+
+		if (rowLeft == NoColumn)
+			continue;
+
+		if (rowLeft < area.left) area.left = rowLeft;
+		if (rowRight > area.right) area.right = rowRight;
+		if (row < area.top) area.top = row;
+		area.bottom = row + 1;
+	}
+
+	return area;
+}
+
+/*
+ *	\brief Threshold a window of rows into the mask and get the bounds of the pixels in the band
+*/
+MaskArea ThresholdDepthBand(
+		const unsigned short *depthPixels,			//!< The packed depth pixels of the whole frame, depth in the top 13 bits
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int firstRow,						//!< The first row to threshold
+		unsigned int lastRow,						//!< One past the last row to threshold
+		int nearPoint,								//!< The nearest depth in the band, in millimetres
+		int farPoint,								//!< One past the furthest depth in the band, in millimetres
+		unsigned char *mask							//!< The mask of the whole frame, only the rows in the window are written
+	)
+{
+	const MaskArea rows = { 0, firstRow, width, lastRow };
+	return ThresholdDepthWindow(depthPixels, width, rows, nearPoint, farPoint, mask);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+/*
+ *	\brief A rectangle of mask pixels, the right and bottom edges are exclusive
+*/
+struct MaskArea
+{
+	unsigned int			left;								//!< The first column in the area
+	unsigned int			top;								//!< The first row in the area
+	unsigned int			right;								//!< One past the last column in the area
+	unsigned int			bottom;								//!< One past the last row in the area
+
+							//! Does the area contain no pixels
+	bool					IsEmpty() const
+							{
+								return left >= right || top >= bottom;
+							}
+};
+
+/*
+ *	The depth band threshold used to find the hand.
+ *	Each row of packed depth pixels is thresholded into a one byte mask, 1 where the depth
+ *	lies in [nearPoint, farPoint) millimetres, while the first and last set column of the
+ *	row is tracked, so the bounds of the band come out of the same pass as the mask.
+ *	A window of the frame can be thresholded on its own, such as the area around the last hand.
+ *	Rows are processed 16 pixels at a time with SSE2 where the compiler targets x86.
+*/
+
+							//! Threshold a window of rows into the mask and get the bounds of the pixels in the band
+MaskArea					ThresholdDepthBand(
+								const unsigned short *depthPixels,	//!< The packed depth pixels of the whole frame, depth in the top 13 bits
+								unsigned int width,				//!< The number of pixels in a row
+								unsigned int firstRow,			//!< The first row to threshold
+								unsigned int lastRow,			//!< One past the last row to threshold
+								int nearPoint,					//!< The nearest depth in the band, in millimetres
+								int farPoint,					//!< One past the furthest depth in the band, in millimetres
+								unsigned char *mask				//!< The mask of the whole frame, only the rows in the window are written
+							);
+
+							//! Threshold a window of the frame into the mask and get the bounds of the pixels in the band
+MaskArea					ThresholdDepthWindow(
+								const unsigned short *depthPixels,	//!< The packed depth pixels of the whole frame, depth in the top 13 bits
+								unsigned int width,				//!< The number of pixels in a row
+								const MaskArea &window,			//!< The window to threshold
+								int nearPoint,					//!< The nearest depth in the band, in millimetres
+								int farPoint,					//!< One past the furthest depth in the band, in millimetres
+								unsigned char *mask				//!< The mask of the whole frame, only the pixels in the window are written
+							);
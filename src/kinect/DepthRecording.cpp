@@ -0,0 +1,267 @@
+#include "DepthRecording.h"
+
+/*
+ *	\brief Append a little endian 32 bit value to a byte buffer
+*/
+static void PutU32(
+		std::vector<unsigned char> &bytes,			//!< The buffer to append to
+		unsigned int value							//!< The value to append
+	)
+{
+	bytes.push_back(static_cast<unsigned char>(value));
+	bytes.push_back(static_cast<unsigned char>(value >> 8));
+	bytes.push_back(static_cast<unsigned char>(value >> 16));
+	bytes.push_back(static_cast<unsigned char>(value >> 24));
+}
+
+/*
+ *	\brief Fold a signed 16 bit difference so small differences either side of zero are small numbers
+*/
+static unsigned int ZigZag(
+		unsigned short difference					//!< The difference, wrapped to 16 bits
+	)
+{
+	const int value = static_cast<short>(difference);
+	return static_cast<unsigned short>((static_cast<unsigned int>(value) << 1) ^ static_cast<unsigned int>(value >> 15));
+}
+
+/*
+ *	\brief Undo ZigZag
+*/
+static unsigned short UnZigZag(
+		unsigned int folded							//!< The folded difference
+	)
+{
+	return static_cast<unsigned short>((folded >> 1) ^ (0 - (folded & 1)));
+}
+
+/*
+ *	\brief Get the difference of a pixel from its prediction
+*/
+static unsigned short GetDifference(
+		const unsigned short *pixels,				//!< The pixels of the frame
+		const unsigned short *previous,				//!< The pixels of the previous frame, null for a key frame
+		unsigned int pixel							//!< The pixel to get the difference of
+	)
+{
+	const unsigned short prediction = previous != nullptr ? previous[pixel] : pixel > 0 ? pixels[pixel - 1] : 0;
+	return static_cast<unsigned short>(pixels[pixel] - prediction);
+}
+
+/*
+ *	\brief Delta encode a frame, against the previous frame or against itself for a key frame
+*/
+void EncodeDepthDeltas(
+		const unsigned short *pixels,				//!< The packed depth pixels of the frame
+		const unsigned short *previous,				//!< The pixels of the previous frame, null for a key frame
+		unsigned int count,							//!< The number of pixels in a frame
+		std::vector<unsigned char> &encoded			//!< Receives the encoded frame
+	)
+{
+	encoded.clear();
+
+	unsigned int pixel = 0;
+	while (pixel < count)
+	{
+		const unsigned int folded = ZigZag(GetDifference(pixels, previous, pixel));
+
+		unsigned int run = 1;
+		if (folded == 0)
+		{
+			while (pixel + run < count && run < 128 && GetDifference(pixels, previous, pixel + run) == 0)
+				run++;
+
+			encoded.push_back(static_cast<unsigned char>(run - 1));
+		}
+		else if (folded < 256)
+		{
+			// single zeros are cheaper inside the run, two or more start a zero run
+			while (pixel + run < count && run < 64)
+			{
+				const unsigned int next = ZigZag(GetDifference(pixels, previous, pixel + run));
+				if (next >= 256) break;
+				if (next == 0 && (pixel + run + 1 >= count || GetDifference(pixels, previous, pixel + run + 1) == 0)) break;
+				run++;
+			}
+
+			encoded.push_back(static_cast<unsigned char>(0x80 + (run - 1)));
+			for (unsigned int index = 0; index < run; ++index)
+			{
+				encoded.push_back(static_cast<unsigned char>(ZigZag(GetDifference(pixels, previous, pixel + index))));
+			}
+		}
+		else
+		{
+			while (pixel + run < count && run < 64 && ZigZag(GetDifference(pixels, previous, pixel + run)) >= 256)
+				run++;
+
+			encoded.push_back(static_cast<unsigned char>(0xc0 + (run - 1)));
+			for (unsigned int index = 0; index < run; ++index)
+			{
+				const unsigned short difference = GetDifference(pixels, previous, pixel + index);
+				encoded.push_back(static_cast<unsigned char>(difference));
+				encoded.push_back(static_cast<unsigned char>(difference >> 8));
+			}
+		}
+
+		pixel += run;
+	}
+}
+
+/*
+ *	\brief Decode a delta encoded frame, false if the data is malformed
+*/
+bool DecodeDepthDeltas(
+		const unsigned char *encoded,				//!< The encoded frame
+		unsigned int size,							//!< The number of encoded bytes
+		const unsigned short *previous,				//!< The pixels of the previous frame, null for a key frame, may be the same as pixels
+		unsigned int count,							//!< The number of pixels in a frame
+		unsigned short *pixels						//!< Receives the pixels
+	)
+{
+	const unsigned char *end = encoded + size;
+	unsigned short last = 0;
+	unsigned int pixel = 0;
+
+	while (encoded < end)
+	{
+		const unsigned int token = *encoded++;
+		const unsigned int run = (token < 0x80 ? token : token & 0x3f) + 1;
+		const unsigned int bytesPerPixel = token < 0x80 ? 0 : token < 0xc0 ? 1 : 2;
+
+		if (pixel + run > count || static_cast<unsigned int>(end - encoded) < run * bytesPerPixel)
+			return false;
+
+		for (unsigned int index = 0; index < run; ++index, ++pixel)
+		{
+			unsigned short difference = 0;
+			if (bytesPerPixel == 1)
+			{
+				difference = UnZigZag(*encoded++);
+			}
+			else if (bytesPerPixel == 2)
+			{
+				difference = static_cast<unsigned short>(encoded[0] | (encoded[1] << 8));
+				encoded += 2;
+			}
+
+			const unsigned short prediction = previous != nullptr ? previous[pixel] : last;
+			last = static_cast<unsigned short>(prediction + difference);
+			pixels[pixel] = last;
+		}
+	}
+
+	return pixel == count;
+}
+
+/*
+ *	\brief Class constructor
+*/
+CDepthRecordingWriter::CDepthRecordingWriter() :
+	m_width(0),
+	m_height(0)
+{
+
+}
+
+/*
+ *	\brief Class destructor
+*/
+CDepthRecordingWriter::~CDepthRecordingWriter()
+{
+	Close();
+}
+
+/*
+ *	\brief Create a recording and write its header
+*/
+bool CDepthRecordingWriter::Open(
+		const std::string &fileName,				//!< The location to write the recording to
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height							//!< The number of rows in a frame
+	)
+{
+	Close();
+
+	m_file.open(fileName.c_str(), std::ios::binary | std::ios::trunc);
+	if (!m_file)
+		return false;
+
+	m_width = width;
+	m_height = height;
+
+	std::vector<unsigned char> header;
+	header.push_back('V');
+	header.push_back('C');
+	header.push_back('D');
+	header.push_back('R');
+	PutU32(header, DepthRecordingVersion);
+	PutU32(header, width);
+	PutU32(header, height);
+
+	m_file.write(reinterpret_cast<const char *>(&header[0]), header.size());
+	return m_file.good();
+}
+
+/*
+ *	\brief Append a raw frame chunk
+*/
+bool CDepthRecordingWriter::WriteFrame(
+		unsigned long long timestamp,				//!< When the frame was captured, in microseconds
+		const unsigned short *pixels				//!< The packed depth pixels of the frame
+	)
+{
+	const unsigned int pixelCount = m_width * m_height;
+
+	m_raw.resize(pixelCount * 2);
+	for (unsigned int pixel = 0; pixel < pixelCount; ++pixel)
+	{
+		m_raw[pixel * 2] = static_cast<unsigned char>(pixels[pixel]);
+		m_raw[(pixel * 2) + 1] = static_cast<unsigned char>(pixels[pixel] >> 8);
+	}
+
+	return WriteEncodedFrame(timestamp, DepthFrameEncoding::Raw, &m_raw[0], pixelCount * 2);
+}
+
+/*
+ *	\brief Append a frame chunk which has already been encoded
+*/
+bool CDepthRecordingWriter::WriteEncodedFrame(
+		unsigned long long timestamp,				//!< When the frame was captured, in microseconds
+		DepthFrameEncoding::Enum encoding,			//!< How the frame was encoded
+		const unsigned char *data,					//!< The encoded frame
+		unsigned int size							//!< The number of encoded bytes
+	)
+{
+	if (!m_file.is_open())
+		return false;
+
+	m_chunk.clear();
+	m_chunk.push_back('F');
+	m_chunk.push_back('R');
+	m_chunk.push_back('A');
+	m_chunk.push_back('M');
+	PutU32(m_chunk, DepthFrameChunkHeaderSize + size);
+	PutU32(m_chunk, static_cast<unsigned int>(timestamp));
+	PutU32(m_chunk, static_cast<unsigned int>(timestamp >> 32));
+	PutU32(m_chunk, encoding);
+
+	m_file.write(reinterpret_cast<const char *>(&m_chunk[0]), m_chunk.size());
+	if (size > 0)
+	{
+		m_file.write(reinterpret_cast<const char *>(data), size);
+	}
+
+	return m_file.good();
+}
+
+/*
+ *	\brief Finish the recording
+*/
+void CDepthRecordingWriter::Close()
+{
+	if (m_file.is_open())
+	{
+		m_file.close();
+	}
+}
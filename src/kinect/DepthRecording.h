@@ -0,0 +1,101 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*
+ *	A depth recording is a 16 byte header followed by a stream of chunks, all little endian.
+ *
+ *	Header:		"VCDR", version (u32), frame width (u32), frame height (u32)
+ *	Chunk:		tag (4 chars), payload size (u32), payload
+ *	"FRAM":		timestamp in microseconds (u64), encoding (u32), encoded pixels
+ *
+ *	Readers skip chunks with tags they don't know, so new chunk types can be added
+ *	without breaking older readers.
+ *
+ *	The delta encodings store each pixel as the difference from a prediction, packed into tokens:
+ *		0x00 - 0x7f		a run of 1 to 128 zero differences
+ *		0x80 - 0xbf		1 to 64 differences which zigzag into a byte, one byte each
+ *		0xc0 - 0xff		1 to 64 differences, two bytes each
+ *	Key frames predict each pixel from the one before it, so they decode on their own.
+ *	Other frames predict each pixel from the same pixel of the frame before, which the
+ *	still background of a depth stream makes mostly zero runs.
+*/
+
+struct DepthFrameEncoding {
+	enum Enum {
+		Raw,							//!< The packed depth pixels as they are
+		KeyDelta,						//!< Differences from the previous pixel in the frame
+		FrameDelta,						//!< Differences from the same pixel in the previous frame
+		Noof
+	};
+};
+
+static const unsigned int DepthRecordingVersion = 1;			//!< The version written to new recordings
+static const unsigned int DepthRecordingHeaderSize = 16;		//!< The size of the header in bytes
+static const unsigned int DepthChunkHeaderSize = 8;				//!< The size of a chunk's tag and payload size in bytes
+static const unsigned int DepthFrameChunkHeaderSize = 12;		//!< The size of a frame chunk's timestamp and encoding in bytes
+
+							//! Delta encode a frame, against the previous frame or against itself for a key frame
+void						EncodeDepthDeltas(
+								const unsigned short *pixels,	//!< The packed depth pixels of the frame
+								const unsigned short *previous,	//!< The pixels of the previous frame, null for a key frame
+								unsigned int count,				//!< The number of pixels in a frame
+								std::vector<unsigned char> &encoded	//!< Receives the encoded frame
+							);
+
+							//! Decode a delta encoded frame, false if the data is malformed
+bool						DecodeDepthDeltas(
+								const unsigned char *encoded,	//!< The encoded frame
+								unsigned int size,				//!< The number of encoded bytes
+								const unsigned short *previous,	//!< The pixels of the previous frame, null for a key frame, may be the same as pixels
+								unsigned int count,				//!< The number of pixels in a frame
+								unsigned short *pixels			//!< Receives the pixels
+							);
+
+/*
+ *	\brief Writes depth frames into a depth recording as they arrive
+*/
+class CDepthRecordingWriter {
+private:
+	std::ofstream				m_file;							//!< The recording being written
+	unsigned int				m_width;						//!< The number of pixels in a row
+	unsigned int				m_height;						//!< The number of rows in a frame
+	std::vector<unsigned char>	m_chunk;						//!< The frame chunk being assembled
+	std::vector<unsigned char>	m_raw;							//!< The little endian pixels of a raw frame
+
+public:
+								//! Class constructor
+								CDepthRecordingWriter();
+
+								//! Class destructor
+								~CDepthRecordingWriter();
+
+								//! Create a recording and write its header
+	bool						Open(
+									const std::string &fileName,	//!< The location to write the recording to
+									unsigned int width,				//!< The number of pixels in a row
+									unsigned int height				//!< The number of rows in a frame
+								);
+
+								//! Append a raw frame chunk
+	bool						WriteFrame(
+									unsigned long long timestamp,	//!< When the frame was captured, in microseconds
+									const unsigned short *pixels	//!< The packed depth pixels of the frame
+								);
+
+								//! Append a frame chunk which has already been encoded
+	bool						WriteEncodedFrame(
+									unsigned long long timestamp,	//!< When the frame was captured, in microseconds
+									DepthFrameEncoding::Enum encoding,	//!< How the frame was encoded
+									const unsigned char *data,		//!< The encoded frame
+									unsigned int size				//!< The number of encoded bytes
+								);
+
+								//! Finish the recording
+	void						Close();
+};
@@ -0,0 +1,96 @@
+#include "DistanceTransform.h"
+
+// the chamfer steps, a diagonal is close enough to 3 * sqrt(2)
+static const unsigned int STRAIGHT_STEP = DISTANCE_UNITS_PER_PIXEL;
+static const unsigned int DIAGONAL_STEP = 4;
+
+/*
+ *	\brief Lower a distance to a neighbour's distance plus a step, if that is nearer
+*/
+static inline void Relax(
+		unsigned int &distance,						//!< The distance to lower
+		unsigned int neighbour,						//!< The distance of the neighbour
+		unsigned int step							//!< The distance to the neighbour
+	)
+{
+	if (neighbour + step < distance)
+	{
+		distance = neighbour + step;
+	}
+}
+
+/*
+ *	\brief Get the distance of each pixel of an area to the nearest edge in the area
+*/
+void ComputeDistanceTransform(
+		const unsigned char *edges,					//!< The edge mask of the whole image, non zero on an edge
+		unsigned int width,							//!< The number of pixels in a row
+		const MaskArea &area,						//!< The area to find the distances in
+		unsigned short *distance					//!< The distances of the whole image, only the area is written
+	)
+{
+	if (area.IsEmpty())
+		return;
+
+	// forwards, from the pixels above and to the left
+	for (unsigned int row = area.top; row < area.bottom; ++row)
+	{
+		const unsigned char *rowEdges = edges + (row * width);
+		unsigned short *rowDistance = distance + (row * width);
+		const bool hasAbove = row > area.top;
+		const unsigned short *above = hasAbove ? rowDistance - width : rowDistance;
+
+		for (unsigned int column = area.left; column < area.right; ++column)
+		{
+			if (rowEdges[column] != 0)
+			{
+				rowDistance[column] = 0;
+				continue;
+			}
+
+			unsigned int nearest = NO_EDGE_DISTANCE;
+			if (column > area.left)
+			{
+				Relax(nearest, rowDistance[column - 1], STRAIGHT_STEP);
+			}
+
+			if (hasAbove)
+			{
+				Relax(nearest, above[column], STRAIGHT_STEP);
+				if (column > area.left) Relax(nearest, above[column - 1], DIAGONAL_STEP);
+				if (column + 1 < area.right) Relax(nearest, above[column + 1], DIAGONAL_STEP);
+			}
+
+			rowDistance[column] = static_cast<unsigned short>(nearest < NO_EDGE_DISTANCE ? nearest : NO_EDGE_DISTANCE);
+		}
+	}
+
+	// backwards, from the pixels below and to the right
+	for (unsigned int row = area.bottom; row-- > area.top;)
+	{
+		unsigned short *rowDistance = distance + (row * width);
+		const bool hasBelow = row + 1 < area.bottom;
+		const unsigned short *below = hasBelow ? rowDistance + width : rowDistance;
+
+		for (unsigned int column = area.right; column-- > area.left;)
+		{
+			unsigned int nearest = rowDistance[column];
+			if (nearest == 0)
+				continue;
+
+			if (column + 1 < area.right)
+			{
+				Relax(nearest, rowDistance[column + 1], STRAIGHT_STEP);
+			}
+
+			if (hasBelow)
+			{
+				Relax(nearest, below[column], STRAIGHT_STEP);
+				if (column + 1 < area.right) Relax(nearest, below[column + 1], DIAGONAL_STEP);
+				if (column > area.left) Relax(nearest, below[column - 1], DIAGONAL_STEP);
+			}
+
+			rowDistance[column] = static_cast<unsigned short>(nearest < NO_EDGE_DISTANCE ? nearest : NO_EDGE_DISTANCE);
+		}
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "DepthBand.h"
+
+/*
+ *	The chamfer distance transform the hand templates are matched against.
+ *	Each pixel of an area gets the distance to the nearest edge pixel in the area, stepping
+ *	3 for a straight move and 4 for a diagonal one, so a distance divided by
+ *	DISTANCE_UNITS_PER_PIXEL is within 8% of the true distance in pixels. Two passes over
+ *	the area, forwards then backwards, find every distance. Only the area is written.
+*/
+
+							//! The distance of a straight step between neighbouring pixels
+static const unsigned int	DISTANCE_UNITS_PER_PIXEL = 3;
+
+							//! The distance given to pixels with no edge in the area
+static const unsigned short	NO_EDGE_DISTANCE = 0xFFFF;
+
+							//! Get the distance of each pixel of an area to the nearest edge in the area
+void						ComputeDistanceTransform(
+								const unsigned char *edges,		//!< The edge mask of the whole image, non zero on an edge
+								unsigned int width,				//!< The number of pixels in a row
+								const MaskArea &area,			//!< The area to find the distances in
+								unsigned short *distance		//!< The distances of the whole image, only the area is written
+							);
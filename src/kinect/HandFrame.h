@@ -0,0 +1,69 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "CHandShapeClassifier.h"
+#include "DepthBand.h"
+#include <vector>
+
+struct HandState {
+	enum Enum {
+		ClosedFist,
+		OpenHand,
+		NotFound,
+		Noof
+	};
+};
+
+/*
+ *	\brief What the hand tracker made of one depth frame.
+ *	Segmentation fills in where the hand is and copies out the mask of its blob, then
+ *	classification works from that copy alone and fills in the rest. Nothing refers back
+ *	to the tracker's own buffers, so the two halves can run on different threads a frame
+ *	apart, and the debug view can be drawn from the frame after both have moved on.
+ *	Tracking only ever writes here, it never draws into the depth or the debug view.
+*/
+struct HandFrame
+{
+	bool						found;							//!< Did segmentation find a hand
+	int							nearPoint;						//!< The nearest depth of the band the hand was searched for in, in millimetres
+	int							farPoint;						//!< One past the furthest depth of the band
+	MaskArea					area;							//!< The hand area, in frame pixels
+	float						palmX;							//!< The column of the middle of the hand area
+	float						palmY;							//!< The row of the middle of the hand area
+	unsigned int				startX;							//!< The column of the hand blob's first pixel, scanning rows top to bottom
+	unsigned int				startY;							//!< The row of the hand blob's first pixel
+
+	MaskArea					maskArea;						//!< The area the mask and edges cover, the hand area and a pixel around it
+	std::vector<unsigned char>	mask;							//!< One byte per pixel of the mask area, 1 on the hand blob
+	std::vector<unsigned char>	edges;							//!< One byte per pixel of the mask area, 1 on the edges of the hand blob
+
+	HandState::Enum				state;							//!< The steadied open or closed state, not found if there is no hand
+	float						confidence;						//!< How sure the classifier is of the state this frame, between 0 and 1, 0 if there is no hand
+	HandState::Enum				templateState;					//!< The state of the template which fit best, not found if none matched
+	float						centerX;						//!< The column of the palm when the hand was last found or closed
+	float						centerY;						//!< The row of the palm when the hand was last found or closed
+	std::vector<ContourPoint>	fingerValleys;					//!< The deepest points between the fingers counted, in frame pixels
+	std::vector<ContourPoint>	templateOutline;				//!< The outline of the best template where it fit, in frame pixels
+
+								//! Class constructor
+								HandFrame() :
+									found(false),
+									nearPoint(0),
+									farPoint(0),
+									palmX(0.0f),
+									palmY(0.0f),
+									startX(0),
+									startY(0),
+									state(HandState::NotFound),
+									confidence(0.0f),
+									templateState(HandState::NotFound),
+									centerX(0.0f),
+									centerY(0.0f)
+								{
+									const MaskArea noArea = { 0, 0, 0, 0 };
+									area = noArea;
+									maskArea = noArea;
+								}
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "HandFrame.h"
+
+/*
+ *	\brief The hand as the tracker last saw it, as handed to the render thread.
+ *	A sample is filled in once per depth frame and never changed after it is published,
+ *	the render thread only ever reads whole samples, see CTripleBuffer.
+*/
+struct HandSample
+{
+	unsigned long long			timestamp;						//!< When the sensor captured the frame the sample came from, in microseconds
+	unsigned long long			acquiredAt;						//!< When the frame was taken from the sensor, in microseconds of the steady clock, the clock the render thread predicts with
+	unsigned long long			sequence;						//!< The number of depth frames pushed into the pipeline before that frame
+	HandState::Enum				state;							//!< The steadied open or closed state, not found if there is no hand
+	float						confidence;						//!< How sure the classifier was of the state that frame, between 0 and 1, 0 if there is no hand
+	float						palmX;							//!< The column of the middle of the hand area, in depth pixels
+	float						palmY;							//!< The row of the middle of the hand area, in depth pixels
+	float						centerX;						//!< The column of the palm when the hand was last found or closed, in depth pixels
+	float						centerY;						//!< The row of the palm when the hand was last found or closed, in depth pixels
+
+								//! Class constructor, a sample with no hand
+								HandSample() :
+									timestamp(0),
+									acquiredAt(0),
+									sequence(0),
+									state(HandState::NotFound),
+									confidence(0.0f),
+									palmX(0.0f),
+									palmY(0.0f),
+									centerX(0.0f),
+									centerY(0.0f)
+								{
+								}
+
+								//! Make a sample from a classified hand
+								HandSample(
+									const HandFrame &hand,				//!< The classified hand
+									unsigned long long frameTimestamp,	//!< When the sensor captured the frame, in microseconds
+									unsigned long long frameAcquiredAt,	//!< When the frame was taken from the sensor, in microseconds of the steady clock
+									unsigned long long frameSequence	//!< The number of frames pushed before the frame
+								) :
+									timestamp(frameTimestamp),
+									acquiredAt(frameAcquiredAt),
+									sequence(frameSequence),
+									state(hand.state),
+									confidence(hand.confidence),
+									palmX(hand.palmX),
+									palmY(hand.palmY),
+									centerX(hand.centerX),
+									centerY(hand.centerY)
+								{
+								}
+};
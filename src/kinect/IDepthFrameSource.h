@@ -0,0 +1,30 @@
+#pragma once
+
+class CDepthBuffer;
+
+/*
+ *	\brief A frame of packed Kinect depth pixels, depth in millimetres in the top 13 bits
+ *	and the player index in the bottom 3
+*/
+struct DepthFrame
+{
+	unsigned int			width;								//!< The number of pixels in a row
+	unsigned int			height;								//!< The number of rows in the frame
+	unsigned long long		timestamp;							//!< When the frame was captured, in microseconds
+	const unsigned short	*pixels;							//!< The pixels, row by row
+	CDepthBuffer			*buffer;							//!< The pooled buffer holding the pixels, which a consumer may take a reference to rather than copy them, null if they aren't pooled
+};
+
+/*
+ *	\brief Somewhere depth frames come from, such as the sensor or a recording
+*/
+class IDepthFrameSource {
+public:
+							//! Class destructor
+	virtual					~IDepthFrameSource() {};
+
+							//! Wait for the next frame, its pixels stay valid until the next call. False once there are no more frames
+	virtual bool			GetNextFrame(
+								DepthFrame &frame				//!< Receives the frame
+							) = 0;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+/*
+ *	\brief Smooths a stream of timestamped 2D positions and extrapolates it.
+ *	Positions come in at the sensor's rate, the renderer asks for the position at the time
+ *	of each frame it draws, which is usually after the last position, so a filter keeps an
+ *	estimate of the velocity as well and projects it forward to the time asked for.
+*/
+class IPositionFilter {
+public:
+							//! Class destructor
+	virtual					~IPositionFilter() {};
+
+							//! Forget every position, such as when the hand is lost
+	virtual void			Reset() = 0;
+
+							//! Add a measured position, times must not go backwards
+	virtual void			Add(
+								unsigned long long time,		//!< When the position was measured, in microseconds
+								float x,						//!< The measured column
+								float y							//!< The measured row
+							) = 0;
+
+							//! Get the estimated position at a time, false if no position has been added
+	virtual bool			Predict(
+								unsigned long long time,		//!< The time to estimate the position at, in microseconds
+								float &x,						//!< Receives the estimated column
+								float &y						//!< Receives the estimated row
+							) const = 0;
+};
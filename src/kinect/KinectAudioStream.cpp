@@ -19,17 +19,12 @@
 /// </summary>
 KinectAudioStream::KinectAudioStream(IMediaObject *pKinectDmo) :
       m_cRef(1),
-      m_CurrentWriteBuffer(NULL),
-      m_CurrentReadBuffer(NULL),
-      m_CurrentReadBufferIndex(0),
-      m_BytesRead(0),
       m_hStopEvent(NULL),
-      m_hDataReady(NULL),
-      m_hCaptureThread(NULL)
+      m_hCaptureThread(NULL),
+      m_BytesRead(0)
 {
     pKinectDmo->AddRef();
     m_pKinectDmo = pKinectDmo;
-    InitializeCriticalSection(&m_Lock);
 }
 
 /// <summary>
@@ -38,7 +33,6 @@ KinectAudioStream::KinectAudioStream(IMediaObject *pKinectDmo) :
 KinectAudioStream::~KinectAudioStream()
 {
     SafeRelease(m_pKinectDmo);
-    DeleteCriticalSection(&m_Lock);
 }
 
 /// <summary>
@@ -50,16 +44,9 @@ HRESULT KinectAudioStream::StartCapture()
     HRESULT hr = S_OK;
 
     m_hStopEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
-    m_hDataReady = CreateEvent( NULL, FALSE, FALSE, NULL );
     m_BytesRead = 0;
 
-    for (UINT i = 0; i < NumBuffers; i++)
-    {
-        CStaticMediaBuffer *pBuf = new CStaticMediaBuffer();
-        m_BufferPool.push(pBuf);
-    }
-
-    m_CurrentWriteBuffer = NULL;
+    m_AudioRing.Create(RingBytes, AudioBlockAlign);
 
     m_hCaptureThread = CreateThread(NULL, 0, CaptureThread, this, 0, NULL);
 
@@ -89,21 +76,8 @@ HRESULT KinectAudioStream::StopCapture()
         m_hStopEvent = NULL;
     }
 
-    if (NULL != m_hDataReady)
-    {
-        SetEvent(m_hDataReady);
-        CloseHandle(m_hDataReady);
-        m_hDataReady = NULL;
-    }
-
-    // Release all buffers to buffer pool and then free all buffers in pool
-    ReleaseAllBuffers();
-    while (!m_BufferPool.empty())
-    {
-        CStaticMediaBuffer* mediaBuffer = m_BufferPool.top();
-        delete mediaBuffer;
-        m_BufferPool.pop();
-    }
+    // Wake a client still waiting to read
+    m_AudioRing.Close();
 
     return hr;
 }
@@ -119,14 +93,18 @@ STDMETHODIMP KinectAudioStream::Read(void *pBuffer, ULONG cbBuffer, ULONG *pcbRe
        return E_INVALIDARG;
    }
 
+    BYTE *pbBuffer = (BYTE*)pBuffer;
     ULONG bytesPendingToRead = cbBuffer;
     while (bytesPendingToRead > 0 && IsCapturing())
     {
-        ReadOneBuffer((BYTE**)&pBuffer, &bytesPendingToRead);
+        ULONG cbCopied = m_AudioRing.Read(pbBuffer, bytesPendingToRead);
+        pbBuffer += cbCopied;
+        bytesPendingToRead -= cbCopied;
 
-        if (NULL == m_CurrentReadBuffer) //no data, wait ...
+        //no data, wait until there is, or capture stops
+        if (bytesPendingToRead > 0 && !m_AudioRing.Wait(CAudioRing::Forever))
         {
-            WaitForSingleObject(m_hDataReady, INFINITE);
+            break;
         }
     }
     ULONG bytesRead = cbBuffer - bytesPendingToRead;
@@ -194,187 +172,6 @@ STDMETHODIMP KinectAudioStream::Clone(IStream **)
 /////////////////////////////////////////////
 // Private KinectAudioStream methods
 
-/// <summary>
-/// Get the next buffer available for writing audio data.
-/// First attempts to find a free buffer in buffer pool and, if none is available, grabs the
-/// oldest (most stale) buffer from circular queue of buffers ready for reading and re-uses it.
-/// </summary>
-/// <returns>Media buffer ready for audio capture, or NULL if none was found.</returns>
-CStaticMediaBuffer *KinectAudioStream::GetWriteBuffer()
-{
-    CStaticMediaBuffer *pBuf = NULL;
-
-    EnterCriticalSection(&m_Lock);
-
-    //Get a free buffer if available. Otherwise, get the oldest buffer
-    //from the read queue. This is a way of overwriting the oldest data
-    if (!m_BufferPool.empty())
-    {   
-        pBuf = m_BufferPool.top();
-        m_BufferPool.pop();
-        pBuf->SetLength(0);
-    }                           
-    else if (!m_ReadBufferQueue.empty())
-    {
-        pBuf = m_ReadBufferQueue.front();
-        m_ReadBufferQueue.pop();
-        pBuf->SetLength(0);
-    }
-
-    LeaveCriticalSection(&m_Lock);
-
-    return pBuf;
-}
-
-
-/// <summary>
-/// Release an audio buffer back into buffer pool.
-/// </summary>
-/// <param name="pBuffer">Buffer to be released.</param>
-void KinectAudioStream::ReleaseBuffer(CStaticMediaBuffer* pBuffer)
-{
-    if (pBuffer != NULL)
-    {
-        EnterCriticalSection(&m_Lock);
-        pBuffer->SetLength(0);
-        m_BufferPool.push(pBuffer);
-        LeaveCriticalSection(&m_Lock);
-    }
-}
-
-/// <summary>
-/// Release all audio buffers back into buffer pool.
-/// </summary>
-void KinectAudioStream::ReleaseAllBuffers()
-{
-    EnterCriticalSection(&m_Lock);
-    while (!m_ReadBufferQueue.empty())
-    {
-        CStaticMediaBuffer *pBuf = m_ReadBufferQueue.front();
-        m_ReadBufferQueue.pop();
-        ReleaseBuffer(pBuf);
-    }
-    if (m_CurrentReadBuffer != NULL)
-    {
-        ReleaseBuffer(m_CurrentReadBuffer);
-    }
-
-    m_CurrentReadBufferIndex = 0;
-    m_CurrentReadBuffer = NULL;
-    LeaveCriticalSection(&m_Lock);
-}
-
-/// <summary>
-/// Add captured audio data to the circular queue of buffers ready for client reading.
-/// </summary>
-/// <param name="pData">Pointer to audio data to be added to queue.</param>
-/// <param name="cbData">Number of bytes to be added to queue.</param>
-void KinectAudioStream::QueueCapturedData(BYTE *pData, UINT cbData)
-{
-    BYTE *pWriteData = NULL;
-    DWORD cbWriteData = 0;
-    DWORD cbMaxLength = 0;
-
-    if (cbData <= 0)
-    {
-        return;
-    }
-
-    if (NULL == m_CurrentWriteBuffer)
-    {
-        m_CurrentWriteBuffer = GetWriteBuffer();
-    }
-
-    m_CurrentWriteBuffer->GetBufferAndLength(&pWriteData, &cbWriteData);
-    m_CurrentWriteBuffer->GetMaxLength(&cbMaxLength);
-
-    if (cbWriteData + cbData < cbMaxLength)
-    {
-        memcpy(pWriteData + cbWriteData, pData, cbData);
-        m_CurrentWriteBuffer->SetLength(cbWriteData + cbData);
-    }
-    else
-    {
-        QueueCapturedBuffer(m_CurrentWriteBuffer);
-
-        m_CurrentWriteBuffer = GetWriteBuffer();
-        m_CurrentWriteBuffer->GetBufferAndLength(&pWriteData, &cbWriteData);
-
-        memcpy(pWriteData, pData, cbData);
-        m_CurrentWriteBuffer->SetLength(cbData);
-    }
-}
-
-/// <summary>
-/// Add buffer full of captured audio data to the circular queue of buffers ready for client reading.
-/// </summary>
-/// <param name="pBuffer">Buffer holding captured audio data.</param>
-void KinectAudioStream::QueueCapturedBuffer(CStaticMediaBuffer *pBuffer)
-{
-    EnterCriticalSection(&m_Lock);
-    m_ReadBufferQueue.push(pBuffer);
-    SetEvent(m_hDataReady);
-
-    LeaveCriticalSection(&m_Lock);
-}
-
-/// <summary>
-/// Perform one read operation from current read buffer until either we completely fill the specified
-/// client buffer or we read until the end of (exhaust) the current read buffer.
-/// If we exhaust the current read buffer, we get the oldest available buffer from circular queue and
-/// make that into our current read buffer.
-/// </summary>
-/// <param name="ppbData">
-/// In/Out pointer to client's audio data buffer to be filled.
-/// </param>
-/// <param name="pcbData">
-/// In/Out pointer to number of bytes remaining to be filled in client's audio data buffer.
-/// </param>
-void KinectAudioStream::ReadOneBuffer(BYTE **ppbData, ULONG* pcbData)
-{
-    EnterCriticalSection(&m_Lock);
-
-    //Do we already have a buffer we are reading from? Otherwise grab one from the queue
-    if (m_CurrentReadBuffer == NULL) 
-    {
-        if(!m_ReadBufferQueue.empty())
-        {
-            m_CurrentReadBuffer = m_ReadBufferQueue.front();
-            m_ReadBufferQueue.pop();
-        }
-    }
-
-    if (m_CurrentReadBuffer != NULL) 
-    {
-        //Copy as much data as we can or need
-        BYTE *pData = NULL;
-        DWORD dwDataLength = 0;
-        m_CurrentReadBuffer->GetBufferAndLength(&pData, &dwDataLength);
-
-        ULONG cbToCopy = min(dwDataLength - m_CurrentReadBufferIndex, *pcbData);
-        memcpy(*ppbData, pData + m_CurrentReadBufferIndex, cbToCopy);
-        *ppbData = (*ppbData)+cbToCopy;
-        *pcbData = (*pcbData)-cbToCopy;
-        m_CurrentReadBufferIndex += cbToCopy;
-
-        //If we are done with this buffer put it back in the queue
-        if (m_CurrentReadBufferIndex >= dwDataLength)
-        {
-            ReleaseBuffer(m_CurrentReadBuffer);
-            m_CurrentReadBuffer = NULL;
-            m_CurrentReadBufferIndex = 0;
-
-            if(!m_ReadBufferQueue.empty())
-            {
-                m_CurrentReadBuffer = m_ReadBufferQueue.front();
-                m_ReadBufferQueue.pop();
-            }
-        }
-    }
-
-    LeaveCriticalSection(&m_Lock);
-}
-
 /// <summary>
 /// Starting address for audio capture thread.
 /// </summary>
@@ -436,17 +233,17 @@ DWORD WINAPI KinectAudioStream::CaptureThread()
                 outputBuffer.GetBufferAndLength(&pbOutputBuffer, &cbProduced);
             }
 
-            // Queue audio data to be read by IStream client
+            // Make audio data available to be read by IStream client
             if (cbProduced > 0)
             {
-                QueueCapturedData(pbOutputBuffer, cbProduced);
+                m_AudioRing.Write(pbOutputBuffer, cbProduced);
             }
         } while (OutputBufferStruct.dwStatus & DMO_OUTPUT_DATA_BUFFERF_INCOMPLETE);
 
         Sleep(10); //sleep 10ms
     }
 
-    SetEvent(m_hDataReady);
+    m_AudioRing.Close();
     AvRevertMmThreadCharacteristics(mmHandle);
 
     if (FAILED(hr))
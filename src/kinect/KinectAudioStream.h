@@ -19,8 +19,7 @@
 // For MMCSS functionality such as AvSetMmThreadCharacteristics
 #include <avrt.h>
 
-#include <stack>
-#include <queue>
+#include "CAudioRing.h"
 
 // Format of Kinect audio stream
 static const WORD       AudioFormat = WAVE_FORMAT_PCM;
@@ -108,7 +107,8 @@ protected:
 
 /// <summary>
 /// Asynchronous IStream implementation that captures audio data from Kinect audio sensor in a background thread
-/// and lets clients read captured audio from any thread.
+/// and lets clients read captured audio from any thread. Captured audio goes through a lock-free ring, so it can
+/// be read as soon as it is captured and the capture thread never waits on the reader.
 /// </summary>
 class KinectAudioStream : public IStream
 {
@@ -138,6 +138,15 @@ public:
     /// <returns>S_OK on success, otherwise failure code.</returns>
     HRESULT StopCapture();
 
+    /// <summary>
+    /// Gets the ring captured audio is read from, which counts the audio captured, read and dropped.
+    /// </summary>
+    /// <returns>The ring of captured audio.</returns>
+    const CAudioRing& GetAudioRing() const
+    {
+        return m_AudioRing;
+    }
+
     /////////////////////////////////////////////
     // IUnknown methods
     STDMETHODIMP_(ULONG) AddRef() { return InterlockedIncrement(&m_cRef); }
@@ -185,11 +194,10 @@ public:
     STDMETHODIMP Clone(IStream **);
 
 private:
-    // Number of audio buffers (chunks of overall ring buffer) used to capture Kinect audio data
-    static const UINT NumBuffers = 32;
-    typedef std::stack<CStaticMediaBuffer*> BufferPool;
-    typedef std::queue<CStaticMediaBuffer*> CircularBufferQueue;
-    
+    // Bytes of captured audio held for reading, 2^20 is about 32 seconds at AudioAverageBytesPerSecond,
+    // the reach of the 32 one second buffers the ring replaced
+    static const UINT RingBytes = 1 << 20;
+
     // Number of references to this object
     UINT                    m_cRef;
 
@@ -199,79 +207,15 @@ private:
     // Event used to signal that capture thread should stop capturing audio
     HANDLE                  m_hStopEvent;
 
-    // Event used to signal that there's captured audio data ready to be read
-    HANDLE                  m_hDataReady;
-
     // Audio capture thread
     HANDLE                  m_hCaptureThread;
 
-    // Pool of unused buffers ready to be used for writing captured audio data
-    BufferPool              m_BufferPool;
-
-    // Circular buffer queue that contains audio data ready for reading by stream clients
-    CircularBufferQueue     m_ReadBufferQueue;
-
-    // Buffer where most recently captured audio data is being written
-    CStaticMediaBuffer*     m_CurrentWriteBuffer;
-
-    // Buffer from which stream client is currently reading audio data
-    CStaticMediaBuffer*     m_CurrentReadBuffer;
-
-    // Next index to be read within current read buffer
-    ULONG                   m_CurrentReadBufferIndex;
+    // Ring of captured audio data ready for reading by stream clients, the oldest data is overwritten when it is full
+    CAudioRing              m_AudioRing;
 
     // Total number of bytes read so far by audio stream client
     ULONG                   m_BytesRead;
 
-    // Critical section used to synchronize multithreaded access to captured audio data
-    CRITICAL_SECTION        m_Lock;
-
-    /// <summary>
-    /// Get the next buffer available for writing audio data.
-    /// First attempts to find a free buffer in buffer pool and, if none is available, grabs the
-    /// oldest (most stale) buffer from circular queue of buffers ready for reading and re-uses it.
-    /// </summary>
-    /// <returns>Media buffer ready for audio capture, or NULL if none was found.</returns>
-    CStaticMediaBuffer*     GetWriteBuffer();
-
-    /// <summary>
-    /// Release an audio buffer back into buffer pool.
-    /// </summary>
-    /// <param name="pBuffer">Buffer to be released.</param>
-    void                    ReleaseBuffer(CStaticMediaBuffer* pBuffer);
-
-    /// <summary>
-    /// Release all audio buffers back into buffer pool.
-    /// </summary>
-    void                    ReleaseAllBuffers();
-
-    /// <summary>
-    /// Add captured audio data to the circular queue of buffers ready for client reading.
-    /// </summary>
-    /// <param name="pData">Pointer to audio data to be added to queue.</param>
-    /// <param name="cbData">Number of bytes to be added to queue.</param>
-    void                    QueueCapturedData(BYTE *pData, UINT cbData);
-
-    /// <summary>
-    /// Add buffer full of captured audio data to the circular queue of buffers ready for client reading.
-    /// </summary>
-    /// <param name="pBuffer">Buffer holding captured audio data.</param>
-    void                    QueueCapturedBuffer(CStaticMediaBuffer *pBuffer);
-
-    /// <summary>
-    /// Perform one read operation from current read buffer until either we completely fill the specified
-    /// client buffer or we read until the end of (exhaust) the current read buffer.
-    /// If we exhaust the current read buffer, we get the oldest available buffer from circular queue and
-    /// make that into our current read buffer.
-    /// </summary>
-    /// <param name="ppbData">
-    /// In/Out pointer to client's audio data buffer to be filled.
-    /// </param>
-    /// <param name="pcbData">
-    /// In/Out pointer to number of bytes remaining to be filled in client's audio data buffer.
-    /// </param>
-    void                    ReadOneBuffer(BYTE **ppbData, ULONG* pcbData);
-
     /// <summary>
     /// Starting address for audio capture thread.
     /// </summary>
@@ -0,0 +1,236 @@
+#include "Screenshot.h"
+#include <fstream>
+#include <string.h>
+
+/*
+ *	\brief Append a little endian 16 bit value to a byte buffer
+*/
+static void PutLittle16(
+		std::vector<unsigned char> &bytes,			//!< The buffer to append to
+		unsigned int value							//!< The value to append
+	)
+{
+	bytes.push_back(static_cast<unsigned char>(value));
+	bytes.push_back(static_cast<unsigned char>(value >> 8));
+}
+
+/*
+ *	\brief Append a little endian 32 bit value to a byte buffer
+*/
+static void PutLittle32(
+		std::vector<unsigned char> &bytes,			//!< The buffer to append to
+		unsigned int value							//!< The value to append
+	)
+{
+	PutLittle16(bytes, value);
+	PutLittle16(bytes, value >> 16);
+}
+
+/*
+ *	\brief Append a big endian 32 bit value to a byte buffer
+*/
+static void PutBig32(
+		std::vector<unsigned char> &bytes,			//!< The buffer to append to
+		unsigned int value							//!< The value to append
+	)
+{
+	bytes.push_back(static_cast<unsigned char>(value >> 24));
+	bytes.push_back(static_cast<unsigned char>(value >> 16));
+	bytes.push_back(static_cast<unsigned char>(value >> 8));
+	bytes.push_back(static_cast<unsigned char>(value));
+}
+
+/*
+ *	\brief Encode a 32 bit top down bitmap, the same file SaveBitmapToFile used to write
+*/
+static void EncodeBitmap(
+		const unsigned char *pixels,				//!< The blue, green, red, unused pixels, rows packed together
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows in the frame
+		std::vector<unsigned char> &encoded			//!< Receives the bytes of the file
+	)
+{
+	static const unsigned int FileHeaderSize = 14;
+	static const unsigned int InfoHeaderSize = 40;
+
+	const unsigned int imageSize = width * height * 4;
+
+	// BITMAPFILEHEADER
+	encoded.push_back('B');
+	encoded.push_back('M');
+	PutLittle32(encoded, FileHeaderSize + InfoHeaderSize + imageSize);
+	PutLittle32(encoded, 0);
+	PutLittle32(encoded, FileHeaderSize + InfoHeaderSize);
+
+	// BITMAPINFOHEADER, a negative height stores the rows top down
+	PutLittle32(encoded, InfoHeaderSize);
+	PutLittle32(encoded, width);
+	PutLittle32(encoded, 0 - height);
+	PutLittle16(encoded, 1);
+	PutLittle16(encoded, 32);
+	PutLittle32(encoded, 0);
+	PutLittle32(encoded, imageSize);
+	PutLittle32(encoded, 0);
+	PutLittle32(encoded, 0);
+	PutLittle32(encoded, 0);
+	PutLittle32(encoded, 0);
+
+	const size_t start = encoded.size();
+	encoded.resize(start + imageSize);
+	memcpy(&encoded[start], pixels, imageSize);
+}
+
+/*
+ *	\brief Encode a 24 bit QOI image
+*/
+static void EncodeQoi(
+		const unsigned char *pixels,				//!< The blue, green, red, unused pixels, rows packed together
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows in the frame
+		std::vector<unsigned char> &encoded			//!< Receives the bytes of the file
+	)
+{
+	static const unsigned char OpIndex = 0x00;
+	static const unsigned char OpDiff = 0x40;
+	static const unsigned char OpLuma = 0x80;
+	static const unsigned char OpRun = 0xc0;
+	static const unsigned char OpRgb = 0xfe;
+
+	encoded.push_back('q');
+	encoded.push_back('o');
+	encoded.push_back('i');
+	encoded.push_back('f');
+	PutBig32(encoded, width);
+	PutBig32(encoded, height);
+	encoded.push_back(3);		// red, green and blue channels
+	encoded.push_back(0);		// srgb with linear alpha
+
+	// the unused byte is never stored, every pixel is opaque
+	unsigned int seen[64] = { 0 };
+	unsigned int previous = 0xff000000;
+	unsigned int run = 0;
+
+	const unsigned int count = width * height;
+	for (unsigned int pixel = 0; pixel < count; ++pixel)
+	{
+		const unsigned char *const bgr = pixels + (pixel * 4);
+		const unsigned int red = bgr[2];
+		const unsigned int green = bgr[1];
+		const unsigned int blue = bgr[0];
+		const unsigned int color = 0xff000000 | (blue << 16) | (green << 8) | red;
+
+		if (color == previous)
+		{
+			run++;
+			if (run == 62 || pixel + 1 == count)
+			{
+				encoded.push_back(static_cast<unsigned char>(OpRun | (run - 1)));
+				run = 0;
+			}
+			continue;
+		}
+
+		if (run > 0)
+		{
+			encoded.push_back(static_cast<unsigned char>(OpRun | (run - 1)));
+			run = 0;
+		}
+
+		const unsigned int index = ((red * 3) + (green * 5) + (blue * 7) + (255 * 11)) % 64;
+		if (seen[index] == color)
+		{
+			encoded.push_back(static_cast<unsigned char>(OpIndex | index));
+		}
+		else
+		{
+			seen[index] = color;
+
+			const int redDifference = static_cast<signed char>(red - (previous & 0xff));
+			const int greenDifference = static_cast<signed char>(green - ((previous >> 8) & 0xff));
+			const int blueDifference = static_cast<signed char>(blue - ((previous >> 16) & 0xff));
+			const int redGreen = redDifference - greenDifference;
+			const int blueGreen = blueDifference - greenDifference;
+
+			if (redDifference >= -2 && redDifference <= 1 && greenDifference >= -2 && greenDifference <= 1 && blueDifference >= -2 && blueDifference <= 1)
+			{
+				encoded.push_back(static_cast<unsigned char>(OpDiff | ((redDifference + 2) << 4) | ((greenDifference + 2) << 2) | (blueDifference + 2)));
+			}
+			else if (greenDifference >= -32 && greenDifference <= 31 && redGreen >= -8 && redGreen <= 7 && blueGreen >= -8 && blueGreen <= 7)
+			{
+				encoded.push_back(static_cast<unsigned char>(OpLuma | (greenDifference + 32)));
+				encoded.push_back(static_cast<unsigned char>(((redGreen + 8) << 4) | (blueGreen + 8)));
+			}
+			else
+			{
+				encoded.push_back(OpRgb);
+				encoded.push_back(static_cast<unsigned char>(red));
+				encoded.push_back(static_cast<unsigned char>(green));
+				encoded.push_back(static_cast<unsigned char>(blue));
+			}
+		}
+
+		previous = color;
+	}
+
+	// the end marker
+	for (unsigned int padding = 0; padding < 7; ++padding)
+	{
+		encoded.push_back(0);
+	}
+	encoded.push_back(1);
+}
+
+/*
+ *	\brief Get the file extension for a screenshot format, including the dot
+*/
+const char *GetScreenshotExtension(
+		ScreenshotFormat::Enum format				//!< The format of the file
+	)
+{
+	return format == ScreenshotFormat::Qoi ? ".qoi" : ".bmp";
+}
+
+/*
+ *	\brief Encode the pixels of a color frame into the bytes of an image file
+*/
+void EncodeScreenshot(
+		const unsigned char *pixels,				//!< The blue, green, red, unused pixels, rows packed together
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows in the frame
+		ScreenshotFormat::Enum format,				//!< The format of the file
+		std::vector<unsigned char> &encoded			//!< Receives the bytes of the file
+	)
+{
+	encoded.clear();
+
+	if (format == ScreenshotFormat::Qoi)
+	{
+		EncodeQoi(pixels, width, height, encoded);
+	}
+	else
+	{
+		EncodeBitmap(pixels, width, height, encoded);
+	}
+}
+
+/*
+ *	\brief Encode and save a color frame, false if the file couldn't be written
+*/
+bool SaveScreenshot(
+		const std::string &fileName,				//!< The location to save the image to
+		const unsigned char *pixels,				//!< The blue, green, red, unused pixels, rows packed together
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows in the frame
+		ScreenshotFormat::Enum format				//!< The format of the file
+	)
+{
+	std::vector<unsigned char> encoded;
+	EncodeScreenshot(pixels, width, height, format, encoded);
+
+	std::ofstream file(fileName.c_str(), std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+
+	file.write(reinterpret_cast<const char *>(&encoded[0]), encoded.size());
+	return file.good();
+}
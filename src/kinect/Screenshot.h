@@ -0,0 +1,45 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include <string>
+#include <vector>
+
+/*
+ *	Screenshots are taken from the 32 bit color stream, whose pixels are laid out
+ *	blue, green, red, unused. They are saved as a 32 bit top down bitmap, as they
+ *	always have been, or as a QOI image (https://qoiformat.org) which is a third
+ *	of the size and needs no compression library to write.
+*/
+
+struct ScreenshotFormat {
+	enum Enum {
+		Bitmap,							//!< An uncompressed 32 bit windows bitmap
+		Qoi,							//!< A losslessly compressed 24 bit QOI image
+		Noof
+	};
+};
+
+							//! Get the file extension for a screenshot format, including the dot
+const char					*GetScreenshotExtension(
+								ScreenshotFormat::Enum format	//!< The format of the file
+							);
+
+							//! Encode the pixels of a color frame into the bytes of an image file
+void						EncodeScreenshot(
+								const unsigned char *pixels,	//!< The blue, green, red, unused pixels, rows packed together
+								unsigned int width,				//!< The number of pixels in a row
+								unsigned int height,			//!< The number of rows in the frame
+								ScreenshotFormat::Enum format,	//!< The format of the file
+								std::vector<unsigned char> &encoded	//!< Receives the bytes of the file
+							);
+
+							//! Encode and save a color frame, false if the file couldn't be written
+bool						SaveScreenshot(
+								const std::string &fileName,	//!< The location to save the image to
+								const unsigned char *pixels,	//!< The blue, green, red, unused pixels, rows packed together
+								unsigned int width,				//!< The number of pixels in a row
+								unsigned int height,			//!< The number of rows in the frame
+								ScreenshotFormat::Enum format	//!< The format of the file
+							);
@@ -0,0 +1,145 @@
+#include "SobelEdges.h"
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+	#define SOBEL_EDGES_SSE2
+	#include <emmintrin.h>
+#endif
+
+/*
+ *	\brief Get the Sobel gradient magnitude of a pixel, which must not be on the image border
+*/
+static unsigned int GetSobelMagnitude(
+		const unsigned char *pixel,					//!< The pixel in the image
+		unsigned int width							//!< The number of pixels in a row
+	)
+{
+	const unsigned char *above = pixel - width;
+	const unsigned char *below = pixel + width;
+
+	const int gx = (above[1] - above[-1]) + ((pixel[1] - pixel[-1]) * 2) + (below[1] - below[-1]);
+	const int gy = (below[-1] + (below[0] * 2) + below[1]) - (above[-1] + (above[0] * 2) + above[1]);
+
+	return (gx < 0 ? -gx : gx) + (gy < 0 ? -gy : gy);
+}
+
+#ifdef SOBEL_EDGES_SSE2
+/*
+ *	\brief Load 8 pixels widened to 16 bits
+*/
+static __m128i LoadWidened(
+		const unsigned char *pixels					//!< The first of the pixels
+	)
+{
+	return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(pixels)), _mm_setzero_si128());
+}
+
+/*
+ *	\brief Get the absolute values of 8 signed 16 bit values
+*/
+static __m128i Absolute(
+		__m128i values								//!< The values
+	)
+{
+	return _mm_max_epi16(values, _mm_sub_epi16(_mm_setzero_si128(), values));
+}
+#endif
+
+/*
+ *	\brief Get the gradient magnitude and edges of an area of an image
+*/
+void DetectSobelEdges(
+		const unsigned char *image,					//!< The pixels of the whole image
+		unsigned int width,							//!< The number of pixels in a row
+		unsigned int height,						//!< The number of rows in the image
+		const MaskArea &area,						//!< The area to detect edges in, pixels on the image border get no gradient
+		unsigned int threshold,						//!< The smallest magnitude which is an edge
+		unsigned short *magnitude,					//!< The magnitudes of the whole image, only the area is written
+		unsigned char *edges						//!< The edge mask of the whole image, only the area is written
+	)
+{
+	const unsigned int right = area.right < width ? area.right : width;
+	const unsigned int bottom = area.bottom < height ? area.bottom : height;
+	if (area.left >= right || area.top >= bottom)
+		return;
+
+	// the kernel needs a pixel either side, so the border of the image has no gradient
+	const unsigned int innerLeft = area.left > 0 ? area.left : 1;
+	const unsigned int innerRight = right < width ? right : width - 1;
+
+#ifdef SOBEL_EDGES_SSE2
+	// magnitudes are at most 2040, so 16 bit lanes never overflow
+	const __m128i edgeLimit = _mm_set1_epi16(static_cast<short>((threshold > 2041 ? 2041 : static_cast<int>(threshold)) - 1));
+	const __m128i one = _mm_set1_epi8(1);
+#endif
+
+	for (unsigned int row = area.top; row < bottom; ++row)
+	{
+		const unsigned int rowStart = row * width;
+		unsigned short *rowMagnitude = magnitude + rowStart;
+		unsigned char *rowEdges = edges + rowStart;
+
+		if (row == 0 || row + 1 >= height || innerLeft >= innerRight)
+		{
+			memset(rowMagnitude + area.left, 0, (right - area.left) * sizeof(unsigned short));
+			memset(rowEdges + area.left, 0, right - area.left);
+			continue;
+		}
+
+		if (area.left < innerLeft)
+		{
+			rowMagnitude[0] = 0;
+			rowEdges[0] = 0;
+		}
+
+		if (innerRight < right)
+		{
+			rowMagnitude[width - 1] = 0;
+			rowEdges[width - 1] = 0;
+		}
+
+		const unsigned char *pixels = image + rowStart;
+		unsigned int column = innerLeft;
+
+#ifdef SOBEL_EDGES_SSE2
+		const unsigned char *above = pixels - width;
+		const unsigned char *below = pixels + width;
+
+		// the loads reach one pixel past the 8, which innerRight keeps inside the row
+		for (; column + 8 <= innerRight; column += 8)
+		{
+			const __m128i aboveLeft = LoadWidened(above + column - 1);
+			const __m128i aboveRight = LoadWidened(above + column + 1);
+			const __m128i pixelLeft = LoadWidened(pixels + column - 1);
+			const __m128i pixelRight = LoadWidened(pixels + column + 1);
+			const __m128i belowLeft = LoadWidened(below + column - 1);
+			const __m128i belowRight = LoadWidened(below + column + 1);
+
+			const __m128i aboveCenter = LoadWidened(above + column);
+			const __m128i belowCenter = LoadWidened(below + column);
+
+			// gx = the right column minus the left, the middle row counting twice
+			const __m128i middleX = _mm_sub_epi16(pixelRight, pixelLeft);
+			const __m128i gx = _mm_add_epi16(_mm_add_epi16(_mm_sub_epi16(aboveRight, aboveLeft), _mm_sub_epi16(belowRight, belowLeft)), _mm_add_epi16(middleX, middleX));
+
+			// gy = the row below minus the row above, the middle column counting twice
+			const __m128i aboveSum = _mm_add_epi16(_mm_add_epi16(aboveLeft, aboveRight), _mm_add_epi16(aboveCenter, aboveCenter));
+			const __m128i belowSum = _mm_add_epi16(_mm_add_epi16(belowLeft, belowRight), _mm_add_epi16(belowCenter, belowCenter));
+			const __m128i gy = _mm_sub_epi16(belowSum, aboveSum);
+
+			const __m128i sum = _mm_add_epi16(Absolute(gx), Absolute(gy));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(rowMagnitude + column), sum);
+
+			const __m128i isEdge = _mm_cmpgt_epi16(sum, edgeLimit);
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(rowEdges + column), _mm_and_si128(_mm_packs_epi16(isEdge, isEdge), one));
+		}
+#endif
+
+		for (; column < innerRight; ++column)
+		{
+			const unsigned int value = GetSobelMagnitude(pixels + column, width);
+			rowMagnitude[column] = static_cast<unsigned short>(value);
+			rowEdges[column] = value >= threshold ? 1 : 0;
+		}
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "DepthBand.h"
+
+/*
+ *	The Sobel edge detector used to find the outline of the hand.
+ *	Each pixel of an area of an 8 bit image gets the gradient magnitude |gx| + |gy| of the
+ *	3x3 Sobel kernels, and is marked 1 in the edge mask where the magnitude reaches a
+ *	threshold. Only the area is written, so the buffers can be reused between frames.
+ *	Rows are processed 8 pixels at a time with SSE2 where the compiler targets x86.
+*/
+
+							//! Get the gradient magnitude and edges of an area of an image
+void						DetectSobelEdges(
+								const unsigned char *image,		//!< The pixels of the whole image
+								unsigned int width,				//!< The number of pixels in a row
+								unsigned int height,			//!< The number of rows in the image
+								const MaskArea &area,			//!< The area to detect edges in, pixels on the image border get no gradient
+								unsigned int threshold,			//!< The smallest magnitude which is an edge
+								unsigned short *magnitude,		//!< The magnitudes of the whole image, only the area is written
+								unsigned char *edges			//!< The edge mask of the whole image, only the area is written
+							);
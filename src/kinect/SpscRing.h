@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include <atomic>
+
+/*
+ *	\brief A bounded queue between exactly one producer thread and one consumer thread.
+ *	The producer only writes the tail and the consumer only writes the head, so neither
+ *	side takes a lock or waits; a push to a full ring or a pop from an empty one fails
+ *	straight away and the caller decides whether to drop, retry or sleep.
+*/
+template <typename T, unsigned int Capacity>
+class CSpscRing {
+	// the positions wrap at 2^32, which only lands back on the same index when the capacity divides it
+	static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "The capacity of a ring must be a power of two");
+
+private:
+	T								m_items[Capacity];					//!< The queued items, indexed by position modulo the capacity
+	std::atomic<unsigned int>		m_head;								//!< The number of items ever popped, only written by the consumer
+	std::atomic<unsigned int>		m_tail;								//!< The number of items ever pushed, only written by the producer
+
+public:
+									//! Class constructor
+									CSpscRing() :
+										m_head(0),
+										m_tail(0)
+									{
+									}
+
+									//! Add an item at the back, false if the ring is full. Only call from the producer thread
+	bool							TryPush(
+										const T &item					//!< The item to add
+									)
+									{
+										const unsigned int tail = m_tail.load(std::memory_order_relaxed);
+										if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+											return false;
+
+										m_items[tail % Capacity] = item;
+										m_tail.store(tail + 1, std::memory_order_release);
+										return true;
+									}
+
+									//! Take the item at the front, false if the ring is empty. Only call from the consumer thread
+	bool							TryPop(
+										T &item							//!< Receives the item
+									)
+									{
+										const unsigned int head = m_head.load(std::memory_order_relaxed);
+										if (head == m_tail.load(std::memory_order_acquire))
+											return false;
+
+										item = m_items[head % Capacity];
+										m_head.store(head + 1, std::memory_order_release);
+										return true;
+									}
+
+									//! Get the number of items queued, which may already be out of date on the other thread
+	unsigned int					GetSize() const
+									{
+										return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+									}
+
+									//! Is nothing queued, which may already be out of date on the other thread
+	bool							IsEmpty() const
+									{
+										return GetSize() == 0;
+									}
+
+									//! Empty the ring, only while neither thread is using it
+	void							Clear()
+									{
+										m_head = 0;
+										m_tail = 0;
+									}
+};
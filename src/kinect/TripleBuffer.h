@@ -0,0 +1,58 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include <atomic>
+
+/*
+ *	\brief Hands the latest value from one writer thread to one reader thread without either waiting.
+ *	There are three slots: the writer fills its back slot and swaps it with the middle one, the reader
+ *	swaps its front slot with the middle one when the middle holds something newer. Each side only
+ *	touches the slot it holds, so a read can never see half of a write, and values the reader never
+ *	got round to are simply replaced by newer ones.
+*/
+template <typename T>
+class CTripleBuffer {
+private:
+	static const unsigned int		FreshFlag = 4;						//!< Set on the middle index when it holds a value the reader hasn't taken
+
+private:
+	T								m_slots[3];							//!< The three values
+	std::atomic<unsigned int>		m_middle;							//!< The index of the middle slot, with the fresh flag
+	unsigned int					m_back;								//!< The index of the slot the writer fills, only used by the writer
+	unsigned int					m_front;							//!< The index of the slot the reader holds, only used by the reader
+
+public:
+									//! Class constructor, the reader starts with a default constructed value
+									CTripleBuffer() :
+										m_middle(1),
+										m_back(2),
+										m_front(0)
+									{
+									}
+
+									//! Make a value the latest, replacing any the reader hasn't taken. Only call from the writer thread
+	void							Publish(
+										const T &value					//!< The value
+									)
+									{
+										m_slots[m_back] = value;
+										m_back = m_middle.exchange(m_back | FreshFlag, std::memory_order_acq_rel) & ~FreshFlag;
+									}
+
+									//! Take the latest value published, true if it is newer than the last one read. Only call from the reader thread
+	bool							Read(
+										T &value						//!< Receives the latest value, the last one read if nothing newer was published
+									)
+									{
+										const bool fresh = (m_middle.load(std::memory_order_relaxed) & FreshFlag) != 0;
+										if (fresh)
+										{
+											m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & ~FreshFlag;
+										}
+
+										value = m_slots[m_front];
+										return fresh;
+									}
+};
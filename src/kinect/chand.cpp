@@ -1,15 +1,45 @@
 #include "chand.h"
-#include "../cviscraft.h"
-#include "../cgizmo.h"
 
-CHand::CHand() : m_edgeTempBuffer(nullptr)
+// The band of depths, in millimetres, the hand is expected to be held in until the band is calibrated.
+// They match the old 8 bit intensity band of 85 to 102.
+static const int NEAR_POINT = 832;
+static const int FAR_POINT = 1344;
+
+// The depth covered by one step of the old 8 bit intensity, used to scale the debug tint
+static const int MILLIMETRES_PER_INTENSITY = 32;
+static const int TINT_SCALER = 6;
+
+// The number of pixels around the last hand area searched before the whole frame
+static const unsigned int HAND_WINDOW_MARGIN = 48;
+
+// Blobs smaller than this many pixels are noise, and the furthest the palm is followed between frames
+static const unsigned int MINIMUM_BLOB_AREA = 64;
+static const float MAXIMUM_HAND_JUMP = 80.0f;
+
+// The smallest Sobel gradient of the hand mask which is an edge. Either side of a straight edge of the mask
+// gets 4, a single pixel dropped inside the hand only gives its neighbours 2, so dropouts aren't edges.
+static const unsigned int EDGE_THRESHOLD = 3;
+
+// The openness the hand must stay above to open, or below to close, for a number of frames in a row
+static const float OPEN_THRESHOLD = 0.5f;
+static const float CLOSE_THRESHOLD = 0.35f;
+static const unsigned int FRAMES_TO_CHANGE_STATE = 3;
+
+CHand::CHand() : m_handMask(nullptr), m_edgeMagnitude(nullptr), m_edgeDistance(nullptr),
+	m_handStateFilter(OPEN_THRESHOLD, CLOSE_THRESHOLD, FRAMES_TO_CHANGE_STATE)
 {
 	m_frameWidth = 0;
 	m_frameHeight = 0;
+	m_tracking = false;
 	m_handState = HandState::NotFound;
-	m_startClose = 0;
 	m_center = D3DXVECTOR2(m_frameWidth * 0.5f, m_frameHeight * 0.5f);
 	m_configuratState = ConfigurationState::None;
+	m_nearPoint = NEAR_POINT;
+	m_farPoint = FAR_POINT;
+	m_templateState = HandState::NotFound;
+
+	const MaskArea empty = { 0, 0, 0, 0 };
+	m_maskWindow = empty;
 
 	for (unsigned int dtmIndex = 0; dtmIndex < HandState::Noof; ++dtmIndex)
 	{
@@ -19,7 +49,14 @@ CHand::CHand() : m_edgeTempBuffer(nullptr)
 
 CHand::~CHand()
 {
-	SafeArrayDelete(m_edgeTempBuffer);
+	SafeArrayDelete(m_handMask);
+	SafeArrayDelete(m_edgeMagnitude);
+	SafeArrayDelete(m_edgeDistance);
+
+	for (unsigned int dtmIndex = 0; dtmIndex < HandState::Noof; ++dtmIndex)
+	{
+		SafeDelete(m_handStateDTM[dtmIndex]);
+	}
 }
 
 bool CHand::Create( 
@@ -30,13 +67,25 @@ bool CHand::Create(
 	m_frameWidth = frameWidth;
 	m_frameHeight = frameHeight;
 
-	m_edgeTempBuffer = new RGBQUAD[frameWidth * frameHeight];
+	// the edge buffers cover a hand frame's mask area, which is never bigger than the frame
+	m_handMask = new BYTE[frameWidth * frameHeight];
+	m_edgeMagnitude = new unsigned short[frameWidth * frameHeight];
+	m_edgeDistance = new unsigned short[frameWidth * frameHeight];
+	memset(m_handMask, 0, frameWidth * frameHeight);
+
+	const MaskArea empty = { 0, 0, 0, 0 };
+	m_maskWindow = empty;
+	m_searchWindow.Create(frameWidth, frameHeight, HAND_WINDOW_MARGIN);
 
-	m_lastPosition = CVisCraft::GetInstance()->GetWindowDimension();
-	m_lastPosition.x *= 0.5f;
-	m_lastPosition.y *= 0.75f;
+	m_blobLabeller.Create(frameWidth, frameHeight);
+
+	m_handStateDTM[HandState::ClosedFist] = new CGestureHandClosed();
+	m_handStateDTM[HandState::OpenHand] = new CGestureHandOpen();
 
 	m_configuratState = ConfigurationState::None;
+	m_bandCalibrator.Create(NEAR_POINT, FAR_POINT);
+	m_nearPoint = NEAR_POINT;
+	m_farPoint = FAR_POINT;
 
 	m_handSize.x = 90;
 	m_handSize.y = 30;
@@ -44,32 +93,336 @@ bool CHand::Create(
 	return true;
 }
 
-RGBQUAD* CHand::FindFromDepth( 
-		RGBQUAD* depthData
+void CHand::Segment( 
+		const CDepthPyramid &pyramid,
+		HandFrame &hand
+	)
+{
+	const USHORT *depthPixels = pyramid.GetLevel(0);
+
+	if (m_configuratState != ConfigurationState::None)
+	{
+		CalibrateBand(pyramid);
+	}
+
+	// a lost hand is looked for in the coarsest level of the pyramid, if nothing there
+	// is in the band and as wide as a hand the full frame isn't searched at all
+	const MaskBlob *handBlob = nullptr;
+	if (m_searchWindow.IsWindowed() || m_searchWindow.Acquire(pyramid, m_nearPoint, m_farPoint, MINIMUM_BLOB_AREA,
+		static_cast<unsigned int>(m_handSize.y), static_cast<unsigned int>(m_handSize.x)))
+	{
+		// look around the last hand, or the coarse blob, first, the whole frame is only searched when
+		// the hand isn't in the window there or runs into the window's edge, as it may carry on past it
+		handBlob = SearchWindow(depthPixels, m_searchWindow.GetWindow());
+	}
+
+	if (m_searchWindow.IsWindowed())
+	{
+		bool cut = handBlob == nullptr;
+		if (!cut)
+		{
+			// the hand area hangs 1.3 widths below the top of the blob, and the hand frame needs a pixel around it
+			MaskArea handBounds = handBlob->bounds;
+			handBounds.bottom = handBounds.top + static_cast<unsigned int>((handBounds.right - 1 - handBounds.left) * 1.3f) + 1;
+			cut = m_searchWindow.IsCut(handBounds);
+		}
+
+		if (cut)
+		{
+			handBlob = SearchWindow(depthPixels, m_searchWindow.GetFrame());
+		}
+	}
+
+	// from the hand blob, try and find a bounding box for the hand
+	m_tracking = handBlob != nullptr && SampleToHandArea(handBlob->bounds);
+
+	if (m_tracking)
+	{
+		const MaskArea handArea = { m_handArea[HandAreaSamplePoint::Left], m_handArea[HandAreaSamplePoint::Top],
+			m_handArea[HandAreaSamplePoint::Right] + 1, m_handArea[HandAreaSamplePoint::Bottom] };
+		m_searchWindow.Follow(handArea);
+	}
+	else
+	{
+		m_searchWindow.Reset();
+	}
+
+	hand.found = m_tracking;
+	hand.nearPoint = m_nearPoint;
+	hand.farPoint = m_farPoint;
+	if (m_tracking)
+	{
+		CopyHandBlob(*handBlob, hand);
+	}
+}
+
+void CHand::Classify(
+		HandFrame &hand
+	)
+{
+	if (!hand.found)
+	{
+		m_handState = HandState::NotFound;
+		m_templateState = HandState::NotFound;
+		hand.state = HandState::NotFound;
+		hand.confidence = 0.0f;
+		hand.templateState = HandState::NotFound;
+		return;
+	}
+
+	// decide whether the hand is open from the shape of the blob
+	UpdateHandState(hand);
+
+	// From the hand bounding box, perform edge detection
+	DetectHandEdges(hand);
+
+	// and fit the hand state templates to the edges
+	MatchHandTemplates(hand);
+
+	hand.state = m_handState;
+	hand.templateState = m_templateState;
+	hand.centerX = m_center.x;
+	hand.centerY = m_center.y;
+}
+
+void CHand::CopyHandBlob(
+		const MaskBlob &handBlob,
+		HandFrame &hand
+	)
+{
+	// the contour is traced from the blob's first pixel, which is always on its top row
+	const unsigned int blobNumber = static_cast<unsigned int>(&handBlob - &m_blobLabeller.GetBlobs()[0]) + 1;
+	hand.startY = handBlob.bounds.top;
+	hand.startX = handBlob.bounds.left;
+	while (hand.startX < handBlob.bounds.right && m_blobLabeller.GetBlobNumber(hand.startX, hand.startY) != blobNumber)
+	{
+		++hand.startX;
+	}
+
+	// the hand area's right column is inclusive, the hand frame's is not
+	hand.area.left = m_handArea[HandAreaSamplePoint::Left];
+	hand.area.right = m_handArea[HandAreaSamplePoint::Right] + 1;
+	hand.area.top = m_handArea[HandAreaSamplePoint::Top];
+	hand.area.bottom = m_handArea[HandAreaSamplePoint::Bottom];
+	hand.palmX = m_palm.x;
+	hand.palmY = m_palm.y;
+
+	// a pixel around the hand area keeps the gradient at its edges, as the blob carries on past the
+	// bottom of it, and only the hand blob is copied so nothing else in the band is classified with it
+	hand.maskArea.left = hand.area.left > 0 ? hand.area.left - 1 : 0;
+	hand.maskArea.top = hand.area.top > 0 ? hand.area.top - 1 : 0;
+	hand.maskArea.right = hand.area.right < m_frameWidth ? hand.area.right + 1 : m_frameWidth;
+	hand.maskArea.bottom = hand.area.bottom < m_frameHeight ? hand.area.bottom + 1 : m_frameHeight;
+
+	hand.mask.resize((hand.maskArea.right - hand.maskArea.left) * (hand.maskArea.bottom - hand.maskArea.top));
+
+	unsigned char *maskPixel = &hand.mask[0];
+	for (unsigned int y = hand.maskArea.top; y < hand.maskArea.bottom; ++y)
+	{
+		for (unsigned int x = hand.maskArea.left; x < hand.maskArea.right; ++x)
+		{
+			*maskPixel++ = m_blobLabeller.GetBlobNumber(x, y) == blobNumber ? 1 : 0;
+		}
+	}
+}
+
+MaskArea CHand::GetLocalHandArea(
+		const HandFrame &hand
+	)
+{
+	MaskArea area;
+	area.left = hand.area.left - hand.maskArea.left;
+	area.right = hand.area.right - hand.maskArea.left;
+	area.top = hand.area.top - hand.maskArea.top;
+	area.bottom = hand.area.bottom - hand.maskArea.top;
+	return area;
+}
+
+const MaskBlob *CHand::SelectHandBlob() const
+{
+	const std::vector<MaskBlob> &blobs = m_blobLabeller.GetBlobs();
+	const MaskBlob *handBlob = nullptr;
+
+	// keep following the blob whose palm is nearest the last one, unless they all jumped away
+	if (m_tracking)
+	{
+		float nearestDistance = MAXIMUM_HAND_JUMP * MAXIMUM_HAND_JUMP;
+		for (unsigned int blob = 0; blob < blobs.size(); ++blob)
+		{
+			// the palm sits where SampleToHandArea will put it, in the middle of the box below the top
+			const float width = static_cast<float>(blobs[blob].bounds.right - 1 - blobs[blob].bounds.left);
+			const float palmX = blobs[blob].bounds.left + (width * 0.5f) - m_palm.x;
+			const float palmY = blobs[blob].bounds.top + (width * 0.65f) - m_palm.y;
+
+			const float distance = (palmX * palmX) + (palmY * palmY);
+			if (distance < nearestDistance)
+			{
+				nearestDistance = distance;
+				handBlob = &blobs[blob];
+			}
+		}
+
+		if (handBlob != nullptr)
+			return handBlob;
+	}
+
+	// otherwise take the largest blob which is as wide as a hand
+	unsigned int largestArea = 0;
+	for (unsigned int blob = 0; blob < blobs.size(); ++blob)
+	{
+		const float width = static_cast<float>(blobs[blob].bounds.right - 1 - blobs[blob].bounds.left);
+		if (width < m_handSize.y || width > m_handSize.x)
+			continue;
+
+		if (blobs[blob].area > largestArea)
+		{
+			largestArea = blobs[blob].area;
+			handBlob = &blobs[blob];
+		}
+	}
+
+	return handBlob;
+}
+
+void CHand::UpdateHandState(
+		HandFrame &hand
+	)
+{
+	const unsigned int maskWidth = hand.maskArea.right - hand.maskArea.left;
+	const HandShape shape = m_shapeClassifier.Classify(&hand.mask[0], maskWidth, GetLocalHandArea(hand),
+		hand.startX - hand.maskArea.left, hand.startY - hand.maskArea.top);
+
+	const HandState::Enum oldState = m_handState;
+	if (oldState == HandState::NotFound)
+	{
+		// a newly found hand takes the state of its first frame straight away
+		m_handStateFilter.Reset(shape.openness >= OPEN_THRESHOLD);
+	}
+	else
+	{
+		m_handStateFilter.Update(shape.openness);
+	}
+
+	m_handState = m_handStateFilter.IsOpen() ? HandState::OpenHand : HandState::ClosedFist;
+	hand.confidence = m_handState == HandState::OpenHand ? shape.openness : 1.0f - shape.openness;
+
+	if (oldState == HandState::NotFound || (m_handState == HandState::ClosedFist && oldState == HandState::OpenHand))
+	{
+		m_center = D3DXVECTOR2(hand.palmX, hand.palmY);
+	}
+
+	// keep the valleys between the fingers the classifier counted, in frame pixels
+	const std::vector<ContourPoint> &contour = m_shapeClassifier.GetContour();
+	const std::vector<ConvexityDefect> &defects = m_shapeClassifier.GetDefects();
+	const std::vector<unsigned int> &valleys = m_shapeClassifier.GetFingerValleys();
+
+	hand.fingerValleys.clear();
+	for (unsigned int valley = 0; valley < valleys.size(); ++valley)
+	{
+		ContourPoint deepest = contour[defects[valleys[valley]].deepest];
+		deepest.x += hand.maskArea.left;
+		deepest.y += hand.maskArea.top;
+		hand.fingerValleys.push_back(deepest);
+	}
+}
+
+void CHand::StartCalibration()
+{
+	m_bandCalibrator.Reset();
+	m_nearPoint = NEAR_POINT;
+	m_farPoint = FAR_POINT;
+	m_configuratState = ConfigurationState::Started;
+}
+
+void CHand::CalibrateBand(
+		const CDepthPyramid &pyramid
+	)
+{
+	// the coarsest level has a sixteenth of the pixels and keeps the nearest depth of each, so the hand's peak survives
+	const unsigned int level = pyramid.GetLevelCount() - 1;
+	if (!m_bandCalibrator.AddFrame(pyramid.GetLevel(level), pyramid.GetLevelWidth(level) * pyramid.GetLevelHeight(level)))
+		return;
+
+	m_nearPoint = m_bandCalibrator.GetNearPoint();
+	m_farPoint = m_bandCalibrator.GetFarPoint();
+
+	if (m_configuratState == ConfigurationState::Started)
+	{
+		m_configuratState = ConfigurationState::Configured;
+	}
+}
+
+MaskArea CHand::ThresholdBandWindow(
+		const USHORT *depthPixels,
+		const MaskArea &window
+	)
+{
+	// clear the pixels of the last window this window won't overwrite, so the mask is only ever set inside it
+	for (unsigned int row = m_maskWindow.top; row < m_maskWindow.bottom; ++row)
+	{
+		BYTE *rowMask = m_handMask + (row * m_frameWidth);
+		if (row < window.top || row >= window.bottom)
+		{
+			memset(rowMask + m_maskWindow.left, 0, m_maskWindow.right - m_maskWindow.left);
+			continue;
+		}
+
+		if (m_maskWindow.left < window.left)
+		{
+			const unsigned int clearEnd = window.left < m_maskWindow.right ? window.left : m_maskWindow.right;
+			memset(rowMask + m_maskWindow.left, 0, clearEnd - m_maskWindow.left);
+		}
+
+		if (m_maskWindow.right > window.right)
+		{
+			const unsigned int clearStart = window.right > m_maskWindow.left ? window.right : m_maskWindow.left;
+			memset(rowMask + clearStart, 0, m_maskWindow.right - clearStart);
+		}
+	}
+
+	m_maskWindow = window;
+	m_searchWindow.AddSearch(window);
+
+	return ThresholdDepthWindow(depthPixels, m_frameWidth, window, m_nearPoint, m_farPoint, m_handMask);
+}
+
+const MaskBlob *CHand::SearchWindow(
+		const USHORT *depthPixels,
+		const MaskArea &window
 	)
 {
 	// start with a simple depth cull.
-	// we can presume the user will be between two given points
-	// The two given points should be controlled by an options value
+	// we can presume the user will be between two given points, found by the band calibration
+	const MaskArea bandArea = ThresholdBandWindow(depthPixels, window);
+
+	// split the band into blobs, so other things in range don't get counted as the hand
+	m_blobLabeller.Label(m_handMask, bandArea, MINIMUM_BLOB_AREA);
 
-	static const int FAR_POINT = 85;
-	static const int NEAR_POINT = 102;
-	static const float SCALER = NEAR_POINT / (NEAR_POINT - FAR_POINT);
-	static const int MID_POINT = FAR_POINT + static_cast<int>((NEAR_POINT - FAR_POINT) / 2);
+	return SelectHandBlob();
+}
 
+void CHand::DrawHandMask(
+		const USHORT *depthPixels,
+		const HandFrame &hand,
+		RGBQUAD *depthData
+	)
+{
+	// the band is tested again rather than kept, the hand frame only holds the hand blob and the band it was found in
+	const int midPoint = hand.nearPoint + ((hand.farPoint - hand.nearPoint) / 2);
 	const unsigned int frameSize = m_frameWidth * m_frameHeight;
 	for (unsigned int depthIndex = 0; depthIndex < frameSize; ++depthIndex)
 	{
-		const int depth = depthData[depthIndex].rgbRed;
-		if (depth > FAR_POINT && depth < NEAR_POINT)
+		const int depth = NuiDepthPixelToDepth(depthPixels[depthIndex]);
+		if (depth >= hand.nearPoint && depth < hand.farPoint)
 		{
-			const int distanceFromMidPoint = depth - MID_POINT;
+			// nearer than the middle of the band tints green, further tints blue
+			const int distanceFromMidPoint = (midPoint - depth) / MILLIMETRES_PER_INTENSITY;
 
 			const int blueColor = distanceFromMidPoint > 0 ? 0 : -distanceFromMidPoint;
 			const int greenColor = distanceFromMidPoint < 0 ? 0 : distanceFromMidPoint;
 
-			depthData[depthIndex].rgbBlue = static_cast<BYTE>(blueColor * SCALER);
-			depthData[depthIndex].rgbGreen = static_cast<BYTE>(greenColor * SCALER) << 2;
+			depthData[depthIndex].rgbBlue = static_cast<BYTE>(blueColor * TINT_SCALER);
+			depthData[depthIndex].rgbGreen = static_cast<BYTE>(greenColor * TINT_SCALER) << 2;
 			depthData[depthIndex].rgbRed = 255;
 		}
 		else
@@ -78,45 +431,40 @@ RGBQUAD* CHand::FindFromDepth(
 		}
 	}
 
-	// from the clamped data, try and find a bounding box for the hand
-	if (!SampleToHandArea(depthData)) {
-		m_handState = HandState::NotFound;
-		return depthData;
-	}
+	if (hand.state == HandState::NotFound)
+		return;
 
-	// From the hand bounding box, perform edge detection
-	DetectHandEdges(depthData);
+	// the edges were only detected over the hand frame's mask area
+	const unsigned char *edge = &hand.edges[0];
+	for (unsigned int y = hand.maskArea.top; y < hand.maskArea.bottom; ++y)
+	{
+		for (unsigned int x = hand.maskArea.left; x < hand.maskArea.right; ++x, ++edge)
+		{
+			if (*edge == 0)
+				continue;
 
-	return depthData;
+			const unsigned int depthIndex = (y * m_frameWidth) + x;
+			depthData[depthIndex].rgbRed = 255;
+			depthData[depthIndex].rgbGreen = 255;
+			depthData[depthIndex].rgbBlue = 255;
+		}
+	}
 }
 
 bool CHand::SampleToHandArea(
-		RGBQUAD *depthData
+		const MaskArea &bandArea
 	)
 {
-	// Start at the opposite extremities
-	unsigned int right = 0;
-	unsigned int bottom = 0;
-	unsigned int left = m_frameWidth;
-	unsigned int top = m_frameHeight;
-
-	// spin through all pixel points, moving the bounds accordingly
-	for (unsigned int yPos = 0; yPos < m_frameHeight; ++yPos)
-	{
-		for (unsigned int xPos = 0; xPos < m_frameWidth; ++xPos)
-		{
-			const unsigned int pixel = (yPos * m_frameWidth) + xPos;
-			if (depthData[pixel].rgbRed == 0)
-				continue;
+	if (bandArea.IsEmpty())
+		return false;
 
-			if (xPos > right) right = xPos;
-			if (xPos < left) left = xPos;
-			if (yPos < top) top = yPos;
-		}
-	}
+	// the extremities of the pixels in the band
+	const unsigned int left = bandArea.left;
+	const unsigned int right = bandArea.right - 1;
+	const unsigned int top = bandArea.top;
 
 	// Set the bottom to be the same distance away from the top, as the box is wide
-	bottom = top + static_cast<int>((right - left) * 1.3f);
+	const unsigned int bottom = top + static_cast<int>((right - left) * 1.3f);
 
 	// Make sure we have valid extremities
 	bool valid = true;
@@ -128,10 +476,7 @@ bool CHand::SampleToHandArea(
 	if (left < 0) valid = false;
 
 	if (!valid)
-	{
-		m_handState = HandState::NotFound;
 		return false;
-	}
 
 	const int widthOfHand = right - left;
 	const int heightOfHand = bottom - top;
@@ -141,10 +486,7 @@ bool CHand::SampleToHandArea(
 	if (widthOfHand < m_handSize.y) valid = false;
 
 	if (!valid)
-	{
-		m_handState = HandState::NotFound;
 		return false;
-	}
 
 	// Update our stored sample location
 	m_handArea.Set(0, 0, 0, 0);
@@ -156,51 +498,8 @@ bool CHand::SampleToHandArea(
 	float xPos = left + (widthOfHand * 0.5f);
 	float yPos = top + (heightOfHand * 0.5f);
 
-	HandState::Enum oldState = m_handState;
-
-	float differenceToMax = m_handSize.x - widthOfHand;
-	float differnceToMin = widthOfHand - m_handSize.y;
-
-	std::stringstream buf;
-	buf << "Distance To Max: " << differenceToMax << ", Distance To Min: " << differnceToMin << "\n";
-
-	OutputDebugString(buf.str().c_str());
-
-	m_handState = differenceToMax < differnceToMin ? HandState::OpenHand : HandState::ClosedFist;
-
-	if (oldState != HandState::ClosedFist && m_handState == HandState::ClosedFist)
-	{
-		if (m_startClose == 0) 
-		{
-			m_startClose = clock();
-			m_handState = HandState::OpenHand;
-		}
-		else if (static_cast<float>((clock() - m_startClose)/CLOCKS_PER_SEC) > 0.01f)
-		{
-			m_startClose = 0;
-		}
-		else
-		{
-			m_handState = HandState::OpenHand;
-		}
-	}
-	else if (m_handState == HandState::OpenHand)
-	{
-		m_startClose = 0;
-	}
-
 	m_palm = D3DXVECTOR2(xPos, yPos);
 
-	if (oldState == HandState::NotFound || (m_handState == HandState::ClosedFist && oldState == HandState::OpenHand))
-	{
-		m_center = m_palm;
-	}
-
-	if (m_handState != HandState::NotFound)
-	{
-		CVisCraft::GetInstance()->GetGizmo()->SetInputType(InputType::Kinect); 
-	}
-		
 	return true;
 }
 
@@ -234,134 +533,109 @@ void CHand::DrawBox(
 }
 
 void CHand::DrawHandAreaBounds(
+		const HandFrame &hand,
 		RGBQUAD *depthData
 	)
 {
-	if (m_handState == HandState::NotFound)
+	if (hand.state == HandState::NotFound)
 		return;
 
 	static const int thickness = 1;
 
-	const unsigned int left = m_handArea[HandAreaSamplePoint::Left];
-	const unsigned int right = m_handArea[HandAreaSamplePoint::Right];
-	const unsigned int top = m_handArea[HandAreaSamplePoint::Top];
-	const unsigned int bottom = m_handArea[HandAreaSamplePoint::Bottom];
+	const unsigned int left = hand.area.left;
+	const unsigned int right = hand.area.right - 1;
+	const unsigned int top = hand.area.top;
+	const unsigned int bottom = hand.area.bottom;
 
-	DrawBox(depthData, left - thickness, top, left + thickness, bottom, 0, m_handState == HandState::OpenHand ? 255 : 0, m_handState == HandState::OpenHand ? 0 : 255);
-	DrawBox(depthData, right - thickness, top, right + thickness, bottom, 0, m_handState == HandState::OpenHand ? 255 : 0, m_handState == HandState::OpenHand ? 0 : 255);
-	DrawBox(depthData, left, top - thickness, right, top + thickness, 0, m_handState == HandState::OpenHand ? 255 : 0, m_handState == HandState::OpenHand ? 0 : 255);
-	DrawBox(depthData, left, bottom - thickness, right, bottom + thickness, 0, m_handState == HandState::OpenHand ? 255 : 0, m_handState == HandState::OpenHand ? 0 : 255);
+	DrawBox(depthData, left - thickness, top, left + thickness, bottom, 0, hand.state == HandState::OpenHand ? 255 : 0, hand.state == HandState::OpenHand ? 0 : 255);
+	DrawBox(depthData, right - thickness, top, right + thickness, bottom, 0, hand.state == HandState::OpenHand ? 255 : 0, hand.state == HandState::OpenHand ? 0 : 255);
+	DrawBox(depthData, left, top - thickness, right, top + thickness, 0, hand.state == HandState::OpenHand ? 255 : 0, hand.state == HandState::OpenHand ? 0 : 255);
+	DrawBox(depthData, left, bottom - thickness, right, bottom + thickness, 0, hand.state == HandState::OpenHand ? 255 : 0, hand.state == HandState::OpenHand ? 0 : 255);
 
 	DrawBox(
 		depthData, 
-		static_cast<unsigned int>(m_center.x - 6), 
-		static_cast<unsigned int>(m_center.y - 6), 
-		static_cast<unsigned int>(m_center.x + 6), 
-		static_cast<unsigned int>(m_center.y + 6), 
+		static_cast<unsigned int>(hand.centerX - 6), 
+		static_cast<unsigned int>(hand.centerY - 6), 
+		static_cast<unsigned int>(hand.centerX + 6), 
+		static_cast<unsigned int>(hand.centerY + 6), 
 		255, 255, 0
 	);
-}
-
-void CHand::DetectHandEdges( 
-		RGBQUAD *depthData 
-	)
-{
-	return;
-
-	memcpy(m_edgeTempBuffer, depthData, m_frameWidth * m_frameHeight * sizeof(RGBQUAD));
 
-	const unsigned int left = m_handArea[HandAreaSamplePoint::Left];
-	const unsigned int right = m_handArea[HandAreaSamplePoint::Right];
-	const unsigned int top = m_handArea[HandAreaSamplePoint::Top];
-	const unsigned int bottom = m_handArea[HandAreaSamplePoint::Bottom];
-
-	for (unsigned int yPos = top + 1; yPos < bottom - 1; ++yPos)
+	// mark the valleys between the fingers the classifier counted
+	for (unsigned int valley = 0; valley < hand.fingerValleys.size(); ++valley)
 	{
-		for (unsigned int xPos = left + 1; xPos < right - 1; ++xPos)
-		{
-			const unsigned int pixel = (yPos * m_frameWidth) + xPos;
+		const unsigned int x = static_cast<unsigned int>(hand.fingerValleys[valley].x);
+		const unsigned int y = static_cast<unsigned int>(hand.fingerValleys[valley].y);
+		DrawBox(depthData, x - 2, y - 2, x + 3, y + 3, 255, 0, 255);
+	}
 
-			SAM::TMatrix<float, 3, 3> G[2];
+	// and the outline of the template which fit best
+	for (unsigned int point = 0; point < hand.templateOutline.size(); ++point)
+	{
+		const unsigned int x = static_cast<unsigned int>(hand.templateOutline[point].x);
+		const unsigned int y = static_cast<unsigned int>(hand.templateOutline[point].y);
+		DrawBox(depthData, x, y, x + 1, y + 1, 0, 255, 255);
+	}
+}
 
-			G[0][0] = SAM::TVector<float, 3>(1.0f, 2.0f, 1.0f);
-			G[0][1] = SAM::TVector<float, 3>(0.0f, 0.0f, 0.0f);
-			G[0][2] = SAM::TVector<float, 3>(-1.0f, -2.0f, -1.0f);
+void CHand::DetectHandEdges(
+		HandFrame &hand
+	)
+{
+	const unsigned int maskWidth = hand.maskArea.right - hand.maskArea.left;
+	const unsigned int maskHeight = hand.maskArea.bottom - hand.maskArea.top;
+	const MaskArea area = GetLocalHandArea(hand);
 
-			G[1][0] = SAM::TVector<float, 3>(1.0f, 0.0f, -1.0f);
-			G[1][1] = SAM::TVector<float, 3>(2.0f, 0.0f, -2.0f);
-			G[1][2] = SAM::TVector<float, 3>(1.0f, 0.0f, -1.0f);
+	// only the hand area is written, the pixel around it never holds an edge
+	hand.edges.assign(maskWidth * maskHeight, 0);
 
-			SAM::TMatrix<float, 3, 3> I;
-			SAM::TMatrix<float, 3, 3> sample;
+	DetectSobelEdges(&hand.mask[0], maskWidth, maskHeight, area, EDGE_THRESHOLD, m_edgeMagnitude, &hand.edges[0]);
+	ComputeDistanceTransform(&hand.edges[0], maskWidth, area, m_edgeDistance);
+}
 
-			// fetch the 3x3 neighborhood and use the Red color intensity value
-			for (int sampleOffsetX = 0; sampleOffsetX < 3; ++sampleOffsetX)
-			{
-				for (int sampleOffsetY = 0; sampleOffsetY < 3; ++sampleOffsetY)
-				{
-					unsigned int samplePoint = ((yPos + (sampleOffsetY - 1)) * m_frameWidth) + (xPos + (sampleOffsetX - 1));
-					I[sampleOffsetX][sampleOffsetY] = depthData[samplePoint].rgbRed;
-				}
-			}
+void CHand::MatchHandTemplates(
+		HandFrame &hand
+	)
+{
+	const unsigned int maskWidth = hand.maskArea.right - hand.maskArea.left;
+	const MaskArea area = GetLocalHandArea(hand);
 
-			// ignore solid color blocks, as they won't contain an edge
-			bool allSame = true;
-			float lastColor = I[0][0];
-			for (int i=0; i < 3; i++)
-			{
-				for (int j=0; j < 3; j++)
-				{
-					if (I[i][j] != lastColor)
-					{
-						allSame = false;
-						break;	
-					}
-					lastColor = I[i][j];
-				}
-			}
+	m_templateState = HandState::NotFound;
+	float bestScore = 0.0f;
 
-			// if the sample data is all the same, return the current color
-			if (allSame)
-			{
-				m_edgeTempBuffer[pixel] = depthData[pixel];
-				continue;
-			}
+	for (unsigned int state = 0; state < HandState::Noof; ++state)
+	{
+		if (m_handStateDTM[state] == nullptr)
+			continue;
 
-			// sample region is most likely an edge
-			m_edgeTempBuffer[pixel].rgbRed = 255;
-			m_edgeTempBuffer[pixel].rgbGreen = 255;
-			m_edgeTempBuffer[pixel].rgbBlue = 255;
+		const bool matched = m_handStateDTM[state]->Match(&hand.edges[0], m_edgeDistance, maskWidth, area, m_templateMatch[state]);
+		if (matched && (m_templateState == HandState::NotFound || m_templateMatch[state].score < bestScore))
+		{
+			m_templateState = static_cast<HandState::Enum>(state);
+			bestScore = m_templateMatch[state].score;
 		}
 	}
 
-	memcpy(depthData, m_edgeTempBuffer, m_frameWidth * m_frameHeight * sizeof(RGBQUAD));
-}
-
-void CHand::Release()
-{
-
-}
+	// keep the outline of the best template where it fit, in frame pixels
+	hand.templateOutline.clear();
+	if (m_templateState == HandState::NotFound)
+		return;
 
-const D3DXVECTOR2 CHand::GetHandPosition()
-{
-	if (m_handState == HandState::OpenHand || m_handState == HandState::ClosedFist)
+	const TemplateMatch &match = m_templateMatch[m_templateState];
+	const std::vector<TemplatePoint> &outline = m_handStateDTM[m_templateState]->GetPoints();
+	for (unsigned int point = 0; point < outline.size(); ++point)
 	{
-		D3DXVECTOR2 differnce = (m_center - m_palm);
-		differnce.x = differnce.x * 0.025f;
-		differnce.y = differnce.y * 0.025f;
-
-		const float sqrLen = (differnce.x*differnce.x + differnce.y*differnce.y);
-		if (sqrLen > 1.0f) {
-			differnce.y = differnce.y * 0.5f;
-			m_oldPosition = m_lastPosition;
-			m_lastPosition = m_lastPosition - differnce;
-		}
-	}
+		ContourPoint pixel;
+		pixel.x = static_cast<int>(floor(match.x + (outline[point].x * match.scale) + 0.5f)) + static_cast<int>(hand.maskArea.left);
+		pixel.y = static_cast<int>(floor(match.y + (outline[point].y * match.scale) + 0.5f)) + static_cast<int>(hand.maskArea.top);
+		if (pixel.x < 0 || pixel.y < 0)
+			continue;
 
-	return m_lastPosition;
+		hand.templateOutline.push_back(pixel);
+	}
 }
 
-HandState::Enum CHand::GetHandState() const
+void CHand::Release()
 {
-	return m_handState;
-}
+
+}
\ No newline at end of file
@@ -9,63 +9,116 @@
 
 #include "../helper.h"
 #include "CDeformableTemplateModel.h"
+#include "CBlobLabeller.h"
+#include "CDepthBandCalibrator.h"
+#include "CHandSearchWindow.h"
+#include "CHandShapeClassifier.h"
+#include "CHandStateHysteresis.h"
+#include "DepthBand.h"
+#include "DistanceTransform.h"
+#include "HandFrame.h"
+#include "SobelEdges.h"
 #include "gestures/CGestureHandClosed.h"
-
-struct HandState {
-	enum Enum {
-		ClosedFist,
-		OpenHand,
-		NotFound,
-		Noof
-	};
-};
+#include "gestures/CGestureHandOpen.h"
 
 struct ConfigurationState {
 	enum Enum {
-		None,
-		Started,
-		HasOpenHand,
-		HasClosedHand,
-		HasVoice,
-		Configured,
+		None,							//!< Configuration hasn't been started, the default band is used
+		Started,						//!< The band is being calibrated from the frames
+		Configured,						//!< The band has been calibrated at least once since starting
 		Noof
 	};
 };
 
+/*
+ *	\brief Tracks the hand through the depth frames in two halves. Segment finds the hand blob
+ *	and copies it into a hand frame, Classify decides from that copy alone whether the hand
+ *	is open. Each half keeps its own state, so they can run on different threads.
+*/
 class CHand {
 private:
 
 	unsigned int									m_frameWidth;									//!< 
 	unsigned int									m_frameHeight;									//!<
 
-	D3DXVECTOR2										m_palm;											//!<
-	D3DXVECTOR2										m_lastPosition;									//!< 
-	D3DXVECTOR2										m_oldPosition;									//!< 
+	D3DXVECTOR2										m_palm;											//!< The palm of the last hand segmented, the next frame's blob is the one nearest it
 	D3DXVECTOR2										m_center;
 	D3DXVECTOR2										m_handSize;
 
 	SAM::TVector<unsigned int, 4>					m_handArea;										//!< 
+	bool											m_tracking;										//!< Was a hand segmented last frame
 	HandState::Enum									m_handState;
 
-	CDeformableTemplateModel						*m_handStateDTM[HandState::Noof];				//!< 	
+	CDeformableTemplateModel						*m_handStateDTM[HandState::Noof];				//!< The template of each hand state, null for states without one
+	TemplateMatch									m_templateMatch[HandState::Noof];				//!< Where each template fit the hand edges last frame
+	HandState::Enum									m_templateState;								//!< The state of the best fitting template which matched, not found if none did
 
-	RGBQUAD											*m_edgeTempBuffer;								//!< 
+	BYTE											*m_handMask;									//!< One byte per depth pixel, non zero where the depth is inside the hand band
+	unsigned short									*m_edgeMagnitude;								//!< One gradient magnitude per pixel of a hand frame's mask area
+	unsigned short									*m_edgeDistance;								//!< The distance to the nearest edge per pixel of a hand frame's mask area
+	MaskArea										m_maskWindow;									//!< The window of the hand mask thresholded last, the mask is clear outside it
+	CHandSearchWindow								m_searchWindow;									//!< The window around the last hand searched before the whole frame
+	CBlobLabeller									m_blobLabeller;									//!< Splits the hand mask into connected blobs
+	CHandShapeClassifier							m_shapeClassifier;								//!< Measures how open the hand is from its outline
+	CHandStateHysteresis							m_handStateFilter;								//!< Steadies the open or closed decision over a few frames
 
-	clock_t											m_startClose;									//!< 
-
-	ConfigurationState::Enum						m_configuratState;								//!< The current state of configuration
+	ConfigurationState::Enum						m_configuratState;								//!< The current state of configuration, the band is calibrated from started on
+	CDepthBandCalibrator							m_bandCalibrator;								//!< Finds the band the hand is held in from the recent frames
+	int												m_nearPoint;									//!< The nearest depth in the hand band, in millimetres
+	int												m_farPoint;										//!< One past the furthest depth in the hand band, in millimetres
 
 private:
 
 													//! Try to sample the data down to a smaller area,
 													//! Where the hand could be located
 	bool											SampleToHandArea(
-														RGBQUAD *depthData
+														const MaskArea &bandArea						//!< The bounds of the depth pixels in the hand band
 													);
 
-													//! Detect the edges of the hands and display them in white
+													//! Copy the hand area and the pixels of the hand blob around it into a hand frame
+	void											CopyHandBlob(
+														const MaskBlob &handBlob,						//!< The blob the hand area was sampled from
+														HandFrame &hand									//!< Receives the hand area and mask
+													);
+
+													//! Classify the hand blob as open or closed and update the hand state
+	void											UpdateHandState(
+														HandFrame &hand									//!< The segmented hand, receives the finger valleys and how sure the state is
+													);
+
+													//! Choose the blob most likely to be the hand, by size and by how near it is to the last hand
+	const MaskBlob									*SelectHandBlob() const;
+
+													//! Count the coarsest level of the frame's pyramid into the band calibration and take up the band if it moved
+	void											CalibrateBand(
+														const CDepthPyramid &pyramid					//!< The depth pyramid of the frame
+													);
+
+													//! Threshold a window into the hand mask, clearing the pixels left over from the last window
+	MaskArea										ThresholdBandWindow(
+														const USHORT *depthPixels,						//!< The packed depth pixels of the frame
+														const MaskArea &window							//!< The window to threshold
+													);
+
+													//! Threshold and label a window of the frame and choose the hand blob in it, null if there isn't one
+	const MaskBlob									*SearchWindow(
+														const USHORT *depthPixels,						//!< The packed depth pixels of the frame
+														const MaskArea &window							//!< The window to search
+													);
+
+													//! Detect the edges of the hand mask within the hand area
 	void											DetectHandEdges(
-														RGBQUAD *depthData
+														HandFrame &hand									//!< The segmented hand, receives the edges
+													);
+
+													//! Fit each hand state's template to the hand edges and find the state which fits best
+	void											MatchHandTemplates(
+														HandFrame &hand									//!< The hand with its edges detected, receives the best outline
+													);
+
+													//! Get the area of a hand frame's mask which holds the hand area
+	static MaskArea									GetLocalHandArea(
+														const HandFrame &hand							//!< The segmented hand
 													);
 
 													//! 
@@ -96,26 +149,54 @@ public:
 													//! 
 	void											Release();
 
-													//! Try and find a hand from the depth image
-	RGBQUAD*										FindFromDepth(
-														RGBQUAD *depthData
+													//! Try and find a hand in the raw depth pixels, the first half of tracking
+	void											Segment(
+														const CDepthPyramid &pyramid,					//!< The depth pyramid of the frame, level 0 as given by the depth stream
+														HandFrame &hand									//!< Receives where the hand is and the mask of its blob
+													);
+
+													//! Decide whether a segmented hand is open or closed, the second half of tracking
+	void											Classify(
+														HandFrame &hand									//!< The segmented hand, receives its state, edges and the shapes found
+													);
+
+													//! Tint the depth pixels inside the hand band and draw the hand edges for debugging
+	void											DrawHandMask(
+														const USHORT *depthPixels,						//!< The packed depth pixels the hand was found in
+														const HandFrame &hand,							//!< The classified hand
+														RGBQUAD *depthData								//!< The colored depth frame to draw over
 													);
 
 													//! Draw a green box around the sampled hand area for debugging
 	void											DrawHandAreaBounds(
+														const HandFrame &hand,							//!< The classified hand
 														RGBQUAD *depthData
 													);
 
-													//! Get the current hand position
-	const D3DXVECTOR2								GetHandPosition();
+													//! Start calibrating the hand band from the frames segmented, until then the fixed band is used
+	void											StartCalibration();
 
-													//! Get the current hand state
-	HandState::Enum									GetHandState() const;
+													//! Get how far configuration has got
+	ConfigurationState::Enum						GetConfigurationState() const
+													{
+														return m_configuratState;
+													}
 
-													//! 
-	void											ResetHandPosition()
+													//! Get the band calibration, with the band the hand is searched for in
+	const CDepthBandCalibrator						&GetBandCalibrator() const
+													{
+														return m_bandCalibrator;
+													}
+
+													//! Get the window the hand is searched for in, with the number of pixels searched
+	const CHandSearchWindow							&GetSearchWindow() const
+													{
+														return m_searchWindow;
+													}
+
+													//! Get the state of the template which best fit the hand last frame, not found if none matched
+	HandState::Enum									GetTemplateState() const
 													{
-														m_lastPosition = m_oldPosition;
+														return m_templateState;
 													}
-	
 };
\ No newline at end of file
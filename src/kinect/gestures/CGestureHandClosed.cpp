@@ -1,12 +1,16 @@
 #include "CGestureHandClosed.h"
 
+// the template unit is the width of the fist, the origin is the middle of the palm
+static const float MATCH_DISTANCE = 2.5f;
+static const float OUTLINE_SPACING = 0.08f;
 
-CGestureHandClosed::CGestureHandClosed() : CDeformableTemplateModel()
+CGestureHandClosed::CGestureHandClosed() : CDeformableTemplateModel(MATCH_DISTANCE)
 {
-	SetCenterPoint(SAM::TVector<float, 2>(20.0f, 20.0f), SAM::TVector<BYTE, 3>(0, 0, 0), 255);
-	AddPoint(SAM::TVector<float, 2>(-18.0f, 0.0f), SAM::TVector<BYTE, 3>(255, 255, 255), 0);
-	AddPoint(SAM::TVector<float, 2>(18.0f, 0.0f), SAM::TVector<BYTE, 3>(255, 255, 255), 0);
-	AddPoint(SAM::TVector<float, 2>(0.0f, -18.0f), SAM::TVector<BYTE, 3>(255, 255, 255), 0);
+	// the fist, then the wrist and forearm reaching down out of the hand area
+	AddCapsule(0.0f, -0.05f, 0.0f, 0.1f, 0.5f);
+	AddCapsule(0.0f, 0.0f, 0.0f, 2.0f, 0.275f);
+
+	BuildOutline(OUTLINE_SPACING);
 }
 
 CGestureHandClosed::~CGestureHandClosed()
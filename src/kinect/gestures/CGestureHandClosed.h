@@ -13,4 +13,4 @@ public:
 										//! Class destructor
 										~CGestureHandClosed();
 
-};
\ No newline at end of file
+};
@@ -0,0 +1,37 @@
+#include "CGestureHandOpen.h"
+#include <math.h>
+
+// the template unit is the width of the palm, the origin is the middle of the palm
+static const float MATCH_DISTANCE = 3.0f;
+static const float OUTLINE_SPACING = 0.08f;
+
+// the fingers spread from the palm, the angle of each from straight up, their lengths and
+// their radii, the little finger on the right and the thumb sticking out to the left
+static const float FINGER_ANGLES[] = { -0.47f, -0.16f, 0.16f, 0.47f, -1.22f };
+static const float FINGER_LENGTHS[] = { 0.8f, 0.875f, 0.825f, 0.675f, 0.6f };
+static const float FINGER_RADII[] = { 0.1f, 0.1f, 0.1f, 0.1f, 0.125f };
+static const float FINGER_BASE = 0.3f;
+
+CGestureHandOpen::CGestureHandOpen() : CDeformableTemplateModel(MATCH_DISTANCE)
+{
+	// the palm, then the wrist and forearm reaching down out of the hand area
+	AddCapsule(0.0f, -0.05f, 0.0f, 0.1f, 0.5f);
+	AddCapsule(0.0f, 0.0f, 0.0f, 2.0f, 0.275f);
+
+	for (unsigned int finger = 0; finger < sizeof(FINGER_ANGLES) / sizeof(FINGER_ANGLES[0]); ++finger)
+	{
+		const float tip = FINGER_BASE + FINGER_LENGTHS[finger];
+		AddCapsule(
+			sin(FINGER_ANGLES[finger]) * FINGER_BASE, -cos(FINGER_ANGLES[finger]) * FINGER_BASE,
+			sin(FINGER_ANGLES[finger]) * tip, -cos(FINGER_ANGLES[finger]) * tip,
+			FINGER_RADII[finger]
+		);
+	}
+
+	BuildOutline(OUTLINE_SPACING);
+}
+
+CGestureHandOpen::~CGestureHandOpen()
+{
+
+}
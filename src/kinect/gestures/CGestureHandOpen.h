@@ -0,0 +1,16 @@
+#pragma once
+
+#include "../CDeformableTemplateModel.h"
+
+class CGestureHandOpen : public CDeformableTemplateModel
+{
+private:
+
+public:
+										//! Class constructor
+										CGestureHandOpen();
+
+										//! Class destructor
+										~CGestureHandOpen();
+
+};
@@ -0,0 +1,78 @@
+#include "CHeightField.h"
+#include "CHeightMapLoader.h"
+#include "HeightMapWriter.h"
+
+/*
+ *	\brief Class constructor
+*/
+CHeightField::CHeightField() :
+	m_size(0)
+{
+
+}
+
+/*
+ *	\brief Class destructor
+*/
+CHeightField::~CHeightField()
+{
+
+}
+
+/*
+ *	\brief Create a flat heightmap of a given size
+*/
+void CHeightField::Create(
+		unsigned int size,							//!< The width and height of the heightmap
+		float height								//!< The height to fill the heightmap with
+	)
+{
+	m_size = size;
+	m_heights.assign(size * size, height);
+}
+
+/*
+ *	\brief Load a 24 bit heightmap bitmap, blocking until it has been decoded
+*/
+bool CHeightField::Load(
+		const char *fileName						//!< The location of the heightmap to load
+	)
+{
+	CHeightMapLoader loader;
+	loader.Start(fileName);
+	loader.Wait();
+
+	if (loader.GetState() != HeightMapLoadState::Complete)
+	{
+		m_error = loader.GetError();
+		return false;
+	}
+
+	m_size = loader.GetSize();
+	m_heights.assign(loader.GetHeights(), loader.GetHeights() + (m_size * m_size));
+	m_error.clear();
+
+	return true;
+}
+
+/*
+ *	\brief Save the heightmap as a 24 bit bitmap
+*/
+bool CHeightField::Save(
+		const char *fileName						//!< The location to write the heightmap to
+	)
+{
+	const HeightPlane plane = GetPlane();
+
+	float minimum, maximum;
+	plane.GetRange(minimum, maximum);
+
+	if (!SaveHeightMapBitmap(fileName, plane, minimum, maximum))
+	{
+		m_error = "Failed to write the heightmap file";
+		return false;
+	}
+
+	m_error.clear();
+	return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "HeightPlane.h"
+#include <string>
+#include <vector>
+
+/*
+ *	\brief A square heightmap held in plain memory, with no renderer attached.
+ *	Used by the batch processor to edit heightmaps without a window or GPU.
+*/
+class CHeightField {
+private:
+	std::vector<float>		m_heights;							//!< The heights, row by row
+	unsigned int			m_size;								//!< The width and height of the heightmap
+	std::string				m_error;							//!< A description of why the last load or save failed
+
+public:
+							//! Class constructor
+							CHeightField();
+
+							//! Class destructor
+							~CHeightField();
+
+							//! Create a flat heightmap of a given size
+	void					Create(
+								unsigned int size,				//!< The width and height of the heightmap
+								float height					//!< The height to fill the heightmap with
+							);
+
+							//! Load a 24 bit heightmap bitmap, blocking until it has been decoded
+	bool					Load(
+								const char *fileName			//!< The location of the heightmap to load
+							);
+
+							//! Save the heightmap as a 24 bit bitmap
+	bool					Save(
+								const char *fileName			//!< The location to write the heightmap to
+							);
+
+							//! Get a view of the heights for the stamps, generators and filters
+	HeightPlane				GetPlane()
+							{
+								HeightPlane plane;
+								plane.heights = m_heights.empty() ? nullptr : &m_heights[0];
+								plane.stride = 1;
+								plane.width = m_size;
+								plane.height = m_size;
+								return plane;
+							}
+
+							//! Get the width and height of the heightmap
+	unsigned int			GetSize() const
+							{
+								return m_size;
+							}
+
+							//! Get a description of why the last load or save failed
+	const char				*GetError() const
+							{
+								return m_error.c_str();
+							}
+};
@@ -0,0 +1,223 @@
+#include "CHeightMapLoader.h"
+#include <fstream>
+#include <vector>
+
+/*
+ *	\brief Read a little endian value from a byte buffer
+*/
+template<typename T>
+static T ReadLittleEndian(
+		const unsigned char *data
+	)
+{
+	T value = 0;
+	for (unsigned int byte = 0; byte < sizeof(T); ++byte)
+	{
+		value |= static_cast<T>(data[byte]) << (byte * 8);
+	}
+	return value;
+}
+
+/*
+ *	\brief Class constructor
+*/
+CHeightMapLoader::CHeightMapLoader() :
+	m_cancel(false),
+	m_state(HeightMapLoadState::Idle),
+	m_coarseReady(false),
+	m_rowsDecoded(0),
+	m_size(0),
+	m_coarseSize(0),
+	m_heights(nullptr),
+	m_coarse(nullptr)
+{
+
+}
+
+/*
+ *	\brief Class destructor, cancels any load in progress
+*/
+CHeightMapLoader::~CHeightMapLoader()
+{
+	Cancel();
+	Wait();
+	FreeBuffers();
+}
+
+/*
+ *	\brief Start loading a heightmap, cancelling any load already in progress
+*/
+bool CHeightMapLoader::Start(
+		const char *fileName						//!< The location of the heightmap to load
+	)
+{
+	Cancel();
+	Wait();
+	FreeBuffers();
+
+	m_fileName = fileName;
+	m_error.clear();
+	m_size = 0;
+	m_coarseSize = 0;
+	m_cancel = false;
+	m_coarseReady = false;
+	m_rowsDecoded = 0;
+	m_state = HeightMapLoadState::Loading;
+
+	m_thread = std::thread(&CHeightMapLoader::LoadThread, this);
+
+	return true;
+}
+
+/*
+ *	\brief Block until the decode thread has finished
+*/
+void CHeightMapLoader::Wait()
+{
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+/*
+ *	\brief Set the load as failed with a given reason
+*/
+void CHeightMapLoader::Fail(
+		const char *error							//!< Why the load failed
+	)
+{
+	m_error = error;
+	m_state = HeightMapLoadState::Failed;
+}
+
+/*
+ *	\brief Free the decoded buffers
+*/
+void CHeightMapLoader::FreeBuffers()
+{
+	SafeArrayDelete(m_heights);
+	SafeArrayDelete(m_coarse);
+}
+
+/*
+ *	\brief The decode thread entry point
+*/
+void CHeightMapLoader::LoadThread()
+{
+	static const unsigned int HeaderSize = 54;		// BITMAPFILEHEADER + BITMAPINFOHEADER
+
+	std::ifstream file(m_fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		Fail("Failed to open the heightmap file");
+		return;
+	}
+
+	unsigned char header[HeaderSize];
+	if (!file.read(reinterpret_cast<char*>(header), HeaderSize))
+	{
+		Fail("Failed to read heightmap header");
+		return;
+	}
+
+	if (header[0] != 'B' || header[1] != 'M')
+	{
+		Fail("The heightmap is not a bitmap image");
+		return;
+	}
+
+	const unsigned int dataOffset = ReadLittleEndian<unsigned int>(&header[10]);
+	const int width = static_cast<int>(ReadLittleEndian<unsigned int>(&header[18]));
+	const int height = static_cast<int>(ReadLittleEndian<unsigned int>(&header[22]));
+	const unsigned short bitCount = ReadLittleEndian<unsigned short>(&header[28]);
+
+	if (width != height || width < 2)
+	{
+		Fail("Heightmap image is not square");
+		return;
+	}
+
+	if (bitCount / 8 != 3)
+	{
+		Fail("The height map is not a 24 bit image");
+		return;
+	}
+
+	const unsigned int size = static_cast<unsigned int>(width);
+	const unsigned int rowPitch = ((size * 3) + 3) & ~3u;
+	const unsigned int coarseSize = (size + CoarseStep - 1) / CoarseStep;
+
+	m_heights = new float[size * size];
+	m_coarse = new float[coarseSize * coarseSize];
+	m_size = size;
+	m_coarseSize = coarseSize;
+
+	std::vector<unsigned char> rows(rowPitch * BandRows);
+
+	// Sample every CoarseStep'th row and column first, so the terrain can be shown straight away
+	for (unsigned int coarseZ = 0; coarseZ < coarseSize; ++coarseZ)
+	{
+		if (m_cancel)
+		{
+			m_state = HeightMapLoadState::Cancelled;
+			return;
+		}
+
+		file.seekg(dataOffset + (coarseZ * CoarseStep * rowPitch), std::ios::beg);
+		if (!file.read(reinterpret_cast<char*>(&rows[0]), rowPitch))
+		{
+			Fail("Failed to read image data");
+			return;
+		}
+
+		for (unsigned int coarseX = 0; coarseX < coarseSize; ++coarseX)
+		{
+			m_coarse[(coarseZ * coarseSize) + coarseX] = rows[coarseX * CoarseStep * 3];
+		}
+
+		if (m_progress)
+		{
+			m_progress(coarseZ + 1, 0);
+		}
+	}
+
+	m_coarseReady = true;
+
+	// Now decode the full resolution map a band at a time
+	file.seekg(dataOffset, std::ios::beg);
+	for (unsigned int bandZ = 0; bandZ < size; bandZ += BandRows)
+	{
+		if (m_cancel)
+		{
+			m_state = HeightMapLoadState::Cancelled;
+			return;
+		}
+
+		const unsigned int bandRows = bandZ + BandRows > size ? size - bandZ : BandRows;
+		if (!file.read(reinterpret_cast<char*>(&rows[0]), rowPitch * bandRows))
+		{
+			Fail("Failed to read image data");
+			return;
+		}
+
+		for (unsigned int row = 0; row < bandRows; ++row)
+		{
+			const unsigned char *const pixel = &rows[row * rowPitch];
+			float *const heights = &m_heights[(bandZ + row) * size];
+			for (unsigned int x = 0; x < size; ++x)
+			{
+				heights[x] = pixel[x * 3];
+			}
+		}
+
+		m_rowsDecoded = bandZ + bandRows;
+
+		if (m_progress)
+		{
+			m_progress(coarseSize, bandZ + bandRows);
+		}
+	}
+
+	m_state = HeightMapLoadState::Complete;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "../helper.h"
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <string>
+
+struct HeightMapLoadState {
+	enum Enum {
+		Idle,
+		Loading,
+		Complete,
+		Failed,
+		Cancelled
+	};
+};
+
+/*
+ *	\brief Decodes a 24 bit heightmap bitmap on a background thread.
+ *	A coarse preview (every CoarseStep'th row and column) is published first,
+ *	then the full resolution heights are decoded in bands of BandRows rows.
+ *	The owner polls the loader from the main thread and consumes rows as they finish,
+ *	or can be called back on the decode thread as each coarse row and band is published.
+*/
+class CHeightMapLoader {
+public:
+	static const unsigned int		CoarseStep = 8;						//!< The row/column step used to sample the coarse preview
+	static const unsigned int		BandRows = 16;						//!< The number of rows decoded per refinement band
+
+private:
+	std::thread						m_thread;							//!< The background decode thread
+	std::string						m_fileName;							//!< The location of the heightmap being loaded
+	std::string						m_error;							//!< A description of why the load failed
+
+	std::atomic<bool>				m_cancel;							//!< Set to ask the decode thread to stop
+	std::atomic<int>				m_state;							//!< The current HeightMapLoadState
+	std::atomic<bool>				m_coarseReady;						//!< Has the coarse preview been published
+	std::atomic<unsigned int>		m_rowsDecoded;						//!< The number of full resolution rows published
+
+	unsigned int					m_size;								//!< The width and height of the heightmap
+	unsigned int					m_coarseSize;						//!< The width and height of the coarse preview
+	float							*m_heights;							//!< The full resolution heights, valid up to m_rowsDecoded
+	float							*m_coarse;							//!< The coarse preview heights
+
+	std::function<void (unsigned int, unsigned int)>	m_progress;		//!< Called on the decode thread with the coarse rows and full rows published so far
+
+private:
+									//! The decode thread entry point
+	void							LoadThread();
+
+									//! Set the load as failed with a given reason
+	void							Fail(
+										const char *error				//!< Why the load failed
+									);
+
+									//! Free the decoded buffers
+	void							FreeBuffers();
+
+public:
+									//! Class constructor
+									CHeightMapLoader();
+
+									//! Class destructor, cancels any load in progress
+									~CHeightMapLoader();
+
+									//! Start loading a heightmap, cancelling any load already in progress
+	bool							Start(
+										const char *fileName			//!< The location of the heightmap to load
+									);
+
+									//! Set the function called on the decode thread after each coarse row and each band, with the coarse rows and full rows published so far. Only while no load is running
+	void							SetProgressCallback(
+										const std::function<void (unsigned int, unsigned int)> &progress	//!< The function, or an empty one for none
+									)
+									{
+										m_progress = progress;
+									}
+
+									//! Ask the decode thread to stop at the next band
+	void							Cancel()
+									{
+										m_cancel = true;
+									}
+
+									//! Block until the decode thread has finished
+	void							Wait();
+
+									//! Get the state of the current load
+	HeightMapLoadState::Enum		GetState() const
+									{
+										return static_cast<HeightMapLoadState::Enum>(m_state.load());
+									}
+
+									//! Has the coarse preview been published yet
+	bool							IsCoarseReady() const
+									{
+										return m_coarseReady;
+									}
+
+									//! Get the width and height of the heightmap, valid once the coarse preview is ready
+	unsigned int					GetSize() const
+									{
+										return m_size;
+									}
+
+									//! Get the value at a given full resolution coordinate from the coarse preview
+	float							GetCoarseHeight(
+										unsigned int x,					//!< The x coordinate in the full resolution map
+										unsigned int z					//!< The z coordinate in the full resolution map
+									) const
+									{
+										return m_coarse[((z / CoarseStep) * m_coarseSize) + (x / CoarseStep)];
+									}
+
+									//! Get the number of full resolution rows which have been decoded
+	unsigned int					GetRowsDecoded() const
+									{
+										return m_rowsDecoded;
+									}
+
+									//! Get the full resolution heights, only rows below GetRowsDecoded are valid
+	const float						*GetHeights() const
+									{
+										return m_heights;
+									}
+
+									//! Get a description of why the load failed
+	const char						*GetError() const
+									{
+										return m_error.c_str();
+									}
+};
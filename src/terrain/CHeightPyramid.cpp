@@ -0,0 +1,276 @@
+#include "CHeightPyramid.h"
+#include <float.h>
+
+/*
+ *	\brief Class constructor
+*/
+CHeightPyramid::CHeightPyramid() :
+	m_columnLevels(0),
+	m_rowLevels(0)
+{
+
+}
+
+/*
+ *	\brief Class destructor
+*/
+CHeightPyramid::~CHeightPyramid()
+{
+
+}
+
+/*
+ *	\brief Allocate the pyramid levels for a given height plane size
+*/
+void CHeightPyramid::Create(
+		unsigned int width,						//!< The number of columns in the height plane
+		unsigned int height						//!< The number of rows in the height plane
+	)
+{
+	m_levels.clear();
+
+	// the sizes each axis halves through until a single cell covers it
+	std::vector<unsigned int> widths(1, width);
+	while (widths.back() > 1)
+	{
+		widths.push_back((widths.back() + 1) / 2);
+	}
+
+	std::vector<unsigned int> heights(1, height);
+	while (heights.back() > 1)
+	{
+		heights.push_back((heights.back() + 1) / 2);
+	}
+
+	m_columnLevels = static_cast<unsigned int>(widths.size());
+	m_rowLevels = static_cast<unsigned int>(heights.size());
+
+	for (unsigned int rowLevel = 0; rowLevel < m_rowLevels; ++rowLevel)
+	{
+		for (unsigned int columnLevel = 0; columnLevel < m_columnLevels; ++columnLevel)
+		{
+			Level level;
+			level.width = widths[columnLevel];
+			level.height = heights[rowLevel];
+			level.cells.resize(level.width * level.height);
+			m_levels.push_back(level);
+		}
+	}
+}
+
+/*
+ *	\brief Rebuild every level from the height plane
+*/
+void CHeightPyramid::Rebuild(
+		const float *heights,					//!< The first height in the plane
+		unsigned int stride						//!< The number of floats between consecutive heights
+	)
+{
+	if (m_levels.empty())
+		return;
+
+	TerrainArea area;
+	area.left = 0;
+	area.top = 0;
+	area.right = m_levels[0].width;
+	area.bottom = m_levels[0].height;
+
+	Update(heights, stride, area);
+}
+
+/*
+ *	\brief Update the base cells of an area and re-reduce only their parents
+*/
+void CHeightPyramid::Update(
+		const float *heights,					//!< The first height in the plane
+		unsigned int stride,					//!< The number of floats between consecutive heights
+		const TerrainArea &area					//!< The area of the height plane which changed
+	)
+{
+	if (m_levels.empty())
+		return;
+
+	Level &base = m_levels[0];
+
+	TerrainArea dirty = area;
+	if (dirty.right > base.width) dirty.right = base.width;
+	if (dirty.bottom > base.height) dirty.bottom = base.height;
+	if (dirty.IsEmpty())
+		return;
+
+	for (unsigned int z = dirty.top; z < dirty.bottom; ++z)
+	{
+		for (unsigned int x = dirty.left; x < dirty.right; ++x)
+		{
+			const unsigned int index = (z * base.width) + x;
+			const float height = heights[index * stride];
+
+			HeightPyramidCell &cell = base.cells[index];
+			cell.minimum = cell.maximum = cell.average = height;
+		}
+	}
+
+	// walk up the pyramid, each level is reduced from the one halved once less along the columns,
+	// or along the rows for the first column, both of which come before it
+	for (unsigned int rowLevel = 0; rowLevel < m_rowLevels; ++rowLevel)
+	{
+		for (unsigned int columnLevel = 0; columnLevel < m_columnLevels; ++columnLevel)
+		{
+			if (columnLevel == 0 && rowLevel == 0)
+				continue;
+
+			TerrainArea parent;
+			parent.left = dirty.left >> columnLevel;
+			parent.top = dirty.top >> rowLevel;
+			parent.right = ((dirty.right - 1) >> columnLevel) + 1;
+			parent.bottom = ((dirty.bottom - 1) >> rowLevel) + 1;
+
+			ReduceLevel(columnLevel, rowLevel, parent);
+		}
+	}
+}
+
+/*
+ *	\brief Get the number of base samples covered by a cell along one axis
+*/
+unsigned int CHeightPyramid::GetCellCoverage(
+		unsigned int level,						//!< The level of the cell
+		unsigned int cell,						//!< The index of the cell along the axis
+		unsigned int baseSize					//!< The size of the base level along the axis
+	) const
+{
+	const unsigned int span = 1u << level;
+	const unsigned int start = cell * span;
+	return start + span > baseSize ? baseSize - start : span;
+}
+
+/*
+ *	\brief Re-reduce the cells of an area of a level from the level halved once less, along the columns when it can
+*/
+void CHeightPyramid::ReduceLevel(
+		unsigned int columnLevel,				//!< The number of times the columns of the level are halved
+		unsigned int rowLevel,					//!< The number of times the rows of the level are halved, with the columns, not both 0
+		const TerrainArea &area					//!< The area of the level to reduce
+	)
+{
+	const unsigned int childColumnLevel = columnLevel != 0 ? columnLevel - 1 : 0;
+	const unsigned int childRowLevel = columnLevel != 0 ? rowLevel : rowLevel - 1;
+	const unsigned int columnStep = columnLevel != 0 ? 2 : 1;
+	const unsigned int rowStep = columnLevel != 0 ? 1 : 2;
+
+	const Level &child = GetLevel(childColumnLevel, childRowLevel);
+	Level &parent = m_levels[(rowLevel * m_columnLevels) + columnLevel];
+
+	const unsigned int baseWidth = m_levels[0].width;
+	const unsigned int baseHeight = m_levels[0].height;
+
+	for (unsigned int z = area.top; z < area.bottom; ++z)
+	{
+		for (unsigned int x = area.left; x < area.right; ++x)
+		{
+			HeightPyramidCell &cell = parent.cells[(z * parent.width) + x];
+			cell.minimum = FLT_MAX;
+			cell.maximum = -FLT_MAX;
+
+			float total = 0.0f;
+			unsigned int samples = 0;
+
+			const unsigned int childRight = (x * columnStep) + columnStep > child.width ? child.width : (x * columnStep) + columnStep;
+			const unsigned int childBottom = (z * rowStep) + rowStep > child.height ? child.height : (z * rowStep) + rowStep;
+
+			for (unsigned int childZ = z * rowStep; childZ < childBottom; ++childZ)
+			{
+				for (unsigned int childX = x * columnStep; childX < childRight; ++childX)
+				{
+					const HeightPyramidCell &childCell = child.cells[(childZ * child.width) + childX];
+					if (childCell.minimum < cell.minimum) cell.minimum = childCell.minimum;
+					if (childCell.maximum > cell.maximum) cell.maximum = childCell.maximum;
+
+					// weight the average by how many samples the child covers, edge cells may cover less
+					const unsigned int coverage = GetCellCoverage(childColumnLevel, childX, baseWidth) * GetCellCoverage(childRowLevel, childZ, baseHeight);
+					total += childCell.average * coverage;
+					samples += coverage;
+				}
+			}
+
+			cell.average = total / static_cast<float>(samples);
+		}
+	}
+}
+
+/*
+ *	\brief Find the lowest, highest and average heights within an area, false if it is empty
+*/
+bool CHeightPyramid::QueryRange(
+		const TerrainArea &area,				//!< The area of the base level to query
+		float &minimum,							//!< Receives the lowest height in the area
+		float &maximum,							//!< Receives the highest height in the area
+		float &average							//!< Receives the average height in the area
+	) const
+{
+	if (m_levels.empty())
+		return false;
+
+	TerrainArea query = area;
+	if (query.right > m_levels[0].width) query.right = m_levels[0].width;
+	if (query.bottom > m_levels[0].height) query.bottom = m_levels[0].height;
+	if (query.IsEmpty())
+		return false;
+
+	// split an axis into aligned blocks, at most one off each end per halving, the
+	// blocks are whole cells of the level halved that many times and lie inside the plane
+	struct Blocks
+	{
+		unsigned int	count;
+		unsigned int	level[64];
+		unsigned int	index[64];
+	};
+
+	auto split = [](unsigned int first, unsigned int last, Blocks &blocks)
+	{
+		blocks.count = 0;
+		for (unsigned int level = 0; first < last; ++level)
+		{
+			if (first & 1)
+			{
+				blocks.level[blocks.count] = level;
+				blocks.index[blocks.count++] = first++;
+			}
+
+			if (last & 1)
+			{
+				blocks.level[blocks.count] = level;
+				blocks.index[blocks.count++] = --last;
+			}
+
+			first /= 2;
+			last /= 2;
+		}
+	};
+
+	Blocks columns;
+	Blocks rows;
+	split(query.left, query.right, columns);
+	split(query.top, query.bottom, rows);
+
+	minimum = FLT_MAX;
+	maximum = -FLT_MAX;
+	double total = 0.0;
+
+	for (unsigned int row = 0; row < rows.count; ++row)
+	{
+		for (unsigned int column = 0; column < columns.count; ++column)
+		{
+			const Level &level = GetLevel(columns.level[column], rows.level[row]);
+			const HeightPyramidCell &cell = level.cells[(rows.index[row] * level.width) + columns.index[column]];
+			if (cell.minimum < minimum) minimum = cell.minimum;
+			if (cell.maximum > maximum) maximum = cell.maximum;
+
+			total += static_cast<double>(cell.average) * static_cast<double>(1u << columns.level[column]) * static_cast<double>(1u << rows.level[row]);
+		}
+	}
+
+	const double samples = static_cast<double>(query.right - query.left) * static_cast<double>(query.bottom - query.top);
+	average = static_cast<float>(total / samples);
+	return true;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "../helper.h"
+#include "TerrainArea.h"
+#include <vector>
+
+struct HeightPyramidCell
+{
+	float					minimum;							//!< The lowest height covered by the cell
+	float					maximum;							//!< The highest height covered by the cell
+	float					average;							//!< The average height covered by the cell
+};
+
+/*
+ *	\brief A min/max/average mip pyramid over a height plane.
+ *	Level 0 holds one cell per height sample, each level above halves the
+ *	resolution until a single cell covers the whole plane.
+ *
+ *	The columns and rows are halved separately, so there is a level for every
+ *	pair of column and row halvings, about four times the cells of the plane.
+ *	The square levels are those halved the same number of times both ways. A
+ *	range query splits its columns and its rows into at most two aligned blocks
+ *	per halving and takes one cell for each pair, so it reads O(log w * log h)
+ *	cells however large the area.
+*/
+class CHeightPyramid {
+private:
+
+	struct Level
+	{
+		unsigned int					width;					//!< The number of columns in the level
+		unsigned int					height;					//!< The number of rows in the level
+		std::vector<HeightPyramidCell>	cells;					//!< The cells of the level
+	};
+
+private:
+	std::vector<Level>		m_levels;							//!< The levels of the pyramid, by row halvings then column halvings
+	unsigned int			m_columnLevels;						//!< The number of times the columns halve, plus one
+	unsigned int			m_rowLevels;						//!< The number of times the rows halve, plus one
+
+private:
+							//! Get a level by the number of times its columns and rows are halved, each clamped to the last
+	const Level				&GetLevel(
+								unsigned int columnLevel,		//!< The number of times the columns are halved
+								unsigned int rowLevel			//!< The number of times the rows are halved
+							) const
+							{
+								columnLevel = columnLevel < m_columnLevels ? columnLevel : m_columnLevels - 1;
+								rowLevel = rowLevel < m_rowLevels ? rowLevel : m_rowLevels - 1;
+								return m_levels[(rowLevel * m_columnLevels) + columnLevel];
+							}
+
+							//! Re-reduce the cells of an area of a level from the level halved once less, along the columns when it can
+	void					ReduceLevel(
+								unsigned int columnLevel,		//!< The number of times the columns of the level are halved
+								unsigned int rowLevel,			//!< The number of times the rows of the level are halved, with the columns, not both 0
+								const TerrainArea &area			//!< The area of the level to reduce
+							);
+
+							//! Get the number of base samples covered by a cell along one axis
+	unsigned int			GetCellCoverage(
+								unsigned int level,				//!< The level of the cell
+								unsigned int cell,				//!< The index of the cell along the axis
+								unsigned int baseSize			//!< The size of the base level along the axis
+							) const;
+
+public:
+							//! Class constructor
+							CHeightPyramid();
+
+							//! Class destructor
+							~CHeightPyramid();
+
+							//! Allocate the pyramid levels for a given height plane size
+	void					Create(
+								unsigned int width,				//!< The number of columns in the height plane
+								unsigned int height				//!< The number of rows in the height plane
+							);
+
+							//! Rebuild every level from the height plane
+	void					Rebuild(
+								const float *heights,			//!< The first height in the plane
+								unsigned int stride				//!< The number of floats between consecutive heights
+							);
+
+							//! Update the base cells of an area and re-reduce only their parents
+	void					Update(
+								const float *heights,			//!< The first height in the plane
+								unsigned int stride,			//!< The number of floats between consecutive heights
+								const TerrainArea &area			//!< The area of the height plane which changed
+							);
+
+							//! Find the lowest, highest and average heights within an area, false if it is empty
+	bool					QueryRange(
+								const TerrainArea &area,		//!< The area of the base level to query
+								float &minimum,					//!< Receives the lowest height in the area
+								float &maximum,					//!< Receives the highest height in the area
+								float &average					//!< Receives the average height in the area
+							) const;
+
+							//! Get the number of square levels in the pyramid
+	unsigned int			GetLevelCount() const
+							{
+								return m_columnLevels > m_rowLevels ? m_columnLevels : m_rowLevels;
+							}
+
+							//! Get the number of columns in a square level
+	unsigned int			GetLevelWidth(
+								unsigned int level				//!< The level to query
+							) const
+							{
+								return GetLevel(level, level).width;
+							}
+
+							//! Get the number of rows in a square level
+	unsigned int			GetLevelHeight(
+								unsigned int level				//!< The level to query
+							) const
+							{
+								return GetLevel(level, level).height;
+							}
+
+							//! Get a cell of a square level
+	const HeightPyramidCell	&GetCell(
+								unsigned int level,				//!< The level of the cell
+								unsigned int x,					//!< The column of the cell
+								unsigned int z					//!< The row of the cell
+							) const
+							{
+								const Level &square = GetLevel(level, level);
+								return square.cells[(z * square.width) + x];
+							}
+
+							//! Get the cell covering the whole height plane
+	const HeightPyramidCell	&GetRoot() const
+							{
+								return m_levels.back().cells[0];
+							}
+};
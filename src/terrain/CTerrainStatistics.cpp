@@ -0,0 +1,193 @@
+#include "CTerrainStatistics.h"
+
+/*
+ *	\brief Class constructor
+*/
+CTerrainStatistics::CTerrainStatistics(
+		const CHeightPyramid *pyramid				//!< The pyramid providing the min and max heights, must be updated first
+	) :
+	m_pyramid(pyramid),
+	m_width(0),
+	m_height(0),
+	m_sum(0.0),
+	m_histogramMinimum(0.0f),
+	m_histogramBinSize(1.0f)
+{
+	for (unsigned int bin = 0; bin < HistogramBins; ++bin)
+	{
+		m_histogram[bin] = 0;
+	}
+}
+
+/*
+ *	\brief Class destructor
+*/
+CTerrainStatistics::~CTerrainStatistics()
+{
+
+}
+
+/*
+ *	\brief Rebuild the statistics from the whole height plane
+*/
+void CTerrainStatistics::Rebuild(
+		const float *heights,						//!< The first height in the plane
+		unsigned int stride,						//!< The number of floats between consecutive heights
+		unsigned int width,							//!< The number of columns in the height plane
+		unsigned int height							//!< The number of rows in the height plane
+	)
+{
+	m_width = width;
+	m_height = height;
+
+	m_sum = 0.0;
+	for (unsigned int index = 0; index < width * height; ++index)
+	{
+		m_sum += heights[index * stride];
+	}
+
+	RebuildHistogram(heights, stride);
+}
+
+/*
+ *	\brief Take the heights of an area out of the statistics, before the plane changes them
+*/
+void CTerrainStatistics::BeginUpdate(
+		const float *heights,						//!< The first height in the plane, still holding the old heights
+		unsigned int stride,						//!< The number of floats between consecutive heights
+		const TerrainArea &area						//!< The area of the height plane about to change
+	)
+{
+	const unsigned int right = area.right > m_width ? m_width : area.right;
+	const unsigned int bottom = area.bottom > m_height ? m_height : area.bottom;
+
+	for (unsigned int z = area.top; z < bottom; ++z)
+	{
+		for (unsigned int x = area.left; x < right; ++x)
+		{
+			const float oldHeight = heights[((z * m_width) + x) * stride];
+			m_sum -= oldHeight;
+			m_histogram[GetBin(oldHeight)]--;
+		}
+	}
+}
+
+/*
+ *	\brief Put the heights of an area back into the statistics once they have changed, after BeginUpdate for the same area
+*/
+void CTerrainStatistics::Update(
+		const float *heights,						//!< The first height in the plane, holding the new heights
+		unsigned int stride,						//!< The number of floats between consecutive heights
+		const TerrainArea &area						//!< The area of the height plane which changed
+	)
+{
+	const unsigned int right = area.right > m_width ? m_width : area.right;
+	const unsigned int bottom = area.bottom > m_height ? m_height : area.bottom;
+
+	bool outsideHistogram = false;
+
+	for (unsigned int z = area.top; z < bottom; ++z)
+	{
+		for (unsigned int x = area.left; x < right; ++x)
+		{
+			const float newHeight = heights[((z * m_width) + x) * stride];
+			m_sum += newHeight;
+
+			// once a height leaves the histogram range every bin will be recounted anyway
+			if (outsideHistogram || IsOutsideHistogram(newHeight))
+			{
+				outsideHistogram = true;
+				continue;
+			}
+
+			m_histogram[GetBin(newHeight)]++;
+		}
+	}
+
+	if (outsideHistogram)
+	{
+		RebuildHistogram(heights, stride);
+	}
+}
+
+/*
+ *	\brief Get the histogram bin a height falls in
+*/
+unsigned int CTerrainStatistics::GetBin(
+		const float height							//!< The height to find the bin of
+	) const
+{
+	const int bin = static_cast<int>((height - m_histogramMinimum) / m_histogramBinSize);
+	return bin < 0 ? 0 : bin >= static_cast<int>(HistogramBins) ? HistogramBins - 1 : static_cast<unsigned int>(bin);
+}
+
+/*
+ *	\brief Is a height outside of the range covered by the histogram
+*/
+bool CTerrainStatistics::IsOutsideHistogram(
+		const float height							//!< The height to test
+	) const
+{
+	return height < m_histogramMinimum || height >= m_histogramMinimum + (m_histogramBinSize * HistogramBins);
+}
+
+/*
+ *	\brief Choose a new histogram range from the current heights and rebin them
+*/
+void CTerrainStatistics::RebuildHistogram(
+		const float *heights,						//!< The first height in the plane
+		unsigned int stride							//!< The number of floats between consecutive heights
+	)
+{
+	const float minimum = GetMinimum();
+	const float maximum = GetMaximum();
+
+	// leave head room either side so small brush strokes don't force a rebin
+	float padding = (maximum - minimum) * 0.25f;
+	if (padding < 16.0f) padding = 16.0f;
+
+	m_histogramMinimum = minimum - padding;
+	m_histogramBinSize = ((maximum - minimum) + (padding * 2.0f)) / static_cast<float>(HistogramBins);
+
+	for (unsigned int bin = 0; bin < HistogramBins; ++bin)
+	{
+		m_histogram[bin] = 0;
+	}
+
+	for (unsigned int index = 0; index < m_width * m_height; ++index)
+	{
+		m_histogram[GetBin(heights[index * stride])]++;
+	}
+}
+
+/*
+ *	\brief Estimate the height below which a given fraction of the terrain lies
+*/
+float CTerrainStatistics::GetHeightAtPercentile(
+		float fraction								//!< The fraction of the terrain, between 0 and 1
+	) const
+{
+	if (m_width * m_height == 0)
+		return 0.0f;
+
+	fraction = fraction < 0.0f ? 0.0f : fraction > 1.0f ? 1.0f : fraction;
+	const float target = fraction * static_cast<float>(m_width * m_height);
+
+	float height = GetMaximum();
+	float counted = 0.0f;
+	for (unsigned int bin = 0; bin < HistogramBins; ++bin)
+	{
+		const float count = static_cast<float>(m_histogram[bin]);
+		if (count > 0.0f && counted + count >= target)
+		{
+			// interpolate within the bin
+			height = m_histogramMinimum + (m_histogramBinSize * (bin + ((target - counted) / count)));
+			break;
+		}
+		counted += count;
+	}
+
+	const float minimum = GetMinimum();
+	const float maximum = GetMaximum();
+	return height < minimum ? minimum : height > maximum ? maximum : height;
+}
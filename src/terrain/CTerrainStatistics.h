@@ -0,0 +1,120 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "CHeightPyramid.h"
+
+/*
+ *	\brief Tracks the min, max, mean and a histogram of a height plane.
+ *	Updates only touch the modified area, and come in two halves: the area's
+ *	heights are taken out of the running sum and histogram before the plane
+ *	changes, and the new heights put back in after, so no copy of the plane
+ *	is kept. The min and max are read from the root of the height pyramid.
+*/
+class CTerrainStatistics {
+public:
+	static const unsigned int		HistogramBins = 64;					//!< The number of bins in the height histogram
+
+private:
+	const CHeightPyramid			*m_pyramid;							//!< The pyramid providing the min and max heights
+
+	unsigned int					m_width;							//!< The number of columns in the height plane
+	unsigned int					m_height;							//!< The number of rows in the height plane
+
+	double							m_sum;								//!< The sum of every height
+	unsigned int					m_histogram[HistogramBins];			//!< The number of heights in each bin
+	float							m_histogramMinimum;					//!< The height at the start of the first bin
+	float							m_histogramBinSize;					//!< The range of heights covered by each bin
+
+private:
+									//! Get the histogram bin a height falls in
+	unsigned int					GetBin(
+										const float height				//!< The height to find the bin of
+									) const;
+
+									//! Is a height outside of the range covered by the histogram
+	bool							IsOutsideHistogram(
+										const float height				//!< The height to test
+									) const;
+
+									//! Choose a new histogram range from the current heights and rebin them
+	void							RebuildHistogram(
+										const float *heights,			//!< The first height in the plane
+										unsigned int stride				//!< The number of floats between consecutive heights
+									);
+
+public:
+									//! Class constructor
+									CTerrainStatistics(
+										const CHeightPyramid *pyramid	//!< The pyramid providing the min and max heights, must be updated first
+									);
+
+									//! Class destructor
+									~CTerrainStatistics();
+
+									//! Rebuild the statistics from the whole height plane
+	void							Rebuild(
+										const float *heights,			//!< The first height in the plane
+										unsigned int stride,			//!< The number of floats between consecutive heights
+										unsigned int width,				//!< The number of columns in the height plane
+										unsigned int height				//!< The number of rows in the height plane
+									);
+
+									//! Take the heights of an area out of the statistics, before the plane changes them
+	void							BeginUpdate(
+										const float *heights,			//!< The first height in the plane, still holding the old heights
+										unsigned int stride,			//!< The number of floats between consecutive heights
+										const TerrainArea &area			//!< The area of the height plane about to change
+									);
+
+									//! Put the heights of an area back into the statistics once they have changed, after BeginUpdate for the same area
+	void							Update(
+										const float *heights,			//!< The first height in the plane, holding the new heights
+										unsigned int stride,			//!< The number of floats between consecutive heights
+										const TerrainArea &area			//!< The area of the height plane which changed
+									);
+
+									//! Get the lowest height
+	float							GetMinimum() const
+									{
+										return m_pyramid->GetRoot().minimum;
+									}
+
+									//! Get the highest height
+	float							GetMaximum() const
+									{
+										return m_pyramid->GetRoot().maximum;
+									}
+
+									//! Get the mean height
+	float							GetMean() const
+									{
+										return m_width * m_height == 0 ? 0.0f : static_cast<float>(m_sum / (m_width * m_height));
+									}
+
+									//! Get the number of heights counted in a histogram bin
+	unsigned int					GetHistogramCount(
+										unsigned int bin				//!< The bin to get the count of
+									) const
+									{
+										return m_histogram[bin];
+									}
+
+									//! Get the height at the start of the first histogram bin
+	float							GetHistogramMinimum() const
+									{
+										return m_histogramMinimum;
+									}
+
+									//! Get the range of heights covered by each histogram bin
+	float							GetHistogramBinSize() const
+									{
+										return m_histogramBinSize;
+									}
+
+									//! Estimate the height below which a given fraction of the terrain lies
+	float							GetHeightAtPercentile(
+										float fraction					//!< The fraction of the terrain, between 0 and 1
+									) const;
+};
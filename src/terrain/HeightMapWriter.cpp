@@ -0,0 +1,77 @@
+#include "HeightMapWriter.h"
+#include <fstream>
+#include <vector>
+
+/*
+ *	\brief Write a little endian value into a byte buffer
+*/
+template<typename T>
+static void WriteLittleEndian(
+		unsigned char *data,
+		const T value
+	)
+{
+	for (unsigned int byte = 0; byte < sizeof(T); ++byte)
+	{
+		data[byte] = static_cast<unsigned char>((value >> (byte * 8)) & 0xff);
+	}
+}
+
+/*
+ *	\brief Write a height plane as a 24 bit greyscale heightmap bitmap
+*/
+bool SaveHeightMapBitmap(
+		const char *fileName,						//!< The location to write the heightmap to
+		const HeightPlane &plane,					//!< The heights to write
+		const float minimum,						//!< The lowest height in the plane
+		const float maximum							//!< The highest height in the plane
+	)
+{
+	static const unsigned int HeaderSize = 54;		// BITMAPFILEHEADER + BITMAPINFOHEADER
+
+	if (plane.IsEmpty())
+		return false;
+
+	// rows are padded to 4 bytes, the same as CHeightMapLoader expects
+	const unsigned int rowPitch = ((plane.width * 3) + 3) & ~3u;
+	const unsigned int imageSize = rowPitch * plane.height;
+
+	unsigned char header[HeaderSize] = { 0 };
+	header[0] = 'B';
+	header[1] = 'M';
+	WriteLittleEndian<unsigned int>(&header[2], HeaderSize + imageSize);
+	WriteLittleEndian<unsigned int>(&header[10], HeaderSize);
+	WriteLittleEndian<unsigned int>(&header[14], 40);
+	WriteLittleEndian<unsigned int>(&header[18], plane.width);
+	WriteLittleEndian<unsigned int>(&header[22], plane.height);
+	WriteLittleEndian<unsigned short>(&header[26], 1);
+	WriteLittleEndian<unsigned short>(&header[28], 24);
+	WriteLittleEndian<unsigned int>(&header[38], 0x0ec4);
+	WriteLittleEndian<unsigned int>(&header[42], 0x0ec4);
+
+	// offset the lowest point to 0, only squash the heights if they don't fit in a byte
+	const float scale = maximum - minimum > 255.0f ? 255.0f / (maximum - minimum) : 1.0f;
+
+	std::vector<unsigned char> image(imageSize, 0);
+	for (unsigned int z = 0; z < plane.height; ++z)
+	{
+		unsigned char *const pixel = &image[z * rowPitch];
+		for (unsigned int x = 0; x < plane.width; ++x)
+		{
+			float value = (plane.At(x, z) - minimum) * scale;
+			value = value < 0.0f ? 0.0f : value > 255.0f ? 255.0f : value;
+
+			const unsigned char color = static_cast<unsigned char>(value);
+			pixel[(x * 3)] = pixel[(x * 3) + 1] = pixel[(x * 3) + 2] = color;
+		}
+	}
+
+	std::ofstream file(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+
+	file.write(reinterpret_cast<const char*>(header), HeaderSize);
+	file.write(reinterpret_cast<const char*>(&image[0]), imageSize);
+
+	return file.good();
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "HeightPlane.h"
+
+							//! Write a height plane as a 24 bit greyscale heightmap bitmap.
+							//! The minimum is written as 0, the range is only squashed if it doesn't fit in a byte.
+bool						SaveHeightMapBitmap(
+								const char *fileName,			//!< The location to write the heightmap to
+								const HeightPlane &plane,		//!< The heights to write
+								const float minimum,			//!< The lowest height in the plane
+								const float maximum				//!< The highest height in the plane
+							);
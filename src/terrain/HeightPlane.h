@@ -0,0 +1,74 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include <float.h>
+#include <math.h>
+
+/*
+ *	\brief A view of a square grid of heights, which may be interleaved with other vertex data.
+ *	Height x, z lives at heights[((z * width) + x) * stride], vertex x, z sits at world x, z.
+*/
+struct HeightPlane
+{
+	float					*heights;							//!< The first height in the plane
+	unsigned int			stride;								//!< The number of floats between consecutive heights
+	unsigned int			width;								//!< The number of columns in the plane
+	unsigned int			height;								//!< The number of rows in the plane
+
+							//! Does the plane contain no heights
+	bool					IsEmpty() const
+							{
+								return heights == nullptr || width == 0 || height == 0;
+							}
+
+							//! Get the height of a given cell
+	float					&At(
+								unsigned int x,					//!< The column of the cell
+								unsigned int z					//!< The row of the cell
+							) const
+							{
+								return heights[((z * width) + x) * stride];
+							}
+
+							//! Get the height of the vertex closest to a world x, z, or null if none are within a cell
+	float					*GetNearest(
+								const float x,					//!< The x coord to look up the height from
+								const float z					//!< The z coord to look up the height from
+							) const
+							{
+								if (IsEmpty())
+									return nullptr;
+
+								int cellX = static_cast<int>(floor(x + 0.5f));
+								int cellZ = static_cast<int>(floor(z + 0.5f));
+								cellX = cellX < 0 ? 0 : cellX >= static_cast<int>(width) ? static_cast<int>(width) - 1 : cellX;
+								cellZ = cellZ < 0 ? 0 : cellZ >= static_cast<int>(height) ? static_cast<int>(height) - 1 : cellZ;
+
+								if (fabs(cellX - x) > 1.0f || fabs(cellZ - z) > 1.0f)
+									return nullptr;
+
+								return &At(cellX, cellZ);
+							}
+
+							//! Find the lowest and highest heights in the plane
+	void					GetRange(
+								float &minimum,					//!< Receives the lowest height
+								float &maximum					//!< Receives the highest height
+							) const
+							{
+								minimum = FLT_MAX;
+								maximum = -FLT_MAX;
+
+								for (unsigned int z = 0; z < height; ++z)
+								{
+									for (unsigned int x = 0; x < width; ++x)
+									{
+										const float value = At(x, z);
+										if (value < minimum) minimum = value;
+										if (value > maximum) maximum = value;
+									}
+								}
+							}
+};
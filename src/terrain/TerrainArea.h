@@ -0,0 +1,18 @@
+#pragma once
+
+/*
+ *	\brief A rectangle of terrain cells, the right and bottom edges are exclusive
+*/
+struct TerrainArea
+{
+	unsigned int			left;								//!< The first column in the area
+	unsigned int			top;								//!< The first row in the area
+	unsigned int			right;								//!< One past the last column in the area
+	unsigned int			bottom;								//!< One past the last row in the area
+
+							//! Does the area contain no cells
+	bool					IsEmpty() const
+							{
+								return left >= right || top >= bottom;
+							}
+};
@@ -0,0 +1,210 @@
+#include "TerrainBrushStamps.h"
+#include <stdlib.h>
+
+/*
+ *	\brief Get an area covering no cells, returned when a stamp misses the plane
+*/
+static TerrainArea GetEmptyArea()
+{
+	TerrainArea area = { 0, 0, 0, 0 };
+	return area;
+}
+
+/*
+ *	\brief Get the area of cells a stamp of a given size centered at x, z can modify
+*/
+TerrainArea GetStampArea(
+		const HeightPlane &plane,					//!< The plane being stamped
+		const float x,								//!< The x coord of the stamp center
+		const float z,								//!< The z coord of the stamp center
+		const int size								//!< The size of the stamp
+	)
+{
+	// vertex lookups snap to the closest vertex, so pad the area by a cell each side
+	const int centerX = static_cast<int>(floor(x + 0.5f));
+	const int centerZ = static_cast<int>(floor(z + 0.5f));
+
+	const int width = static_cast<int>(plane.width);
+	const int height = static_cast<int>(plane.height);
+
+	const int left = centerX - size - 1;
+	const int top = centerZ - size - 1;
+	const int right = centerX + size + 2;
+	const int bottom = centerZ + size + 2;
+
+	TerrainArea area;
+	area.left = static_cast<unsigned int>(left < 0 ? 0 : left > width ? width : left);
+	area.top = static_cast<unsigned int>(top < 0 ? 0 : top > height ? height : top);
+	area.right = static_cast<unsigned int>(right < 0 ? 0 : right > width ? width : right);
+	area.bottom = static_cast<unsigned int>(bottom < 0 ? 0 : bottom > height ? height : bottom);
+
+	return area;
+}
+
+/*
+ *	\brief Move the heights by an amount which falls off with distance from the center
+*/
+TerrainArea StampOffset(
+		const HeightPlane &plane,					//!< The plane to stamp
+		const float x,								//!< The x coord of the stamp center
+		const float z,								//!< The z coord of the stamp center
+		const int size,								//!< The size of the stamp
+		const float amount,							//!< The amount the center moves up by, negative to lower
+		const float falloff							//!< How quickly the amount falls off away from the center
+	)
+{
+	for (int xOffset = -size; xOffset <= size; ++xOffset)
+	{
+		for (int zOffset = -size; zOffset <= size; ++zOffset)
+		{
+			float *const height = plane.GetNearest(x + xOffset, z + zOffset);
+			if (height == nullptr)
+			{
+				continue;
+			}
+
+			float scale = 1;
+			if (xOffset < 0) scale += -xOffset; else scale += xOffset;
+			if (zOffset < 0) scale += -zOffset; else scale += zOffset;
+			scale *= falloff;
+
+			*height += amount / scale;
+		}
+	}
+
+	return GetStampArea(plane, x, z, size);
+}
+
+/*
+ *	\brief Set the heights to the height at the center
+*/
+TerrainArea StampLevel(
+		const HeightPlane &plane,					//!< The plane to stamp
+		const float x,								//!< The x coord of the stamp center
+		const float z,								//!< The z coord of the stamp center
+		const int size								//!< The size of the stamp
+	)
+{
+	const float *const center = plane.GetNearest(x, z);
+	if (center == nullptr)
+	{
+		return GetEmptyArea();
+	}
+
+	const float centerHeight = *center;
+
+	for (int xOffset = -size; xOffset <= size; ++xOffset)
+	{
+		for (int zOffset = -size; zOffset <= size; ++zOffset)
+		{
+			float *const height = plane.GetNearest(x + xOffset, z + zOffset);
+			if (height == nullptr)
+			{
+				continue;
+			}
+
+			*height = centerHeight;
+		}
+	}
+
+	return GetStampArea(plane, x, z, size);
+}
+
+/*
+ *	\brief Get the average height of the vertices a stamp covers
+*/
+float GetStampAverage(
+		const HeightPlane &plane,					//!< The plane to average
+		const float x,								//!< The x coord of the stamp center
+		const float z,								//!< The z coord of the stamp center
+		const int size								//!< The size of the stamp
+	)
+{
+	float count = 0.0f;
+	float total = 0.0f;
+
+	for (int xOffset = -size; xOffset <= size; ++xOffset)
+	{
+		for (int zOffset = -size; zOffset <= size; ++zOffset)
+		{
+			const float *const height = plane.GetNearest(x + xOffset, z + zOffset);
+			if (height == nullptr)
+			{
+				continue;
+			}
+
+			total += *height;
+			count++;
+		}
+	}
+
+	return count > 0.0f ? total / count : 0.0f;
+}
+
+/*
+ *	\brief Pull the heights towards their average
+*/
+TerrainArea StampSmooth(
+		const HeightPlane &plane,					//!< The plane to stamp
+		const float x,								//!< The x coord of the stamp center
+		const float z,								//!< The z coord of the stamp center
+		const int size,								//!< The size of the stamp
+		const float amount							//!< The fraction of the distance to the average moved, between 0 and 1
+	)
+{
+	if (plane.GetNearest(x, z) == nullptr)
+	{
+		return GetEmptyArea();
+	}
+
+	const float averageHeight = GetStampAverage(plane, x, z, size);
+
+	for (int xOffset = -size; xOffset <= size; ++xOffset)
+	{
+		for (int zOffset = -size; zOffset <= size; ++zOffset)
+		{
+			float *const height = plane.GetNearest(x + xOffset, z + zOffset);
+			if (height == nullptr)
+			{
+				continue;
+			}
+
+			*height -= (*height - averageHeight) * amount;
+		}
+	}
+
+	return GetStampArea(plane, x, z, size);
+}
+
+/*
+ *	\brief Add random noise to the heights, seed with srand for repeatable results
+*/
+TerrainArea StampNoise(
+		const HeightPlane &plane,					//!< The plane to stamp
+		const float x,								//!< The x coord of the stamp center
+		const float z,								//!< The z coord of the stamp center
+		const int size,								//!< The size of the stamp
+		const float amplitude						//!< The largest change to any height
+	)
+{
+	if (plane.GetNearest(x, z) == nullptr)
+	{
+		return GetEmptyArea();
+	}
+
+	for (int xOffset = -size; xOffset <= size; ++xOffset)
+	{
+		for (int zOffset = -size; zOffset <= size; ++zOffset)
+		{
+			float *const height = plane.GetNearest(x + xOffset, z + zOffset);
+			if (height == nullptr)
+			{
+				continue;
+			}
+
+			*height += (500 - (rand() % 1000)) * (amplitude / 500.0f);
+		}
+	}
+
+	return GetStampArea(plane, x, z, size);
+}
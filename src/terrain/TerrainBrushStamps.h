@@ -0,0 +1,65 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "HeightPlane.h"
+#include "TerrainArea.h"
+
+/*
+ *	The brush stamps shared by the editor brushes and the batch processor.
+ *	Each stamp covers the (size * 2 + 1) square of vertices closest to a world x, z
+ *	and returns the area of the plane it may have modified.
+*/
+
+							//! Get the area of cells a stamp of a given size centered at x, z can modify
+TerrainArea					GetStampArea(
+								const HeightPlane &plane,		//!< The plane being stamped
+								const float x,					//!< The x coord of the stamp center
+								const float z,					//!< The z coord of the stamp center
+								const int size					//!< The size of the stamp
+							);
+
+							//! Move the heights by an amount which falls off with distance from the center
+TerrainArea					StampOffset(
+								const HeightPlane &plane,		//!< The plane to stamp
+								const float x,					//!< The x coord of the stamp center
+								const float z,					//!< The z coord of the stamp center
+								const int size,					//!< The size of the stamp
+								const float amount,				//!< The amount the center moves up by, negative to lower
+								const float falloff				//!< How quickly the amount falls off away from the center
+							);
+
+							//! Set the heights to the height at the center
+TerrainArea					StampLevel(
+								const HeightPlane &plane,		//!< The plane to stamp
+								const float x,					//!< The x coord of the stamp center
+								const float z,					//!< The z coord of the stamp center
+								const int size					//!< The size of the stamp
+							);
+
+							//! Pull the heights towards their average
+TerrainArea					StampSmooth(
+								const HeightPlane &plane,		//!< The plane to stamp
+								const float x,					//!< The x coord of the stamp center
+								const float z,					//!< The z coord of the stamp center
+								const int size,					//!< The size of the stamp
+								const float amount				//!< The fraction of the distance to the average moved, between 0 and 1
+							);
+
+							//! Add random noise to the heights, seed with srand for repeatable results
+TerrainArea					StampNoise(
+								const HeightPlane &plane,		//!< The plane to stamp
+								const float x,					//!< The x coord of the stamp center
+								const float z,					//!< The z coord of the stamp center
+								const int size,					//!< The size of the stamp
+								const float amplitude			//!< The largest change to any height
+							);
+
+							//! Get the average height of the vertices a stamp covers
+float						GetStampAverage(
+								const HeightPlane &plane,		//!< The plane to average
+								const float x,					//!< The x coord of the stamp center
+								const float z,					//!< The z coord of the stamp center
+								const int size					//!< The size of the stamp
+							);
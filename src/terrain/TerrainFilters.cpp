@@ -0,0 +1,102 @@
+#include "TerrainFilters.h"
+#include <vector>
+
+/*
+ *	\brief Replace each height with the average of its 3x3 neighbourhood
+*/
+void FilterBlur(
+		const HeightPlane &plane,					//!< The plane to filter
+		const unsigned int passes					//!< The number of times the blur is applied
+	)
+{
+	if (plane.IsEmpty())
+		return;
+
+	const int width = static_cast<int>(plane.width);
+	const int height = static_cast<int>(plane.height);
+
+	std::vector<float> source(plane.width * plane.height);
+
+	for (unsigned int pass = 0; pass < passes; ++pass)
+	{
+		for (int z = 0; z < height; ++z)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				source[(z * width) + x] = plane.At(x, z);
+			}
+		}
+
+		for (int z = 0; z < height; ++z)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				float total = 0.0f;
+				float count = 0.0f;
+
+				// edge cells only average the neighbours which exist
+				for (int neighbourZ = z - 1; neighbourZ <= z + 1; ++neighbourZ)
+				{
+					if (neighbourZ < 0 || neighbourZ >= height)
+						continue;
+
+					for (int neighbourX = x - 1; neighbourX <= x + 1; ++neighbourX)
+					{
+						if (neighbourX < 0 || neighbourX >= width)
+							continue;
+
+						total += source[(neighbourZ * width) + neighbourX];
+						count++;
+					}
+				}
+
+				plane.At(x, z) = total / count;
+			}
+		}
+	}
+}
+
+/*
+ *	\brief Clamp every height into a range
+*/
+void FilterClamp(
+		const HeightPlane &plane,					//!< The plane to filter
+		const float minimum,						//!< The lowest height allowed
+		const float maximum							//!< The highest height allowed
+	)
+{
+	for (unsigned int z = 0; z < plane.height; ++z)
+	{
+		for (unsigned int x = 0; x < plane.width; ++x)
+		{
+			float &height = plane.At(x, z);
+			height = height < minimum ? minimum : height > maximum ? maximum : height;
+		}
+	}
+}
+
+/*
+ *	\brief Linearly remap the heights so they span a new range
+*/
+void FilterRescale(
+		const HeightPlane &plane,					//!< The plane to filter
+		const float minimum,						//!< The new lowest height
+		const float maximum							//!< The new highest height
+	)
+{
+	float currentMinimum, currentMaximum;
+	plane.GetRange(currentMinimum, currentMaximum);
+
+	// a flat plane has no range to stretch, move it to the new minimum
+	const float range = currentMaximum - currentMinimum;
+	const float scale = range > 0.0f ? (maximum - minimum) / range : 0.0f;
+
+	for (unsigned int z = 0; z < plane.height; ++z)
+	{
+		for (unsigned int x = 0; x < plane.width; ++x)
+		{
+			float &height = plane.At(x, z);
+			height = minimum + ((height - currentMinimum) * scale);
+		}
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "HeightPlane.h"
+
+/*
+ *	Whole plane height filters used by the batch processor.
+*/
+
+							//! Replace each height with the average of its 3x3 neighbourhood
+void						FilterBlur(
+								const HeightPlane &plane,		//!< The plane to filter
+								const unsigned int passes		//!< The number of times the blur is applied
+							);
+
+							//! Clamp every height into a range
+void						FilterClamp(
+								const HeightPlane &plane,		//!< The plane to filter
+								const float minimum,			//!< The lowest height allowed
+								const float maximum				//!< The highest height allowed
+							);
+
+							//! Linearly remap the heights so they span a new range
+void						FilterRescale(
+								const HeightPlane &plane,		//!< The plane to filter
+								const float minimum,			//!< The new lowest height
+								const float maximum				//!< The new highest height
+							);
@@ -0,0 +1,101 @@
+#include "TerrainGenerators.h"
+
+/*
+ *	\brief Hash a lattice point to a value between -1 and 1
+*/
+static float LatticeValue(
+		const unsigned int seed,					//!< The seed of the noise
+		const int x,								//!< The x coord of the lattice point
+		const int z									//!< The z coord of the lattice point
+	)
+{
+	unsigned int hash = seed;
+	hash ^= static_cast<unsigned int>(x) * 0x27d4eb2du;
+	hash ^= static_cast<unsigned int>(z) * 0x165667b1u;
+	hash = (hash ^ (hash >> 15)) * 0x85ebca6bu;
+	hash = (hash ^ (hash >> 13)) * 0xc2b2ae35u;
+	hash ^= hash >> 16;
+
+	return (static_cast<float>(hash & 0xffff) / 32767.5f) - 1.0f;
+}
+
+/*
+ *	\brief Smoothly interpolate the lattice values around a point
+*/
+static float ValueNoise(
+		const unsigned int seed,					//!< The seed of the noise
+		const float x,								//!< The x coord in lattice units
+		const float z								//!< The z coord in lattice units
+	)
+{
+	const float floorX = floor(x);
+	const float floorZ = floor(z);
+	const int cellX = static_cast<int>(floorX);
+	const int cellZ = static_cast<int>(floorZ);
+
+	// smoothstep the blend so the lattice lines don't show
+	float blendX = x - floorX;
+	float blendZ = z - floorZ;
+	blendX = blendX * blendX * (3.0f - (2.0f * blendX));
+	blendZ = blendZ * blendZ * (3.0f - (2.0f * blendZ));
+
+	const float topLeft = LatticeValue(seed, cellX, cellZ);
+	const float topRight = LatticeValue(seed, cellX + 1, cellZ);
+	const float bottomLeft = LatticeValue(seed, cellX, cellZ + 1);
+	const float bottomRight = LatticeValue(seed, cellX + 1, cellZ + 1);
+
+	const float top = topLeft + ((topRight - topLeft) * blendX);
+	const float bottom = bottomLeft + ((bottomRight - bottomLeft) * blendX);
+	return top + ((bottom - top) * blendZ);
+}
+
+/*
+ *	\brief Set every height in the plane to a given value
+*/
+void GenerateFlat(
+		const HeightPlane &plane,					//!< The plane to fill
+		const float height							//!< The height to fill the plane with
+	)
+{
+	for (unsigned int z = 0; z < plane.height; ++z)
+	{
+		for (unsigned int x = 0; x < plane.width; ++x)
+		{
+			plane.At(x, z) = height;
+		}
+	}
+}
+
+/*
+ *	\brief Fill the plane with fractal value noise
+*/
+void GenerateFractal(
+		const HeightPlane &plane,					//!< The plane to fill
+		const unsigned int seed,					//!< The seed of the noise
+		const unsigned int octaves,					//!< The number of noise layers summed together
+		const float featureSize,					//!< The number of cells between lattice points of the first octave
+		const float amplitude,						//!< The largest height of the first octave
+		const float persistence						//!< How much each octave's amplitude is scaled by
+	)
+{
+	const float baseFrequency = featureSize > 0.0f ? 1.0f / featureSize : 1.0f;
+
+	for (unsigned int z = 0; z < plane.height; ++z)
+	{
+		for (unsigned int x = 0; x < plane.width; ++x)
+		{
+			float frequency = baseFrequency;
+			float octaveAmplitude = amplitude;
+			float height = 0.0f;
+
+			for (unsigned int octave = 0; octave < octaves; ++octave)
+			{
+				height += ValueNoise(seed + octave, x * frequency, z * frequency) * octaveAmplitude;
+				frequency *= 2.0f;
+				octaveAmplitude *= persistence;
+			}
+
+			plane.At(x, z) = height;
+		}
+	}
+}
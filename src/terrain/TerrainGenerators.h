@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "HeightPlane.h"
+
+/*
+ *	Whole plane height generators used by the batch processor.
+ *	The same seed and parameters always produce the same plane.
+*/
+
+							//! Set every height in the plane to a given value
+void						GenerateFlat(
+								const HeightPlane &plane,		//!< The plane to fill
+								const float height				//!< The height to fill the plane with
+							);
+
+							//! Fill the plane with fractal value noise
+void						GenerateFractal(
+								const HeightPlane &plane,		//!< The plane to fill
+								const unsigned int seed,		//!< The seed of the noise
+								const unsigned int octaves,		//!< The number of noise layers summed together
+								const float featureSize,		//!< The number of cells between lattice points of the first octave
+								const float amplitude,			//!< The largest height of the first octave
+								const float persistence			//!< How much each octave's amplitude is scaled by
+							);
@@ -0,0 +1,115 @@
+#include "TerrainMesh.h"
+#include <string.h>
+
+/*
+ *	\brief Calculate smooth vertex normals for a height plane by averaging the normals of the faces around each vertex
+*/
+void CalculatePlaneNormals(
+		const HeightPlane &plane,					//!< The heights to calculate the normals of
+		float *faceNormals,							//!< Scratch space for three floats per face, (width - 1) * (height - 1) faces
+		float *normals,								//!< The x of the first vertex normal, laid out like the plane
+		const unsigned int stride					//!< The number of floats between consecutive normals
+	)
+{
+	const int width = static_cast<int>(plane.width);
+	const int height = static_cast<int>(plane.height);
+	const int faceWidth = width - 1;
+
+	// Go through all the faces in the mesh and calculate their normals.
+	// Vertex x, z sits at world x, z so only the heights differ between faces.
+	for (int z = 0; z < height - 1; ++z)
+	{
+		for (int x = 0; x < width - 1; ++x)
+		{
+			const float height1 = plane.At(x, z);
+			const float height2 = plane.At(x + 1, z);
+			const float height3 = plane.At(x, z + 1);
+
+			// The two vectors for this face, vertex1 - vertex3 and vertex3 - vertex2
+			const float vector1[3] = { 0.0f, height1 - height3, -1.0f };
+			const float vector2[3] = { -1.0f, height3 - height2, 1.0f };
+
+			// The cross product of those two vectors is the un-normalized face normal.
+			float *const face = &faceNormals[((z * faceWidth) + x) * 3];
+			face[0] = (vector1[1] * vector2[2]) - (vector1[2] * vector2[1]);
+			face[1] = (vector1[2] * vector2[0]) - (vector1[0] * vector2[2]);
+			face[2] = (vector1[0] * vector2[1]) - (vector1[1] * vector2[0]);
+		}
+	}
+
+	// Now go through all the vertices and take an average of each face normal
+	// that the vertex touches to get the averaged normal for that vertex.
+	for (int z = 0; z < height; ++z)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			float sum[3] = { 0.0f, 0.0f, 0.0f };
+			int count = 0;
+
+			// The four faces around the vertex: bottom left, bottom right, upper left, upper right
+			for (int faceZ = z - 1; faceZ <= z; ++faceZ)
+			{
+				if (faceZ < 0 || faceZ >= height - 1)
+					continue;
+
+				for (int faceX = x - 1; faceX <= x; ++faceX)
+				{
+					if (faceX < 0 || faceX >= width - 1)
+						continue;
+
+					const float *const face = &faceNormals[((faceZ * faceWidth) + faceX) * 3];
+					sum[0] += face[0];
+					sum[1] += face[1];
+					sum[2] += face[2];
+					count++;
+				}
+			}
+
+			// Take the average of the faces touching this vertex.
+			sum[0] = sum[0] / static_cast<float>(count);
+			sum[1] = sum[1] / static_cast<float>(count);
+			sum[2] = sum[2] / static_cast<float>(count);
+
+			const float length = sqrt((sum[0] * sum[0]) + (sum[1] * sum[1]) + (sum[2] * sum[2]));
+
+			// Normalize the final shared normal for this vertex.
+			float *const normal = &normals[((z * width) + x) * stride];
+			normal[0] = sum[0] / length;
+			normal[1] = sum[1] / length;
+			normal[2] = sum[2] / length;
+		}
+	}
+}
+
+/*
+ *	\brief Expand a grid of vertices into a triangle list, six vertices per quad
+*/
+void BuildTriangleList(
+		const float *vertices,						//!< The first vertex of the grid
+		const unsigned int vertexSize,				//!< The number of floats in each vertex
+		const unsigned int width,					//!< The number of columns in the grid
+		const unsigned int height,					//!< The number of rows in the grid
+		float *triangles							//!< Receives (width - 1) * (height - 1) * 6 vertices
+	)
+{
+	const size_t vertexBytes = vertexSize * sizeof(float);
+
+	for (unsigned int z = 0; z < height - 1; ++z)
+	{
+		for (unsigned int x = 0; x < width - 1; ++x)
+		{
+			const float *const bottomLeft	= &vertices[((z * width) + x) * vertexSize];
+			const float *const bottomRight	= &vertices[((z * width) + (x + 1)) * vertexSize];
+			const float *const topLeft		= &vertices[(((z + 1) * width) + x) * vertexSize];
+			const float *const topRight		= &vertices[(((z + 1) * width) + (x + 1)) * vertexSize];
+
+			memcpy(triangles, topLeft, vertexBytes);		triangles += vertexSize;
+			memcpy(triangles, topRight, vertexBytes);		triangles += vertexSize;
+			memcpy(triangles, bottomLeft, vertexBytes);		triangles += vertexSize;
+
+			memcpy(triangles, bottomLeft, vertexBytes);		triangles += vertexSize;
+			memcpy(triangles, topRight, vertexBytes);		triangles += vertexSize;
+			memcpy(triangles, bottomRight, vertexBytes);	triangles += vertexSize;
+		}
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+	Header file includes
+*/
+#include "HeightPlane.h"
+
+/*
+ *	Mesh building for a height plane, shared by CTerrain and the benchmarks.
+*/
+
+							//! Calculate smooth vertex normals for a height plane by averaging the normals of the faces around each vertex
+void						CalculatePlaneNormals(
+								const HeightPlane &plane,		//!< The heights to calculate the normals of
+								float *faceNormals,				//!< Scratch space for three floats per face, (width - 1) * (height - 1) faces
+								float *normals,					//!< The x of the first vertex normal, laid out like the plane
+								const unsigned int stride		//!< The number of floats between consecutive normals
+							);
+
+							//! Expand a grid of vertices into a triangle list, six vertices per quad
+void						BuildTriangleList(
+								const float *vertices,			//!< The first vertex of the grid
+								const unsigned int vertexSize,	//!< The number of floats in each vertex
+								const unsigned int width,		//!< The number of columns in the grid
+								const unsigned int height,		//!< The number of rows in the grid
+								float *triangles				//!< Receives (width - 1) * (height - 1) * 6 vertices
+							);